@@ -0,0 +1,38 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <audio/algo/drain/ArrayGeometry.hpp>
+#include <audio/algo/drain/debug.hpp>
+
+// http://www.labbookpages.co.uk/audio/beamforming/delaySum.html
+
+const double audio::algo::drain::speedSound = 340.29; // m/s
+
+double audio::algo::drain::calculateDelay(const vec3& _pos, const audio::algo::drain::Direction& _dir) {
+	// unitary vector in the direction of the source:
+	double cosEtha = etk::cos(_dir.angleEtha);
+	vec3 unit(etk::sin(_dir.angleAlpha) * cosEtha,
+	          etk::sin(_dir.angleEtha),
+	          etk::cos(_dir.angleAlpha) * cosEtha);
+	if (_dir.radius <= 0.0) {
+		// plane wave: projection of the position on the arrival direction
+		return -double(_pos.dot(unit)) / audio::algo::drain::speedSound;
+	}
+	vec3 pos = unit * _dir.radius;
+	double delay = (_pos-pos).length();
+	return (delay - _dir.radius) / audio::algo::drain::speedSound;
+}
+
+double audio::algo::drain::calculateMaxDelay(const etk::Vector<vec3>& _positions) {
+	double out = 0.0;
+	for (size_t iii=0; iii<_positions.size(); ++iii) {
+		for (size_t jjj=iii+1; jjj<_positions.size(); ++jjj) {
+			out = etk::max(out, double((_positions[iii]-_positions[jjj]).length()));
+		}
+	}
+	return out / audio::algo::drain::speedSound;
+}
+
@@ -0,0 +1,56 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <etk/types.hpp>
+#include <etk/Vector.hpp>
+#include <etk/math/Vector3D.hpp>
+
+namespace audio {
+	namespace algo {
+		namespace drain {
+			/**
+			 * @brief Speed of the sound in the air (m/s).
+			 */
+			extern const double speedSound;
+			/**
+			 * @brief Direction of a source seen from the center of a microphone array.
+			 */
+			class Direction {
+				public:
+					double radius; //!< radius distance of the source (<=0 for a plane wave ==> far field)
+					double angleAlpha; //!< angle on the XY plane, 0 is to the right and turning to the left is positive (clock orientation)
+					double angleEtha; //!< angle on the XZ plane, 0 is directly ahead, turning upwards is positive
+					/**
+					 * @brief Constructor
+					 * @param[in] _alpha Azimuth angle (radian).
+					 * @param[in] _etha Elevation angle (radian).
+					 * @param[in] _radius Distance of the source (meter), 0 for a far field source.
+					 */
+					Direction(double _alpha=0.0, double _etha=0.0, double _radius=0.0) :
+					  radius(_radius),
+					  angleAlpha(_alpha),
+					  angleEtha(_etha) {
+						
+					}
+			};
+			/**
+			 * @brief Calculate the delay of arrival of a source on a microphone, relative to the center of the array.
+			 * @param[in] _pos Position of the microphone (meter).
+			 * @param[in] _dir Direction of the source.
+			 * @return Delay in second (negative when the microphone is reached before the array center).
+			 */
+			double calculateDelay(const vec3& _pos, const audio::algo::drain::Direction& _dir);
+			/**
+			 * @brief Get the maximum delay difference that can exist between two microphones of the array.
+			 * @param[in] _positions Position of all the microphones (meter).
+			 * @return Delay in second.
+			 */
+			double calculateMaxDelay(const etk::Vector<vec3>& _positions);
+		}
+	}
+}
+
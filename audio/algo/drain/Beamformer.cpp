@@ -0,0 +1,314 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <audio/algo/drain/Beamformer.hpp>
+#include <audio/algo/drain/debug.hpp>
+
+// see http://www.labbookpages.co.uk/audio/beamforming/fractionalDelay.html
+
+// Number of sample processed at the same time (the crossfade of a steering change is done on one block).
+static const int32_t blockSize = 128;
+// Number of tap of the lagrange fractional delay interpolator (3rd order).
+static const int32_t lagrangeNbTap = 4;
+
+namespace audio {
+	namespace algo {
+		namespace drain {
+			class BeamformerPrivate {
+				protected:
+					float m_sampleRate;
+					int32_t m_nbChannel;
+					etk::Vector<vec3> m_positions; //!< position of each microphone
+					etk::Vector<float> m_weight; //!< weight of each microphone
+					audio::algo::drain::Direction m_steering; //!< current listening direction
+					int32_t m_maxDelay; //!< maximum delay that can be applied on a channel (sample)
+					int32_t m_latency; //!< delay applied on the first reached microphone for the last steering (sample)
+					int32_t m_size; //!< size of a delay line (power of 2)
+					int32_t m_mask; //!< mask of the delay line position
+					int32_t m_writePos; //!< current write position in the delay lines
+					etk::Vector<float> m_delayLine; //!< mirrored delay lines: [channel][2*m_size] (every sample is written at pos and pos+m_size to read a continuous window)
+					etk::Vector<int32_t> m_delayInteger[2]; //!< integer part of the delay of each channel (2 set to cross-fade)
+					etk::Vector<float> m_coef[2]; //!< lagrange coefficients with the weight of each channel [channel][lagrangeNbTap] (2 set to cross-fade)
+					int32_t m_current; //!< Id of the coefficient set in use
+					bool m_update; //!< A new coefficient set is waiting to be cross-faded
+					etk::Vector<float> m_tmp; //!< temporary output used for cross-fading
+					etk::Vector<double> m_delay; //!< temporary delay of arrival of each channel (second)
+				public:
+					BeamformerPrivate() :
+					  m_sampleRate(48000),
+					  m_nbChannel(0),
+					  m_maxDelay(0),
+					  m_latency(0),
+					  m_size(0),
+					  m_mask(0),
+					  m_writePos(0),
+					  m_current(0),
+					  m_update(false) {
+						
+					}
+					void init(float _sampleRate, int8_t _nbChannel) {
+						m_sampleRate = _sampleRate;
+						m_nbChannel = _nbChannel;
+						m_positions.clear();
+						m_weight.clear();
+						m_weight.resize(m_nbChannel, 1.0f/float(m_nbChannel));
+						m_delayLine.clear();
+						m_size = 0;
+						m_tmp.resize(blockSize, 0.0f);
+					}
+					void reset() {
+						for (size_t iii=0; iii<m_delayLine.size(); ++iii) {
+							m_delayLine[iii] = 0.0f;
+						}
+						m_writePos = 0;
+					}
+					bool setMicrophonePosition(const etk::Vector<vec3>& _positions) {
+						if (_positions.size() != size_t(m_nbChannel)) {
+							AA_DRAIN_ERROR("Request " << _positions.size() << " microphone position with " << m_nbChannel << " channels");
+							return false;
+						}
+						m_positions = _positions;
+						m_delay.resize(m_nbChannel, 0.0);
+						// all the possible compensation delay + the lagrange interpolator margin
+						m_maxDelay = int32_t(audio::algo::drain::calculateMaxDelay(m_positions) * m_sampleRate) + lagrangeNbTap + 1;
+						m_size = 1;
+						while (m_size < m_maxDelay + lagrangeNbTap + blockSize) {
+							m_size <<= 1;
+						}
+						m_mask = m_size - 1;
+						m_delayLine.clear();
+						m_delayLine.resize(m_nbChannel*m_size*2, 0.0f);
+						m_writePos = 0;
+						for (int32_t iii=0; iii<2; ++iii) {
+							m_delayInteger[iii].resize(m_nbChannel, 0);
+							m_coef[iii].resize(m_nbChannel*lagrangeNbTap, 0.0f);
+						}
+						m_current = 0;
+						calculateCoefficient(m_current);
+						m_update = false;
+						return true;
+					}
+					void setWeight(int32_t _idChannel, float _weight) {
+						if (    _idChannel < 0
+						     || _idChannel >= m_nbChannel) {
+							AA_DRAIN_ERROR("Request weight on channel " << _idChannel << " out of [0.." << m_nbChannel << "[");
+							return;
+						}
+						m_weight[_idChannel] = _weight;
+						requestUpdate();
+					}
+					void setSteering(const audio::algo::drain::Direction& _direction) {
+						m_steering = _direction;
+						requestUpdate();
+					}
+					const audio::algo::drain::Direction& getSteering() {
+						return m_steering;
+					}
+					int32_t getLatency() {
+						return m_latency;
+					}
+					void process(float* _output, const float* _input, size_t _nbChunk) {
+						if (m_size == 0) {
+							AA_DRAIN_ERROR("Beamformer microphone position are not set ...");
+							return;
+						}
+						while (_nbChunk > 0) {
+							int32_t nbSample = etk::min(size_t(blockSize), _nbChunk);
+							// store the input in the delay lines
+							for (int32_t iii=0; iii<nbSample; ++iii) {
+								int32_t pos = (m_writePos + iii) & m_mask;
+								for (int32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+									float* line = &m_delayLine[ccc*m_size*2];
+									line[pos] = _input[ccc];
+									line[pos + m_size] = _input[ccc];
+								}
+								_input += m_nbChannel;
+							}
+							processBlock(_output, nbSample, m_current);
+							if (m_update == true) {
+								// cross-fade from the old to the new set of coefficients
+								int32_t next = (m_current+1)%2;
+								processBlock(&m_tmp[0], nbSample, next);
+								float step = 1.0f / float(nbSample);
+								for (int32_t iii=0; iii<nbSample; ++iii) {
+									float gain = float(iii+1) * step;
+									_output[iii] += (m_tmp[iii] - _output[iii]) * gain;
+								}
+								m_current = next;
+								m_update = false;
+							}
+							m_writePos = (m_writePos + nbSample) & m_mask;
+							_output += nbSample;
+							_nbChunk -= nbSample;
+						}
+					}
+				protected:
+					void requestUpdate() {
+						if (m_size == 0) {
+							// not configured ==> nothing to update
+							return;
+						}
+						int32_t next = (m_current+1)%2;
+						calculateCoefficient(next);
+						m_update = true;
+					}
+					/**
+					 * @brief Calculate the delay and the interpolation coefficient of each channel for the current steering.
+					 * @param[in] _id Id of the coefficient set to update.
+					 */
+					void calculateCoefficient(int32_t _id) {
+						double delayMax = 0.0;
+						for (int32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+							m_delay[ccc] = audio::algo::drain::calculateDelay(m_positions[ccc], m_steering);
+							if (    ccc == 0
+							     || m_delay[ccc] > delayMax) {
+								delayMax = m_delay[ccc];
+							}
+						}
+						double latency = 0.0;
+						for (int32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+							// the last reached microphone is not delayed, the other wait for it.
+							// 1 sample is added to have the fractional delay in the [1..2[ range (best lagrange accuracy)
+							double delaySample = (delayMax - m_delay[ccc]) * m_sampleRate + 1.0;
+							delaySample = etk::min(delaySample, double(m_maxDelay - lagrangeNbTap + 1));
+							latency = etk::max(latency, delaySample);
+							int32_t delayInteger = int32_t(delaySample) - 1;
+							double ddd = delaySample - double(delayInteger);
+							m_delayInteger[_id][ccc] = delayInteger;
+							float* coef = &m_coef[_id][ccc*lagrangeNbTap];
+							float weight = m_weight[ccc];
+							coef[0] = -(ddd-1.0)*(ddd-2.0)*(ddd-3.0)/6.0 * weight;
+							coef[1] = ddd*(ddd-2.0)*(ddd-3.0)/2.0 * weight;
+							coef[2] = -ddd*(ddd-1.0)*(ddd-3.0)/2.0 * weight;
+							coef[3] = ddd*(ddd-1.0)*(ddd-2.0)/6.0 * weight;
+						}
+						m_latency = int32_t(latency + 0.5);
+					}
+					/**
+					 * @brief Sum all the delayed channels of the last written block.
+					 * @param[out] _output Output buffer.
+					 * @param[in] _nbSample Number of sample of the block.
+					 * @param[in] _id Id of the coefficient set to use.
+					 */
+					void processBlock(float* _output, int32_t _nbSample, int32_t _id) {
+						for (int32_t iii=0; iii<_nbSample; ++iii) {
+							_output[iii] = 0.0f;
+						}
+						for (int32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+							// continuous window of the delay line: [start .. start + _nbSample + lagrangeNbTap - 1[
+							int32_t start = (m_writePos - m_delayInteger[_id][ccc] - (lagrangeNbTap-1)) & m_mask;
+							const float* line = &m_delayLine[ccc*m_size*2 + start + lagrangeNbTap-1];
+							const float* coef = &m_coef[_id][ccc*lagrangeNbTap];
+							float coef0 = coef[0];
+							float coef1 = coef[1];
+							float coef2 = coef[2];
+							float coef3 = coef[3];
+							// no dependency between samples ==> vectorized by the compiler
+							for (int32_t iii=0; iii<_nbSample; ++iii) {
+								_output[iii] +=   coef0 * line[iii]
+								                + coef1 * line[iii-1]
+								                + coef2 * line[iii-2]
+								                + coef3 * line[iii-3];
+							}
+						}
+					}
+			};
+		}
+	}
+}
+
+audio::algo::drain::Beamformer::Beamformer() {
+	
+}
+
+audio::algo::drain::Beamformer::~Beamformer() {
+	
+}
+
+void audio::algo::drain::Beamformer::init(float _sampleRate, int8_t _nbChannel, enum audio::format _format) {
+	if (_format != audio::format_float) {
+		AA_DRAIN_CRITICAL("Request format for beamformer that not exist ... : " << _format);
+		return;
+	}
+	if (_nbChannel <= 0) {
+		AA_DRAIN_ERROR("Request beamformer with " << int32_t(_nbChannel) << " channel(s)");
+		return;
+	}
+	m_private = ememory::makeShared<BeamformerPrivate>();
+	if (m_private == null) {
+		AA_DRAIN_ERROR("can not allocate private data...");
+		return;
+	}
+	m_private->init(_sampleRate, _nbChannel);
+}
+
+void audio::algo::drain::Beamformer::reset() {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Beamformer does not init ...");
+		return;
+	}
+	m_private->reset();
+}
+
+etk::Vector<enum audio::format> audio::algo::drain::Beamformer::getSupportedFormat() {
+	etk::Vector<enum audio::format> out = audio::algo::drain::Beamformer::getNativeSupportedFormat();
+	return out;
+}
+
+etk::Vector<enum audio::format> audio::algo::drain::Beamformer::getNativeSupportedFormat() {
+	etk::Vector<enum audio::format> out;
+	out.pushBack(audio::format_float);
+	return out;
+}
+
+void audio::algo::drain::Beamformer::process(void* _output, const void* _input, size_t _nbChunk) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Beamformer does not init ...");
+		return;
+	}
+	m_private->process(reinterpret_cast<float*>(_output), reinterpret_cast<const float*>(_input), _nbChunk);
+}
+
+bool audio::algo::drain::Beamformer::setMicrophonePosition(const etk::Vector<vec3>& _positions) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Beamformer does not init ...");
+		return false;
+	}
+	return m_private->setMicrophonePosition(_positions);
+}
+
+void audio::algo::drain::Beamformer::setWeight(int32_t _idChannel, float _weight) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Beamformer does not init ...");
+		return;
+	}
+	m_private->setWeight(_idChannel, _weight);
+}
+
+void audio::algo::drain::Beamformer::setSteering(const audio::algo::drain::Direction& _direction) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Beamformer does not init ...");
+		return;
+	}
+	m_private->setSteering(_direction);
+}
+
+audio::algo::drain::Direction audio::algo::drain::Beamformer::getSteering() {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Beamformer does not init ...");
+		return audio::algo::drain::Direction();
+	}
+	return m_private->getSteering();
+}
+
+int32_t audio::algo::drain::Beamformer::getLatency() {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Beamformer does not init ...");
+		return 0;
+	}
+	return m_private->getLatency();
+}
+
@@ -0,0 +1,96 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <etk/types.hpp>
+#include <ememory/memory.hpp>
+#include <etk/Vector.hpp>
+#include <audio/format.hpp>
+#include <audio/algo/drain/ArrayGeometry.hpp>
+
+namespace audio {
+	namespace algo {
+		namespace drain {
+			class BeamformerPrivate;
+			/**
+			 * @brief Delay and sum beamformer: align all the microphones of an array on a direction and mix them.
+			 * The input is an interleaved stream of nbChannel microphones, the output is a mono stream.
+			 */
+			class Beamformer {
+				public:
+					/**
+					 * @brief Constructor
+					 */
+					Beamformer();
+					/**
+					 * @brief Destructor
+					 */
+					virtual ~Beamformer();
+				public:
+					/**
+					 * @brief Reset all history of the Algo.
+					 */
+					void reset();
+					/**
+					 * @brief Initialize the Algorithm
+					 * @param[in] _sampleRate Sample rate of the stream.
+					 * @param[in] _nbChannel Number of microphone in the stream.
+					 * @param[in] _format Input data format.
+					 */
+					virtual void init(float _sampleRate=48000, int8_t _nbChannel=4, enum audio::format _format=audio::format_float);
+					/**
+					 * @brief Get list of format suported in input.
+					 * @return list of supported format
+					 */
+					virtual etk::Vector<enum audio::format> getSupportedFormat();
+					/**
+					 * @brief Get list of algorithm format suported. No format convertion.
+					 * @return list of supported format
+					 */
+					virtual etk::Vector<enum audio::format> getNativeSupportedFormat();
+					/**
+					 * @brief Main input algo process.
+					 * @param[in,out] _output Output data (mono).
+					 * @param[in] _input Input data (interleaved, nbChannel).
+					 * @param[in] _nbChunk Number of chunk in the input buffer.
+					 */
+					virtual void process(void* _output, const void* _input, size_t _nbChunk);
+				public:
+					/**
+					 * @brief Set the position of all the microphones (must be called after init, before process).
+					 * @param[in] _positions Position of each microphone in meter (one per channel).
+					 * @return true The position have been set.
+					 */
+					bool setMicrophonePosition(const etk::Vector<vec3>& _positions);
+					/**
+					 * @brief Set the weight of a microphone in the sum (default 1/nbChannel).
+					 * @param[in] _idChannel Id of the microphone.
+					 * @param[in] _weight Linear gain to apply.
+					 */
+					void setWeight(int32_t _idChannel, float _weight);
+					/**
+					 * @brief Set the direction to listen. The change is cross-faded on the next processed block.
+					 * @param[in] _direction Direction of the source.
+					 */
+					void setSteering(const audio::algo::drain::Direction& _direction);
+					/**
+					 * @brief Get the direction listened.
+					 * @return Current steering direction.
+					 */
+					audio::algo::drain::Direction getSteering();
+					/**
+					 * @brief Get the algorithm latency for the last steering (delay between the first microphone reached by the wave and the output).
+					 * @note It changes with the steering, the maximum is the largest delay between two microphones of the array (+1 sample).
+					 * @return Latency in sample (rounded).
+					 */
+					int32_t getLatency();
+				protected:
+					ememory::SharedPtr<BeamformerPrivate> m_private; //!< private data.
+			};
+		}
+	}
+}
+
@@ -0,0 +1,544 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <audio/algo/drain/BeamformerStft.hpp>
+#include <audio/algo/drain/Fft.hpp>
+#include <audio/algo/drain/VectorMath.hpp>
+#include <audio/algo/drain/debug.hpp>
+extern "C" {
+	#include <math.h>
+}
+
+// Forgetting factor of the MVDR spatial covariance.
+static const float mvdrForget = 0.98f;
+// Number of frame between two MVDR weights calculation.
+static const int32_t mvdrPeriod = 4;
+
+namespace audio {
+	namespace algo {
+		namespace drain {
+			class BeamformerStftPrivate {
+				protected:
+					float m_sampleRate;
+					int32_t m_nbChannel;
+					int32_t m_frameSize; //!< FFT size
+					int32_t m_hopSize; //!< number of sample between 2 frames
+					int32_t m_nbBin; //!< number of frequency bin
+					enum audio::algo::drain::beamformerStftMode m_mode;
+					audio::algo::drain::Fft m_fft;
+					etk::Vector<vec3> m_positions; //!< position of each microphone
+					audio::algo::drain::Direction m_steering; //!< current listening direction
+					double m_resolution; //!< angle step of the steering cache (degree)
+					double m_ethaMin; //!< lowest elevation of the steering cache (degree)
+					double m_ethaMax; //!< highest elevation of the steering cache (degree)
+					int32_t m_nbAlpha; //!< number of azimuth in the cache grid
+					int32_t m_nbEtha; //!< number of elevation in the cache grid
+					etk::Vector<float> m_cache; //!< steering vectors of all the grid directions: [elevation][azimuth][real|imag][channel][bin]
+					etk::Vector<float> m_phase; //!< temporary phase of each bin [bin]
+					etk::Vector<float> m_steerReal; //!< steering vector in use [channel][bin]
+					etk::Vector<float> m_steerImag; //!< steering vector in use [channel][bin]
+					etk::Vector<float> m_weightReal; //!< beamforming weight [channel][bin]
+					etk::Vector<float> m_weightImag; //!< beamforming weight [channel][bin]
+					etk::Vector<float> m_window; //!< square root hann window (analysis and synthesis)
+					etk::Vector<float> m_input; //!< last frame of each channel [channel][frameSize]
+					int32_t m_fill; //!< number of new sample in the current hop
+					etk::Vector<float> m_frame; //!< temporary windowed frame
+					etk::Vector<float> m_specReal; //!< spectrum of each channel [channel][bin]
+					etk::Vector<float> m_specImag; //!< spectrum of each channel [channel][bin]
+					etk::Vector<float> m_outReal; //!< beam spectrum [bin]
+					etk::Vector<float> m_outImag; //!< beam spectrum [bin]
+					etk::Vector<float> m_overlap; //!< overlap-add accumulator [frameSize]
+					etk::Vector<float> m_outputReady; //!< synthesized samples waiting to be output [hopSize]
+					// MVDR:
+					etk::Vector<float> m_covReal; //!< spatial covariance [bin][channel][channel]
+					etk::Vector<float> m_covImag; //!< spatial covariance [bin][channel][channel]
+					etk::Vector<float> m_solveReal; //!< linear system solver matrix [channel][channel+1]
+					etk::Vector<float> m_solveImag; //!< linear system solver matrix [channel][channel+1]
+					int32_t m_frameCount; //!< frame counter for the MVDR weights update
+					bool m_weightUpdate; //!< Force the MVDR weights calculation on the next frame
+					float m_loading; //!< Diagonal loading of the MVDR covariance (ratio of the mean power)
+				public:
+					BeamformerStftPrivate() :
+					  m_sampleRate(48000),
+					  m_nbChannel(0),
+					  m_frameSize(0),
+					  m_hopSize(0),
+					  m_nbBin(0),
+					  m_mode(audio::algo::drain::beamformerStftMode_delayAndSum),
+					  m_resolution(1.0),
+					  m_ethaMin(0.0),
+					  m_ethaMax(0.0),
+					  m_nbAlpha(0),
+					  m_nbEtha(0),
+					  m_fill(0),
+					  m_frameCount(0),
+					  m_weightUpdate(false),
+					  m_loading(0.1f) {
+						
+					}
+					bool init(float _sampleRate, int8_t _nbChannel, int32_t _frameSize) {
+						m_sampleRate = _sampleRate;
+						m_nbChannel = _nbChannel;
+						if (m_fft.init(_frameSize) == false) {
+							return false;
+						}
+						m_frameSize = _frameSize;
+						m_hopSize = m_frameSize/2;
+						m_nbBin = m_fft.getNbBin();
+						m_window.resize(m_frameSize, 0.0f);
+						for (int32_t iii=0; iii<m_frameSize; ++iii) {
+							// periodic hann ==> sum of the squared windows is 1 with an overlap of 50%
+							m_window[iii] = etk::sqrt(0.5 - 0.5*etk::cos(2.0*M_PI*double(iii)/double(m_frameSize)));
+						}
+						m_input.resize(m_nbChannel*m_frameSize, 0.0f);
+						m_frame.resize(m_frameSize, 0.0f);
+						m_specReal.resize(m_nbChannel*m_nbBin, 0.0f);
+						m_specImag.resize(m_nbChannel*m_nbBin, 0.0f);
+						m_steerReal.resize(m_nbChannel*m_nbBin, 0.0f);
+						m_steerImag.resize(m_nbChannel*m_nbBin, 0.0f);
+						m_weightReal.resize(m_nbChannel*m_nbBin, 0.0f);
+						m_weightImag.resize(m_nbChannel*m_nbBin, 0.0f);
+						m_outReal.resize(m_nbBin, 0.0f);
+						m_outImag.resize(m_nbBin, 0.0f);
+						m_overlap.resize(m_frameSize, 0.0f);
+						m_outputReady.resize(m_hopSize, 0.0f);
+						m_covReal.resize(m_nbBin*m_nbChannel*m_nbChannel, 0.0f);
+						m_covImag.resize(m_nbBin*m_nbChannel*m_nbChannel, 0.0f);
+						m_solveReal.resize(m_nbChannel*(m_nbChannel+1), 0.0f);
+						m_solveImag.resize(m_nbChannel*(m_nbChannel+1), 0.0f);
+						m_phase.resize(m_nbBin, 0.0f);
+						updateCache();
+						reset();
+						return true;
+					}
+					void reset() {
+						for (size_t iii=0; iii<m_input.size(); ++iii) {
+							m_input[iii] = 0.0f;
+						}
+						for (size_t iii=0; iii<m_overlap.size(); ++iii) {
+							m_overlap[iii] = 0.0f;
+						}
+						for (size_t iii=0; iii<m_outputReady.size(); ++iii) {
+							m_outputReady[iii] = 0.0f;
+						}
+						// identity covariance ==> the first MVDR weights are the delay and sum weights
+						for (int32_t bbb=0; bbb<m_nbBin; ++bbb) {
+							for (int32_t iii=0; iii<m_nbChannel; ++iii) {
+								for (int32_t jjj=0; jjj<m_nbChannel; ++jjj) {
+									int32_t id = (bbb*m_nbChannel + iii)*m_nbChannel + jjj;
+									m_covReal[id] = iii == jjj ? 1.0e-6f : 0.0f;
+									m_covImag[id] = 0.0f;
+								}
+							}
+						}
+						m_fill = 0;
+						m_frameCount = 0;
+						m_weightUpdate = true;
+					}
+					bool setMicrophonePosition(const etk::Vector<vec3>& _positions) {
+						if (_positions.size() != size_t(m_nbChannel)) {
+							AA_DRAIN_ERROR("Request " << _positions.size() << " microphone position with " << m_nbChannel << " channels");
+							return false;
+						}
+						m_positions = _positions;
+						updateCache();
+						setSteering(m_steering);
+						return true;
+					}
+					void setMode(enum audio::algo::drain::beamformerStftMode _mode) {
+						m_mode = _mode;
+						setSteering(m_steering);
+					}
+					void setDiagonalLoading(float _loading) {
+						m_loading = etk::max(_loading, 0.0f);
+						m_weightUpdate = true;
+					}
+					void setAngleResolution(double _resolution) {
+						m_resolution = etk::max(_resolution, 0.01);
+						updateCache();
+					}
+					void setElevationRange(double _ethaMin, double _ethaMax) {
+						m_ethaMin = etk::max(-90.0, etk::min(90.0, _ethaMin));
+						m_ethaMax = etk::max(m_ethaMin, etk::min(90.0, _ethaMax));
+						updateCache();
+					}
+					void setSteering(const audio::algo::drain::Direction& _direction) {
+						m_steering = _direction;
+						if (m_positions.size() == 0) {
+							return;
+						}
+						if (m_steering.radius > 0.0) {
+							// near field: depend on the distance ==> not cached
+							calculateSteering(&m_steerReal[0], &m_steerImag[0], m_steering);
+						} else {
+							double alpha = m_steering.angleAlpha*180.0/M_PI;
+							double etha = m_steering.angleEtha*180.0/M_PI;
+							int32_t idAlpha = int32_t(floor((alpha + 180.0)/m_resolution + 0.5));
+							idAlpha = ((idAlpha % m_nbAlpha) + m_nbAlpha) % m_nbAlpha;
+							int32_t idEtha = int32_t(floor((etha - m_ethaMin)/m_resolution + 0.5));
+							if (    idEtha < 0
+							     || idEtha >= m_nbEtha) {
+								// out of the elevation range of the cache
+								calculateSteering(&m_steerReal[0], &m_steerImag[0], m_steering);
+							} else {
+								int32_t size = m_nbChannel*m_nbBin;
+								const float* cache = &m_cache[(idEtha*m_nbAlpha + idAlpha)*2*size];
+								for (int32_t iii=0; iii<size; ++iii) {
+									m_steerReal[iii] = cache[iii];
+									m_steerImag[iii] = cache[size + iii];
+								}
+							}
+						}
+						if (m_mode == audio::algo::drain::beamformerStftMode_delayAndSum) {
+							float scale = 1.0f/float(m_nbChannel);
+							for (size_t iii=0; iii<m_steerReal.size(); ++iii) {
+								m_weightReal[iii] = m_steerReal[iii] * scale;
+								m_weightImag[iii] = m_steerImag[iii] * scale;
+							}
+						} else {
+							m_weightUpdate = true;
+						}
+					}
+					const audio::algo::drain::Direction& getSteering() {
+						return m_steering;
+					}
+					int32_t getLatency() {
+						return m_frameSize;
+					}
+					void process(float* _output, const float* _input, size_t _nbChunk) {
+						if (m_positions.size() == 0) {
+							AA_DRAIN_ERROR("BeamformerStft microphone position are not set ...");
+							return;
+						}
+						for (size_t iii=0; iii<_nbChunk; ++iii) {
+							int32_t pos = m_frameSize - m_hopSize + m_fill;
+							for (int32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+								m_input[ccc*m_frameSize + pos] = _input[ccc];
+							}
+							_input += m_nbChannel;
+							_output[iii] = m_outputReady[m_fill];
+							m_fill++;
+							if (m_fill == m_hopSize) {
+								processFrame();
+								m_fill = 0;
+							}
+						}
+					}
+				protected:
+					/**
+					 * @brief Calculate the steering vector of a direction: exp(-j.2.pi.f.delay) for each channel and bin (no allocation).
+					 */
+					void calculateSteering(float* _real, float* _imag, const audio::algo::drain::Direction& _direction) {
+						for (int32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+							double delay = audio::algo::drain::calculateDelay(m_positions[ccc], _direction);
+							double step = -2.0 * M_PI * delay * m_sampleRate / double(m_frameSize);
+							for (int32_t bbb=0; bbb<m_nbBin; ++bbb) {
+								m_phase[bbb] = remainder(step*double(bbb), 2.0*M_PI);
+							}
+							audio::algo::drain::vectorMath::sinCos(&_imag[ccc*m_nbBin], &_real[ccc*m_nbBin], &m_phase[0], m_nbBin);
+						}
+					}
+					/**
+					 * @brief Allocate and calculate the steering vectors of all the directions of the grid (when the microphone positions are set).
+					 */
+					void updateCache() {
+						m_nbAlpha = int32_t(360.0/m_resolution + 0.5);
+						m_nbEtha = int32_t((m_ethaMax - m_ethaMin)/m_resolution + 0.5) + 1;
+						int32_t size = m_nbChannel*m_nbBin;
+						m_cache.resize(m_nbAlpha*m_nbEtha*2*size, 0.0f);
+						if (m_positions.size() == 0) {
+							return;
+						}
+						for (int32_t eee=0; eee<m_nbEtha; ++eee) {
+							for (int32_t aaa=0; aaa<m_nbAlpha; ++aaa) {
+								float* cache = &m_cache[(eee*m_nbAlpha + aaa)*2*size];
+								audio::algo::drain::Direction direction((-180.0 + double(aaa)*m_resolution)*M_PI/180.0,
+								                                        (m_ethaMin + double(eee)*m_resolution)*M_PI/180.0,
+								                                        0.0);
+								calculateSteering(cache, cache + size, direction);
+							}
+						}
+					}
+					void processFrame() {
+						for (int32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+							float* input = &m_input[ccc*m_frameSize];
+							for (int32_t iii=0; iii<m_frameSize; ++iii) {
+								m_frame[iii] = input[iii] * m_window[iii];
+							}
+							m_fft.forward(&m_specReal[ccc*m_nbBin], &m_specImag[ccc*m_nbBin], &m_frame[0]);
+							// slide the analysis frame
+							for (int32_t iii=0; iii<m_frameSize-m_hopSize; ++iii) {
+								input[iii] = input[iii+m_hopSize];
+							}
+						}
+						if (m_mode == audio::algo::drain::beamformerStftMode_mvdr) {
+							updateCovariance();
+							m_frameCount++;
+							if (    m_weightUpdate == true
+							     || m_frameCount >= mvdrPeriod) {
+								updateMvdrWeight();
+								m_frameCount = 0;
+								m_weightUpdate = false;
+							}
+						}
+						// beam = sum(conj(weight) * spectrum), each loop is done on all the bins
+						for (int32_t bbb=0; bbb<m_nbBin; ++bbb) {
+							m_outReal[bbb] = 0.0f;
+							m_outImag[bbb] = 0.0f;
+						}
+						for (int32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+							const float* wReal = &m_weightReal[ccc*m_nbBin];
+							const float* wImag = &m_weightImag[ccc*m_nbBin];
+							const float* sReal = &m_specReal[ccc*m_nbBin];
+							const float* sImag = &m_specImag[ccc*m_nbBin];
+							for (int32_t bbb=0; bbb<m_nbBin; ++bbb) {
+								m_outReal[bbb] += wReal[bbb]*sReal[bbb] + wImag[bbb]*sImag[bbb];
+								m_outImag[bbb] += wReal[bbb]*sImag[bbb] - wImag[bbb]*sReal[bbb];
+							}
+						}
+						// synthesis
+						m_fft.inverse(&m_frame[0], &m_outReal[0], &m_outImag[0]);
+						for (int32_t iii=0; iii<m_frameSize; ++iii) {
+							m_overlap[iii] += m_frame[iii] * m_window[iii];
+						}
+						for (int32_t iii=0; iii<m_hopSize; ++iii) {
+							m_outputReady[iii] = m_overlap[iii];
+						}
+						for (int32_t iii=0; iii<m_frameSize-m_hopSize; ++iii) {
+							m_overlap[iii] = m_overlap[iii+m_hopSize];
+						}
+						for (int32_t iii=m_frameSize-m_hopSize; iii<m_frameSize; ++iii) {
+							m_overlap[iii] = 0.0f;
+						}
+					}
+					/**
+					 * @brief Recursive update of the spatial covariance matrix of each bin.
+					 */
+					void updateCovariance() {
+						for (int32_t iii=0; iii<m_nbChannel; ++iii) {
+							for (int32_t jjj=iii; jjj<m_nbChannel; ++jjj) {
+								const float* aReal = &m_specReal[iii*m_nbBin];
+								const float* aImag = &m_specImag[iii*m_nbBin];
+								const float* bReal = &m_specReal[jjj*m_nbBin];
+								const float* bImag = &m_specImag[jjj*m_nbBin];
+								int32_t id = iii*m_nbChannel + jjj;
+								int32_t idMirror = jjj*m_nbChannel + iii;
+								int32_t stride = m_nbChannel*m_nbChannel;
+								for (int32_t bbb=0; bbb<m_nbBin; ++bbb) {
+									// a * conj(b)
+									float real = aReal[bbb]*bReal[bbb] + aImag[bbb]*bImag[bbb];
+									float imag = aImag[bbb]*bReal[bbb] - aReal[bbb]*bImag[bbb];
+									float& covReal = m_covReal[bbb*stride + id];
+									float& covImag = m_covImag[bbb*stride + id];
+									covReal = mvdrForget*covReal + (1.0f-mvdrForget)*real;
+									covImag = mvdrForget*covImag + (1.0f-mvdrForget)*imag;
+									// hermitian matrix
+									m_covReal[bbb*stride + idMirror] = covReal;
+									m_covImag[bbb*stride + idMirror] = -covImag;
+								}
+							}
+						}
+					}
+					/**
+					 * @brief MVDR weight of each bin: w = R^-1.d / (d^H.R^-1.d)
+					 */
+					void updateMvdrWeight() {
+						int32_t nbCol = m_nbChannel+1;
+						float* aReal = &m_solveReal[0];
+						float* aImag = &m_solveImag[0];
+						for (int32_t bbb=0; bbb<m_nbBin; ++bbb) {
+							const float* covReal = &m_covReal[bbb*m_nbChannel*m_nbChannel];
+							const float* covImag = &m_covImag[bbb*m_nbChannel*m_nbChannel];
+							float trace = 0.0f;
+							for (int32_t iii=0; iii<m_nbChannel; ++iii) {
+								trace += covReal[iii*m_nbChannel + iii];
+							}
+							float loading = m_loading * trace / float(m_nbChannel) + 1.0e-12f;
+							// augmented matrix [R + loading.I | d]
+							for (int32_t iii=0; iii<m_nbChannel; ++iii) {
+								for (int32_t jjj=0; jjj<m_nbChannel; ++jjj) {
+									aReal[iii*nbCol + jjj] = covReal[iii*m_nbChannel + jjj];
+									aImag[iii*nbCol + jjj] = covImag[iii*m_nbChannel + jjj];
+								}
+								aReal[iii*nbCol + iii] += loading;
+								aReal[iii*nbCol + m_nbChannel] = m_steerReal[iii*m_nbBin + bbb];
+								aImag[iii*nbCol + m_nbChannel] = m_steerImag[iii*m_nbBin + bbb];
+							}
+							// gauss elimination (hermitian positive definite ==> no pivoting needed)
+							for (int32_t kkk=0; kkk<m_nbChannel; ++kkk) {
+								float pivotReal = aReal[kkk*nbCol + kkk];
+								float pivotImag = aImag[kkk*nbCol + kkk];
+								float norm = 1.0f / (pivotReal*pivotReal + pivotImag*pivotImag);
+								for (int32_t iii=kkk+1; iii<m_nbChannel; ++iii) {
+									// factor = a[i][k] / a[k][k]
+									float fReal = (aReal[iii*nbCol + kkk]*pivotReal + aImag[iii*nbCol + kkk]*pivotImag) * norm;
+									float fImag = (aImag[iii*nbCol + kkk]*pivotReal - aReal[iii*nbCol + kkk]*pivotImag) * norm;
+									for (int32_t jjj=kkk; jjj<nbCol; ++jjj) {
+										aReal[iii*nbCol + jjj] -= fReal*aReal[kkk*nbCol + jjj] - fImag*aImag[kkk*nbCol + jjj];
+										aImag[iii*nbCol + jjj] -= fReal*aImag[kkk*nbCol + jjj] + fImag*aReal[kkk*nbCol + jjj];
+									}
+								}
+							}
+							// back substitution: the solution replace the last column
+							for (int32_t iii=m_nbChannel-1; iii>=0; --iii) {
+								float sumReal = aReal[iii*nbCol + m_nbChannel];
+								float sumImag = aImag[iii*nbCol + m_nbChannel];
+								for (int32_t jjj=iii+1; jjj<m_nbChannel; ++jjj) {
+									sumReal -= aReal[iii*nbCol + jjj]*aReal[jjj*nbCol + m_nbChannel] - aImag[iii*nbCol + jjj]*aImag[jjj*nbCol + m_nbChannel];
+									sumImag -= aReal[iii*nbCol + jjj]*aImag[jjj*nbCol + m_nbChannel] + aImag[iii*nbCol + jjj]*aReal[jjj*nbCol + m_nbChannel];
+								}
+								float pivotReal = aReal[iii*nbCol + iii];
+								float pivotImag = aImag[iii*nbCol + iii];
+								float norm = 1.0f / (pivotReal*pivotReal + pivotImag*pivotImag);
+								aReal[iii*nbCol + m_nbChannel] = (sumReal*pivotReal + sumImag*pivotImag) * norm;
+								aImag[iii*nbCol + m_nbChannel] = (sumImag*pivotReal - sumReal*pivotImag) * norm;
+							}
+							// normalization: d^H.R^-1.d is real
+							float denominator = 0.0f;
+							for (int32_t iii=0; iii<m_nbChannel; ++iii) {
+								denominator +=   m_steerReal[iii*m_nbBin + bbb]*aReal[iii*nbCol + m_nbChannel]
+								               + m_steerImag[iii*m_nbBin + bbb]*aImag[iii*nbCol + m_nbChannel];
+							}
+							if (denominator <= 0.0f) {
+								// degenerated ==> delay and sum
+								for (int32_t iii=0; iii<m_nbChannel; ++iii) {
+									m_weightReal[iii*m_nbBin + bbb] = m_steerReal[iii*m_nbBin + bbb] / float(m_nbChannel);
+									m_weightImag[iii*m_nbBin + bbb] = m_steerImag[iii*m_nbBin + bbb] / float(m_nbChannel);
+								}
+								continue;
+							}
+							denominator = 1.0f / denominator;
+							for (int32_t iii=0; iii<m_nbChannel; ++iii) {
+								m_weightReal[iii*m_nbBin + bbb] = aReal[iii*nbCol + m_nbChannel] * denominator;
+								m_weightImag[iii*m_nbBin + bbb] = aImag[iii*nbCol + m_nbChannel] * denominator;
+							}
+						}
+					}
+			};
+		}
+	}
+}
+
+audio::algo::drain::BeamformerStft::BeamformerStft() {
+	
+}
+
+audio::algo::drain::BeamformerStft::~BeamformerStft() {
+	
+}
+
+void audio::algo::drain::BeamformerStft::init(float _sampleRate, int8_t _nbChannel, enum audio::format _format, int32_t _frameSize) {
+	if (_format != audio::format_float) {
+		AA_DRAIN_CRITICAL("Request format for beamformer that not exist ... : " << _format);
+		return;
+	}
+	if (_nbChannel <= 0) {
+		AA_DRAIN_ERROR("Request beamformer with " << int32_t(_nbChannel) << " channel(s)");
+		return;
+	}
+	m_private = ememory::makeShared<BeamformerStftPrivate>();
+	if (m_private == null) {
+		AA_DRAIN_ERROR("can not allocate private data...");
+		return;
+	}
+	if (m_private->init(_sampleRate, _nbChannel, _frameSize) == false) {
+		m_private = null;
+	}
+}
+
+void audio::algo::drain::BeamformerStft::reset() {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("BeamformerStft does not init ...");
+		return;
+	}
+	m_private->reset();
+}
+
+etk::Vector<enum audio::format> audio::algo::drain::BeamformerStft::getSupportedFormat() {
+	etk::Vector<enum audio::format> out = audio::algo::drain::BeamformerStft::getNativeSupportedFormat();
+	return out;
+}
+
+etk::Vector<enum audio::format> audio::algo::drain::BeamformerStft::getNativeSupportedFormat() {
+	etk::Vector<enum audio::format> out;
+	out.pushBack(audio::format_float);
+	return out;
+}
+
+void audio::algo::drain::BeamformerStft::process(void* _output, const void* _input, size_t _nbChunk) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("BeamformerStft does not init ...");
+		return;
+	}
+	m_private->process(reinterpret_cast<float*>(_output), reinterpret_cast<const float*>(_input), _nbChunk);
+}
+
+bool audio::algo::drain::BeamformerStft::setMicrophonePosition(const etk::Vector<vec3>& _positions) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("BeamformerStft does not init ...");
+		return false;
+	}
+	return m_private->setMicrophonePosition(_positions);
+}
+
+void audio::algo::drain::BeamformerStft::setMode(enum audio::algo::drain::beamformerStftMode _mode) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("BeamformerStft does not init ...");
+		return;
+	}
+	m_private->setMode(_mode);
+}
+
+void audio::algo::drain::BeamformerStft::setDiagonalLoading(float _loading) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("BeamformerStft does not init ...");
+		return;
+	}
+	m_private->setDiagonalLoading(_loading);
+}
+
+void audio::algo::drain::BeamformerStft::setAngleResolution(double _resolution) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("BeamformerStft does not init ...");
+		return;
+	}
+	m_private->setAngleResolution(_resolution);
+	m_private->setSteering(m_private->getSteering());
+}
+
+void audio::algo::drain::BeamformerStft::setElevationRange(double _ethaMin, double _ethaMax) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("BeamformerStft does not init ...");
+		return;
+	}
+	m_private->setElevationRange(_ethaMin, _ethaMax);
+	m_private->setSteering(m_private->getSteering());
+}
+
+void audio::algo::drain::BeamformerStft::setSteering(const audio::algo::drain::Direction& _direction) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("BeamformerStft does not init ...");
+		return;
+	}
+	m_private->setSteering(_direction);
+}
+
+audio::algo::drain::Direction audio::algo::drain::BeamformerStft::getSteering() {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("BeamformerStft does not init ...");
+		return audio::algo::drain::Direction();
+	}
+	return m_private->getSteering();
+}
+
+int32_t audio::algo::drain::BeamformerStft::getLatency() {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("BeamformerStft does not init ...");
+		return 0;
+	}
+	return m_private->getLatency();
+}
+
@@ -0,0 +1,116 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <etk/types.hpp>
+#include <ememory/memory.hpp>
+#include <etk/Vector.hpp>
+#include <audio/format.hpp>
+#include <audio/algo/drain/ArrayGeometry.hpp>
+
+namespace audio {
+	namespace algo {
+		namespace drain {
+			enum beamformerStftMode {
+				beamformerStftMode_delayAndSum, //!< Phase alignment and average of all the microphones
+				beamformerStftMode_mvdr, //!< Minimum variance distortionless response (adaptive noise rejection)
+			};
+			class BeamformerStftPrivate;
+			/**
+			 * @brief Frequency domain (STFT) beamformer: the steering is applied on each frequency bin with an overlap-add synthesis.
+			 * The input is an interleaved stream of nbChannel microphones, the output is a mono stream.
+			 */
+			class BeamformerStft {
+				public:
+					/**
+					 * @brief Constructor
+					 */
+					BeamformerStft();
+					/**
+					 * @brief Destructor
+					 */
+					virtual ~BeamformerStft();
+				public:
+					/**
+					 * @brief Reset all history of the Algo.
+					 */
+					void reset();
+					/**
+					 * @brief Initialize the Algorithm
+					 * @param[in] _sampleRate Sample rate of the stream.
+					 * @param[in] _nbChannel Number of microphone in the stream.
+					 * @param[in] _format Input data format.
+					 * @param[in] _frameSize Size of the FFT frame (power of 2), the hop size is the half.
+					 */
+					virtual void init(float _sampleRate=48000, int8_t _nbChannel=4, enum audio::format _format=audio::format_float, int32_t _frameSize=512);
+					/**
+					 * @brief Get list of format suported in input.
+					 * @return list of supported format
+					 */
+					virtual etk::Vector<enum audio::format> getSupportedFormat();
+					/**
+					 * @brief Get list of algorithm format suported. No format convertion.
+					 * @return list of supported format
+					 */
+					virtual etk::Vector<enum audio::format> getNativeSupportedFormat();
+					/**
+					 * @brief Main input algo process.
+					 * @param[in,out] _output Output data (mono).
+					 * @param[in] _input Input data (interleaved, nbChannel).
+					 * @param[in] _nbChunk Number of chunk in the input buffer.
+					 */
+					virtual void process(void* _output, const void* _input, size_t _nbChunk);
+				public:
+					/**
+					 * @brief Set the position of all the microphones (must be called after init, before process): the steering cache is calculated.
+					 * @param[in] _positions Position of each microphone in meter (one per channel).
+					 * @return true The position have been set.
+					 */
+					bool setMicrophonePosition(const etk::Vector<vec3>& _positions);
+					/**
+					 * @brief Set the beamforming weight calculation.
+					 * @param[in] _mode New mode.
+					 */
+					void setMode(enum audio::algo::drain::beamformerStftMode _mode);
+					/**
+					 * @brief Set the MVDR diagonal loading: higher is more robust to steering errors and target leakage, lower reject more the interferences.
+					 * @param[in] _loading Ratio of the mean microphone power added on the covariance diagonal (default 0.1).
+					 */
+					void setDiagonalLoading(float _loading);
+					/**
+					 * @brief Set the angle step of the steering vector cache (default 1 degree, allocation: not in the real-time thread).
+					 * @param[in] _resolution Step in degree.
+					 */
+					void setAngleResolution(double _resolution);
+					/**
+					 * @brief Set the elevation range of the steering vector cache (default 0..0: horizontal plane only, allocation: not in the real-time thread).
+					 * @note The cache store 2 x nbChannel x nbBin float by direction: 360 azimuth x 1 elevation with 4 microphones and a 512 points FFT is 2.9 MB.
+					 * @param[in] _ethaMin Lowest elevation in degree.
+					 * @param[in] _ethaMax Highest elevation in degree.
+					 */
+					void setElevationRange(double _ethaMin, double _ethaMax);
+					/**
+					 * @brief Set the direction to listen (no allocation). Far field directions in the elevation range are rounded on the cache grid, the other are calculated.
+					 * @param[in] _direction Direction of the source.
+					 */
+					void setSteering(const audio::algo::drain::Direction& _direction);
+					/**
+					 * @brief Get the direction listened.
+					 * @return Current steering direction.
+					 */
+					audio::algo::drain::Direction getSteering();
+					/**
+					 * @brief Get the algorithm latency.
+					 * @return Latency in sample.
+					 */
+					int32_t getLatency();
+				protected:
+					ememory::SharedPtr<BeamformerStftPrivate> m_private; //!< private data.
+			};
+		}
+	}
+}
+
@@ -8,16 +8,9 @@
 #include <ememory/memory.hpp>
 #include <etk/types.hpp>
 #include <audio/algo/drain/BiQuadType.hpp>
+#include <audio/algo/drain/BiQuadDesign.hpp>
+#include <audio/algo/drain/VectorMath.hpp>
 #include <etk/Pair.hpp>
-extern "C" {
-	#include <math.h>
-}
-#ifndef M_LN10
-	#define M_LN10 2.30258509299404568402
-#endif
-#ifndef M_SQRT2
-	#define M_SQRT2 1.41421356237309504880
-#endif
 
 namespace audio {
 	namespace algo {
@@ -48,118 +41,14 @@ namespace audio {
 					 * @param[in] _sampleRate Sample rate of the signal
 					 */
 					void setBiquad(enum audio::algo::drain::biQuadType _type, double _frequencyCut, double _qualityFactor, double _gain, float _sampleRate) {
-						reset();
-						if (_sampleRate < 1) {
-							m_a[0] = 1.0;
-							m_a[1] = 0.0;
-							m_a[2] = 0.0;
-							m_b[0] = 0.0;
-							m_b[1] = 0.0;
-							return;
-						}
-						if (_frequencyCut > _sampleRate/2) {
-							_frequencyCut = _sampleRate/2;
-						} else if (_frequencyCut < 0) {
-							_frequencyCut = 0;
-						}
-						if (_qualityFactor < 0.01) {
-							_qualityFactor = 0.01;
-						}
-						double norm;
-						double V = etk::pow(10.0, etk::abs(_gain) / 20.0);
-						double K = etk::tan(M_PI * _frequencyCut / _sampleRate);
-						switch (_type) {
-							case biQuadType_none:
-								m_a[0] = 1.0;
-								m_a[1] = 0.0;
-								m_a[2] = 0.0;
-								m_b[0] = 0.0;
-								m_b[1] = 0.0;
-								break;
-							case biQuadType_lowPass:
-								norm = 1.0 / (1.0 + K / _qualityFactor + K * K);
-								m_a[0] = K * K * norm;
-								m_a[1] = m_a[0] * 2.0;
-								m_a[2] = m_a[0];
-								m_b[0] = 2.0 * (K * K - 1.0) * norm;
-								m_b[1] = (1.0 - K / _qualityFactor + K * K) * norm;
-								break;
-							case biQuadType_highPass:
-								norm = 1.0 / (1.0 + K / _qualityFactor + K * K);
-								m_a[0] = 1.0 * norm;
-								m_a[1] = m_a[0] * -2.0;
-								m_a[2] = m_a[0];
-								m_b[0] = 2.0 * (K * K - 1.0) * norm;
-								m_b[1] = (1.0 - K / _qualityFactor + K * K) * norm;
-								break;
-							case biQuadType_bandPass:
-								norm = 1.0 / (1.0 + K / _qualityFactor + K * K);
-								m_a[0] = K / _qualityFactor * norm;
-								m_a[1] = 0.0;
-								m_a[2] = m_a[0] * -1.0;
-								m_b[0] = 2.0 * (K * K - 1.0) * norm;
-								m_b[1] = (1.0 - K / _qualityFactor + K * K) * norm;
-								break;
-							case biQuadType_notch:
-								norm = 1.0 / (1.0 + K / _qualityFactor + K * K);
-								m_a[0] = (1.0 + K * K) * norm;
-								m_a[1] = 2.0 * (K * K - 1.0) * norm;
-								m_a[2] = m_a[0];
-								m_b[0] = m_a[1];
-								m_b[1] = (1.0 - K / _qualityFactor + K * K) * norm;
-								break;
-							case biQuadType_peak:
-								if (_gain >= 0.0) {
-									norm = 1.0 / (1.0 + 1.0/_qualityFactor * K + K * K);
-									m_a[0] = (1.0 + V/_qualityFactor * K + K * K) * norm;
-									m_a[1] = 2.0 * (K * K - 1.0) * norm;
-									m_a[2] = (1.0 - V/_qualityFactor * K + K * K) * norm;
-									m_b[0] = m_a[1];
-									m_b[1] = (1.0 - 1.0/_qualityFactor * K + K * K) * norm;
-								} else {
-									norm = 1.0 / (1.0 + V/_qualityFactor * K + K * K);
-									m_a[0] = (1.0 + 1.0/_qualityFactor * K + K * K) * norm;
-									m_a[1] = 2.0 * (K * K - 1.0) * norm;
-									m_a[2] = (1.0 - 1.0/_qualityFactor * K + K * K) * norm;
-									m_b[0] = m_a[1];
-									m_b[1] = (1.0 - V/_qualityFactor * K + K * K) * norm;
-								}
-								break;
-							case biQuadType_lowShelf:
-								if (_gain >= 0) {
-									norm = 1.0 / (1.0 + M_SQRT2 * K + K * K);
-									m_a[0] = (1.0 + etk::sqrt(2.0*V) * K + V * K * K) * norm;
-									m_a[1] = 2.0 * (V * K * K - 1.0) * norm;
-									m_a[2] = (1.0 - etk::sqrt(2.0*V) * K + V * K * K) * norm;
-									m_b[0] = 2.0 * (K * K - 1.0) * norm;
-									m_b[1] = (1.0 - M_SQRT2 * K + K * K) * norm;
-								} else {
-									norm = 1.0 / (1.0 + etk::sqrt(2.0*V) * K + V * K * K);
-									m_a[0] = (1.0 + M_SQRT2 * K + K * K) * norm;
-									m_a[1] = 2.0 * (K * K - 1.0) * norm;
-									m_a[2] = (1.0 - M_SQRT2 * K + K * K) * norm;
-									m_b[0] = 2.0 * (V * K * K - 1.0) * norm;
-									m_b[1] = (1.0 - etk::sqrt(2.0*V) * K + V * K * K) * norm;
-								}
-								break;
-							case biQuadType_highShelf:
-								if (_gain >= 0) {
-									norm = 1.0 / (1.0 + M_SQRT2 * K + K * K);
-									m_a[0] = (V + etk::sqrt(2.0*V) * K + K * K) * norm;
-									m_a[1] = 2.0 * (K * K - V) * norm;
-									m_a[2] = (V - etk::sqrt(2.0*V) * K + K * K) * norm;
-									m_b[0] = 2.0 * (K * K - 1.0) * norm;
-									m_b[1] = (1.0 - M_SQRT2 * K + K * K) * norm;
-								} else {
-									norm = 1.0 / (V + etk::sqrt(2.0*V) * K + K * K);
-									m_a[0] = (1.0 + M_SQRT2 * K + K * K) * norm;
-									m_a[1] = 2.0 * (K * K - 1.0) * norm;
-									m_a[2] = (1.0 - M_SQRT2 * K + K * K) * norm;
-									m_b[0] = 2.0 * (K * K - V) * norm;
-									m_b[1] = (V - etk::sqrt(2.0*V) * K + K * K) * norm;
-								}
-								break;
-						}
+						setBiquadCoef(audio::algo::drain::biQuadDesign(_type, _frequencyCut, _qualityFactor, _gain, _sampleRate));
+					}
+					/**
+					 * @brief Set the Coefficients (calculated with biQuadDesign).
+					 * @param[in] _coef New coefficients.
+					 */
+					void setBiquadCoef(const audio::algo::drain::BiQuadCoefficient& _coef) {
+						setBiquadCoef(_coef.m_a[0], _coef.m_a[1], _coef.m_a[2], _coef.m_b[0], _coef.m_b[1]);
 					}
 					/**
 					 * @brief Set direct Coefficients
@@ -172,6 +61,17 @@ namespace audio {
 						m_b[1] = _b1;
 						reset();
 					}
+					/**
+					 * @brief Change the Coefficients of a running filter (the history is kept, no discontinuity on the signal).
+					 * @param[in] _coef New coefficients.
+					 */
+					void updateBiquadCoef(const audio::algo::drain::BiQuadCoefficient& _coef) {
+						m_a[0] = _coef.m_a[0];
+						m_a[1] = _coef.m_a[1];
+						m_a[2] = _coef.m_a[2];
+						m_b[0] = _coef.m_b[0];
+						m_b[1] = _coef.m_b[1];
+					}
 					/**
 					 * @brief Get direct Coefficients
 					 */
@@ -194,16 +94,35 @@ namespace audio {
 						out.pushBack(m_b[1]);
 						return out;
 					}
+					/**
+					 * @brief Get the history of the filter (to continue the filtering with an other precision).
+					 * @param[out] _history x[n-1], x[n-2], y[n-1], y[n-2] (the 2 states of the transposed direct form II are the 2 first values).
+					 */
+					void getHistory(double* _history) const {
+						_history[0] = m_x[0].getDouble();
+						_history[1] = m_x[1].getDouble();
+						_history[2] = m_y[0].getDouble();
+						_history[3] = m_y[1].getDouble();
+					}
+					/**
+					 * @brief Set the history of the filter (the coefficients are not modified).
+					 * @param[in] _history x[n-1], x[n-2], y[n-1], y[n-2] (same order as getHistory).
+					 */
+					void setHistory(const double* _history) {
+						m_x[0] = TYPE(_history[0]);
+						m_x[1] = TYPE(_history[1]);
+						m_y[0] = TYPE(_history[2]);
+						m_y[1] = TYPE(_history[3]);
+					}
 					/**
 					 * @brief Reset bequad filter (only history not value).
 					 */
 					void reset() {
 						m_x[0] = 0;
-						m_y[1] = 0;
-						m_x[0] = 0;
+						m_x[1] = 0;
+						m_y[0] = 0;
 						m_y[1] = 0;
 					}
-				protected:
 					/**
 					 * @brief process single sample in float.
 					 * @param[in] _sample Sample to process
@@ -225,6 +144,18 @@ namespace audio {
 						m_y[0] = result;
 						return result;
 					}
+					/**
+					 * @brief process single sample in transposed direct form II (same coefficients, 2 states: m_x[0] and m_x[1], m_y is not used).
+					 * @note The history is not compatible with the direct form I one: reset the filter when changing of form.
+					 * @param[in] _sample Sample to process
+					 * @return updataed value
+					 */
+					TYPE processTransposed(TYPE _sample) {
+						TYPE result = m_a[0] * _sample + m_x[0];
+						m_x[0] = m_a[1] * _sample - m_b[0] * result + m_x[1];
+						m_x[1] = m_a[2] * _sample - m_b[1] * result;
+						return result;
+					}
 				public:
 					/**
 					 * @brief Porcess function.
@@ -254,9 +185,10 @@ namespace audio {
 					 */
 					etk::Vector<etk::Pair<float,float> > calculateTheory(double _sampleRate){
 						etk::Vector<etk::Pair<float,float> > out;
-						double norm;
 						bool buildLinear = true;
 						size_t len = 512;
+						etk::Vector<float> halfAngle;
+						halfAngle.resize(len, 0.0f);
 						for (size_t iii=0; iii < len; iii++) {
 							double w;
 							if (buildLinear == true) {
@@ -266,15 +198,32 @@ namespace audio {
 								// 0.001 to 1, times pi, log scale
 								w = etk::exp(etk::log(1.0 / 0.001) * iii / (len - 1.0)) * 0.001 * M_PI;
 							}
+							halfAngle[iii] = w/2.0;
+						}
+						etk::Vector<float> sinHalf;
+						sinHalf.resize(len, 0.0f);
+						etk::Vector<float> numerator;
+						numerator.resize(len, 0.0f);
+						audio::algo::drain::vectorMath::sinCos(&sinHalf[0], &numerator[0], &halfAngle[0], len);
+						// |H|^2 = N(phi) / D(phi) with phi = sin(w/2)^2
+						double num0 = etk::pow((m_a[0]+m_a[1]+m_a[2]).getDouble(), 2.0);
+						double num1 = - 4.0*((m_a[0]*m_a[1]).getDouble() + 4.0*(m_a[0]*m_a[2]).getDouble() + (m_a[1]*m_a[2]).getDouble());
+						double num2 = 16.0*(m_a[0]*m_a[2]).getDouble();
+						double den0 = etk::pow(1.0+(m_b[0]+m_b[1]).getDouble(), 2.0);
+						double den1 = - 4.0*((m_b[0]).getDouble() + 4.0*(m_b[1]).getDouble() + (m_b[0]*m_b[1]).getDouble());
+						double den2 = 16.0*m_b[1].getDouble();
+						etk::Vector<float>& denominator = halfAngle;
+						for (size_t iii=0; iii < len; iii++) {
+							double phi = double(sinHalf[iii]) * double(sinHalf[iii]);
+							numerator[iii] = num0 + num1*phi + num2*phi*phi;
+							denominator[iii] = den0 + den1*phi + den2*phi*phi;
+						}
+						audio::algo::drain::vectorMath::powerToDb(&numerator[0], &numerator[0], len, -1000.0f);
+						audio::algo::drain::vectorMath::powerToDb(&denominator[0], &denominator[0], len, -1000.0f);
+						out.reserve(len);
+						for (size_t iii=0; iii < len; iii++) {
 							double freq = iii / (len - 1.0) * _sampleRate / 2.0;
-							double phi = etk::pow(etk::sin(w/2.0), 2.0);
-							double y =   etk::log(   etk::pow((m_a[0]+m_a[1]+m_a[2]).getDouble(), 2.0)
-							                       - 4.0*((m_a[0]*m_a[1]).getDouble() + 4.0*(m_a[0]*m_a[2]).getDouble() + (m_a[1]*m_a[2]).getDouble())*phi
-							                       + 16.0*(m_a[0]*m_a[2]).getDouble()*phi*phi)
-							           - etk::log(   etk::pow(1.0+(m_b[0]+m_b[1]).getDouble(), 2.0)
-							                       - 4.0*((m_b[0]).getDouble() + 4.0*(m_b[1]).getDouble() + (m_b[0]*m_b[1]).getDouble())*phi
-							                       + 16.0*m_b[1].getDouble()*phi*phi);
-							y = y * 10.0 / M_LN10;
+							double y = numerator[iii] - denominator[iii];
 							if (y <= -200) {
 								y = -200.0;
 							}
@@ -0,0 +1,215 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <audio/algo/drain/BiQuadCache.hpp>
+#include <audio/algo/drain/debug.hpp>
+#include <ethread/Mutex.hpp>
+#include <atomic>
+extern "C" {
+	#include <string.h>
+}
+
+// Number of set of the table (power of 2).
+static const size_t nbSet = 256;
+// Number of entry in a set (a new design replace the oldest entry of its set).
+static const size_t nbWay = 4;
+// Number of 64 bits word of an entry: type, frequency, Q, gain, sample rate and the 5 coefficients.
+static const size_t nbWord = 10;
+
+namespace audio {
+	namespace algo {
+		namespace drain {
+			/**
+			 * @brief One design of the cache, read without lock (sequence lock).
+			 * The writer (mutex owner) set an odd sequence during the update, a reader keep its copy only if the sequence is even and did not change during the copy.
+			 * The words are atomic (relaxed access) to have no data race with a concurrent update.
+			 */
+			class BiQuadCacheEntry {
+				public:
+					std::atomic<uint32_t> m_sequence; //!< even: stable, odd: update in progress
+					std::atomic<uint64_t> m_word[nbWord]; //!< key and design (bits of the double)
+				public:
+					BiQuadCacheEntry() :
+					  m_sequence(0) {
+						for (size_t iii=0; iii<nbWord; ++iii) {
+							m_word[iii].store(0, std::memory_order_relaxed);
+						}
+					}
+			};
+			class BiQuadCacheData {
+				public:
+					ethread::Mutex m_mutex; //!< serialize the writers
+					audio::algo::drain::BiQuadCacheEntry m_entry[nbSet*nbWay]; //!< set associative table
+					uint8_t m_next[nbSet]; //!< next way to replace in each set
+					std::atomic<size_t> m_size; //!< number of entry
+					std::atomic<size_t> m_nbHit; //!< number of request found in the cache
+				public:
+					BiQuadCacheData() :
+					  m_size(0),
+					  m_nbHit(0) {
+						memset(m_next, 0, sizeof(m_next));
+					}
+			};
+		}
+	}
+}
+
+static audio::algo::drain::BiQuadCacheData& getData() {
+	static audio::algo::drain::BiQuadCacheData data;
+	return data;
+}
+
+static uint64_t doubleToBits(double _value) {
+	uint64_t bits;
+	memcpy(&bits, &_value, sizeof(double));
+	return bits;
+}
+
+static double bitsToDouble(uint64_t _bits) {
+	double value;
+	memcpy(&value, &_bits, sizeof(double));
+	return value;
+}
+
+static uint64_t hashWord(uint64_t _hash, uint64_t _bits) {
+	// FNV like mix
+	_hash ^= _bits;
+	_hash *= 0x100000001B3ULL;
+	_hash ^= _hash >> 29;
+	return _hash;
+}
+
+/**
+ * @brief Create the key of a design: type (+1, 0 is an empty entry) and bits of the parameters.
+ */
+static void createKey(uint64_t* _key, enum audio::algo::drain::biQuadType _type, double _frequencyCut, double _qualityFactor, double _gain, double _sampleRate) {
+	_key[0] = uint64_t(_type) + 1;
+	_key[1] = doubleToBits(_frequencyCut);
+	_key[2] = doubleToBits(_qualityFactor);
+	_key[3] = doubleToBits(_gain);
+	_key[4] = doubleToBits(_sampleRate);
+}
+
+static size_t hashKey(const uint64_t* _key) {
+	uint64_t hash = 0xCBF29CE484222325ULL;
+	for (size_t iii=0; iii<5; ++iii) {
+		hash = hashWord(hash, _key[iii]);
+	}
+	return size_t(hash ^ (hash >> 32));
+}
+
+/**
+ * @brief Read an entry without lock.
+ * @param[in] _entry Entry to read.
+ * @param[out] _word Copy of the words of the entry.
+ * @return true The copy is coherent (no update during the read).
+ */
+static bool readEntry(const audio::algo::drain::BiQuadCacheEntry& _entry, uint64_t* _word) {
+	uint32_t sequence = _entry.m_sequence.load(std::memory_order_acquire);
+	if ((sequence & 1) != 0) {
+		return false;
+	}
+	for (size_t iii=0; iii<nbWord; ++iii) {
+		_word[iii] = _entry.m_word[iii].load(std::memory_order_relaxed);
+	}
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return _entry.m_sequence.load(std::memory_order_relaxed) == sequence;
+}
+
+/**
+ * @brief Write an entry (the mutex must be locked).
+ * @param[in] _entry Entry to write.
+ * @param[in] _word New words of the entry.
+ */
+static void writeEntry(audio::algo::drain::BiQuadCacheEntry& _entry, const uint64_t* _word) {
+	uint32_t sequence = _entry.m_sequence.load(std::memory_order_relaxed);
+	_entry.m_sequence.store(sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	for (size_t iii=0; iii<nbWord; ++iii) {
+		_entry.m_word[iii].store(_word[iii], std::memory_order_relaxed);
+	}
+	_entry.m_sequence.store(sequence + 2, std::memory_order_release);
+}
+
+static audio::algo::drain::BiQuadCoefficient wordToCoefficient(const uint64_t* _word) {
+	return audio::algo::drain::BiQuadCoefficient(bitsToDouble(_word[5]),
+	                                             bitsToDouble(_word[6]),
+	                                             bitsToDouble(_word[7]),
+	                                             bitsToDouble(_word[8]),
+	                                             bitsToDouble(_word[9]));
+}
+
+audio::algo::drain::BiQuadCoefficient audio::algo::drain::BiQuadCache::get(enum audio::algo::drain::biQuadType _type, double _frequencyCut, double _qualityFactor, double _gain, double _sampleRate) {
+	if (audio::algo::drain::biQuadCheck(_frequencyCut, _qualityFactor, _gain, _sampleRate) == false) {
+		AA_DRAIN_ERROR("Can not design a bi-quad with f=" << _frequencyCut << " Q=" << _qualityFactor << " gain=" << _gain << " sampleRate=" << _sampleRate << " ==> pass threw");
+		return audio::algo::drain::BiQuadCoefficient();
+	}
+	audio::algo::drain::BiQuadCacheData& data = getData();
+	uint64_t word[nbWord];
+	createKey(word, _type, _frequencyCut, _qualityFactor, _gain, _sampleRate);
+	size_t idSet = hashKey(word) & (nbSet-1);
+	audio::algo::drain::BiQuadCacheEntry* set = &data.m_entry[idSet*nbWay];
+	// lookup without lock
+	uint64_t read[nbWord];
+	for (size_t www=0; www<nbWay; ++www) {
+		if (    readEntry(set[www], read) == true
+		     && memcmp(read, word, 5*sizeof(uint64_t)) == 0) {
+			data.m_nbHit.fetch_add(1, std::memory_order_relaxed);
+			return wordToCoefficient(read);
+		}
+	}
+	// the design is calculated out of the lock
+	audio::algo::drain::BiQuadCoefficient coef = audio::algo::drain::biQuadDesign(_type, _frequencyCut, _qualityFactor, _gain, _sampleRate);
+	for (size_t iii=0; iii<3; ++iii) {
+		word[5+iii] = doubleToBits(coef.m_a[iii]);
+	}
+	for (size_t iii=0; iii<2; ++iii) {
+		word[8+iii] = doubleToBits(coef.m_b[iii]);
+	}
+	ethread::UniqueLock lock(data.m_mutex);
+	// an other thread can have added the same design (or an update was in progress during the lookup)
+	for (size_t www=0; www<nbWay; ++www) {
+		if (    readEntry(set[www], read) == true
+		     && memcmp(read, word, 5*sizeof(uint64_t)) == 0) {
+			return coef;
+		}
+	}
+	// replace the oldest entry of the set
+	size_t idWay = data.m_next[idSet];
+	data.m_next[idSet] = uint8_t((idWay+1) % nbWay);
+	if (set[idWay].m_word[0].load(std::memory_order_relaxed) == 0) {
+		data.m_size.fetch_add(1, std::memory_order_relaxed);
+	}
+	writeEntry(set[idWay], word);
+	return coef;
+}
+
+size_t audio::algo::drain::BiQuadCache::getSize() {
+	return getData().m_size.load(std::memory_order_relaxed);
+}
+
+size_t audio::algo::drain::BiQuadCache::getCapacity() {
+	return nbSet*nbWay;
+}
+
+size_t audio::algo::drain::BiQuadCache::getNbHit() {
+	return getData().m_nbHit.load(std::memory_order_relaxed);
+}
+
+void audio::algo::drain::BiQuadCache::clear() {
+	audio::algo::drain::BiQuadCacheData& data = getData();
+	ethread::UniqueLock lock(data.m_mutex);
+	uint64_t word[nbWord];
+	memset(word, 0, sizeof(word));
+	for (size_t iii=0; iii<nbSet*nbWay; ++iii) {
+		if (data.m_entry[iii].m_word[0].load(std::memory_order_relaxed) != 0) {
+			writeEntry(data.m_entry[iii], word);
+		}
+	}
+	memset(data.m_next, 0, sizeof(data.m_next));
+	data.m_size.store(0, std::memory_order_relaxed);
+	data.m_nbHit.store(0, std::memory_order_relaxed);
+}
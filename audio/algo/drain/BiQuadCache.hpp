@@ -0,0 +1,56 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <etk/types.hpp>
+#include <audio/algo/drain/BiQuadType.hpp>
+#include <audio/algo/drain/BiQuadDesign.hpp>
+
+namespace audio {
+	namespace algo {
+		namespace drain {
+			/**
+			 * @brief Process wide cache of the bi-quad designs (thread safe).
+			 * Many instances loading the same preset calculate each band only one time.
+			 * The table has a fixed capacity (1024 designs, about 100 kB allocated once): a new design replace the oldest entry of its set (4 entries per set).
+			 * A request found in the cache does not lock (sequence lock on the entry), only the insertion of a new design lock the mutex.
+			 */
+			class BiQuadCache {
+				public:
+					/**
+					 * @brief Get the coefficients of a bi-quad (calculated with biQuadDesign on the first request or after the eviction of the design).
+					 * @param[in] _type Type of biquad.
+					 * @param[in] _frequencyCut Cut Frequency. [0..sampleRate/2]
+					 * @param[in] _qualityFactor Q factor of quality (good value of 0.707 ==> permit to not ower gain) limit [0.01 .. 10]
+					 * @param[in] _gain Gain to apply (for notch, peak, lowShelf and highShelf) limit : -30, +30
+					 * @param[in] _sampleRate Sample rate of the signal
+					 * @return The bi-quad coefficients.
+					 */
+					static audio::algo::drain::BiQuadCoefficient get(enum audio::algo::drain::biQuadType _type, double _frequencyCut, double _qualityFactor, double _gain, double _sampleRate);
+					/**
+					 * @brief Get the number of design stored in the cache.
+					 * @return Number of entry.
+					 */
+					static size_t getSize();
+					/**
+					 * @brief Get the maximum number of design stored in the cache.
+					 * @return Number of entry of the table.
+					 */
+					static size_t getCapacity();
+					/**
+					 * @brief Get the number of request that found the design in the cache.
+					 * @return Number of hit since the start (or the last clear).
+					 */
+					static size_t getNbHit();
+					/**
+					 * @brief Remove all the entry of the cache.
+					 */
+					static void clear();
+			};
+		}
+	}
+}
+
@@ -0,0 +1,291 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <etk/types.hpp>
+#include <audio/algo/drain/BiQuadType.hpp>
+extern "C" {
+	#include <math.h>
+}
+#ifndef M_LN10
+	#define M_LN10 2.30258509299404568402
+#endif
+#ifndef M_SQRT2
+	#define M_SQRT2 1.41421356237309504880
+#endif
+
+// see http://www.musicdsp.org/files/Audio-EQ-Cookbook.txt
+// see http://www.earlevel.com/main/2013/10/13/biquad-calculator-v2/
+
+namespace audio {
+	namespace algo {
+		namespace drain {
+			/**
+			 * @brief Coefficients of a bi-quad: y[n] = a0.x[n] + a1.x[n-1] + a2.x[n-2] - b0.y[n-1] - b1.y[n-2]
+			 */
+			class BiQuadCoefficient {
+				public:
+					double m_a[3]; //!< A bi-Quad coef
+					double m_b[2]; //!< B bi-Quad coef
+				public:
+					constexpr BiQuadCoefficient(double _a0=1.0, double _a1=0.0, double _a2=0.0, double _b0=0.0, double _b1=0.0) :
+					  m_a{_a0, _a1, _a2},
+					  m_b{_b0, _b1} {
+						
+					}
+			};
+			/**
+			 * @brief Math functions usable in constant expression (the design of a biquad can be done at compile time).
+			 * @note Precision is close to the double precision on the range used by the design (not for generic usage).
+			 */
+			namespace designMath {
+				constexpr double abs(double _value) {
+					return _value < 0.0 ? -_value : _value;
+				}
+				/**
+				 * @brief Check that a value is not an infinity or a NaN (inf-inf and nan-nan are NaN).
+				 */
+				constexpr bool isFinite(double _value) {
+					return _value - _value == 0.0;
+				}
+				/**
+				 * @brief Square root (Newton iteration).
+				 */
+				constexpr double sqrt(double _value) {
+					if (_value <= 0.0) {
+						return 0.0;
+					}
+					double out = _value > 1.0 ? _value : 1.0;
+					for (int32_t iii=0; iii<2048; ++iii) {
+						double next = 0.5 * (out + _value / out);
+						if (next >= out) {
+							break;
+						}
+						out = next;
+					}
+					return out;
+				}
+				/**
+				 * @brief Exponential (argument divided by 2 until < 0.5, Taylor series, then squared back).
+				 */
+				constexpr double exp(double _value) {
+					if (isFinite(_value) == false) {
+						// exp(+inf)=+inf, exp(-inf)=0, exp(nan)=nan (the reduction below never ends on an infinity)
+						return _value < 0.0 ? 0.0 : _value;
+					}
+					int32_t nbSquare = 0;
+					while (abs(_value) > 0.5) {
+						_value *= 0.5;
+						nbSquare++;
+					}
+					double out = 1.0;
+					double term = 1.0;
+					for (int32_t iii=1; iii<20; ++iii) {
+						term *= _value / iii;
+						out += term;
+					}
+					for (int32_t iii=0; iii<nbSquare; ++iii) {
+						out *= out;
+					}
+					return out;
+				}
+				/**
+				 * @brief Tangent on [0..pi/2] (Taylor series of sin and cos on [0..pi/4]).
+				 */
+				constexpr double tan(double _value) {
+					bool invert = _value > M_PI/4.0;
+					if (invert == true) {
+						// limit on cos(pi/2) in double (same result as the libc)
+						_value = M_PI/2.0 - _value;
+						_value = _value > 6.123233995736766e-17 ? _value : 6.123233995736766e-17;
+					}
+					double value2 = _value*_value;
+					double valueSin = _value;
+					double valueCos = 1.0;
+					double termSin = _value;
+					double termCos = 1.0;
+					for (int32_t iii=1; iii<12; ++iii) {
+						termSin *= -value2 / ((2*iii) * (2*iii+1));
+						termCos *= -value2 / ((2*iii-1) * (2*iii));
+						valueSin += termSin;
+						valueCos += termCos;
+					}
+					if (invert == true) {
+						return valueCos / valueSin;
+					}
+					return valueSin / valueCos;
+				}
+			}
+			/**
+			 * @brief Calculate the coefficients of a bi-quad from the values that depend on the frequency and on the gain (can be used in constant expression).
+			 * The frequency part (tangent) can be stored to change only the gain (dynamic bands: no tan() at each update).
+			 * @param[in] _type Type of biquad.
+			 * @param[in] _tangent tan(pi.frequencyCut/sampleRate).
+			 * @param[in] _qualityFactor Q factor of quality (already limited to [0.01..[).
+			 * @param[in] _gain Gain to apply in dB (only the sign is used: cut or boost).
+			 * @param[in] _gainLinear 10^(|gain|/20).
+			 * @return The bi-quad coefficients.
+			 */
+			constexpr audio::algo::drain::BiQuadCoefficient biQuadDesignTangent(enum audio::algo::drain::biQuadType _type, double _tangent, double _qualityFactor, double _gain, double _gainLinear) {
+				double norm = 0.0;
+				double V = _gainLinear;
+				double K = _tangent;
+				double sqrt2V = designMath::sqrt(2.0*V);
+				switch (_type) {
+					case biQuadType_none:
+						break;
+					case biQuadType_lowPass:
+						norm = 1.0 / (1.0 + K / _qualityFactor + K * K);
+						return audio::algo::drain::BiQuadCoefficient(K * K * norm,
+						                                             2.0 * K * K * norm,
+						                                             K * K * norm,
+						                                             2.0 * (K * K - 1.0) * norm,
+						                                             (1.0 - K / _qualityFactor + K * K) * norm);
+					case biQuadType_highPass:
+						norm = 1.0 / (1.0 + K / _qualityFactor + K * K);
+						return audio::algo::drain::BiQuadCoefficient(1.0 * norm,
+						                                             -2.0 * norm,
+						                                             1.0 * norm,
+						                                             2.0 * (K * K - 1.0) * norm,
+						                                             (1.0 - K / _qualityFactor + K * K) * norm);
+					case biQuadType_bandPass:
+						norm = 1.0 / (1.0 + K / _qualityFactor + K * K);
+						return audio::algo::drain::BiQuadCoefficient(K / _qualityFactor * norm,
+						                                             0.0,
+						                                             -K / _qualityFactor * norm,
+						                                             2.0 * (K * K - 1.0) * norm,
+						                                             (1.0 - K / _qualityFactor + K * K) * norm);
+					case biQuadType_notch:
+						norm = 1.0 / (1.0 + K / _qualityFactor + K * K);
+						return audio::algo::drain::BiQuadCoefficient((1.0 + K * K) * norm,
+						                                             2.0 * (K * K - 1.0) * norm,
+						                                             (1.0 + K * K) * norm,
+						                                             2.0 * (K * K - 1.0) * norm,
+						                                             (1.0 - K / _qualityFactor + K * K) * norm);
+					case biQuadType_peak:
+						if (_gain >= 0.0) {
+							norm = 1.0 / (1.0 + 1.0/_qualityFactor * K + K * K);
+							return audio::algo::drain::BiQuadCoefficient((1.0 + V/_qualityFactor * K + K * K) * norm,
+							                                             2.0 * (K * K - 1.0) * norm,
+							                                             (1.0 - V/_qualityFactor * K + K * K) * norm,
+							                                             2.0 * (K * K - 1.0) * norm,
+							                                             (1.0 - 1.0/_qualityFactor * K + K * K) * norm);
+						}
+						norm = 1.0 / (1.0 + V/_qualityFactor * K + K * K);
+						return audio::algo::drain::BiQuadCoefficient((1.0 + 1.0/_qualityFactor * K + K * K) * norm,
+						                                             2.0 * (K * K - 1.0) * norm,
+						                                             (1.0 - 1.0/_qualityFactor * K + K * K) * norm,
+						                                             2.0 * (K * K - 1.0) * norm,
+						                                             (1.0 - V/_qualityFactor * K + K * K) * norm);
+					case biQuadType_lowShelf:
+						if (_gain >= 0) {
+							norm = 1.0 / (1.0 + M_SQRT2 * K + K * K);
+							return audio::algo::drain::BiQuadCoefficient((1.0 + sqrt2V * K + V * K * K) * norm,
+							                                             2.0 * (V * K * K - 1.0) * norm,
+							                                             (1.0 - sqrt2V * K + V * K * K) * norm,
+							                                             2.0 * (K * K - 1.0) * norm,
+							                                             (1.0 - M_SQRT2 * K + K * K) * norm);
+						}
+						norm = 1.0 / (1.0 + sqrt2V * K + V * K * K);
+						return audio::algo::drain::BiQuadCoefficient((1.0 + M_SQRT2 * K + K * K) * norm,
+						                                             2.0 * (K * K - 1.0) * norm,
+						                                             (1.0 - M_SQRT2 * K + K * K) * norm,
+						                                             2.0 * (V * K * K - 1.0) * norm,
+						                                             (1.0 - sqrt2V * K + V * K * K) * norm);
+					case biQuadType_highShelf:
+						if (_gain >= 0) {
+							norm = 1.0 / (1.0 + M_SQRT2 * K + K * K);
+							return audio::algo::drain::BiQuadCoefficient((V + sqrt2V * K + K * K) * norm,
+							                                             2.0 * (K * K - V) * norm,
+							                                             (V - sqrt2V * K + K * K) * norm,
+							                                             2.0 * (K * K - 1.0) * norm,
+							                                             (1.0 - M_SQRT2 * K + K * K) * norm);
+						}
+						norm = 1.0 / (V + sqrt2V * K + K * K);
+						return audio::algo::drain::BiQuadCoefficient((1.0 + M_SQRT2 * K + K * K) * norm,
+						                                             2.0 * (K * K - 1.0) * norm,
+						                                             (1.0 - M_SQRT2 * K + K * K) * norm,
+						                                             2.0 * (K * K - V) * norm,
+						                                             (V - sqrt2V * K + K * K) * norm);
+				}
+				return audio::algo::drain::BiQuadCoefficient();
+			}
+			/**
+			 * @brief Calculate the squared magnitude of the peak of biQuadDesignTangent at a frequency (closed form, no complex evaluation of the transfer function).
+			 * With t = tan(pi.f/sampleRate) and K = tan(pi.frequencyCut/sampleRate): ((K^2-t^2)^2 + (V.K.t/Q)^2) / ((K^2-t^2)^2 + (K.t/Q)^2) for a boost. A cut is the inverse of the boost (its response in dB is the opposite).
+			 * @param[in] _tangentCut2 K^2.
+			 * @param[in] _tangent2 t^2.
+			 * @param[in] _invQuality2 1/Q^2.
+			 * @param[in] _gainLinear2 V^2 = 10^(|gain|/10).
+			 * @param[out] _distance (K^2-t^2)^2 (for the derivatives).
+			 * @param[out] _width (K.t/Q)^2 (for the derivatives).
+			 * @return The squared magnitude of the boost.
+			 */
+			template<typename TYPE> constexpr TYPE biQuadPeakPower(TYPE _tangentCut2, TYPE _tangent2, TYPE _invQuality2, TYPE _gainLinear2, TYPE& _distance, TYPE& _width) {
+				TYPE delta = _tangentCut2 - _tangent2;
+				_distance = delta * delta;
+				_width = _tangentCut2 * _tangent2 * _invQuality2;
+				return (_distance + _gainLinear2 * _width) / (_distance + _width);
+			}
+			/**
+			 * @brief Calculate the squared magnitude of the peak of biQuadDesignTangent at a frequency (see upper).
+			 * @param[in] _tangentCut2 K^2.
+			 * @param[in] _tangent2 t^2.
+			 * @param[in] _invQuality2 1/Q^2.
+			 * @param[in] _gainLinear2 V^2 = 10^(|gain|/10).
+			 * @return The squared magnitude of the boost.
+			 */
+			template<typename TYPE> constexpr TYPE biQuadPeakPower(TYPE _tangentCut2, TYPE _tangent2, TYPE _invQuality2, TYPE _gainLinear2) {
+				TYPE distance = 0;
+				TYPE width = 0;
+				return biQuadPeakPower(_tangentCut2, _tangent2, _invQuality2, _gainLinear2, distance, width);
+			}
+			/**
+			 * @brief Check the parameters of a design: all the values must be finite.
+			 * @param[in] _frequencyCut Cut Frequency.
+			 * @param[in] _qualityFactor Q factor of quality.
+			 * @param[in] _gain Gain to apply (dB).
+			 * @param[in] _sampleRate Sample rate of the signal.
+			 * @return true The design can be calculated.
+			 */
+			constexpr bool biQuadCheck(double _frequencyCut, double _qualityFactor, double _gain, double _sampleRate) {
+				return    designMath::isFinite(_frequencyCut) == true
+				       && designMath::isFinite(_qualityFactor) == true
+				       && designMath::isFinite(_gain) == true
+				       && designMath::isFinite(_sampleRate) == true;
+			}
+			/**
+			 * @brief Calculate the coefficients of a bi-quad (can be used in constant expression).
+			 * @param[in] _type Type of biquad.
+			 * @param[in] _frequencyCut Cut Frequency. [0..sampleRate/2]
+			 * @param[in] _qualityFactor Q factor of quality (good value of 0.707 ==> permit to not ower gain) limit [0.01 .. 10]
+			 * @param[in] _gain Gain to apply (for notch, peak, lowShelf and highShelf) limit : -30, +30
+			 * @param[in] _sampleRate Sample rate of the signal
+			 * @return The bi-quad coefficients (pass threw if the sample rate is wrong or if a parameter is an infinity or a NaN).
+			 */
+			constexpr audio::algo::drain::BiQuadCoefficient biQuadDesign(enum audio::algo::drain::biQuadType _type, double _frequencyCut, double _qualityFactor, double _gain, double _sampleRate) {
+				if (    _sampleRate < 1
+				     || biQuadCheck(_frequencyCut, _qualityFactor, _gain, _sampleRate) == false) {
+					return audio::algo::drain::BiQuadCoefficient();
+				}
+				if (_frequencyCut > _sampleRate/2) {
+					_frequencyCut = _sampleRate/2;
+				} else if (_frequencyCut < 0) {
+					_frequencyCut = 0;
+				}
+				if (_qualityFactor < 0.01) {
+					_qualityFactor = 0.01;
+				}
+				return biQuadDesignTangent(_type,
+				                           designMath::tan(M_PI * _frequencyCut / _sampleRate),
+				                           _qualityFactor,
+				                           _gain,
+				                           designMath::exp(designMath::abs(_gain) / 20.0 * M_LN10));
+			}
+		}
+	}
+}
+
@@ -0,0 +1,142 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <audio/algo/drain/Chain.hpp>
+#include <audio/algo/drain/debug.hpp>
+extern "C" {
+	#include <string.h>
+}
+
+// Default sub-block size: an audio callback (up to 4096 chunks) is processed at once by each stage.
+// The sub-blocking on the L1 cache size did not win on the stages measured (bi-quads are bound by the computation, not by the memory).
+static const size_t subBlockDefaultSize = 4096;
+
+audio::algo::drain::Chain::Chain() :
+  m_sampleRate(48000),
+  m_nbChannel(2),
+  m_format(audio::format_float),
+  m_subBlockSize(0),
+  m_subBlockSizeUsed(0) {
+	
+}
+
+audio::algo::drain::Chain::~Chain() {
+	
+}
+
+void audio::algo::drain::Chain::init(float _sampleRate, int8_t _nbChannel, enum audio::format _format, size_t _subBlockSize) {
+	m_sampleRate = _sampleRate;
+	m_nbChannel = _nbChannel;
+	m_format = _format;
+	m_subBlockSize = _subBlockSize;
+	m_stages.clear();
+	m_buffers.clear();
+	m_subBlockSizeUsed = 0;
+	if (audio::getFormatBytes(m_format) == 0) {
+		AA_DRAIN_ERROR("Can not chain algorithms with format: " << m_format);
+	}
+}
+
+int8_t audio::algo::drain::Chain::getOutputNbChannel() const {
+	if (m_stages.size() == 0) {
+		return m_nbChannel;
+	}
+	return m_stages.back().m_nbChannelOut;
+}
+
+bool audio::algo::drain::Chain::addStage(const etk::Function<void(void*, const void*, size_t)>& _process, int8_t _nbChannelOut, bool _inPlace, const etk::String& _name) {
+	if (_process == null) {
+		AA_DRAIN_ERROR("Can not add a stage without process function");
+		return false;
+	}
+	audio::algo::drain::ChainStage stage;
+	stage.m_name = _name;
+	stage.m_process = _process;
+	stage.m_nbChannelIn = getOutputNbChannel();
+	stage.m_nbChannelOut = _nbChannelOut;
+	if (stage.m_nbChannelOut <= 0) {
+		stage.m_nbChannelOut = stage.m_nbChannelIn;
+	}
+	stage.m_inPlace = _inPlace;
+	stage.m_bufferIn = -1;
+	stage.m_bufferOut = -1;
+	m_stages.pushBack(stage);
+	plan();
+	return true;
+}
+
+void audio::algo::drain::Chain::plan() {
+	size_t formatBytes = audio::getFormatBytes(m_format);
+	if (formatBytes == 0) {
+		return;
+	}
+	// The first stage read the input of the chain and the last one write the output of the chain: only the data between two stages are in a buffer.
+	int32_t nbBuffer = 0;
+	int32_t nbChannelMax = m_nbChannel;
+	int8_t current = -1;
+	for (size_t iii=0; iii<m_stages.size(); ++iii) {
+		audio::algo::drain::ChainStage& stage = m_stages[iii];
+		nbChannelMax = etk::max(nbChannelMax, int32_t(stage.m_nbChannelOut));
+		stage.m_bufferIn = current;
+		if (iii == m_stages.size()-1) {
+			stage.m_bufferOut = -1;
+		} else if (    current >= 0
+		            && stage.m_inPlace == true
+		            && stage.m_nbChannelOut <= stage.m_nbChannelIn) {
+			// a chunk is never written before the previous chunks are read
+			stage.m_bufferOut = current;
+		} else if (current == 0) {
+			stage.m_bufferOut = 1;
+		} else {
+			stage.m_bufferOut = 0;
+		}
+		nbBuffer = etk::max(nbBuffer, int32_t(stage.m_bufferOut) + 1);
+		current = stage.m_bufferOut;
+	}
+	m_subBlockSizeUsed = m_subBlockSize;
+	if (m_subBlockSizeUsed == 0) {
+		m_subBlockSizeUsed = subBlockDefaultSize;
+	}
+	m_buffers.resize(nbBuffer);
+	for (int32_t iii=0; iii<nbBuffer; ++iii) {
+		m_buffers[iii].resize((m_subBlockSizeUsed * nbChannelMax * formatBytes + sizeof(uint64_t) - 1) / sizeof(uint64_t), 0);
+	}
+	AA_DRAIN_VERBOSE("Chain of " << m_stages.size() << " stages: " << nbBuffer << " buffers, sub-block=" << m_subBlockSizeUsed << " chunks");
+}
+
+void audio::algo::drain::Chain::process(void* _output, const void* _input, size_t _nbChunk) {
+	size_t formatBytes = audio::getFormatBytes(m_format);
+	if (m_stages.size() == 0) {
+		if (_output != _input) {
+			memmove(_output, _input, _nbChunk * m_nbChannel * formatBytes);
+		}
+		return;
+	}
+	if (m_stages.size() == 1) {
+		m_stages[0].m_process(_output, _input, _nbChunk);
+		return;
+	}
+	const uint8_t* input = reinterpret_cast<const uint8_t*>(_input);
+	uint8_t* output = reinterpret_cast<uint8_t*>(_output);
+	size_t inputChunkSize = formatBytes * m_nbChannel;
+	size_t outputChunkSize = formatBytes * getOutputNbChannel();
+	for (size_t offset=0; offset<_nbChunk; offset+=m_subBlockSizeUsed) {
+		size_t nbChunk = etk::min(m_subBlockSizeUsed, _nbChunk - offset);
+		for (size_t iii=0; iii<m_stages.size(); ++iii) {
+			audio::algo::drain::ChainStage& stage = m_stages[iii];
+			const void* in = &input[offset*inputChunkSize];
+			if (stage.m_bufferIn >= 0) {
+				in = &m_buffers[stage.m_bufferIn][0];
+			}
+			void* out = &output[offset*outputChunkSize];
+			if (stage.m_bufferOut >= 0) {
+				out = &m_buffers[stage.m_bufferOut][0];
+			}
+			stage.m_process(out, in, nbChunk);
+		}
+	}
+}
+
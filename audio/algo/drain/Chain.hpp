@@ -0,0 +1,143 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <etk/types.hpp>
+#include <ememory/memory.hpp>
+#include <etk/Vector.hpp>
+#include <etk/String.hpp>
+#include <etk/Function.hpp>
+#include <audio/format.hpp>
+
+namespace audio {
+	namespace algo {
+		namespace drain {
+			/**
+			 * @brief Description of a stage of a Chain.
+			 */
+			class ChainStage {
+				public:
+					etk::String m_name; //!< name of the stage (debug)
+					etk::Function<void(void*, const void*, size_t)> m_process; //!< process function of the algorithm
+					int8_t m_nbChannelIn; //!< number of channel at the input of the stage
+					int8_t m_nbChannelOut; //!< number of channel at the output of the stage
+					bool m_inPlace; //!< the algorithm accept the same pointer in input and output
+					int8_t m_bufferIn; //!< id of the input buffer (-1: input of the chain)
+					int8_t m_bufferOut; //!< id of the output buffer (-1: output of the chain)
+			};
+			/**
+			 * @brief Chain of algorithms processed as a single one.
+			 * All the stages use the same format, the number of channel can change at each stage. The intermediate buffers are planned when a stage is added:
+			 * a stage that accept to work in place writes in its input buffer, the other ones use a second buffer (ping-pong). There is no copy between the stages and no allocation in process.
+			 * The stream is processed by sub-block: all the stages process a sub-block before the next one (by default a sub-block is a full audio callback, up to 4096 chunks: the buffers are allocated for it).
+			 * @code
+			 * audio::algo::drain::Chain chain;
+			 * chain.init(48000, 2, audio::format_float);
+			 * chain.addStage(equalizer); // ememory::SharedPtr<audio::algo::drain::Equalizer>
+			 * chain.addStage(beamformer, 1, false);
+			 * chain.process(output, input, nbChunk);
+			 * @endcode
+			 */
+			class Chain {
+				protected:
+					float m_sampleRate; //!< sample rate of the stream
+					int8_t m_nbChannel; //!< number of channel at the input of the chain
+					enum audio::format m_format; //!< format of the samples
+					size_t m_subBlockSize; //!< number of chunk processed by all the stages at once (0: default)
+					size_t m_subBlockSizeUsed; //!< number of chunk of the current plan
+					etk::Vector<audio::algo::drain::ChainStage> m_stages; //!< list of all the stages
+					etk::Vector<etk::Vector<uint64_t> > m_buffers; //!< intermediate buffers (uint64_t to be aligned for all the formats)
+				public:
+					/**
+					 * @brief Constructor
+					 */
+					Chain();
+					/**
+					 * @brief Destructor
+					 */
+					virtual ~Chain();
+				public:
+					/**
+					 * @brief Initialize the chain (remove all the stages).
+					 * @param[in] _sampleRate Sample rate of the stream.
+					 * @param[in] _nbChannel Number of channel at the input of the chain.
+					 * @param[in] _format Data format of all the stages.
+					 * @param[in] _subBlockSize Number of chunk processed by all the stages before the next sub-block (0: 4096, the calls up to this size are processed at once by each stage).
+					 */
+					void init(float _sampleRate=48000, int8_t _nbChannel=2, enum audio::format _format=audio::format_float, size_t _subBlockSize=0);
+					/**
+					 * @brief Add a stage at the end of the chain (the buffers are allocated here, not in process).
+					 * @param[in] _process Process function of the stage: (output, input, nbChunk).
+					 * @param[in] _nbChannelOut Number of channel at the output of the stage (-1: same as the input).
+					 * @param[in] _inPlace The function accept the same pointer in input and output.
+					 * @param[in] _name Name of the stage (debug).
+					 * @return true The stage is added.
+					 */
+					bool addStage(const etk::Function<void(void*, const void*, size_t)>& _process, int8_t _nbChannelOut=-1, bool _inPlace=true, const etk::String& _name="");
+					/**
+					 * @brief Add an algorithm at the end of the chain (it must be initialized with the format and the number of channel of this stage).
+					 * @param[in] _algo Algorithm with a process(void*, const void*, size_t) function (Equalizer, Beamformer ...).
+					 * @param[in] _nbChannelOut Number of channel at the output of the stage (-1: same as the input).
+					 * @param[in] _inPlace The algorithm accept the same pointer in input and output.
+					 * @param[in] _name Name of the stage (debug).
+					 * @return true The stage is added.
+					 */
+					template<class ALGO> bool addStage(const ememory::SharedPtr<ALGO>& _algo, int8_t _nbChannelOut=-1, bool _inPlace=true, const etk::String& _name="") {
+						if (_algo == null) {
+							return false;
+						}
+						ememory::SharedPtr<ALGO> algo = _algo;
+						return addStage([algo](void* _output, const void* _input, size_t _nbChunk) {
+						                    algo->process(_output, _input, _nbChunk);
+						                },
+						                _nbChannelOut,
+						                _inPlace,
+						                _name);
+					}
+					/**
+					 * @brief Get the number of stage.
+					 * @return Number of stage.
+					 */
+					int32_t getNbStage() const {
+						return m_stages.size();
+					}
+					/**
+					 * @brief Get the number of channel at the output of the chain.
+					 * @return Number of channel.
+					 */
+					int8_t getOutputNbChannel() const;
+					/**
+					 * @brief Get the number of intermediate buffer used by the chain (0, 1 if all the stages work in place, 2 else).
+					 * @return Number of buffer.
+					 */
+					int32_t getNbBuffer() const {
+						return m_buffers.size();
+					}
+					/**
+					 * @brief Get the number of chunk processed by all the stages at once.
+					 * @return Number of chunk.
+					 */
+					size_t getSubBlockSize() const {
+						return m_subBlockSizeUsed;
+					}
+					/**
+					 * @brief Main input algo process.
+					 * @note The output can be the input only if the output has less or the same number of channel than the input.
+					 * @param[out] _output Output data (interleaved, getOutputNbChannel()).
+					 * @param[in] _input Input data (interleaved, nbChannel of init).
+					 * @param[in] _nbChunk Number of chunk in the input buffer.
+					 */
+					void process(void* _output, const void* _input, size_t _nbChunk);
+				protected:
+					/**
+					 * @brief Select the buffer of each stage and allocate them.
+					 */
+					void plan();
+			};
+		}
+	}
+}
+
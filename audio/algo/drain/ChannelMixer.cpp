@@ -0,0 +1,522 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <audio/algo/drain/ChannelMixer.hpp>
+#include <audio/algo/drain/debug.hpp>
+extern "C" {
+	#include <math.h>
+	#include <string.h>
+}
+
+// Number of chunk of a planar sub-block of the matrix kernel on interleaved data (stay in the L1 cache).
+static const int32_t subBlockSize = 128;
+// Gain of the center and surround channels in a down-mix (-3 dB).
+static const float mixGain = 0.70710678f;
+
+/**
+ * @brief Fill the stereo down-mix of a standard layout (2, 6 or 8 channels).
+ * @param[out] _left Gain of each input channel in the left output.
+ * @param[out] _right Gain of each input channel in the right output.
+ * @param[in] _nbChannelIn Number of input channel.
+ */
+static void stereoDownMix(float* _left, float* _right, int32_t _nbChannelIn) {
+	_left[0] = 1.0f;
+	_right[1] = 1.0f;
+	if (_nbChannelIn >= 6) {
+		// center and surround (the LFE is not mixed)
+		_left[2] = mixGain;
+		_right[2] = mixGain;
+		_left[4] = mixGain;
+		_right[5] = mixGain;
+	}
+	if (_nbChannelIn >= 8) {
+		_left[6] = mixGain;
+		_right[7] = mixGain;
+	}
+}
+
+namespace audio {
+	namespace algo {
+		namespace drain {
+			class ChannelMixerPrivate {
+				protected:
+					float m_sampleRate;
+					int32_t m_nbChannelIn;
+					int32_t m_nbChannelOut;
+					etk::Vector<float> m_gain; //!< current matrix (start of the ramp) [output][input]
+					etk::Vector<float> m_target; //!< matrix at the end of the ramp
+					int64_t m_rampLength; //!< duration of the ramp (sample, 0: no ramp)
+					int64_t m_rampPosition; //!< position in the ramp
+					enum audio::algo::drain::channelMixerKernel m_kernel;
+					etk::Vector<int32_t> m_source; //!< permutation: input of each output (-1: silence)
+					etk::Vector<float> m_sourceGain; //!< permutation: gain of each output
+					etk::Vector<int32_t> m_entryStart; //!< matrix: first entry of each output (nbChannelOut+1)
+					etk::Vector<int32_t> m_entryInput; //!< matrix: input of each non-zero gain
+					etk::Vector<float> m_entryGain; //!< matrix: gain at the start of the block
+					etk::Vector<float> m_entryStep; //!< matrix: increment of the gain for each sample (ramp)
+					etk::Vector<float> m_planarInput; //!< planar sub-block of the input [channel][sample]
+					etk::Vector<float> m_planarOutput; //!< planar sub-block of the output [channel][sample]
+					etk::Vector<const float*> m_pointerInput;
+					etk::Vector<float*> m_pointerOutput;
+					etk::Vector<float> m_chunk; //!< one output chunk (in place permutation)
+				public:
+					ChannelMixerPrivate() :
+					  m_sampleRate(48000),
+					  m_nbChannelIn(1),
+					  m_nbChannelOut(1),
+					  m_rampLength(0),
+					  m_rampPosition(0),
+					  m_kernel(audio::algo::drain::channelMixerKernel_identity) {
+						
+					}
+					void init(float _sampleRate, int32_t _nbChannelIn, int32_t _nbChannelOut) {
+						m_sampleRate = _sampleRate;
+						m_nbChannelIn = _nbChannelIn;
+						m_nbChannelOut = _nbChannelOut;
+						m_gain = audio::algo::drain::ChannelMixer::createStandardMatrix(m_nbChannelIn, m_nbChannelOut);
+						m_target = m_gain;
+						m_source.resize(m_nbChannelOut, -1);
+						m_sourceGain.resize(m_nbChannelOut, 0.0f);
+						m_entryStart.resize(m_nbChannelOut+1, 0);
+						m_entryInput.resize(m_nbChannelOut*m_nbChannelIn, 0);
+						m_entryGain.resize(m_nbChannelOut*m_nbChannelIn, 0.0f);
+						m_entryStep.resize(m_nbChannelOut*m_nbChannelIn, 0.0f);
+						m_planarInput.resize(m_nbChannelIn*subBlockSize, 0.0f);
+						m_planarOutput.resize(m_nbChannelOut*subBlockSize, 0.0f);
+						m_pointerInput.resize(m_nbChannelIn, null);
+						m_pointerOutput.resize(m_nbChannelOut, null);
+						m_chunk.resize(m_nbChannelOut, 0.0f);
+						reset();
+					}
+					void reset() {
+						for (size_t iii=0; iii<m_gain.size(); ++iii) {
+							m_gain[iii] = m_target[iii];
+						}
+						m_rampLength = 0;
+						m_rampPosition = 0;
+						analyze();
+					}
+					bool setMatrix(const etk::Vector<float>& _gain, float _rampTime) {
+						if (_gain.size() != m_target.size()) {
+							AA_DRAIN_ERROR("Channel mixer matrix of " << _gain.size() << " gains, expected " << m_nbChannelOut << "x" << m_nbChannelIn);
+							return false;
+						}
+						// the ramp start from the current position of the previous ramp
+						for (size_t iii=0; iii<m_gain.size(); ++iii) {
+							m_gain[iii] = getCurrentGain(iii);
+							m_target[iii] = _gain[iii];
+						}
+						m_rampLength = int64_t(etk::max(0.0f, _rampTime) * m_sampleRate);
+						m_rampPosition = 0;
+						if (m_rampLength == 0) {
+							reset();
+						} else {
+							analyze();
+						}
+						return true;
+					}
+					void setGain(int32_t _idChannelOut, int32_t _idChannelIn, float _gain) {
+						if (    _idChannelOut < 0
+						     || _idChannelOut >= m_nbChannelOut
+						     || _idChannelIn < 0
+						     || _idChannelIn >= m_nbChannelIn) {
+							AA_DRAIN_ERROR("Channel mixer gain [" << _idChannelOut << "][" << _idChannelIn << "] out of the matrix " << m_nbChannelOut << "x" << m_nbChannelIn);
+							return;
+						}
+						etk::Vector<float> gain = m_target;
+						gain[_idChannelOut*m_nbChannelIn + _idChannelIn] = _gain;
+						setMatrix(gain, 0.0f);
+					}
+					etk::Vector<float> getMatrix() {
+						return m_target;
+					}
+					enum audio::algo::drain::channelMixerKernel getKernel() {
+						return m_kernel;
+					}
+					void process(float* _output, const float* _input, size_t _nbChunk) {
+						switch (m_kernel) {
+							case audio::algo::drain::channelMixerKernel_identity:
+								if (_output != _input) {
+									memmove(_output, _input, _nbChunk*m_nbChannelIn*sizeof(float));
+								}
+								return;
+							case audio::algo::drain::channelMixerKernel_permutation:
+								if (    _output + _nbChunk*m_nbChannelOut <= _input
+								     || _input + _nbChunk*m_nbChannelIn <= _output) {
+									// separate buffers: one strided copy per output channel
+									for (int32_t ooo=0; ooo<m_nbChannelOut; ++ooo) {
+										float* output = &_output[ooo];
+										if (m_source[ooo] < 0) {
+											for (size_t iii=0; iii<_nbChunk; ++iii) {
+												output[iii*m_nbChannelOut] = 0.0f;
+											}
+											continue;
+										}
+										const float* input = &_input[m_source[ooo]];
+										float gain = m_sourceGain[ooo];
+										for (size_t iii=0; iii<_nbChunk; ++iii) {
+											output[iii*m_nbChannelOut] = input[iii*m_nbChannelIn] * gain;
+										}
+									}
+									return;
+								}
+								// in place: each chunk is read before being written
+								for (size_t iii=0; iii<_nbChunk; ++iii) {
+									const float* input = &_input[iii*m_nbChannelIn];
+									for (int32_t ooo=0; ooo<m_nbChannelOut; ++ooo) {
+										m_chunk[ooo] = m_source[ooo] < 0 ? 0.0f : input[m_source[ooo]] * m_sourceGain[ooo];
+									}
+									float* output = &_output[iii*m_nbChannelOut];
+									for (int32_t ooo=0; ooo<m_nbChannelOut; ++ooo) {
+										output[ooo] = m_chunk[ooo];
+									}
+								}
+								return;
+							case audio::algo::drain::channelMixerKernel_matrix:
+								break;
+						}
+						for (int32_t iii=0; iii<m_nbChannelIn; ++iii) {
+							m_pointerInput[iii] = &m_planarInput[iii*subBlockSize];
+						}
+						for (int32_t ooo=0; ooo<m_nbChannelOut; ++ooo) {
+							m_pointerOutput[ooo] = &m_planarOutput[ooo*subBlockSize];
+						}
+						size_t offset = 0;
+						while (offset < _nbChunk) {
+							size_t nbChunk = getBlockSize(etk::min(size_t(subBlockSize), _nbChunk - offset));
+							// the whole sub-block is read before being written (in place when nbChannelOut <= nbChannelIn)
+							const float* input = &_input[offset*m_nbChannelIn];
+							for (int32_t iii=0; iii<m_nbChannelIn; ++iii) {
+								float* planar = &m_planarInput[iii*subBlockSize];
+								for (size_t sss=0; sss<nbChunk; ++sss) {
+									planar[sss] = input[sss*m_nbChannelIn + iii];
+								}
+							}
+							applyMatrix(&m_pointerOutput[0], &m_pointerInput[0], 0, nbChunk);
+							float* output = &_output[offset*m_nbChannelOut];
+							for (int32_t ooo=0; ooo<m_nbChannelOut; ++ooo) {
+								const float* planar = &m_planarOutput[ooo*subBlockSize];
+								for (size_t sss=0; sss<nbChunk; ++sss) {
+									output[sss*m_nbChannelOut + ooo] = planar[sss];
+								}
+							}
+							offset += nbChunk;
+						}
+					}
+					void processPlanar(float* const* _output, const float* const* _input, size_t _nbChunk) {
+						switch (m_kernel) {
+							case audio::algo::drain::channelMixerKernel_identity:
+								for (int32_t ooo=0; ooo<m_nbChannelOut; ++ooo) {
+									if (_output[ooo] != _input[ooo]) {
+										memmove(_output[ooo], _input[ooo], _nbChunk*sizeof(float));
+									}
+								}
+								return;
+							case audio::algo::drain::channelMixerKernel_permutation:
+								for (int32_t ooo=0; ooo<m_nbChannelOut; ++ooo) {
+									float* output = _output[ooo];
+									if (m_source[ooo] < 0) {
+										memset(output, 0, _nbChunk*sizeof(float));
+										continue;
+									}
+									const float* input = _input[m_source[ooo]];
+									float gain = m_sourceGain[ooo];
+									for (size_t sss=0; sss<_nbChunk; ++sss) {
+										output[sss] = input[sss] * gain;
+									}
+								}
+								return;
+							case audio::algo::drain::channelMixerKernel_matrix:
+								break;
+						}
+						size_t offset = 0;
+						while (offset < _nbChunk) {
+							size_t nbChunk = getBlockSize(_nbChunk - offset);
+							applyMatrix(_output, _input, offset, nbChunk);
+							offset += nbChunk;
+						}
+					}
+				protected:
+					float getCurrentGain(size_t _id) {
+						if (m_rampLength == 0) {
+							return m_target[_id];
+						}
+						return m_gain[_id] + (m_target[_id] - m_gain[_id]) * float(double(m_rampPosition) / double(m_rampLength));
+					}
+					/**
+					 * @brief Limit a block to the end of the ramp (the gains are exactly the target after).
+					 */
+					size_t getBlockSize(size_t _nbChunk) {
+						if (m_rampLength == 0) {
+							return _nbChunk;
+						}
+						return size_t(etk::min(int64_t(_nbChunk), m_rampLength - m_rampPosition));
+					}
+					/**
+					 * @brief Select the kernel of the current matrix and prepare its data.
+					 */
+					void analyze() {
+						bool ramp = m_rampLength != 0;
+						// list of the non-zero gains of each output (the gains that are non-zero at the start or at the end of the ramp)
+						int32_t nbEntry = 0;
+						bool permutation = true;
+						for (int32_t ooo=0; ooo<m_nbChannelOut; ++ooo) {
+							m_entryStart[ooo] = nbEntry;
+							m_source[ooo] = -1;
+							m_sourceGain[ooo] = 0.0f;
+							for (int32_t iii=0; iii<m_nbChannelIn; ++iii) {
+								int32_t id = ooo*m_nbChannelIn + iii;
+								if (    m_gain[id] == 0.0f
+								     && m_target[id] == 0.0f) {
+									continue;
+								}
+								m_entryInput[nbEntry] = iii;
+								m_entryGain[nbEntry] = m_gain[id];
+								m_entryStep[nbEntry] = ramp == true ? (m_target[id] - m_gain[id]) / float(m_rampLength) : 0.0f;
+								nbEntry++;
+								if (m_source[ooo] >= 0) {
+									permutation = false;
+								}
+								m_source[ooo] = iii;
+								m_sourceGain[ooo] = m_gain[id];
+							}
+						}
+						m_entryStart[m_nbChannelOut] = nbEntry;
+						bool identity =    permutation == true
+						                && m_nbChannelIn == m_nbChannelOut;
+						for (int32_t ooo=0; ooo<m_nbChannelOut && identity == true; ++ooo) {
+							identity = m_source[ooo] == ooo && m_sourceGain[ooo] == 1.0f;
+						}
+						if (ramp == true) {
+							m_kernel = audio::algo::drain::channelMixerKernel_matrix;
+						} else if (identity == true) {
+							m_kernel = audio::algo::drain::channelMixerKernel_identity;
+						} else if (permutation == true) {
+							m_kernel = audio::algo::drain::channelMixerKernel_permutation;
+						} else {
+							m_kernel = audio::algo::drain::channelMixerKernel_matrix;
+						}
+						AA_DRAIN_VERBOSE("Channel mixer " << m_nbChannelIn << " ==> " << m_nbChannelOut << ": kernel " << int32_t(m_kernel) << " with " << nbEntry << " non-zero gains");
+					}
+					/**
+					 * @brief Sum the non-zero gains of each output on planar buffers (the loops on the samples are vectorized).
+					 */
+					void applyMatrix(float* const* _output, const float* const* _input, size_t _offset, size_t _nbChunk) {
+						bool ramp = m_rampLength != 0;
+						if (ramp == true) {
+							float position = float(m_rampPosition);
+							for (int32_t ooo=0; ooo<m_nbChannelOut; ++ooo) {
+								for (int32_t eee=m_entryStart[ooo]; eee<m_entryStart[ooo+1]; ++eee) {
+									int32_t id = ooo*m_nbChannelIn + m_entryInput[eee];
+									m_entryGain[eee] = m_gain[id] + m_entryStep[eee] * position;
+								}
+							}
+						}
+						for (int32_t ooo=0; ooo<m_nbChannelOut; ++ooo) {
+							float* output = &_output[ooo][_offset];
+							int32_t start = m_entryStart[ooo];
+							int32_t stop = m_entryStart[ooo+1];
+							if (start == stop) {
+								memset(output, 0, _nbChunk*sizeof(float));
+								continue;
+							}
+							for (int32_t eee=start; eee<stop; ++eee) {
+								const float* input = &_input[m_entryInput[eee]][_offset];
+								float gain = m_entryGain[eee];
+								float step = m_entryStep[eee];
+								if (eee == start) {
+									if (ramp == false) {
+										for (size_t sss=0; sss<_nbChunk; ++sss) {
+											output[sss] = input[sss] * gain;
+										}
+									} else {
+										for (size_t sss=0; sss<_nbChunk; ++sss) {
+											output[sss] = input[sss] * (gain + step * float(sss));
+										}
+									}
+								} else {
+									if (ramp == false) {
+										for (size_t sss=0; sss<_nbChunk; ++sss) {
+											output[sss] += input[sss] * gain;
+										}
+									} else {
+										for (size_t sss=0; sss<_nbChunk; ++sss) {
+											output[sss] += input[sss] * (gain + step * float(sss));
+										}
+									}
+								}
+							}
+						}
+						if (ramp == true) {
+							m_rampPosition += _nbChunk;
+							if (m_rampPosition >= m_rampLength) {
+								// end of the ramp: select the kernel of the new matrix
+								reset();
+							}
+						}
+					}
+			};
+		}
+	}
+}
+
+audio::algo::drain::ChannelMixer::ChannelMixer() {
+	
+}
+
+audio::algo::drain::ChannelMixer::~ChannelMixer() {
+	
+}
+
+void audio::algo::drain::ChannelMixer::init(float _sampleRate, int8_t _nbChannelIn, int8_t _nbChannelOut, enum audio::format _format) {
+	if (_format != audio::format_float) {
+		AA_DRAIN_CRITICAL("Request format for channel mixer that not exist ... : " << _format);
+		return;
+	}
+	if (    _nbChannelIn <= 0
+	     || _nbChannelOut <= 0) {
+		AA_DRAIN_ERROR("Request channel mixer with " << int32_t(_nbChannelIn) << " ==> " << int32_t(_nbChannelOut) << " channel(s)");
+		return;
+	}
+	m_private = ememory::makeShared<ChannelMixerPrivate>();
+	if (m_private == null) {
+		AA_DRAIN_ERROR("can not allocate private data...");
+		return;
+	}
+	m_private->init(_sampleRate, _nbChannelIn, _nbChannelOut);
+}
+
+void audio::algo::drain::ChannelMixer::reset() {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("ChannelMixer does not init ...");
+		return;
+	}
+	m_private->reset();
+}
+
+etk::Vector<enum audio::format> audio::algo::drain::ChannelMixer::getSupportedFormat() {
+	etk::Vector<enum audio::format> out = audio::algo::drain::ChannelMixer::getNativeSupportedFormat();
+	return out;
+}
+
+etk::Vector<enum audio::format> audio::algo::drain::ChannelMixer::getNativeSupportedFormat() {
+	etk::Vector<enum audio::format> out;
+	out.pushBack(audio::format_float);
+	return out;
+}
+
+void audio::algo::drain::ChannelMixer::process(void* _output, const void* _input, size_t _nbChunk) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("ChannelMixer does not init ...");
+		return;
+	}
+	m_private->process(reinterpret_cast<float*>(_output), reinterpret_cast<const float*>(_input), _nbChunk);
+}
+
+void audio::algo::drain::ChannelMixer::processPlanar(float* const* _output, const float* const* _input, size_t _nbChunk) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("ChannelMixer does not init ...");
+		return;
+	}
+	m_private->processPlanar(_output, _input, _nbChunk);
+}
+
+bool audio::algo::drain::ChannelMixer::setMatrix(const etk::Vector<float>& _gain, float _rampTime) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("ChannelMixer does not init ...");
+		return false;
+	}
+	return m_private->setMatrix(_gain, _rampTime);
+}
+
+void audio::algo::drain::ChannelMixer::setGain(int32_t _idChannelOut, int32_t _idChannelIn, float _gain) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("ChannelMixer does not init ...");
+		return;
+	}
+	m_private->setGain(_idChannelOut, _idChannelIn, _gain);
+}
+
+etk::Vector<float> audio::algo::drain::ChannelMixer::getMatrix() {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("ChannelMixer does not init ...");
+		return etk::Vector<float>();
+	}
+	return m_private->getMatrix();
+}
+
+enum audio::algo::drain::channelMixerKernel audio::algo::drain::ChannelMixer::getKernel() {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("ChannelMixer does not init ...");
+		return audio::algo::drain::channelMixerKernel_identity;
+	}
+	return m_private->getKernel();
+}
+
+etk::Vector<float> audio::algo::drain::ChannelMixer::createStandardMatrix(int8_t _nbChannelIn, int8_t _nbChannelOut) {
+	etk::Vector<float> out;
+	if (    _nbChannelIn <= 0
+	     || _nbChannelOut <= 0) {
+		return out;
+	}
+	out.resize(int32_t(_nbChannelIn)*int32_t(_nbChannelOut), 0.0f);
+	bool knownIn =    _nbChannelIn == 1
+	               || _nbChannelIn == 2
+	               || _nbChannelIn == 6
+	               || _nbChannelIn == 8;
+	bool knownOut =    _nbChannelOut == 1
+	                || _nbChannelOut == 2
+	                || _nbChannelOut == 6
+	                || _nbChannelOut == 8;
+	if (    _nbChannelIn == _nbChannelOut
+	     || knownIn == false
+	     || knownOut == false) {
+		for (int32_t iii=0; iii<etk::min(_nbChannelIn, _nbChannelOut); ++iii) {
+			out[iii*_nbChannelIn + iii] = 1.0f;
+		}
+		return out;
+	}
+	if (_nbChannelIn == 1) {
+		if (_nbChannelOut == 2) {
+			out[0] = mixGain;
+			out[1] = mixGain;
+		} else {
+			// center
+			out[2] = 1.0f;
+		}
+		return out;
+	}
+	if (_nbChannelOut == 1) {
+		// half of the stereo down-mix
+		etk::Vector<float> stereo;
+		stereo.resize(2*_nbChannelIn, 0.0f);
+		stereoDownMix(&stereo[0], &stereo[_nbChannelIn], _nbChannelIn);
+		for (int32_t iii=0; iii<_nbChannelIn; ++iii) {
+			out[iii] = 0.5f * (stereo[iii] + stereo[_nbChannelIn + iii]);
+		}
+		return out;
+	}
+	if (_nbChannelOut == 2) {
+		stereoDownMix(&out[0], &out[_nbChannelIn], _nbChannelIn);
+		return out;
+	}
+	if (_nbChannelIn == 8) {
+		// 7.1 ==> 5.1: the back channels are mixed in the surround channels
+		for (int32_t iii=0; iii<4; ++iii) {
+			out[iii*_nbChannelIn + iii] = 1.0f;
+		}
+		out[4*_nbChannelIn + 4] = mixGain;
+		out[4*_nbChannelIn + 6] = mixGain;
+		out[5*_nbChannelIn + 5] = mixGain;
+		out[5*_nbChannelIn + 7] = mixGain;
+		return out;
+	}
+	// up-mix (2 ==> 6/8, 6 ==> 8): the channels of the input layout are copied
+	for (int32_t iii=0; iii<_nbChannelIn; ++iii) {
+		out[iii*_nbChannelIn + iii] = 1.0f;
+	}
+	return out;
+}
@@ -0,0 +1,116 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <etk/types.hpp>
+#include <ememory/memory.hpp>
+#include <etk/Vector.hpp>
+#include <audio/format.hpp>
+
+namespace audio {
+	namespace algo {
+		namespace drain {
+			/**
+			 * @brief Kernel selected by the channel mixer for its matrix.
+			 */
+			enum channelMixerKernel {
+				channelMixerKernel_identity, //!< same number of channel, unitary diagonal: copy (nothing in place)
+				channelMixerKernel_permutation, //!< each output has one input at most (reorder, selection, gain by channel): no sum
+				channelMixerKernel_matrix, //!< sum of the non-zero gains of each output only (a sparse matrix cost its number of non-zero)
+			};
+			class ChannelMixerPrivate;
+			/**
+			 * @brief Channel matrix mixer: output[o] = sum(gain[o][i] * input[i]) (up-mix, down-mix, routing).
+			 * The matrix is analyzed to select the cheapest kernel. The matrix kernel work on planar sub-blocks: the loops on the samples are vectorized by the compiler.
+			 * A change of the matrix can be ramped: each gain move linearly from its old value to its new value (no click).
+			 * The standard layouts (WAV order) are: 1: mono, 2: L R, 6: L R C LFE Ls Rs, 8: L R C LFE Ls Rs Lb Rb.
+			 */
+			class ChannelMixer {
+				public:
+					/**
+					 * @brief Constructor
+					 */
+					ChannelMixer();
+					/**
+					 * @brief Destructor
+					 */
+					virtual ~ChannelMixer();
+				public:
+					/**
+					 * @brief Reset all history of the Algo (end the current ramp).
+					 */
+					void reset();
+					/**
+					 * @brief Initialize the Algorithm (the matrix is the standard mix of the two layouts).
+					 * @param[in] _sampleRate Sample rate of the stream.
+					 * @param[in] _nbChannelIn Number of channel in the input stream.
+					 * @param[in] _nbChannelOut Number of channel in the output stream.
+					 * @param[in] _format Input data format.
+					 */
+					virtual void init(float _sampleRate=48000, int8_t _nbChannelIn=2, int8_t _nbChannelOut=2, enum audio::format _format=audio::format_float);
+					/**
+					 * @brief Get list of format suported in input.
+					 * @return list of supported format
+					 */
+					virtual etk::Vector<enum audio::format> getSupportedFormat();
+					/**
+					 * @brief Get list of algorithm format suported. No format convertion.
+					 * @return list of supported format
+					 */
+					virtual etk::Vector<enum audio::format> getNativeSupportedFormat();
+					/**
+					 * @brief Main input algo process on interleaved data (no allocation, can be done in place when nbChannelOut <= nbChannelIn).
+					 * @param[out] _output Output data (nbChannelOut).
+					 * @param[in] _input Input data (nbChannelIn).
+					 * @param[in] _nbChunk Number of chunk in the input buffer.
+					 */
+					virtual void process(void* _output, const void* _input, size_t _nbChunk);
+					/**
+					 * @brief Process planar float data (no allocation, the output buffers must not be the input buffers).
+					 * @param[out] _output Output buffer of each output channel.
+					 * @param[in] _input Input buffer of each input channel.
+					 * @param[in] _nbChunk Number of sample in each buffer.
+					 */
+					void processPlanar(float* const* _output, const float* const* _input, size_t _nbChunk);
+				public:
+					/**
+					 * @brief Set the gain matrix (no allocation: can be called between two process).
+					 * @param[in] _gain Gains [output][input] (nbChannelOut x nbChannelIn, linear).
+					 * @param[in] _rampTime Duration of the transition from the current matrix (second, 0: immediate).
+					 * @return true The matrix has the right size.
+					 */
+					bool setMatrix(const etk::Vector<float>& _gain, float _rampTime=0.0f);
+					/**
+					 * @brief Set one gain of the matrix (immediate).
+					 * @param[in] _idChannelOut Id of the output channel.
+					 * @param[in] _idChannelIn Id of the input channel.
+					 * @param[in] _gain Linear gain.
+					 */
+					void setGain(int32_t _idChannelOut, int32_t _idChannelIn, float _gain);
+					/**
+					 * @brief Get the gain matrix (target of the ramp).
+					 * @return Gains [output][input].
+					 */
+					etk::Vector<float> getMatrix();
+					/**
+					 * @brief Get the kernel used by the current matrix (the matrix kernel is used during a ramp).
+					 * @return Type of kernel.
+					 */
+					enum audio::algo::drain::channelMixerKernel getKernel();
+					/**
+					 * @brief Create the standard mix between two layouts (ITU-R BS.775 down-mix: -3 dB for the center and the surround, the LFE is not mixed).
+					 * @param[in] _nbChannelIn Number of input channel.
+					 * @param[in] _nbChannelOut Number of output channel.
+					 * @return Gains [output][input] (the first channels are copied for the unknown layouts).
+					 */
+					static etk::Vector<float> createStandardMatrix(int8_t _nbChannelIn, int8_t _nbChannelOut);
+				protected:
+					ememory::SharedPtr<ChannelMixerPrivate> m_private; //!< private data.
+			};
+		}
+	}
+}
+
@@ -0,0 +1,394 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <audio/algo/drain/Crossover.hpp>
+#include <audio/algo/drain/BiQuadDesign.hpp>
+#include <audio/algo/drain/debug.hpp>
+extern "C" {
+	#include <math.h>
+	#include <string.h>
+}
+
+// Number of sample of a planar sub-block (all the intermediate bands stay in the L1 cache).
+static const int32_t subBlockSize = 128;
+// Number of coefficient of a section (a0 a1 a2 b0 b1).
+static const int32_t sectionSize = 5;
+// Q of the two sections of a 4th order Butterworth filter (1/(2.cos(pi/8)) and 1/(2.cos(3pi/8))).
+static const double butterworth4Q[2] = {0.54119610, 1.30656296};
+
+/**
+ * @brief Store the coefficients of a biquad in a section.
+ * @param[out] _section Section to set (sectionSize coefficients).
+ * @param[in] _coef Biquad coefficients.
+ * @param[in] _gain Gain applied on the numerator (-1: inverted output).
+ */
+static void setSection(float* _section, const audio::algo::drain::BiQuadCoefficient& _coef, double _gain=1.0) {
+	_section[0] = _coef.m_a[0] * _gain;
+	_section[1] = _coef.m_a[1] * _gain;
+	_section[2] = _coef.m_a[2] * _gain;
+	_section[3] = _coef.m_b[0];
+	_section[4] = _coef.m_b[1];
+}
+
+/**
+ * @brief Store the 2nd order all-pass that has the denominator of a biquad (mirrored numerator).
+ * @param[out] _section Section to set (sectionSize coefficients).
+ * @param[in] _coef Biquad coefficients (low-pass or high-pass of the crossover).
+ */
+static void setAllPass(float* _section, const audio::algo::drain::BiQuadCoefficient& _coef) {
+	_section[0] = _coef.m_b[1];
+	_section[1] = _coef.m_b[0];
+	_section[2] = 1.0f;
+	_section[3] = _coef.m_b[0];
+	_section[4] = _coef.m_b[1];
+}
+
+/**
+ * @brief Filter two streams with a cascade of sections each (transposed direct form 2, can be done in place).
+ * The recurrences of all the sections are independent from one sample to the next: they run in parallel in the processor pipeline (a single section is latency bound).
+ * @param[in] _sectionA Coefficients of the nbSection sections of the stream A.
+ * @param[in,out] _stateA History of the sections of the stream A (2 values by section).
+ * @param[out] _outputA Output samples of the stream A.
+ * @param[in] _inputA Input samples of the stream A.
+ * @param[in] _sectionB Coefficients of the sections of the stream B.
+ * @param[in,out] _stateB History of the sections of the stream B.
+ * @param[out] _outputB Output samples of the stream B.
+ * @param[in] _inputB Input samples of the stream B (can be the input of the stream A).
+ * @param[in] _nbSample Number of sample.
+ */
+template<int32_t nbSection>
+static void processCascade(const float* _sectionA, float* _stateA, float* _outputA, const float* _inputA,
+                           const float* _sectionB, float* _stateB, float* _outputB, const float* _inputB,
+                           int32_t _nbSample) {
+	float coef[2*nbSection][sectionSize];
+	float state[2*nbSection][2];
+	for (int32_t kkk=0; kkk<nbSection; ++kkk) {
+		for (int32_t iii=0; iii<sectionSize; ++iii) {
+			coef[kkk][iii] = _sectionA[kkk*sectionSize + iii];
+			coef[nbSection+kkk][iii] = _sectionB[kkk*sectionSize + iii];
+		}
+		state[kkk][0] = _stateA[kkk*2];
+		state[kkk][1] = _stateA[kkk*2+1];
+		state[nbSection+kkk][0] = _stateB[kkk*2];
+		state[nbSection+kkk][1] = _stateB[kkk*2+1];
+	}
+	for (int32_t iii=0; iii<_nbSample; ++iii) {
+		float value[2] = {_inputA[iii], _inputB[iii]};
+		for (int32_t sss=0; sss<2; ++sss) {
+			for (int32_t kkk=sss*nbSection; kkk<(sss+1)*nbSection; ++kkk) {
+				float result = coef[kkk][0] * value[sss] + state[kkk][0];
+				state[kkk][0] = coef[kkk][1] * value[sss] - coef[kkk][3] * result + state[kkk][1];
+				state[kkk][1] = coef[kkk][2] * value[sss] - coef[kkk][4] * result;
+				value[sss] = result;
+			}
+		}
+		_outputA[iii] = value[0];
+		_outputB[iii] = value[1];
+	}
+	for (int32_t kkk=0; kkk<nbSection; ++kkk) {
+		_stateA[kkk*2] = state[kkk][0];
+		_stateA[kkk*2+1] = state[kkk][1];
+		_stateB[kkk*2] = state[nbSection+kkk][0];
+		_stateB[kkk*2+1] = state[nbSection+kkk][1];
+	}
+}
+
+/**
+ * @brief Select the cascade kernel of a number of section (1, 2 or 4: the sections of the Linkwitz-Riley filters and all-pass).
+ */
+static void processCascade(int32_t _nbSection,
+                           const float* _sectionA, float* _stateA, float* _outputA, const float* _inputA,
+                           const float* _sectionB, float* _stateB, float* _outputB, const float* _inputB,
+                           int32_t _nbSample) {
+	switch (_nbSection) {
+		case 1:
+			processCascade<1>(_sectionA, _stateA, _outputA, _inputA, _sectionB, _stateB, _outputB, _inputB, _nbSample);
+			break;
+		case 2:
+			processCascade<2>(_sectionA, _stateA, _outputA, _inputA, _sectionB, _stateB, _outputB, _inputB, _nbSample);
+			break;
+		case 4:
+			processCascade<4>(_sectionA, _stateA, _outputA, _inputA, _sectionB, _stateB, _outputB, _inputB, _nbSample);
+			break;
+		default:
+			AA_DRAIN_ERROR("Crossover cascade of " << _nbSection << " section(s) does not exist");
+			break;
+	}
+}
+
+namespace audio {
+	namespace algo {
+		namespace drain {
+			class CrossoverPrivate {
+				protected:
+					float m_sampleRate;
+					int32_t m_nbChannel;
+					int32_t m_nbSplit; //!< number of crossover frequency (nbBand-1)
+					int32_t m_nbCascade; //!< number of section of the low-pass (and of the high-pass) of a split
+					int32_t m_nbAllPass; //!< number of section of the all-pass of a split
+					etk::Vector<float> m_frequency;
+					etk::Vector<float> m_section; //!< [split][low-pass, high-pass, all-pass][sectionSize]
+					etk::Vector<float> m_stateTree; //!< history of the low-pass and high-pass [channel][split][section][2]
+					etk::Vector<float> m_stateAllPass; //!< history of the compensation of each band [channel][band][split][section][2]
+					etk::Vector<float> m_input; //!< planar sub-block of one input channel
+					etk::Vector<float> m_high; //!< two sub-blocks for the high-pass output of the splits
+					etk::Vector<float> m_stateScratch; //!< history of the unused stream of a cascade
+					etk::Vector<float> m_band; //!< planar sub-block of each band of one channel
+					etk::Vector<float*> m_pointerBand;
+				public:
+					CrossoverPrivate() :
+					  m_sampleRate(48000),
+					  m_nbChannel(1),
+					  m_nbSplit(0),
+					  m_nbCascade(0),
+					  m_nbAllPass(0) {
+						
+					}
+					void init(float _sampleRate, int32_t _nbChannel) {
+						m_sampleRate = _sampleRate;
+						m_nbChannel = _nbChannel;
+						m_input.resize(subBlockSize, 0.0f);
+						m_high.resize(2*subBlockSize, 0.0f);
+						m_stateScratch.resize(2*2, 0.0f);
+						setCrossover(etk::Vector<float>(), 4);
+					}
+					void reset() {
+						for (size_t iii=0; iii<m_stateTree.size(); ++iii) {
+							m_stateTree[iii] = 0.0f;
+						}
+						for (size_t iii=0; iii<m_stateAllPass.size(); ++iii) {
+							m_stateAllPass[iii] = 0.0f;
+						}
+					}
+					bool setCrossover(const etk::Vector<float>& _frequency, int32_t _order) {
+						if (    _order != 2
+						     && _order != 4
+						     && _order != 8) {
+							AA_DRAIN_ERROR("Crossover order " << _order << " does not exist (2, 4 or 8)");
+							return false;
+						}
+						for (size_t iii=0; iii<_frequency.size(); ++iii) {
+							if (    _frequency[iii] <= 0.0f
+							     || _frequency[iii] >= m_sampleRate*0.5f
+							     || (    iii > 0
+							          && _frequency[iii] <= _frequency[iii-1])) {
+								AA_DRAIN_ERROR("Crossover frequency " << _frequency[iii] << " Hz is out of range or not increasing");
+								return false;
+							}
+						}
+						m_frequency = _frequency;
+						m_nbSplit = _frequency.size();
+						m_nbCascade = _order/2;
+						m_nbAllPass = _order == 8 ? 2 : 1;
+						int32_t nbSection = 2*m_nbCascade + m_nbAllPass;
+						int32_t nbBand = m_nbSplit+1;
+						m_section.resize(m_nbSplit*nbSection*sectionSize, 0.0f);
+						for (int32_t sss=0; sss<m_nbSplit; ++sss) {
+							float* lowPass = &m_section[sss*nbSection*sectionSize];
+							float* highPass = lowPass + m_nbCascade*sectionSize;
+							float* allPass = highPass + m_nbCascade*sectionSize;
+							double tangent = tan(M_PI * m_frequency[sss] / m_sampleRate);
+							if (_order == 2) {
+								// LR2: low-pass - high-pass = 1st order all-pass (the high side is inverted to stay in phase)
+								setSection(lowPass, audio::algo::drain::biQuadDesignTangent(audio::algo::drain::biQuadType_lowPass, tangent, 0.5, 0.0, 1.0));
+								setSection(highPass, audio::algo::drain::biQuadDesignTangent(audio::algo::drain::biQuadType_highPass, tangent, 0.5, 0.0, 1.0), -1.0);
+								double coef = (tangent - 1.0) / (tangent + 1.0);
+								setSection(allPass, audio::algo::drain::BiQuadCoefficient(coef, 1.0, 0.0, coef, 0.0));
+								continue;
+							}
+							// LR4 and LR8: square of a Butterworth filter, low-pass + high-pass = all-pass with the Butterworth denominator
+							for (int32_t kkk=0; kkk<m_nbAllPass; ++kkk) {
+								double quality = _order == 4 ? M_SQRT1_2 : butterworth4Q[kkk];
+								audio::algo::drain::BiQuadCoefficient coefLow = audio::algo::drain::biQuadDesignTangent(audio::algo::drain::biQuadType_lowPass, tangent, quality, 0.0, 1.0);
+								audio::algo::drain::BiQuadCoefficient coefHigh = audio::algo::drain::biQuadDesignTangent(audio::algo::drain::biQuadType_highPass, tangent, quality, 0.0, 1.0);
+								setSection(lowPass + kkk*sectionSize, coefLow);
+								setSection(lowPass + (kkk+m_nbAllPass)*sectionSize, coefLow);
+								setSection(highPass + kkk*sectionSize, coefHigh);
+								setSection(highPass + (kkk+m_nbAllPass)*sectionSize, coefHigh);
+								setAllPass(allPass + kkk*sectionSize, coefLow);
+							}
+						}
+						m_stateTree.resize(m_nbChannel*m_nbSplit*2*m_nbCascade*2, 0.0f);
+						m_stateAllPass.resize(m_nbChannel*nbBand*m_nbSplit*m_nbAllPass*2, 0.0f);
+						m_band.resize(nbBand*subBlockSize, 0.0f);
+						m_pointerBand.resize(nbBand, null);
+						reset();
+						return true;
+					}
+					int32_t getNbBand() {
+						return m_nbSplit+1;
+					}
+					int32_t getOutputNbChannel() {
+						return (m_nbSplit+1)*m_nbChannel;
+					}
+				protected:
+					/**
+					 * @brief Split a sub-block of one channel in all the bands.
+					 * @param[in] _idChannel Id of the channel (history).
+					 * @param[out] _band Output buffer of each band (not the input).
+					 * @param[in] _input Input samples.
+					 * @param[in] _nbSample Number of sample [1..subBlockSize].
+					 */
+					void processChannel(int32_t _idChannel, float* const* _band, const float* _input, int32_t _nbSample) {
+						int32_t nbSection = 2*m_nbCascade + m_nbAllPass;
+						int32_t nbBand = m_nbSplit+1;
+						if (m_nbSplit == 0) {
+							memcpy(_band[0], _input, _nbSample*sizeof(float));
+							return;
+						}
+						float* stateTree = &m_stateTree[_idChannel*m_nbSplit*2*m_nbCascade*2];
+						const float* current = _input;
+						for (int32_t sss=0; sss<m_nbSplit; ++sss) {
+							const float* lowPass = &m_section[sss*nbSection*sectionSize];
+							const float* highPass = lowPass + m_nbCascade*sectionSize;
+							float* stateLow = stateTree + sss*2*m_nbCascade*2;
+							float* stateHigh = stateLow + m_nbCascade*2;
+							// the high-pass output of the last split is the last band, else the input of the next split
+							float* high = sss == m_nbSplit-1 ? _band[nbBand-1] : &m_high[(sss%2)*subBlockSize];
+							processCascade(m_nbCascade, lowPass, stateLow, _band[sss], current, highPass, stateHigh, high, current, _nbSample);
+							current = high;
+						}
+						// phase alignment: each band get the all-pass of the splits it did not cross (two bands by pass)
+						float* stateAllPass = &m_stateAllPass[_idChannel*nbBand*m_nbSplit*m_nbAllPass*2];
+						for (int32_t sss=1; sss<m_nbSplit; ++sss) {
+							const float* allPass = &m_section[(sss*nbSection + 2*m_nbCascade)*sectionSize];
+							for (int32_t bbb=0; bbb<sss; bbb+=2) {
+								float* stateA = stateAllPass + (bbb*m_nbSplit + sss)*m_nbAllPass*2;
+								if (bbb+1 < sss) {
+									float* stateB = stateAllPass + ((bbb+1)*m_nbSplit + sss)*m_nbAllPass*2;
+									processCascade(m_nbAllPass, allPass, stateA, _band[bbb], _band[bbb], allPass, stateB, _band[bbb+1], _band[bbb+1], _nbSample);
+								} else {
+									// the second stream is a scratch (free in the pipeline)
+									processCascade(m_nbAllPass, allPass, stateA, _band[bbb], _band[bbb], allPass, &m_stateScratch[0], &m_high[0], &m_high[0], _nbSample);
+								}
+							}
+						}
+					}
+				public:
+					void process(float* _output, const float* _input, size_t _nbChunk) {
+						int32_t nbBand = m_nbSplit+1;
+						int32_t nbChannelOut = nbBand*m_nbChannel;
+						for (int32_t bbb=0; bbb<nbBand; ++bbb) {
+							m_pointerBand[bbb] = &m_band[bbb*subBlockSize];
+						}
+						for (size_t offset=0; offset<_nbChunk; offset+=subBlockSize) {
+							int32_t nbSample = etk::min(size_t(subBlockSize), _nbChunk-offset);
+							for (int32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+								const float* input = _input + offset*m_nbChannel + ccc;
+								for (int32_t iii=0; iii<nbSample; ++iii) {
+									m_input[iii] = input[iii*m_nbChannel];
+								}
+								processChannel(ccc, &m_pointerBand[0], &m_input[0], nbSample);
+								for (int32_t bbb=0; bbb<nbBand; ++bbb) {
+									const float* band = m_pointerBand[bbb];
+									float* output = _output + offset*nbChannelOut + bbb*m_nbChannel + ccc;
+									for (int32_t iii=0; iii<nbSample; ++iii) {
+										output[iii*nbChannelOut] = band[iii];
+									}
+								}
+							}
+						}
+					}
+					void processPlanar(float* const* _output, const float* const* _input, size_t _nbChunk) {
+						int32_t nbBand = m_nbSplit+1;
+						for (size_t offset=0; offset<_nbChunk; offset+=subBlockSize) {
+							int32_t nbSample = etk::min(size_t(subBlockSize), _nbChunk-offset);
+							for (int32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+								for (int32_t bbb=0; bbb<nbBand; ++bbb) {
+									m_pointerBand[bbb] = _output[bbb*m_nbChannel + ccc] + offset;
+								}
+								processChannel(ccc, &m_pointerBand[0], _input[ccc] + offset, nbSample);
+							}
+						}
+					}
+			};
+		}
+	}
+}
+
+audio::algo::drain::Crossover::Crossover() {
+	
+}
+
+audio::algo::drain::Crossover::~Crossover() {
+	
+}
+
+void audio::algo::drain::Crossover::init(float _sampleRate, int8_t _nbChannel, enum audio::format _format) {
+	if (_format != audio::format_float) {
+		AA_DRAIN_CRITICAL("Request format for crossover that not exist ... : " << _format);
+		return;
+	}
+	if (_nbChannel <= 0) {
+		AA_DRAIN_ERROR("Request crossover with " << int32_t(_nbChannel) << " channel(s)");
+		return;
+	}
+	m_private = ememory::makeShared<CrossoverPrivate>();
+	if (m_private == null) {
+		AA_DRAIN_ERROR("can not allocate private data...");
+		return;
+	}
+	m_private->init(_sampleRate, _nbChannel);
+}
+
+void audio::algo::drain::Crossover::reset() {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Crossover does not init ...");
+		return;
+	}
+	m_private->reset();
+}
+
+etk::Vector<enum audio::format> audio::algo::drain::Crossover::getSupportedFormat() {
+	etk::Vector<enum audio::format> out = audio::algo::drain::Crossover::getNativeSupportedFormat();
+	return out;
+}
+
+etk::Vector<enum audio::format> audio::algo::drain::Crossover::getNativeSupportedFormat() {
+	etk::Vector<enum audio::format> out;
+	out.pushBack(audio::format_float);
+	return out;
+}
+
+void audio::algo::drain::Crossover::process(void* _output, const void* _input, size_t _nbChunk) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Crossover does not init ...");
+		return;
+	}
+	m_private->process(reinterpret_cast<float*>(_output), reinterpret_cast<const float*>(_input), _nbChunk);
+}
+
+void audio::algo::drain::Crossover::processPlanar(float* const* _output, const float* const* _input, size_t _nbChunk) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Crossover does not init ...");
+		return;
+	}
+	m_private->processPlanar(_output, _input, _nbChunk);
+}
+
+bool audio::algo::drain::Crossover::setCrossover(const etk::Vector<float>& _frequency, int32_t _order) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Crossover does not init ...");
+		return false;
+	}
+	return m_private->setCrossover(_frequency, _order);
+}
+
+int32_t audio::algo::drain::Crossover::getNbBand() {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Crossover does not init ...");
+		return 0;
+	}
+	return m_private->getNbBand();
+}
+
+int32_t audio::algo::drain::Crossover::getOutputNbChannel() {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Crossover does not init ...");
+		return 0;
+	}
+	return m_private->getOutputNbChannel();
+}
@@ -0,0 +1,93 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <etk/types.hpp>
+#include <ememory/memory.hpp>
+#include <etk/Vector.hpp>
+#include <audio/format.hpp>
+
+namespace audio {
+	namespace algo {
+		namespace drain {
+			class CrossoverPrivate;
+			/**
+			 * @brief Multi-way Linkwitz-Riley crossover: N band outputs from each input channel in one pass.
+			 * The bands are split in a tree: the high-pass output of a split is the input of the next split (the input is read once and the high-pass chain is shared).
+			 * Each band is delayed by the all-pass response of the higher splits: the sum of the bands has a flat magnitude (phase aligned bands).
+			 * The output channel of the band b of the input channel c is b*nbChannel + c (band-major: low L R, mid L R, high L R).
+			 */
+			class Crossover {
+				public:
+					/**
+					 * @brief Constructor
+					 */
+					Crossover();
+					/**
+					 * @brief Destructor
+					 */
+					virtual ~Crossover();
+				public:
+					/**
+					 * @brief Reset all history of the Algo.
+					 */
+					void reset();
+					/**
+					 * @brief Initialize the Algorithm (one band: the input is copied).
+					 * @param[in] _sampleRate Sample rate of the stream.
+					 * @param[in] _nbChannel Number of channel in the input stream.
+					 * @param[in] _format Input data format.
+					 */
+					virtual void init(float _sampleRate=48000, int8_t _nbChannel=2, enum audio::format _format=audio::format_float);
+					/**
+					 * @brief Get list of format suported in input.
+					 * @return list of supported format
+					 */
+					virtual etk::Vector<enum audio::format> getSupportedFormat();
+					/**
+					 * @brief Get list of algorithm format suported. No format convertion.
+					 * @return list of supported format
+					 */
+					virtual etk::Vector<enum audio::format> getNativeSupportedFormat();
+					/**
+					 * @brief Main input algo process on interleaved data (no allocation, can not be done in place).
+					 * @param[out] _output Output data (getOutputNbChannel() channels).
+					 * @param[in] _input Input data (nbChannel).
+					 * @param[in] _nbChunk Number of chunk in the input buffer.
+					 */
+					virtual void process(void* _output, const void* _input, size_t _nbChunk);
+					/**
+					 * @brief Process planar float data (no allocation).
+					 * @param[out] _output Output buffer of each output channel (getOutputNbChannel() buffers, band-major).
+					 * @param[in] _input Input buffer of each input channel.
+					 * @param[in] _nbChunk Number of sample in each buffer.
+					 */
+					void processPlanar(float* const* _output, const float* const* _input, size_t _nbChunk);
+				public:
+					/**
+					 * @brief Set the crossover frequencies (allocation: not in the real-time thread, the history is reset).
+					 * @param[in] _frequency Crossover frequencies (Hz, increasing): N frequencies give N+1 bands.
+					 * @param[in] _order Order of the Linkwitz-Riley filters: 2 (12 dB/octave, the high side is inverted), 4 (24 dB/octave) or 8 (48 dB/octave).
+					 * @return true The crossover is set.
+					 */
+					bool setCrossover(const etk::Vector<float>& _frequency, int32_t _order=4);
+					/**
+					 * @brief Get the number of band.
+					 * @return Number of band (number of frequency + 1).
+					 */
+					int32_t getNbBand();
+					/**
+					 * @brief Get the number of output channel.
+					 * @return Number of band x number of input channel.
+					 */
+					int32_t getOutputNbChannel();
+				protected:
+					ememory::SharedPtr<CrossoverPrivate> m_private; //!< private data.
+			};
+		}
+	}
+}
+
@@ -0,0 +1,430 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <audio/algo/drain/DirectionOfArrival.hpp>
+#include <audio/algo/drain/Fft.hpp>
+#include <audio/algo/drain/debug.hpp>
+
+// see "Robust localization in reverberant rooms" (DiBiase, Silverman, Brandstein): SRP-PHAT
+
+// Frequency band used for the correlation (the low frequencies have no spatial resolution).
+static const double frequencyMin = 200.0;
+static const double frequencyMax = 8000.0;
+// Smoothing of the correlations between frames.
+static const float correlationForget = 0.6f;
+
+namespace audio {
+	namespace algo {
+		namespace drain {
+			class DirectionOfArrivalPrivate {
+				protected:
+					float m_sampleRate;
+					int32_t m_nbChannel;
+					int32_t m_nbPair; //!< number of microphone pair
+					int32_t m_frameSize; //!< FFT size
+					int32_t m_hopSize; //!< number of sample between 2 frames
+					int32_t m_nbBin; //!< number of frequency bin
+					int32_t m_binMin; //!< first bin used in the correlation
+					int32_t m_binMax; //!< last bin used in the correlation
+					audio::algo::drain::Fft m_fft;
+					etk::Vector<vec3> m_positions; //!< position of each microphone
+					double m_coarse; //!< coarse grid step (degree)
+					double m_fine; //!< fine grid step (degree)
+					double m_ethaMin; //!< minimum elevation (degree)
+					double m_ethaMax; //!< maximum elevation (degree)
+					int32_t m_nbAlpha; //!< number of azimuth in the fine grid
+					int32_t m_nbEtha; //!< number of elevation in the fine grid
+					int32_t m_stride; //!< number of fine cell in a coarse cell
+					int32_t m_nbSource; //!< number of direction to detect
+					etk::Vector<int32_t> m_tdoaIndex; //!< delay between the 2 microphones of each pair for each direction of the fine grid [direction][pair] (sample, wrapped on the frame size)
+					etk::Vector<float> m_tdoaFrac; //!< fractional part of the delay [direction][pair]
+					etk::Vector<float> m_window; //!< hann window
+					etk::Vector<float> m_input; //!< last frame of each channel [channel][frameSize]
+					int32_t m_fill; //!< number of new sample in the current hop
+					etk::Vector<float> m_frame; //!< temporary windowed frame
+					etk::Vector<float> m_specReal; //!< spectrum of each channel [channel][bin]
+					etk::Vector<float> m_specImag; //!< spectrum of each channel [channel][bin]
+					etk::Vector<float> m_crossReal; //!< temporary cross spectrum [bin]
+					etk::Vector<float> m_crossImag; //!< temporary cross spectrum [bin]
+					etk::Vector<float> m_correlation; //!< smoothed GCC-PHAT of each pair [pair][frameSize]
+					etk::Vector<float> m_power; //!< steered response power of each direction of the fine grid
+					etk::Vector<int32_t> m_powerFrame; //!< Id of the frame when m_power have been calculated
+					int32_t m_frameId; //!< Id of the current frame
+					etk::Vector<etk::Pair<int32_t,int32_t> > m_found; //!< grid position of the detected sources
+					etk::Vector<etk::Pair<audio::algo::drain::Direction, float> > m_result; //!< last estimation
+				public:
+					DirectionOfArrivalPrivate() :
+					  m_sampleRate(48000),
+					  m_nbChannel(0),
+					  m_nbPair(0),
+					  m_frameSize(0),
+					  m_hopSize(0),
+					  m_nbBin(0),
+					  m_binMin(0),
+					  m_binMax(0),
+					  m_coarse(10.0),
+					  m_fine(1.0),
+					  m_ethaMin(0.0),
+					  m_ethaMax(0.0),
+					  m_nbAlpha(0),
+					  m_nbEtha(0),
+					  m_stride(1),
+					  m_nbSource(1),
+					  m_fill(0),
+					  m_frameId(0) {
+						
+					}
+					bool init(float _sampleRate, int8_t _nbChannel, int32_t _frameSize) {
+						m_sampleRate = _sampleRate;
+						m_nbChannel = _nbChannel;
+						m_nbPair = m_nbChannel*(m_nbChannel-1)/2;
+						if (m_fft.init(_frameSize) == false) {
+							return false;
+						}
+						m_frameSize = _frameSize;
+						m_hopSize = m_frameSize/2;
+						m_nbBin = m_fft.getNbBin();
+						m_binMin = etk::max(1, int32_t(frequencyMin * m_frameSize / m_sampleRate));
+						m_binMax = etk::min(m_nbBin-1, int32_t(frequencyMax * m_frameSize / m_sampleRate));
+						m_window.resize(m_frameSize, 0.0f);
+						for (int32_t iii=0; iii<m_frameSize; ++iii) {
+							m_window[iii] = 0.5 - 0.5*etk::cos(2.0*M_PI*double(iii)/double(m_frameSize));
+						}
+						m_input.resize(m_nbChannel*m_frameSize, 0.0f);
+						m_frame.resize(m_frameSize, 0.0f);
+						m_specReal.resize(m_nbChannel*m_nbBin, 0.0f);
+						m_specImag.resize(m_nbChannel*m_nbBin, 0.0f);
+						m_crossReal.resize(m_nbBin, 0.0f);
+						m_crossImag.resize(m_nbBin, 0.0f);
+						m_correlation.resize(m_nbPair*m_frameSize, 0.0f);
+						reset();
+						return true;
+					}
+					void reset() {
+						for (size_t iii=0; iii<m_input.size(); ++iii) {
+							m_input[iii] = 0.0f;
+						}
+						for (size_t iii=0; iii<m_correlation.size(); ++iii) {
+							m_correlation[iii] = 0.0f;
+						}
+						m_fill = 0;
+						m_result.clear();
+					}
+					void setGrid(double _coarse, double _fine, double _ethaMin, double _ethaMax) {
+						m_fine = etk::max(_fine, 0.1);
+						m_coarse = etk::max(_coarse, m_fine);
+						m_ethaMin = etk::max(-90.0, etk::min(_ethaMin, 90.0));
+						m_ethaMax = etk::max(m_ethaMin, etk::min(_ethaMax, 90.0));
+						if (m_positions.size() != 0) {
+							calculateTable();
+						}
+					}
+					void setNbSource(int32_t _nbSource) {
+						m_nbSource = etk::max(1, _nbSource);
+						m_result.reserve(m_nbSource);
+						m_found.reserve(m_nbSource);
+					}
+					bool setMicrophonePosition(const etk::Vector<vec3>& _positions) {
+						if (_positions.size() != size_t(m_nbChannel)) {
+							AA_DRAIN_ERROR("Request " << _positions.size() << " microphone position with " << m_nbChannel << " channels");
+							return false;
+						}
+						m_positions = _positions;
+						double maxDelay = audio::algo::drain::calculateMaxDelay(m_positions) * m_sampleRate;
+						if (maxDelay >= m_hopSize) {
+							AA_DRAIN_WARNING("Microphone array too large for the frame size: delay=" << maxDelay << " sample >= " << m_hopSize);
+						}
+						calculateTable();
+						return true;
+					}
+					const etk::Vector<etk::Pair<audio::algo::drain::Direction, float> >& getDirections() {
+						return m_result;
+					}
+					bool process(const float* _input, size_t _nbChunk) {
+						if (m_positions.size() == 0) {
+							AA_DRAIN_ERROR("DirectionOfArrival microphone position are not set ...");
+							return false;
+						}
+						bool newResult = false;
+						for (size_t iii=0; iii<_nbChunk; ++iii) {
+							int32_t pos = m_frameSize - m_hopSize + m_fill;
+							for (int32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+								m_input[ccc*m_frameSize + pos] = _input[ccc];
+							}
+							_input += m_nbChannel;
+							m_fill++;
+							if (m_fill == m_hopSize) {
+								processFrame();
+								m_fill = 0;
+								newResult = true;
+							}
+						}
+						return newResult;
+					}
+				protected:
+					/**
+					 * @brief Calculate the delay tables of all the fine grid directions.
+					 */
+					void calculateTable() {
+						m_nbAlpha = int32_t(360.0/m_fine + 0.5);
+						m_nbEtha = int32_t((m_ethaMax-m_ethaMin)/m_fine + 0.5) + 1;
+						m_stride = etk::max(1, int32_t(m_coarse/m_fine + 0.5));
+						int32_t nbDirection = m_nbAlpha*m_nbEtha;
+						m_tdoaIndex.resize(nbDirection*m_nbPair, 0);
+						m_tdoaFrac.resize(nbDirection*m_nbPair, 0.0f);
+						m_power.resize(nbDirection, 0.0f);
+						m_powerFrame.resize(nbDirection, 0);
+						for (int32_t iii=0; iii<nbDirection; ++iii) {
+							m_powerFrame[iii] = -1;
+						}
+						m_frameId = 0;
+						etk::Vector<double> delay;
+						delay.resize(m_nbChannel, 0.0);
+						for (int32_t eee=0; eee<m_nbEtha; ++eee) {
+							for (int32_t aaa=0; aaa<m_nbAlpha; ++aaa) {
+								audio::algo::drain::Direction direction = getDirection(aaa, eee);
+								for (int32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+									delay[ccc] = audio::algo::drain::calculateDelay(m_positions[ccc], direction) * m_sampleRate;
+								}
+								int32_t id = (eee*m_nbAlpha + aaa)*m_nbPair;
+								for (int32_t iii=0; iii<m_nbChannel; ++iii) {
+									for (int32_t jjj=iii+1; jjj<m_nbChannel; ++jjj) {
+										// the correlation of the pair (i,j) has its maximum at delay(i) - delay(j)
+										double tdoa = delay[iii] - delay[jjj];
+										double tdoaFloor = floor(tdoa);
+										m_tdoaIndex[id] = (int32_t(tdoaFloor) + m_frameSize) & (m_frameSize-1);
+										m_tdoaFrac[id] = tdoa - tdoaFloor;
+										id++;
+									}
+								}
+							}
+						}
+					}
+					audio::algo::drain::Direction getDirection(int32_t _idAlpha, int32_t _idEtha) {
+						return audio::algo::drain::Direction((-180.0 + double(_idAlpha)*m_fine)*M_PI/180.0,
+						                                     (m_ethaMin + double(_idEtha)*m_fine)*M_PI/180.0,
+						                                     0.0);
+					}
+					void processFrame() {
+						for (int32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+							float* input = &m_input[ccc*m_frameSize];
+							for (int32_t iii=0; iii<m_frameSize; ++iii) {
+								m_frame[iii] = input[iii] * m_window[iii];
+							}
+							m_fft.forward(&m_specReal[ccc*m_nbBin], &m_specImag[ccc*m_nbBin], &m_frame[0]);
+							for (int32_t iii=0; iii<m_frameSize-m_hopSize; ++iii) {
+								input[iii] = input[iii+m_hopSize];
+							}
+						}
+						// GCC-PHAT of each pair
+						int32_t idPair = 0;
+						for (int32_t iii=0; iii<m_nbChannel; ++iii) {
+							for (int32_t jjj=iii+1; jjj<m_nbChannel; ++jjj) {
+								const float* aReal = &m_specReal[iii*m_nbBin];
+								const float* aImag = &m_specImag[iii*m_nbBin];
+								const float* bReal = &m_specReal[jjj*m_nbBin];
+								const float* bImag = &m_specImag[jjj*m_nbBin];
+								for (int32_t bbb=0; bbb<m_nbBin; ++bbb) {
+									m_crossReal[bbb] = 0.0f;
+									m_crossImag[bbb] = 0.0f;
+								}
+								for (int32_t bbb=m_binMin; bbb<=m_binMax; ++bbb) {
+									// a * conj(b) / |a * conj(b)|
+									float real = aReal[bbb]*bReal[bbb] + aImag[bbb]*bImag[bbb];
+									float imag = aImag[bbb]*bReal[bbb] - aReal[bbb]*bImag[bbb];
+									float norm = 1.0f / (etk::sqrt(real*real + imag*imag) + 1.0e-20f);
+									m_crossReal[bbb] = real * norm;
+									m_crossImag[bbb] = imag * norm;
+								}
+								m_fft.inverse(&m_frame[0], &m_crossReal[0], &m_crossImag[0]);
+								float* correlation = &m_correlation[idPair*m_frameSize];
+								for (int32_t kkk=0; kkk<m_frameSize; ++kkk) {
+									correlation[kkk] = correlationForget*correlation[kkk] + (1.0f-correlationForget)*m_frame[kkk];
+								}
+								idPair++;
+							}
+						}
+						searchDirection();
+					}
+					/**
+					 * @brief Get the steered response power of a direction of the fine grid (calculated one time per frame).
+					 */
+					float getPower(int32_t _idAlpha, int32_t _idEtha) {
+						int32_t id = _idEtha*m_nbAlpha + _idAlpha;
+						if (m_powerFrame[id] == m_frameId) {
+							return m_power[id];
+						}
+						const int32_t* index = &m_tdoaIndex[id*m_nbPair];
+						const float* frac = &m_tdoaFrac[id*m_nbPair];
+						float power = 0.0f;
+						for (int32_t ppp=0; ppp<m_nbPair; ++ppp) {
+							const float* correlation = &m_correlation[ppp*m_frameSize];
+							float value0 = correlation[index[ppp]];
+							float value1 = correlation[(index[ppp]+1) & (m_frameSize-1)];
+							power += value0 + (value1-value0)*frac[ppp];
+						}
+						m_power[id] = power;
+						m_powerFrame[id] = m_frameId;
+						return power;
+					}
+					/**
+					 * @brief Check if a direction is near an already detected source.
+					 */
+					bool isExcluded(int32_t _idAlpha, int32_t _idEtha) {
+						int32_t radius = 2*m_stride;
+						for (size_t iii=0; iii<m_found.size(); ++iii) {
+							int32_t deltaAlpha = etk::abs(_idAlpha - m_found[iii].first);
+							deltaAlpha = etk::min(deltaAlpha, m_nbAlpha - deltaAlpha);
+							if (    deltaAlpha <= radius
+							     && etk::abs(_idEtha - m_found[iii].second) <= radius) {
+								return true;
+							}
+						}
+						return false;
+					}
+					void searchDirection() {
+						// invalidate the power of the previous frame
+						m_frameId++;
+						m_result.clear();
+						m_found.clear();
+						for (int32_t sss=0; sss<m_nbSource; ++sss) {
+							// coarse scan
+							int32_t bestAlpha = -1;
+							int32_t bestEtha = -1;
+							float bestPower = 0.0f;
+							for (int32_t eee=0; eee<m_nbEtha; eee+=m_stride) {
+								for (int32_t aaa=0; aaa<m_nbAlpha; aaa+=m_stride) {
+									if (isExcluded(aaa, eee) == true) {
+										continue;
+									}
+									float power = getPower(aaa, eee);
+									if (    bestAlpha < 0
+									     || power > bestPower) {
+										bestPower = power;
+										bestAlpha = aaa;
+										bestEtha = eee;
+									}
+								}
+							}
+							if (bestAlpha < 0) {
+								break;
+							}
+							// refinement around the best coarse direction
+							int32_t centerAlpha = bestAlpha;
+							int32_t centerEtha = bestEtha;
+							for (int32_t eee=centerEtha-m_stride; eee<=centerEtha+m_stride; ++eee) {
+								if (    eee < 0
+								     || eee >= m_nbEtha) {
+									continue;
+								}
+								for (int32_t aaa=centerAlpha-m_stride; aaa<=centerAlpha+m_stride; ++aaa) {
+									int32_t idAlpha = (aaa + m_nbAlpha) % m_nbAlpha;
+									if (isExcluded(idAlpha, eee) == true) {
+										continue;
+									}
+									float power = getPower(idAlpha, eee);
+									if (power > bestPower) {
+										bestPower = power;
+										bestAlpha = idAlpha;
+										bestEtha = eee;
+									}
+								}
+							}
+							m_found.pushBack(etk::makePair(bestAlpha, bestEtha));
+							m_result.pushBack(etk::makePair(getDirection(bestAlpha, bestEtha), etk::max(0.0f, bestPower/float(m_nbPair))));
+						}
+					}
+			};
+		}
+	}
+}
+
+audio::algo::drain::DirectionOfArrival::DirectionOfArrival() {
+	
+}
+
+audio::algo::drain::DirectionOfArrival::~DirectionOfArrival() {
+	
+}
+
+void audio::algo::drain::DirectionOfArrival::init(float _sampleRate, int8_t _nbChannel, enum audio::format _format, int32_t _frameSize) {
+	if (_format != audio::format_float) {
+		AA_DRAIN_CRITICAL("Request format for direction of arrival that not exist ... : " << _format);
+		return;
+	}
+	if (_nbChannel < 2) {
+		AA_DRAIN_ERROR("Request direction of arrival with " << int32_t(_nbChannel) << " channel(s)");
+		return;
+	}
+	m_private = ememory::makeShared<DirectionOfArrivalPrivate>();
+	if (m_private == null) {
+		AA_DRAIN_ERROR("can not allocate private data...");
+		return;
+	}
+	if (m_private->init(_sampleRate, _nbChannel, _frameSize) == false) {
+		m_private = null;
+	}
+}
+
+void audio::algo::drain::DirectionOfArrival::reset() {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("DirectionOfArrival does not init ...");
+		return;
+	}
+	m_private->reset();
+}
+
+etk::Vector<enum audio::format> audio::algo::drain::DirectionOfArrival::getSupportedFormat() {
+	etk::Vector<enum audio::format> out = audio::algo::drain::DirectionOfArrival::getNativeSupportedFormat();
+	return out;
+}
+
+etk::Vector<enum audio::format> audio::algo::drain::DirectionOfArrival::getNativeSupportedFormat() {
+	etk::Vector<enum audio::format> out;
+	out.pushBack(audio::format_float);
+	return out;
+}
+
+bool audio::algo::drain::DirectionOfArrival::process(const void* _input, size_t _nbChunk) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("DirectionOfArrival does not init ...");
+		return false;
+	}
+	return m_private->process(reinterpret_cast<const float*>(_input), _nbChunk);
+}
+
+bool audio::algo::drain::DirectionOfArrival::setMicrophonePosition(const etk::Vector<vec3>& _positions) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("DirectionOfArrival does not init ...");
+		return false;
+	}
+	return m_private->setMicrophonePosition(_positions);
+}
+
+void audio::algo::drain::DirectionOfArrival::setGrid(double _coarse, double _fine, double _ethaMin, double _ethaMax) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("DirectionOfArrival does not init ...");
+		return;
+	}
+	m_private->setGrid(_coarse, _fine, _ethaMin, _ethaMax);
+}
+
+void audio::algo::drain::DirectionOfArrival::setNbSource(int32_t _nbSource) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("DirectionOfArrival does not init ...");
+		return;
+	}
+	m_private->setNbSource(_nbSource);
+}
+
+etk::Vector<etk::Pair<audio::algo::drain::Direction, float> > audio::algo::drain::DirectionOfArrival::getDirections() {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("DirectionOfArrival does not init ...");
+		return etk::Vector<etk::Pair<audio::algo::drain::Direction, float> >();
+	}
+	return m_private->getDirections();
+}
+
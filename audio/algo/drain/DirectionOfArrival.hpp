@@ -0,0 +1,95 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <etk/types.hpp>
+#include <ememory/memory.hpp>
+#include <etk/Vector.hpp>
+#include <etk/Pair.hpp>
+#include <audio/format.hpp>
+#include <audio/algo/drain/ArrayGeometry.hpp>
+
+namespace audio {
+	namespace algo {
+		namespace drain {
+			class DirectionOfArrivalPrivate;
+			/**
+			 * @brief Direction of arrival estimator (SRP-PHAT): scan a grid of directions with the steered response power of the microphone array.
+			 * The input is an interleaved stream of nbChannel microphones, the result is the list of the dominant directions.
+			 */
+			class DirectionOfArrival {
+				public:
+					/**
+					 * @brief Constructor
+					 */
+					DirectionOfArrival();
+					/**
+					 * @brief Destructor
+					 */
+					virtual ~DirectionOfArrival();
+				public:
+					/**
+					 * @brief Reset all history of the Algo.
+					 */
+					void reset();
+					/**
+					 * @brief Initialize the Algorithm
+					 * @param[in] _sampleRate Sample rate of the stream.
+					 * @param[in] _nbChannel Number of microphone in the stream.
+					 * @param[in] _format Input data format.
+					 * @param[in] _frameSize Size of the analysis frame (power of 2), the hop size is the half.
+					 */
+					virtual void init(float _sampleRate=48000, int8_t _nbChannel=4, enum audio::format _format=audio::format_float, int32_t _frameSize=1024);
+					/**
+					 * @brief Get list of format suported in input.
+					 * @return list of supported format
+					 */
+					virtual etk::Vector<enum audio::format> getSupportedFormat();
+					/**
+					 * @brief Get list of algorithm format suported. No format convertion.
+					 * @return list of supported format
+					 */
+					virtual etk::Vector<enum audio::format> getNativeSupportedFormat();
+					/**
+					 * @brief Main input algo process (analysis only).
+					 * @param[in] _input Input data (interleaved, nbChannel).
+					 * @param[in] _nbChunk Number of chunk in the input buffer.
+					 * @return true A new estimation is available.
+					 */
+					virtual bool process(const void* _input, size_t _nbChunk);
+				public:
+					/**
+					 * @brief Set the position of all the microphones (must be called after init, before process).
+					 * @note All the delay tables are calculated here.
+					 * @param[in] _positions Position of each microphone in meter (one per channel).
+					 * @return true The position have been set.
+					 */
+					bool setMicrophonePosition(const etk::Vector<vec3>& _positions);
+					/**
+					 * @brief Set the scanned grid (to call before setMicrophonePosition).
+					 * @param[in] _coarse Step of the first scan (degree).
+					 * @param[in] _fine Step of the refinement around the best coarse directions (degree).
+					 * @param[in] _ethaMin Minimum elevation (degree).
+					 * @param[in] _ethaMax Maximum elevation (degree).
+					 */
+					void setGrid(double _coarse=10.0, double _fine=1.0, double _ethaMin=0.0, double _ethaMax=0.0);
+					/**
+					 * @brief Set the number of source to detect.
+					 * @param[in] _nbSource Maximum number of direction returned.
+					 */
+					void setNbSource(int32_t _nbSource);
+					/**
+					 * @brief Get the dominant directions of the last estimation.
+					 * @return List of direction with the normalized steered power [0..1], the most powerful first.
+					 */
+					etk::Vector<etk::Pair<audio::algo::drain::Direction, float> > getDirections();
+				protected:
+					ememory::SharedPtr<DirectionOfArrivalPrivate> m_private; //!< private data.
+			};
+		}
+	}
+}
+
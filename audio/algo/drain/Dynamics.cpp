@@ -0,0 +1,550 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <audio/algo/drain/Dynamics.hpp>
+#include <audio/algo/drain/VectorMath.hpp>
+#include <audio/algo/drain/debug.hpp>
+extern "C" {
+	#include <math.h>
+}
+
+// Number of sample processed at the same time (detector, gain computer and gain conversion are done on a block).
+static const int32_t blockSize = 128;
+// Level of the silence (dB).
+static const float levelFloor = -200.0f;
+
+/**
+ * @brief Get the coefficient of a one pole smoothing filter.
+ * @param[in] _time Time constant (second).
+ * @param[in] _sampleRate Sample rate of the stream.
+ * @return Feedback coefficient (0: no smoothing).
+ */
+static float timeToCoefficient(float _time, float _sampleRate) {
+	if (_time <= 0.0f) {
+		return 0.0f;
+	}
+	return exp(-1.0 / (double(_time) * double(_sampleRate)));
+}
+
+namespace audio {
+	namespace algo {
+		namespace drain {
+			class DynamicsPrivate {
+				protected:
+					float m_sampleRate;
+					int32_t m_nbChannel;
+					bool m_link; //!< same gain on all the channels
+					enum audio::algo::drain::dynamicsDetector m_detector; //!< type of level detector
+					float m_rmsTime; //!< integration time of the RMS detector
+					float m_rmsCoef; //!< feedback coefficient of the RMS detector
+					float m_threshold; //!< compressor threshold (dB)
+					float m_slope; //!< compressor slope: 1/ratio - 1
+					float m_knee; //!< compressor knee width (dB)
+					float m_gateThreshold; //!< expander threshold (dB)
+					float m_gateSlope; //!< expander slope: ratio - 1
+					float m_gateRange; //!< expander maximum attenuation (dB)
+					float m_attack; //!< attack time (second)
+					float m_release; //!< release time (second)
+					float m_attackCoef; //!< feedback coefficient of a gain decrease
+					float m_releaseCoef; //!< feedback coefficient of a gain increase
+					float m_makeUp; //!< make-up gain (dB)
+					bool m_limiter; //!< the limiter is enable
+					float m_ceiling; //!< limiter ceiling (dB)
+					float m_limiterRelease; //!< limiter release time (second)
+					float m_limiterReleaseCoef; //!< feedback coefficient of the limiter release
+					int32_t m_lookAhead; //!< look-ahead of the limiter (sample)
+					int64_t m_count; //!< number of processed sample (index of the sliding minimum)
+					etk::Vector<float> m_rmsPower; //!< RMS detector state [group]
+					etk::Vector<float> m_gainSmooth; //!< smoothed compressor/expander gain [group] (dB)
+					etk::Vector<float> m_limiterGain; //!< limiter gain after release [group] (dB)
+					etk::Vector<float> m_lastGain; //!< last applied gain [group] (dB)
+					etk::Vector<float> m_level; //!< level of the block [group][blockSize] (power then dB)
+					etk::Vector<float> m_peak; //!< peak level of the block for the limiter [group][blockSize] (power then dB)
+					etk::Vector<float> m_gain; //!< gain of the block [group][blockSize] (dB then linear)
+					int32_t m_delayPos; //!< position in the delay lines
+					etk::Vector<float> m_delayAudio; //!< delay line of the signal [channel][lookAhead]
+					etk::Vector<float> m_delayGain; //!< delay line of the compressor gain [group][lookAhead]
+					int32_t m_windowPos; //!< position in the window of the box filter
+					etk::Vector<float> m_window; //!< sliding minimum of the limiter gain [group][lookAhead+1]
+					etk::Vector<double> m_windowSum; //!< sum of m_window [group]
+					etk::Vector<float> m_dequeValue; //!< monotonic queue of the sliding minimum [group][lookAhead+1]
+					etk::Vector<int64_t> m_dequeIndex; //!< sample index of each value of the queue [group][lookAhead+1]
+					etk::Vector<int32_t> m_dequeHead; //!< first element of the queue [group]
+					etk::Vector<int32_t> m_dequeSize; //!< number of element in the queue [group]
+				public:
+					DynamicsPrivate() :
+					  m_sampleRate(48000),
+					  m_nbChannel(0),
+					  m_link(true),
+					  m_detector(audio::algo::drain::dynamicsDetector_peak),
+					  m_rmsTime(0.01f),
+					  m_rmsCoef(0.0f),
+					  m_threshold(0.0f),
+					  m_slope(0.0f),
+					  m_knee(0.0f),
+					  m_gateThreshold(levelFloor),
+					  m_gateSlope(9.0f),
+					  m_gateRange(80.0f),
+					  m_attack(0.005f),
+					  m_release(0.1f),
+					  m_attackCoef(0.0f),
+					  m_releaseCoef(0.0f),
+					  m_makeUp(0.0f),
+					  m_limiter(false),
+					  m_ceiling(-0.1f),
+					  m_limiterRelease(0.05f),
+					  m_limiterReleaseCoef(0.0f),
+					  m_lookAhead(0),
+					  m_count(0),
+					  m_delayPos(0),
+					  m_windowPos(0) {
+						
+					}
+					void init(float _sampleRate, int8_t _nbChannel) {
+						m_sampleRate = _sampleRate;
+						m_nbChannel = _nbChannel;
+						// a group per channel: enough for the link change without allocation
+						m_rmsPower.resize(m_nbChannel, 0.0f);
+						m_gainSmooth.resize(m_nbChannel, 0.0f);
+						m_limiterGain.resize(m_nbChannel, 0.0f);
+						m_lastGain.resize(m_nbChannel, 0.0f);
+						m_level.resize(m_nbChannel*blockSize, 0.0f);
+						m_peak.resize(m_nbChannel*blockSize, 0.0f);
+						m_gain.resize(m_nbChannel*blockSize, 0.0f);
+						updateTime();
+						resizeLimiter();
+					}
+					void reset() {
+						m_count = 0;
+						for (int32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+							m_rmsPower[ccc] = 0.0f;
+							m_gainSmooth[ccc] = 0.0f;
+							m_limiterGain[ccc] = 0.0f;
+							m_lastGain[ccc] = 0.0f;
+							m_windowSum[ccc] = 0.0;
+							m_dequeHead[ccc] = 0;
+							m_dequeSize[ccc] = 0;
+						}
+						for (size_t iii=0; iii<m_delayAudio.size(); ++iii) {
+							m_delayAudio[iii] = 0.0f;
+						}
+						for (size_t iii=0; iii<m_delayGain.size(); ++iii) {
+							m_delayGain[iii] = 0.0f;
+						}
+						for (size_t iii=0; iii<m_window.size(); ++iii) {
+							m_window[iii] = 0.0f;
+						}
+						m_delayPos = 0;
+						m_windowPos = 0;
+					}
+					void setDetector(enum audio::algo::drain::dynamicsDetector _detector, float _rmsTime) {
+						m_detector = _detector;
+						m_rmsTime = _rmsTime;
+						updateTime();
+					}
+					void setCompressor(float _threshold, float _ratio, float _knee) {
+						if (_ratio < 1.0f) {
+							AA_DRAIN_ERROR("Compressor ratio must be >= 1 : " << _ratio);
+							return;
+						}
+						m_threshold = _threshold;
+						m_slope = 1.0f/_ratio - 1.0f;
+						m_knee = etk::max(0.0f, _knee);
+					}
+					void setGate(float _threshold, float _ratio, float _range) {
+						if (_ratio < 1.0f) {
+							AA_DRAIN_ERROR("Gate ratio must be >= 1 : " << _ratio);
+							return;
+						}
+						m_gateThreshold = _threshold;
+						m_gateSlope = _ratio - 1.0f;
+						m_gateRange = fabs(_range);
+					}
+					void setTime(float _attack, float _release) {
+						m_attack = _attack;
+						m_release = _release;
+						updateTime();
+					}
+					void setMakeUpGain(float _gain) {
+						m_makeUp = _gain;
+					}
+					void setLimiter(bool _enable, float _ceiling, float _lookAhead, float _release) {
+						m_limiter = _enable;
+						m_ceiling = _ceiling;
+						m_limiterRelease = _release;
+						m_lookAhead = 0;
+						if (m_limiter == true) {
+							m_lookAhead = etk::max(int32_t(0), int32_t(_lookAhead*m_sampleRate + 0.5f));
+						}
+						updateTime();
+						resizeLimiter();
+					}
+					void setLink(bool _link) {
+						m_link = _link;
+						reset();
+					}
+					int32_t getLatency() {
+						return m_lookAhead;
+					}
+					float getGainReduction(int32_t _idChannel) {
+						if (    _idChannel < 0
+						     || _idChannel >= m_nbChannel) {
+							AA_DRAIN_ERROR("Request gain reduction of channel " << _idChannel << " out of [0.." << m_nbChannel << "[");
+							return 0.0f;
+						}
+						if (m_link == true) {
+							return m_lastGain[0];
+						}
+						return m_lastGain[_idChannel];
+					}
+					void process(float* _output, const float* _input, size_t _nbChunk) {
+						int32_t nbGroup = m_link == true ? 1 : m_nbChannel;
+						while (_nbChunk > 0) {
+							int32_t nbSample = etk::min(size_t(blockSize), _nbChunk);
+							detect(_input, nbSample);
+							for (int32_t ggg=0; ggg<nbGroup; ++ggg) {
+								float* level = &m_level[ggg*blockSize];
+								float* peak = &m_peak[ggg*blockSize];
+								float* gain = &m_gain[ggg*blockSize];
+								audio::algo::drain::vectorMath::powerToDb(level, level, nbSample, levelFloor);
+								if (    m_limiter == true
+								     && m_detector != audio::algo::drain::dynamicsDetector_peak) {
+									audio::algo::drain::vectorMath::powerToDb(peak, peak, nbSample, levelFloor);
+								}
+								computeGain(gain, level, nbSample);
+								smoothGain(gain, ggg, nbSample);
+								if (m_limiter == true) {
+									if (m_detector == audio::algo::drain::dynamicsDetector_peak) {
+										peak = level;
+									}
+									limit(gain, peak, ggg, nbSample);
+								}
+								m_lastGain[ggg] = gain[nbSample-1];
+								audio::algo::drain::vectorMath::dbToGain(gain, gain, nbSample);
+							}
+							apply(_output, _input, nbSample);
+							m_count += nbSample;
+							if (m_lookAhead != 0) {
+								m_delayPos = (m_delayPos + nbSample) % m_lookAhead;
+								m_windowPos = (m_windowPos + nbSample) % (m_lookAhead+1);
+							}
+							_input += nbSample*m_nbChannel;
+							_output += nbSample*m_nbChannel;
+							_nbChunk -= nbSample;
+						}
+					}
+				protected:
+					void updateTime() {
+						m_rmsCoef = timeToCoefficient(m_rmsTime, m_sampleRate);
+						m_attackCoef = timeToCoefficient(m_attack, m_sampleRate);
+						m_releaseCoef = timeToCoefficient(m_release, m_sampleRate);
+						m_limiterReleaseCoef = timeToCoefficient(m_limiterRelease, m_sampleRate);
+					}
+					void resizeLimiter() {
+						m_delayAudio.clear();
+						m_delayAudio.resize(m_nbChannel*m_lookAhead, 0.0f);
+						m_delayGain.clear();
+						m_delayGain.resize(m_nbChannel*m_lookAhead, 0.0f);
+						m_window.clear();
+						m_window.resize(m_nbChannel*(m_lookAhead+1), 0.0f);
+						m_windowSum.resize(m_nbChannel, 0.0);
+						m_dequeValue.resize(m_nbChannel*(m_lookAhead+1), 0.0f);
+						m_dequeIndex.resize(m_nbChannel*(m_lookAhead+1), 0);
+						m_dequeHead.resize(m_nbChannel, 0);
+						m_dequeSize.resize(m_nbChannel, 0);
+						reset();
+					}
+					/**
+					 * @brief Calculate the power of each group (maximum of the channels when linked).
+					 */
+					void detect(const float* _input, int32_t _nbSample) {
+						int32_t nbGroup = m_link == true ? 1 : m_nbChannel;
+						if (m_link == true) {
+							float* level = &m_level[0];
+							for (int32_t iii=0; iii<_nbSample; ++iii) {
+								float value = 0.0f;
+								for (int32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+									float power = _input[iii*m_nbChannel+ccc] * _input[iii*m_nbChannel+ccc];
+									value = power > value ? power : value;
+								}
+								level[iii] = value;
+							}
+						} else {
+							for (int32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+								float* level = &m_level[ccc*blockSize];
+								for (int32_t iii=0; iii<_nbSample; ++iii) {
+									level[iii] = _input[iii*m_nbChannel+ccc] * _input[iii*m_nbChannel+ccc];
+								}
+							}
+						}
+						if (m_detector == audio::algo::drain::dynamicsDetector_rms) {
+							// the limiter always works on the peaks
+							if (m_limiter == true) {
+								for (int32_t iii=0; iii<nbGroup*blockSize; ++iii) {
+									m_peak[iii] = m_level[iii];
+								}
+							}
+							float coef = m_rmsCoef;
+							for (int32_t ggg=0; ggg<nbGroup; ++ggg) {
+								float* level = &m_level[ggg*blockSize];
+								float power = m_rmsPower[ggg];
+								for (int32_t iii=0; iii<_nbSample; ++iii) {
+									power = coef*power + (1.0f-coef)*level[iii];
+									level[iii] = power;
+								}
+								m_rmsPower[ggg] = power;
+							}
+						}
+					}
+					/**
+					 * @brief Static curve of the compressor and expander (no dependency between samples ==> vectorized by the compiler).
+					 */
+					void computeGain(float* _gain, const float* _level, int32_t _nbSample) {
+						float threshold = m_threshold;
+						float slope = m_slope;
+						float knee = m_knee;
+						float halfKnee = m_knee*0.5f;
+						float invTwoKnee = m_knee > 0.0f ? 0.5f/m_knee : 0.0f;
+						float gateThreshold = m_gateThreshold;
+						float gateSlope = m_gateSlope;
+						float gateRange = -m_gateRange;
+						for (int32_t iii=0; iii<_nbSample; ++iii) {
+							float over = _level[iii] - threshold;
+							// quadratic interpolation in the knee: [-knee/2..knee/2]
+							float inKnee = over + halfKnee;
+							inKnee = inKnee > 0.0f ? inKnee : 0.0f;
+							inKnee = inKnee < knee ? inKnee : knee;
+							float compressor = over > halfKnee ? slope*over : slope*inKnee*inKnee*invTwoKnee;
+							float under = _level[iii] - gateThreshold;
+							float expander = under < 0.0f ? under*gateSlope : 0.0f;
+							expander = expander > gateRange ? expander : gateRange;
+							_gain[iii] = compressor + expander;
+						}
+					}
+					/**
+					 * @brief Attack/release smoothing of the gain and make-up gain.
+					 */
+					void smoothGain(float* _gain, int32_t _group, int32_t _nbSample) {
+						float attackCoef = m_attackCoef;
+						float releaseCoef = m_releaseCoef;
+						float value = m_gainSmooth[_group];
+						for (int32_t iii=0; iii<_nbSample; ++iii) {
+							float coef = _gain[iii] < value ? attackCoef : releaseCoef;
+							value = coef*value + (1.0f-coef)*_gain[iii];
+							_gain[iii] = value;
+						}
+						m_gainSmooth[_group] = value;
+						for (int32_t iii=0; iii<_nbSample; ++iii) {
+							_gain[iii] += m_makeUp;
+						}
+					}
+					/**
+					 * @brief Look-ahead limiter: the required gain of a sample is the minimum on the look-ahead window, then averaged on the same window.
+					 * All the values averaged to output a sample are smaller than its required gain: the ceiling is never exceeded, with a linear ramp of the gain in dB.
+					 * The compressor gain is delayed with the signal.
+					 */
+					void limit(float* _gain, const float* _peak, int32_t _group, int32_t _nbSample) {
+						int32_t windowSize = m_lookAhead + 1;
+						float* window = &m_window[_group*windowSize];
+						float* dequeValue = &m_dequeValue[_group*windowSize];
+						int64_t* dequeIndex = &m_dequeIndex[_group*windowSize];
+						float* delayGain = &m_delayGain[_group*m_lookAhead];
+						int32_t head = m_dequeHead[_group];
+						int32_t size = m_dequeSize[_group];
+						double sum = m_windowSum[_group];
+						float value = m_limiterGain[_group];
+						float releaseCoef = m_limiterReleaseCoef;
+						double invWindowSize = 1.0 / double(windowSize);
+						for (int32_t iii=0; iii<_nbSample; ++iii) {
+							int64_t index = m_count + iii;
+							float required = m_ceiling - (_peak[iii] + _gain[iii]);
+							required = required < 0.0f ? required : 0.0f;
+							// sliding minimum: remove the values bigger than the new one then the values out of the window
+							while (    size > 0
+							        && dequeValue[(head + size - 1) % windowSize] >= required) {
+								--size;
+							}
+							dequeValue[(head + size) % windowSize] = required;
+							dequeIndex[(head + size) % windowSize] = index;
+							++size;
+							if (dequeIndex[head] <= index - windowSize) {
+								head = (head + 1) % windowSize;
+								--size;
+							}
+							float minimum = dequeValue[head];
+							// average on the window
+							int32_t windowPos = (m_windowPos + iii) % windowSize;
+							sum += minimum - window[windowPos];
+							window[windowPos] = minimum;
+							float average = float(sum * invWindowSize);
+							value = average < value ? average : releaseCoef*value + (1.0f-releaseCoef)*average;
+							value = value < average ? value : average;
+							if (m_lookAhead != 0) {
+								int32_t delayPos = (m_delayPos + iii) % m_lookAhead;
+								float compressor = delayGain[delayPos];
+								delayGain[delayPos] = _gain[iii];
+								_gain[iii] = compressor + value;
+							} else {
+								_gain[iii] += value;
+							}
+						}
+						m_dequeHead[_group] = head;
+						m_dequeSize[_group] = size;
+						m_windowSum[_group] = sum;
+						m_limiterGain[_group] = value;
+					}
+					/**
+					 * @brief Apply the linear gain on the (delayed) signal.
+					 */
+					void apply(float* _output, const float* _input, int32_t _nbSample) {
+						for (int32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+							const float* gain = &m_gain[(m_link == true ? 0 : ccc)*blockSize];
+							if (m_lookAhead == 0) {
+								for (int32_t iii=0; iii<_nbSample; ++iii) {
+									_output[iii*m_nbChannel+ccc] = _input[iii*m_nbChannel+ccc] * gain[iii];
+								}
+								continue;
+							}
+							float* delay = &m_delayAudio[ccc*m_lookAhead];
+							int32_t pos = m_delayPos;
+							for (int32_t iii=0; iii<_nbSample; ++iii) {
+								float delayed = delay[pos];
+								delay[pos] = _input[iii*m_nbChannel+ccc];
+								_output[iii*m_nbChannel+ccc] = delayed * gain[iii];
+								++pos;
+								pos = pos == m_lookAhead ? 0 : pos;
+							}
+						}
+					}
+			};
+		}
+	}
+}
+
+audio::algo::drain::Dynamics::Dynamics() {
+	
+}
+
+audio::algo::drain::Dynamics::~Dynamics() {
+	
+}
+
+void audio::algo::drain::Dynamics::init(float _sampleRate, int8_t _nbChannel, enum audio::format _format) {
+	if (_format != audio::format_float) {
+		AA_DRAIN_CRITICAL("Request format for dynamics that not exist ... : " << _format);
+		return;
+	}
+	if (_nbChannel <= 0) {
+		AA_DRAIN_ERROR("Request dynamics with " << int32_t(_nbChannel) << " channel(s)");
+		return;
+	}
+	m_private = ememory::makeShared<DynamicsPrivate>();
+	if (m_private == null) {
+		AA_DRAIN_ERROR("can not allocate private data...");
+		return;
+	}
+	m_private->init(_sampleRate, _nbChannel);
+}
+
+void audio::algo::drain::Dynamics::reset() {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Dynamics does not init ...");
+		return;
+	}
+	m_private->reset();
+}
+
+etk::Vector<enum audio::format> audio::algo::drain::Dynamics::getSupportedFormat() {
+	etk::Vector<enum audio::format> out = audio::algo::drain::Dynamics::getNativeSupportedFormat();
+	return out;
+}
+
+etk::Vector<enum audio::format> audio::algo::drain::Dynamics::getNativeSupportedFormat() {
+	etk::Vector<enum audio::format> out;
+	out.pushBack(audio::format_float);
+	return out;
+}
+
+void audio::algo::drain::Dynamics::process(void* _output, const void* _input, size_t _nbChunk) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Dynamics does not init ...");
+		return;
+	}
+	m_private->process(reinterpret_cast<float*>(_output), reinterpret_cast<const float*>(_input), _nbChunk);
+}
+
+void audio::algo::drain::Dynamics::setDetector(enum audio::algo::drain::dynamicsDetector _detector, float _rmsTime) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Dynamics does not init ...");
+		return;
+	}
+	m_private->setDetector(_detector, _rmsTime);
+}
+
+void audio::algo::drain::Dynamics::setCompressor(float _threshold, float _ratio, float _knee) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Dynamics does not init ...");
+		return;
+	}
+	m_private->setCompressor(_threshold, _ratio, _knee);
+}
+
+void audio::algo::drain::Dynamics::setGate(float _threshold, float _ratio, float _range) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Dynamics does not init ...");
+		return;
+	}
+	m_private->setGate(_threshold, _ratio, _range);
+}
+
+void audio::algo::drain::Dynamics::setTime(float _attack, float _release) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Dynamics does not init ...");
+		return;
+	}
+	m_private->setTime(_attack, _release);
+}
+
+void audio::algo::drain::Dynamics::setMakeUpGain(float _gain) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Dynamics does not init ...");
+		return;
+	}
+	m_private->setMakeUpGain(_gain);
+}
+
+void audio::algo::drain::Dynamics::setLimiter(bool _enable, float _ceiling, float _lookAhead, float _release) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Dynamics does not init ...");
+		return;
+	}
+	m_private->setLimiter(_enable, _ceiling, _lookAhead, _release);
+}
+
+void audio::algo::drain::Dynamics::setLink(bool _link) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Dynamics does not init ...");
+		return;
+	}
+	m_private->setLink(_link);
+}
+
+int32_t audio::algo::drain::Dynamics::getLatency() {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Dynamics does not init ...");
+		return 0;
+	}
+	return m_private->getLatency();
+}
+
+float audio::algo::drain::Dynamics::getGainReduction(int32_t _idChannel) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Dynamics does not init ...");
+		return 0.0f;
+	}
+	return m_private->getGainReduction(_idChannel);
+}
+
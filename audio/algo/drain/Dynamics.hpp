@@ -0,0 +1,131 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <etk/types.hpp>
+#include <ememory/memory.hpp>
+#include <etk/Vector.hpp>
+#include <audio/format.hpp>
+
+namespace audio {
+	namespace algo {
+		namespace drain {
+			/**
+			 * @brief Level detector of the dynamics processor.
+			 */
+			enum dynamicsDetector {
+				dynamicsDetector_peak, //!< absolute value of each sample
+				dynamicsDetector_rms, //!< mean power on the RMS time
+			};
+			class DynamicsPrivate;
+			/**
+			 * @brief Dynamics processor: compressor, downward expander (gate) and look-ahead limiter.
+			 * The gain is calculated in dB: detector ==> gain computer (compressor + expander) ==> attack/release smoothing ==> make-up gain ==> limiter.
+			 * The limiter delays the signal by the look-ahead time, the gain reaches the exact limit when the peak is output (no overshoot).
+			 * With the channel link, the same gain is applied on all the channels (the level is the maximum of the channels): the stereo image is kept.
+			 */
+			class Dynamics {
+				public:
+					/**
+					 * @brief Constructor
+					 */
+					Dynamics();
+					/**
+					 * @brief Destructor
+					 */
+					virtual ~Dynamics();
+				public:
+					/**
+					 * @brief Reset all history of the Algo.
+					 */
+					void reset();
+					/**
+					 * @brief Initialize the Algorithm
+					 * @param[in] _sampleRate Sample rate of the stream.
+					 * @param[in] _nbChannel Number of channel in the stream.
+					 * @param[in] _format Input data format.
+					 */
+					virtual void init(float _sampleRate=48000, int8_t _nbChannel=2, enum audio::format _format=audio::format_float);
+					/**
+					 * @brief Get list of format suported in input.
+					 * @return list of supported format
+					 */
+					virtual etk::Vector<enum audio::format> getSupportedFormat();
+					/**
+					 * @brief Get list of algorithm format suported. No format convertion.
+					 * @return list of supported format
+					 */
+					virtual etk::Vector<enum audio::format> getNativeSupportedFormat();
+					/**
+					 * @brief Main input algo process (no allocation, can be done in place).
+					 * @param[in,out] _output Output data.
+					 * @param[in] _input Input data.
+					 * @param[in] _nbChunk Number of chunk in the input buffer.
+					 */
+					virtual void process(void* _output, const void* _input, size_t _nbChunk);
+				public:
+					/**
+					 * @brief Set the level detector (default: peak).
+					 * @param[in] _detector Type of detector.
+					 * @param[in] _rmsTime Integration time of the RMS detector (second).
+					 */
+					void setDetector(enum audio::algo::drain::dynamicsDetector _detector, float _rmsTime=0.01f);
+					/**
+					 * @brief Set the compressor (default: threshold 0 dB, ratio 1: no compression).
+					 * @param[in] _threshold Level where the compression starts (dB).
+					 * @param[in] _ratio Input level variation for 1 dB of output level variation over the threshold [1..inf].
+					 * @param[in] _knee Width of the soft knee around the threshold (dB).
+					 */
+					void setCompressor(float _threshold, float _ratio, float _knee=0.0f);
+					/**
+					 * @brief Set the downward expander / gate (default: threshold -200 dB: disable).
+					 * @param[in] _threshold Level under which the signal is attenuated (dB).
+					 * @param[in] _ratio Output level variation for 1 dB of input level variation under the threshold [1..inf] (a big value is a gate).
+					 * @param[in] _range Maximum attenuation (dB, positive).
+					 */
+					void setGate(float _threshold, float _ratio=10.0f, float _range=80.0f);
+					/**
+					 * @brief Set the attack and release time of the compressor and expander gain.
+					 * @param[in] _attack Time constant of a gain decrease (second).
+					 * @param[in] _release Time constant of a gain increase (second).
+					 */
+					void setTime(float _attack, float _release);
+					/**
+					 * @brief Set the gain applied after the compressor (before the limiter).
+					 * @param[in] _gain Gain (dB).
+					 */
+					void setMakeUpGain(float _gain);
+					/**
+					 * @brief Set the limiter (allocate the delay lines: not in the real-time thread).
+					 * @param[in] _enable Enable the limiter.
+					 * @param[in] _ceiling Maximum output level (dB).
+					 * @param[in] _lookAhead Delay of the signal to anticipate the peaks (second).
+					 * @param[in] _release Time constant of the gain increase after a peak (second).
+					 */
+					void setLimiter(bool _enable, float _ceiling=-0.1f, float _lookAhead=0.005f, float _release=0.05f);
+					/**
+					 * @brief Link the channels: the same gain is applied on all the channels (default: true).
+					 * @param[in] _link Enable the link.
+					 */
+					void setLink(bool _link);
+					/**
+					 * @brief Get the algorithm latency.
+					 * @return Latency in sample (look-ahead of the limiter).
+					 */
+					int32_t getLatency();
+					/**
+					 * @brief Get the current gain reduction (for a display).
+					 * @param[in] _idChannel Id of the channel (0 if the channels are linked).
+					 * @return Gain applied on the last processed sample (dB).
+					 */
+					float getGainReduction(int32_t _idChannel=0);
+				protected:
+					ememory::SharedPtr<DynamicsPrivate> m_private; //!< private data.
+			};
+		}
+	}
+}
+
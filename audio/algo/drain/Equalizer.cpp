@@ -7,26 +7,146 @@
 #include <audio/algo/drain/Equalizer.hpp>
 #include <audio/algo/drain/debug.hpp>
 #include <audio/algo/drain/BiQuad.hpp>
+#include <audio/algo/drain/BiQuadCache.hpp>
+#include <audio/algo/drain/VectorMath.hpp>
 #include <audio/types.hpp>
+#include <echrono/Steady.hpp>
+#include <etk/uri/uri.hpp>
 
 
 // see http://www.musicdsp.org/files/Audio-EQ-Cookbook.txt
 // see http://www.earlevel.com/main/2013/10/13/biquad-calculator-v2/
 
+// Number of block processed with each kernel during a calibration (the fastest block is kept: less sensible to the interruptions).
+static const int32_t calibrationNbBlock = 32;
+// Maximum difference between a kernel and the direct form I, relative to the signal amplitude (-60 dB).
+static const double calibrationTolerance = 1.0e-3;
+// Relative precision of a float (2^-24).
+static const double floatEpsilon = 5.9604644775390625e-08;
+// Number of chunk processed between two updates of the dynamic bands.
+static const size_t dynamicBlockSize = 32;
+
+/**
+ * @brief Gain of the round-off noise injected in the recursion of a direct form I: sum of h[n]^2 of 1/(1 + b0.z^-1 + b1.z^-2).
+ * @return The power gain (very big for the poles close to the unit circle, 1e300 if unstable).
+ */
+static double getNoiseGain(const audio::algo::drain::BiQuadCoefficient& _coef) {
+	double b0 = _coef.m_b[0];
+	double b1 = _coef.m_b[1];
+	double denominator = (1.0 - b1) * ((1.0 + b1)*(1.0 + b1) - b0*b0);
+	if (denominator <= 0.0) {
+		return 1.0e300;
+	}
+	return (1.0 + b1) / denominator;
+}
+
+/**
+ * @brief Only the float flow can be processed with some stages in double (the fixed point types have their own precision, double is already in double).
+ */
+template<typename TYPE> static bool isMixedPrecisionAvaillable() {
+	return false;
+}
+template<> bool isMixedPrecisionAvaillable<audio::float_t>() {
+	return true;
+}
+
 namespace audio {
 	namespace algo {
 		namespace drain {
+			/**
+			 * @brief Description of a bi-quad: parameters (kept to calculate it again on a sample rate change) and coefficients in double.
+			 */
+			class EqualizerBand {
+				public:
+					bool m_parametric; //!< false: the bi-quad has been set with direct coefficients
+					enum audio::algo::drain::biQuadType m_type; //!< type of the bi-quad
+					double m_frequencyCut; //!< cut frequency
+					double m_qualityFactor; //!< Q factor
+					double m_gain; //!< gain in dB
+					audio::algo::drain::BiQuadCoefficient m_coef; //!< coefficients in double precision
+					bool m_double; //!< the stage is processed in double (m_biquadDouble) instead of the flow type
+					audio::algo::drain::BiQuad<audio::double_t> m_biquadDouble; //!< filter used when m_double is set
+					bool m_dynamic; //!< the gain follows the level of the side-chain
+					audio::algo::drain::EqualizerDynamic m_dynamicParam; //!< configuration of the dynamic band
+					double m_tangent; //!< frequency part of the design: tan(pi.frequencyCut/sampleRate)
+					double m_qualityFactorLimited; //!< Q factor limited as in the design
+					audio::algo::drain::BiQuad<audio::double_t> m_sideChain; //!< band-pass of the level detection
+					float m_dynamicGain; //!< current gain magnitude of the dynamic band (dB)
+					float m_attackCoef; //!< smoothing coefficient of a gain increase (per update)
+					float m_releaseCoef; //!< smoothing coefficient of a gain decrease (per update)
+				public:
+					EqualizerBand(const audio::algo::drain::BiQuadCoefficient& _coef=audio::algo::drain::BiQuadCoefficient(),
+					              bool _parametric=false,
+					              enum audio::algo::drain::biQuadType _type=audio::algo::drain::biQuadType_none,
+					              double _frequencyCut=0.0,
+					              double _qualityFactor=0.0,
+					              double _gain=0.0) :
+					  m_parametric(_parametric),
+					  m_type(_type),
+					  m_frequencyCut(_frequencyCut),
+					  m_qualityFactor(_qualityFactor),
+					  m_gain(_gain),
+					  m_coef(_coef),
+					  m_double(false),
+					  m_dynamic(false),
+					  m_tangent(0.0),
+					  m_qualityFactorLimited(0.0),
+					  m_dynamicGain(0.0f),
+					  m_attackCoef(0.0f),
+					  m_releaseCoef(0.0f) {
+						
+					}
+					/**
+					 * @brief Calculate the parts of a dynamic band that depend on the sample rate (side-chain, frequency part of the design, time constants).
+					 * @param[in] _sampleRate Sample rate of the stream.
+					 */
+					void updateDynamic(float _sampleRate) {
+						double frequency = etk::min(etk::max(m_frequencyCut, 0.0), double(_sampleRate)*0.5);
+						m_tangent = tan(M_PI * frequency / _sampleRate);
+						m_qualityFactorLimited = etk::max(m_qualityFactor, 0.01);
+						double sideChainFrequency = m_dynamicParam.m_sideChainFrequency > 0.0 ? m_dynamicParam.m_sideChainFrequency : m_frequencyCut;
+						double sideChainQualityFactor = m_dynamicParam.m_sideChainQualityFactor > 0.0 ? m_dynamicParam.m_sideChainQualityFactor : m_qualityFactor;
+						m_sideChain.updateBiquadCoef(audio::algo::drain::biQuadDesign(audio::algo::drain::biQuadType_bandPass, sideChainFrequency, sideChainQualityFactor, 0.0, _sampleRate));
+						double updateRate = _sampleRate / double(dynamicBlockSize);
+						m_attackCoef = m_dynamicParam.m_attack > 0.0 ? exp(-1.0 / (m_dynamicParam.m_attack * updateRate)) : 0.0;
+						m_releaseCoef = m_dynamicParam.m_release > 0.0 ? exp(-1.0 / (m_dynamicParam.m_release * updateRate)) : 0.0;
+					}
+					/**
+					 * @brief Move the gain of a dynamic band to its target for a side-chain level.
+					 * @param[in] _level Level of the side-chain (dB).
+					 * @return Gain magnitude (dB).
+					 */
+					float updateDynamicGain(float _level) {
+						float over = _level - float(m_dynamicParam.m_threshold);
+						float target = over > 0.0f ? over * float(1.0 - 1.0/m_dynamicParam.m_ratio) : 0.0f;
+						target = etk::min(target, float(etk::abs(m_gain)));
+						float coef = target > m_dynamicGain ? m_attackCoef : m_releaseCoef;
+						m_dynamicGain = coef*m_dynamicGain + (1.0f-coef)*target;
+						return m_dynamicGain;
+					}
+					/**
+					 * @brief Process a sample in double.
+					 */
+					template<typename TYPE> TYPE processDouble(TYPE _sample) {
+						return TYPE(m_biquadDouble.process(audio::double_t(_sample.getDouble())).getDouble());
+					}
+					template<typename TYPE> TYPE processTransposedDouble(TYPE _sample) {
+						return TYPE(m_biquadDouble.processTransposed(audio::double_t(_sample.getDouble())).getDouble());
+					}
+			};
 			class EqualizerPrivate {
 				protected:
 					float m_sampleRate;
 					int8_t m_nbChannel;
+					enum audio::algo::drain::equalizerKernel m_kernel; //!< processing structure in use
 				public:
 					/**
 					 * @brief Constructor
 					 */
 					EqualizerPrivate() :
 					  m_sampleRate(48000),
-					  m_nbChannel(2) {
+					  m_nbChannel(2),
+					  m_kernel(audio::algo::drain::equalizerKernel_directForm1) {
 						
 					}
 					/**
@@ -49,6 +169,11 @@ namespace audio {
 						m_sampleRate = _sampleRate;
 						m_nbChannel = _nbChannel;
 					};
+					/**
+					 * @brief Change the sample rate: all the parametric bi-quad are calculated again, the history is kept.
+					 * @param[in] _sampleRate New sample rate of the stream.
+					 */
+					virtual void setSampleRate(float _sampleRate) = 0;
 					/**
 					 * @brief Main input algo process.
 					 * @param[in,out] _output Output data.
@@ -56,6 +181,43 @@ namespace audio {
 					 * @param[in] _nbChunk Number of chunk in the input buffer.
 					 */
 					virtual void process(void* _output, const void* _input, size_t _nbChunk) = 0;
+					/**
+					 * @brief Select the processing structure (the history is reset).
+					 * @param[in] _kernel New kernel.
+					 */
+					virtual void setKernel(enum audio::algo::drain::equalizerKernel _kernel) = 0;
+					/**
+					 * @brief Get the processing structure in use.
+					 */
+					enum audio::algo::drain::equalizerKernel getKernel() {
+						return m_kernel;
+					}
+					/**
+					 * @brief Measure all the kernels on a block and select the fastest one that give the same result as the direct form I.
+					 * @param[in] _blockSize Number of chunk of a process call.
+					 * @return The selected kernel.
+					 */
+					virtual enum audio::algo::drain::equalizerKernel calibrate(size_t _blockSize) = 0;
+					/**
+					 * @brief Configure the automatic selection of the stages processed in double.
+					 * @param[in] _enable Enable the selection (else all the stages are processed in the flow type).
+					 * @param[in] _noiseFloor Maximum round-off noise of a stage (dB relative to the signal).
+					 */
+					virtual void setMixedPrecision(bool _enable, double _noiseFloor) = 0;
+					/**
+					 * @brief Get the number of stage processed in double (all the channels).
+					 */
+					virtual int32_t getNbDoubleStage() = 0;
+					/**
+					 * @brief Get the number of channel.
+					 */
+					int8_t getNbChannel() {
+						return m_nbChannel;
+					}
+					/**
+					 * @brief Get the maximum number of bi-quad of a channel.
+					 */
+					virtual int32_t getNbStage() = 0;
 				public:
 					/**
 					 * @brief add a biquad with his value.
@@ -72,6 +234,16 @@ namespace audio {
 					 */
 					virtual bool addBiquad(audio::algo::drain::biQuadType _type, double _frequencyCut, double _qualityFactor, double _gain) = 0;
 					virtual bool addBiquad(int32_t _idChannel, audio::algo::drain::biQuadType _type, double _frequencyCut, double _qualityFactor, double _gain) = 0;
+					virtual bool addBiquad(int32_t _idChannel, audio::algo::drain::biQuadType _type, double _frequencyCut, double _qualityFactor, double _gain, const audio::algo::drain::BiQuadCoefficient& _coef) = 0;
+					virtual bool addBiquad(int32_t _idChannel, audio::algo::drain::biQuadType _type, double _frequencyCut, double _qualityFactor, double _gain, const audio::algo::drain::EqualizerDynamic& _dynamic) = 0;
+					/**
+					 * @brief Change the design of an existing bi-quad (no allocation, the history is kept).
+					 */
+					virtual bool setBiquad(int32_t _idChannel, int32_t _idStage, audio::algo::drain::biQuadType _type, double _frequencyCut, double _qualityFactor, double _gain, const audio::algo::drain::BiQuadCoefficient& _coef) = 0;
+					/**
+					 * @brief Get the current gain of a dynamic bi-quad (dB).
+					 */
+					virtual double getDynamicGain(int32_t _idChannel, int32_t _idStage) = 0;
 				public:
 					// for debug & tools only
 					virtual etk::Vector<etk::Pair<float,float> > calculateTheory() = 0;
@@ -79,11 +251,26 @@ namespace audio {
 			template<typename TYPE> class EqualizerPrivateType : public audio::algo::drain::EqualizerPrivate {
 				protected:
 					etk::Vector<etk::Vector<audio::algo::drain::BiQuad<TYPE> > > m_biquads;
+					etk::Vector<etk::Vector<audio::algo::drain::EqualizerBand> > m_bands; //!< description of each bi-quad of m_biquads
+					int32_t m_crossNbStage; //!< number of stage of the cross channel kernel (the channels with less bi-quads are completed with pass threw stages)
+					etk::Vector<TYPE> m_crossCoef; //!< coefficients of the cross channel kernel [stage][a0, a1, a2, b0, b1][channel]
+					etk::Vector<TYPE> m_crossHistory; //!< history of the cross channel kernel [stage][x1, x2, y1, y2][channel]
+					etk::Vector<uint8_t> m_crossDouble; //!< the stage of the cross channel kernel has at least one channel in double [stage]
+					etk::Vector<double> m_historySave; //!< history of all the channels of a stage while its precision change [channel][x1, x2, y1, y2]
+					bool m_mixedPrecision; //!< the stages with a too big round-off noise are processed in double
+					double m_noiseFloor; //!< maximum round-off noise of a stage in the flow type (dB)
+					int32_t m_nbDynamic; //!< number of dynamic stage (all the channels)
+					etk::Vector<float> m_dynamicLevel; //!< side-chain level of each dynamic stage (power then dB)
+					etk::Vector<float> m_dynamicGain; //!< gain of each dynamic stage (dB then linear)
 				public:
 					/**
 					 * @brief Constructor
 					 */
-					EqualizerPrivateType() {
+					EqualizerPrivateType() :
+					  m_crossNbStage(0),
+					  m_mixedPrecision(false),
+					  m_noiseFloor(-100.0),
+					  m_nbDynamic(0) {
 						
 					}
 					/**
@@ -98,59 +285,585 @@ namespace audio {
 								m_biquads[jjj][iii].reset();
 							}
 						}
+						for (size_t iii=0; iii<m_crossHistory.size(); ++iii) {
+							m_crossHistory[iii] = 0;
+						}
+						for (size_t jjj=0; jjj<m_bands.size(); ++jjj) {
+							for (size_t iii=0; iii<m_bands[jjj].size(); ++iii) {
+								m_bands[jjj][iii].m_biquadDouble.reset();
+								m_bands[jjj][iii].m_sideChain.reset();
+								m_bands[jjj][iii].m_dynamicGain = 0.0f;
+							}
+						}
+					}
+					virtual void setMixedPrecision(bool _enable, double _noiseFloor) {
+						m_mixedPrecision = _enable;
+						m_noiseFloor = _noiseFloor;
+						int32_t nbStage = getNbStage();
+						for (int32_t sss=0; sss<nbStage; ++sss) {
+							updateStagePrecision(sss);
+						}
+						updateCrossChannel();
+					}
+					virtual int32_t getNbDoubleStage() {
+						int32_t out = 0;
+						for (size_t jjj=0; jjj<m_bands.size(); ++jjj) {
+							for (size_t iii=0; iii<m_bands[jjj].size(); ++iii) {
+								if (m_bands[jjj][iii].m_double == true) {
+									out++;
+								}
+							}
+						}
+						return out;
+					}
+					/**
+					 * @brief Select the precision of a stage from the round-off noise of its recursion: about 5 roundings of epsilon amplified by the noise gain.
+					 * @param[in,out] _band Stage to update (the double filter coefficients are updated, the history is moved by updateStagePrecision).
+					 */
+					void updatePrecision(audio::algo::drain::EqualizerBand& _band) {
+						bool isDouble = false;
+						if (    m_mixedPrecision == true
+						     && isMixedPrecisionAvaillable<TYPE>() == true) {
+							double noise = 10.0*log10(5.0 * getNoiseGain(_band.m_coef) * floatEpsilon*floatEpsilon);
+							isDouble = noise > m_noiseFloor;
+						}
+						if (    isDouble == true
+						     && _band.m_double == false) {
+							_band.m_biquadDouble.setBiquadCoef(_band.m_coef);
+						} else {
+							_band.m_biquadDouble.updateBiquadCoef(_band.m_coef);
+						}
+						_band.m_double = isDouble;
+					}
+					/**
+					 * @brief Get the history of a stage from the filter that process it (depend on the kernel and on the precision).
+					 * @param[in] _idChannel Id of the channel.
+					 * @param[in] _idStage Id of the stage in the channel.
+					 * @param[out] _history x1, x2, y1, y2.
+					 */
+					void getStageHistory(int32_t _idChannel, int32_t _idStage, double* _history) {
+						if (    m_kernel == audio::algo::drain::equalizerKernel_crossChannel
+						     && _idStage < int32_t(m_crossDouble.size())
+						     && m_crossDouble[_idStage] == 0) {
+							const TYPE* history = &m_crossHistory[_idStage*4*m_nbChannel];
+							for (int32_t iii=0; iii<4; ++iii) {
+								_history[iii] = history[iii*m_nbChannel + _idChannel].getDouble();
+							}
+						} else if (m_bands[_idChannel][_idStage].m_double == true) {
+							m_bands[_idChannel][_idStage].m_biquadDouble.getHistory(_history);
+						} else {
+							m_biquads[_idChannel][_idStage].getHistory(_history);
+						}
+					}
+					/**
+					 * @brief Set the history of a stage in the filter that process it (depend on the kernel and on the precision).
+					 * @param[in] _idChannel Id of the channel.
+					 * @param[in] _idStage Id of the stage in the channel.
+					 * @param[in] _history x1, x2, y1, y2.
+					 */
+					void setStageHistory(int32_t _idChannel, int32_t _idStage, const double* _history) {
+						if (    m_kernel == audio::algo::drain::equalizerKernel_crossChannel
+						     && _idStage < int32_t(m_crossDouble.size())
+						     && m_crossDouble[_idStage] == 0) {
+							TYPE* history = &m_crossHistory[_idStage*4*m_nbChannel];
+							for (int32_t iii=0; iii<4; ++iii) {
+								history[iii*m_nbChannel + _idChannel] = TYPE(_history[iii]);
+							}
+						} else if (m_bands[_idChannel][_idStage].m_double == true) {
+							m_bands[_idChannel][_idStage].m_biquadDouble.setHistory(_history);
+						} else {
+							m_biquads[_idChannel][_idStage].setHistory(_history);
+						}
+					}
+					/**
+					 * @brief Select the precision of a stage on all the channels (the new coefficients are already set) and move the history in the filters that process it now.
+					 * A stage that change of precision (or of cross channel path) continue with its history: no discontinuity on the signal.
+					 * @param[in] _idStage Id of the stage.
+					 */
+					void updateStagePrecision(int32_t _idStage) {
+						for (int32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+							if (_idStage < int32_t(m_bands[ccc].size())) {
+								getStageHistory(ccc, _idStage, &m_historySave[ccc*4]);
+							}
+						}
+						bool crossDouble = false;
+						for (int32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+							if (_idStage < int32_t(m_bands[ccc].size())) {
+								updatePrecision(m_bands[ccc][_idStage]);
+								crossDouble = crossDouble || m_bands[ccc][_idStage].m_double;
+							}
+						}
+						if (    m_kernel == audio::algo::drain::equalizerKernel_crossChannel
+						     && _idStage < int32_t(m_crossDouble.size())) {
+							m_crossDouble[_idStage] = crossDouble == true ? 1 : 0;
+						}
+						for (int32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+							if (_idStage < int32_t(m_bands[ccc].size())) {
+								setStageHistory(ccc, _idStage, &m_historySave[ccc*4]);
+							}
+						}
+					}
+					/**
+					 * @brief Add a stage on one or all the channels.
+					 * @param[in] _idChannel Id of the channel (-1 for all).
+					 * @param[in] _band Description of the stage.
+					 * @return false The channel does not exist.
+					 */
+					bool addStage(int32_t _idChannel, const audio::algo::drain::EqualizerBand& _band) {
+						if (_idChannel >= int32_t(m_biquads.size())) {
+							return false;
+						}
+						audio::algo::drain::BiQuad<TYPE> bq;
+						bq.setBiquadCoef(_band.m_coef);
+						audio::algo::drain::EqualizerBand band = _band;
+						updatePrecision(band);
+						for (size_t iii=0; iii<m_biquads.size(); ++iii) {
+							if (    _idChannel >= 0
+							     && size_t(_idChannel) != iii) {
+								continue;
+							}
+							m_biquads[iii].pushBack(bq);
+							m_bands[iii].pushBack(band);
+							if (band.m_dynamic == true) {
+								m_nbDynamic++;
+							}
+						}
+						// the batch buffers are allocated here, not in process
+						m_dynamicLevel.resize(m_nbDynamic, 0.0f);
+						m_dynamicGain.resize(m_nbDynamic, 0.0f);
+						updateCrossChannel();
+						return true;
+					}
+					virtual int32_t getNbStage() {
+						int32_t out = 0;
+						for (size_t jjj=0; jjj<m_biquads.size(); ++jjj) {
+							out = etk::max(out, int32_t(m_biquads[jjj].size()));
+						}
+						return out;
+					}
+					/**
+					 * @brief Update the coefficients of the cross channel kernel (the history of the existing stages is kept).
+					 */
+					void updateCrossChannel() {
+						if (m_kernel != audio::algo::drain::equalizerKernel_crossChannel) {
+							return;
+						}
+						m_crossNbStage = getNbStage();
+						m_crossCoef.resize(m_crossNbStage*5*m_nbChannel);
+						size_t oldSize = m_crossHistory.size();
+						m_crossHistory.resize(m_crossNbStage*4*m_nbChannel);
+						for (size_t iii=oldSize; iii<m_crossHistory.size(); ++iii) {
+							m_crossHistory[iii] = 0;
+						}
+						m_crossDouble.resize(m_crossNbStage);
+						for (int32_t sss=0; sss<m_crossNbStage; ++sss) {
+							TYPE* coef = &m_crossCoef[sss*5*m_nbChannel];
+							m_crossDouble[sss] = 0;
+							for (int32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+								if (    sss < int32_t(m_bands[ccc].size())
+								     && m_bands[ccc][sss].m_double == true) {
+									m_crossDouble[sss] = 1;
+								}
+								if (sss < int32_t(m_biquads[ccc].size())) {
+									m_biquads[ccc][sss].getBiquadCoef(coef[0*m_nbChannel + ccc],
+									                                  coef[1*m_nbChannel + ccc],
+									                                  coef[2*m_nbChannel + ccc],
+									                                  coef[3*m_nbChannel + ccc],
+									                                  coef[4*m_nbChannel + ccc]);
+								} else {
+									coef[0*m_nbChannel + ccc] = 1.0;
+									coef[1*m_nbChannel + ccc] = 0.0;
+									coef[2*m_nbChannel + ccc] = 0.0;
+									coef[3*m_nbChannel + ccc] = 0.0;
+									coef[4*m_nbChannel + ccc] = 0.0;
+								}
+							}
+						}
+					}
+					virtual void setKernel(enum audio::algo::drain::equalizerKernel _kernel) {
+						m_kernel = _kernel;
+						m_crossHistory.clear();
+						updateCrossChannel();
+						reset();
+					}
+					virtual enum audio::algo::drain::equalizerKernel calibrate(size_t _blockSize) {
+						static const enum audio::algo::drain::equalizerKernel listKernel[] = {
+							audio::algo::drain::equalizerKernel_directForm1,
+							audio::algo::drain::equalizerKernel_directForm1Cascade,
+							audio::algo::drain::equalizerKernel_transposedDirectForm2,
+							audio::algo::drain::equalizerKernel_crossChannel
+						};
+						_blockSize = etk::max(size_t(1), _blockSize);
+						etk::Vector<TYPE> input;
+						input.resize(_blockSize*m_nbChannel);
+						uint32_t seed = 12345;
+						for (size_t iii=0; iii<input.size(); ++iii) {
+							seed = seed*1664525 + 1013904223;
+							input[iii] = (double(seed>>8)/double(1<<24) - 0.5) * 0.5;
+						}
+						etk::Vector<TYPE> output;
+						output.resize(input.size());
+						etk::Vector<double> reference;
+						reference.resize(input.size(), 0.0);
+						double referenceMax = 0.0;
+						enum audio::algo::drain::equalizerKernel best = audio::algo::drain::equalizerKernel_directForm1;
+						echrono::Duration bestTime;
+						for (size_t kkk=0; kkk<sizeof(listKernel)/sizeof(listKernel[0]); ++kkk) {
+							setKernel(listKernel[kkk]);
+							echrono::Duration minTime;
+							for (int32_t bbb=0; bbb<calibrationNbBlock; ++bbb) {
+								echrono::Steady start = echrono::Steady::now();
+								process(&output[0], &input[0], _blockSize);
+								echrono::Duration time = echrono::Steady::now() - start;
+								if (    bbb == 0
+								     || time < minTime) {
+									minTime = time;
+								}
+							}
+							// same history: the last block must be the same as the reference one
+							double error = 0.0;
+							for (size_t iii=0; iii<output.size(); ++iii) {
+								double value = output[iii].getDouble();
+								if (kkk == 0) {
+									reference[iii] = value;
+									referenceMax = etk::max(referenceMax, etk::abs(value));
+								} else {
+									error = etk::max(error, etk::abs(value - reference[iii]));
+								}
+							}
+							AA_DRAIN_VERBOSE("Calibrate " << listKernel[kkk] << ": " << minTime << " error=" << error);
+							if (error > calibrationTolerance * referenceMax) {
+								AA_DRAIN_WARNING("Kernel " << listKernel[kkk] << " rejected: relative error=" << error/referenceMax);
+								continue;
+							}
+							if (    kkk == 0
+							     || minTime < bestTime) {
+								best = listKernel[kkk];
+								bestTime = minTime;
+							}
+						}
+						setKernel(best);
+						return best;
 					}
 					virtual void init(float _sampleRate=48000, int8_t _nbChannel=2) {
 						audio::algo::drain::EqualizerPrivate::init(_sampleRate, _nbChannel);
 						m_biquads.clear();
 						m_biquads.resize(_nbChannel);
+						m_bands.clear();
+						m_bands.resize(_nbChannel);
+						m_historySave.resize(_nbChannel*4, 0.0);
+						m_nbDynamic = 0;
+					}
+					virtual void setSampleRate(float _sampleRate) {
+						if (_sampleRate == m_sampleRate) {
+							return;
+						}
+						m_sampleRate = _sampleRate;
+						// direct design (not the cache): no lock and no allocation
+						for (size_t jjj=0; jjj<m_biquads.size(); ++jjj) {
+							for (size_t iii=0; iii<m_biquads[jjj].size(); ++iii) {
+								audio::algo::drain::EqualizerBand& band = m_bands[jjj][iii];
+								if (band.m_parametric == false) {
+									continue;
+								}
+								band.m_coef = audio::algo::drain::biQuadDesign(band.m_type, band.m_frequencyCut, band.m_qualityFactor, band.m_gain, m_sampleRate);
+								if (band.m_dynamic == true) {
+									// the coefficients of the current gain are set by the next process
+									band.updateDynamic(m_sampleRate);
+								}
+								m_biquads[jjj][iii].updateBiquadCoef(band.m_coef);
+							}
+						}
+						int32_t nbStage = getNbStage();
+						for (int32_t sss=0; sss<nbStage; ++sss) {
+							updateStagePrecision(sss);
+						}
+						updateCrossChannel();
 					}
 					virtual void process(void* _output, const void* _input, size_t _nbChunk) {
-						for (size_t jjj=0; jjj<m_nbChannel; ++jjj) {
-							// get pointer on data:
-							const TYPE* input = reinterpret_cast<const TYPE*>(_input);
-							TYPE* output = reinterpret_cast<TYPE*>(_output);
+						if (m_nbDynamic == 0) {
+							processBlock(_output, _input, _nbChunk);
+							return;
+						}
+						const TYPE* input = reinterpret_cast<const TYPE*>(_input);
+						TYPE* output = reinterpret_cast<TYPE*>(_output);
+						while (_nbChunk > 0) {
+							size_t nbChunk = etk::min(dynamicBlockSize, _nbChunk);
+							updateDynamic(input, nbChunk);
+							processBlock(output, input, nbChunk);
+							input += nbChunk*m_nbChannel;
+							output += nbChunk*m_nbChannel;
+							_nbChunk -= nbChunk;
+						}
+					}
+					/**
+					 * @brief Update the coefficients of all the dynamic stages from the level of the side-chains on a block.
+					 * The level conversions are done on all the stages at once (vectorMath), then only the gain part of each design is calculated again.
+					 * The new coefficients are set without reset of the history in the filter used by the current kernel.
+					 */
+					void updateDynamic(const TYPE* _input, size_t _nbChunk) {
+						int32_t id = 0;
+						for (int32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+							for (size_t sss=0; sss<m_bands[ccc].size(); ++sss) {
+								audio::algo::drain::EqualizerBand& band = m_bands[ccc][sss];
+								if (band.m_dynamic == false) {
+									continue;
+								}
+								double peak = 0.0;
+								for (size_t iii=0; iii<_nbChunk; ++iii) {
+									double value = band.m_sideChain.process(audio::double_t(_input[iii*m_nbChannel + ccc].getDouble())).getDouble();
+									peak = etk::max(peak, value*value);
+								}
+								m_dynamicLevel[id++] = peak;
+							}
+						}
+						audio::algo::drain::vectorMath::powerToDb(&m_dynamicLevel[0], &m_dynamicLevel[0], m_nbDynamic);
+						id = 0;
+						for (int32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+							for (size_t sss=0; sss<m_bands[ccc].size(); ++sss) {
+								audio::algo::drain::EqualizerBand& band = m_bands[ccc][sss];
+								if (band.m_dynamic == true) {
+									m_dynamicGain[id] = band.updateDynamicGain(m_dynamicLevel[id]);
+									id++;
+								}
+							}
+						}
+						audio::algo::drain::vectorMath::dbToGain(&m_dynamicGain[0], &m_dynamicGain[0], m_nbDynamic);
+						id = 0;
+						for (int32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+							for (size_t sss=0; sss<m_bands[ccc].size(); ++sss) {
+								audio::algo::drain::EqualizerBand& band = m_bands[ccc][sss];
+								if (band.m_dynamic == false) {
+									continue;
+								}
+								audio::algo::drain::BiQuadCoefficient coef = audio::algo::drain::biQuadDesignTangent(band.m_type, band.m_tangent, band.m_qualityFactorLimited, band.m_gain, m_dynamicGain[id++]);
+								if (band.m_double == true) {
+									band.m_biquadDouble.updateBiquadCoef(coef);
+								} else {
+									m_biquads[ccc][sss].updateBiquadCoef(coef);
+								}
+								if (m_kernel == audio::algo::drain::equalizerKernel_crossChannel) {
+									TYPE* crossCoef = &m_crossCoef[sss*5*m_nbChannel];
+									for (int32_t kkk=0; kkk<3; ++kkk) {
+										crossCoef[kkk*m_nbChannel + ccc] = coef.m_a[kkk];
+									}
+									for (int32_t kkk=0; kkk<2; ++kkk) {
+										crossCoef[(3+kkk)*m_nbChannel + ccc] = coef.m_b[kkk];
+									}
+								}
+							}
+						}
+					}
+					/**
+					 * @brief Process a block with the current coefficients.
+					 */
+					void processBlock(void* _output, const void* _input, size_t _nbChunk) {
+						switch (m_kernel) {
+							case audio::algo::drain::equalizerKernel_directForm1:
+								processDirectForm1(reinterpret_cast<TYPE*>(_output), reinterpret_cast<const TYPE*>(_input), _nbChunk);
+								break;
+							case audio::algo::drain::equalizerKernel_directForm1Cascade:
+								processDirectForm1Cascade(reinterpret_cast<TYPE*>(_output), reinterpret_cast<const TYPE*>(_input), _nbChunk);
+								break;
+							case audio::algo::drain::equalizerKernel_transposedDirectForm2:
+								processTransposedDirectForm2(reinterpret_cast<TYPE*>(_output), reinterpret_cast<const TYPE*>(_input), _nbChunk);
+								break;
+							case audio::algo::drain::equalizerKernel_crossChannel:
+								processCrossChannel(reinterpret_cast<TYPE*>(_output), reinterpret_cast<const TYPE*>(_input), _nbChunk);
+								break;
+						}
+					}
+					void processDirectForm1(TYPE* _output, const TYPE* _input, size_t _nbChunk) {
+						for (int32_t jjj=0; jjj<m_nbChannel; ++jjj) {
 							// move to sample offset:
-							input += jjj;
-							output += jjj;
+							const TYPE* input = _input + jjj;
+							TYPE* output = _output + jjj;
 							for (size_t iii=0; iii<m_biquads[jjj].size(); ++iii) {
-								m_biquads[jjj][iii].process(input, output, _nbChunk, m_nbChannel, m_nbChannel);
+								audio::algo::drain::EqualizerBand& band = m_bands[jjj][iii];
+								if (band.m_double == true) {
+									for (size_t kkk=0; kkk<_nbChunk; ++kkk) {
+										output[kkk*m_nbChannel] = band.processDouble(input[kkk*m_nbChannel]);
+									}
+								} else {
+									m_biquads[jjj][iii].process(input, output, _nbChunk, m_nbChannel, m_nbChannel);
+								}
+								// next stages are applied on the result of the previous one
+								input = output;
+							}
+						}
+					}
+					void processDirectForm1Cascade(TYPE* _output, const TYPE* _input, size_t _nbChunk) {
+						for (int32_t jjj=0; jjj<m_nbChannel; ++jjj) {
+							size_t nbStage = m_biquads[jjj].size();
+							if (nbStage == 0) {
+								continue;
+							}
+							audio::algo::drain::BiQuad<TYPE>* biquads = &m_biquads[jjj][0];
+							audio::algo::drain::EqualizerBand* bands = &m_bands[jjj][0];
+							const TYPE* input = _input + jjj;
+							TYPE* output = _output + jjj;
+							for (size_t iii=0; iii<_nbChunk; ++iii) {
+								TYPE sample = *input;
+								for (size_t sss=0; sss<nbStage; ++sss) {
+									if (bands[sss].m_double == true) {
+										sample = bands[sss].processDouble(sample);
+									} else {
+										sample = biquads[sss].process(sample);
+									}
+								}
+								*output = sample;
+								input += m_nbChannel;
+								output += m_nbChannel;
+							}
+						}
+					}
+					void processTransposedDirectForm2(TYPE* _output, const TYPE* _input, size_t _nbChunk) {
+						for (int32_t jjj=0; jjj<m_nbChannel; ++jjj) {
+							const TYPE* input = _input + jjj;
+							TYPE* output = _output + jjj;
+							for (size_t sss=0; sss<m_biquads[jjj].size(); ++sss) {
+								audio::algo::drain::EqualizerBand& band = m_bands[jjj][sss];
+								if (band.m_double == true) {
+									for (size_t iii=0; iii<_nbChunk; ++iii) {
+										output[iii*m_nbChannel] = band.processTransposedDouble(input[iii*m_nbChannel]);
+									}
+									input = output;
+									continue;
+								}
+								// local copy: the states stay in register
+								audio::algo::drain::BiQuad<TYPE> biquad = m_biquads[jjj][sss];
+								for (size_t iii=0; iii<_nbChunk; ++iii) {
+									output[iii*m_nbChannel] = biquad.processTransposed(input[iii*m_nbChannel]);
+								}
+								m_biquads[jjj][sss] = biquad;
+								input = output;
+							}
+						}
+					}
+					void processCrossChannel(TYPE* _output, const TYPE* _input, size_t _nbChunk) {
+						int32_t nbChannel = m_nbChannel;
+						for (size_t iii=0; iii<_nbChunk; ++iii) {
+							const TYPE* input = &_input[iii*nbChannel];
+							TYPE* output = &_output[iii*nbChannel];
+							for (int32_t sss=0; sss<m_crossNbStage; ++sss) {
+								if (m_crossDouble[sss] != 0) {
+									// at least one channel in double: no vectorization on this stage
+									for (int32_t ccc=0; ccc<nbChannel; ++ccc) {
+										if (sss >= int32_t(m_bands[ccc].size())) {
+											output[ccc] = input[ccc];
+										} else if (m_bands[ccc][sss].m_double == true) {
+											output[ccc] = m_bands[ccc][sss].processDouble(input[ccc]);
+										} else {
+											output[ccc] = m_biquads[ccc][sss].process(input[ccc]);
+										}
+									}
+									input = output;
+									continue;
+								}
+								const TYPE* coef = &m_crossCoef[sss*5*nbChannel];
+								TYPE* history = &m_crossHistory[sss*4*nbChannel];
+								for (int32_t ccc=0; ccc<nbChannel; ++ccc) {
+									TYPE sample = input[ccc];
+									TYPE result =   coef[ccc] * sample
+									              + coef[nbChannel + ccc] * history[ccc]
+									              + coef[2*nbChannel + ccc] * history[nbChannel + ccc]
+									              - coef[3*nbChannel + ccc] * history[2*nbChannel + ccc]
+									              - coef[4*nbChannel + ccc] * history[3*nbChannel + ccc];
+									history[nbChannel + ccc] = history[ccc];
+									history[ccc] = sample;
+									history[3*nbChannel + ccc] = history[2*nbChannel + ccc];
+									history[2*nbChannel + ccc] = result;
+									output[ccc] = result;
+								}
+								input = output;
 							}
 						}
 					}
 					virtual bool addBiquad(double _a0, double _a1, double _a2, double _b0, double _b1) {
-						audio::algo::drain::BiQuad<TYPE> bq;
-						bq.setBiquadCoef(_a0, _a1, _a2, _b0, _b1);
 						// add this bequad for every Channel:
-						for (size_t iii=0; iii<m_biquads.size(); ++iii) {
-							m_biquads[iii].pushBack(bq);
-						}
-						return true;
+						return addStage(-1, audio::algo::drain::EqualizerBand(audio::algo::drain::BiQuadCoefficient(_a0, _a1, _a2, _b0, _b1)));
 					}
 					virtual bool addBiquad(audio::algo::drain::biQuadType _type, double _frequencyCut, double _qualityFactor, double _gain) {
-						audio::algo::drain::BiQuad<TYPE> bq;
-						bq.setBiquad(_type, _frequencyCut, _qualityFactor, _gain, m_sampleRate);
-						// add this bequad for every Channel:
-						for (size_t iii=0; iii<m_biquads.size(); ++iii) {
-							m_biquads[iii].pushBack(bq);
-						}
-						return true;
+						return addStage(-1, audio::algo::drain::EqualizerBand(audio::algo::drain::BiQuadCache::get(_type, _frequencyCut, _qualityFactor, _gain, m_sampleRate),
+						                                                      true, _type, _frequencyCut, _qualityFactor, _gain));
 					}
 					virtual bool addBiquad(int32_t _idChannel, double _a0, double _a1, double _a2, double _b0, double _b1) {
-						audio::algo::drain::BiQuad<TYPE> bq;
-						bq.setBiquadCoef(_a0, _a1, _a2, _b0, _b1);
-						if (_idChannel<m_biquads.size()) {
-							m_biquads[_idChannel].pushBack(bq);
+						if (_idChannel >= 0) {
+							addStage(_idChannel, audio::algo::drain::EqualizerBand(audio::algo::drain::BiQuadCoefficient(_a0, _a1, _a2, _b0, _b1)));
 						}
 						return true;
 					}
 					virtual bool addBiquad(int32_t _idChannel, audio::algo::drain::biQuadType _type, double _frequencyCut, double _qualityFactor, double _gain) {
-						audio::algo::drain::BiQuad<TYPE> bq;
-						bq.setBiquad(_type, _frequencyCut, _qualityFactor, _gain, m_sampleRate);
-						if (_idChannel<m_biquads.size()) {
-							m_biquads[_idChannel].pushBack(bq);
+						if (_idChannel >= 0) {
+							addStage(_idChannel, audio::algo::drain::EqualizerBand(audio::algo::drain::BiQuadCache::get(_type, _frequencyCut, _qualityFactor, _gain, m_sampleRate),
+							                                                       true, _type, _frequencyCut, _qualityFactor, _gain));
 						}
 						return true;
 					}
+					virtual bool addBiquad(int32_t _idChannel, audio::algo::drain::biQuadType _type, double _frequencyCut, double _qualityFactor, double _gain, const audio::algo::drain::BiQuadCoefficient& _coef) {
+						return addStage(_idChannel, audio::algo::drain::EqualizerBand(_coef, true, _type, _frequencyCut, _qualityFactor, _gain));
+					}
+					virtual bool addBiquad(int32_t _idChannel, audio::algo::drain::biQuadType _type, double _frequencyCut, double _qualityFactor, double _gain, const audio::algo::drain::EqualizerDynamic& _dynamic) {
+						if (    _type != audio::algo::drain::biQuadType_peak
+						     && _type != audio::algo::drain::biQuadType_lowShelf
+						     && _type != audio::algo::drain::biQuadType_highShelf) {
+							AA_DRAIN_ERROR("Dynamic bi-quad is only available for peak, lowShelf and highShelf: " << _type);
+							return false;
+						}
+						if (_dynamic.m_ratio < 1.0) {
+							AA_DRAIN_ERROR("Dynamic bi-quad ratio must be >= 1 : " << _dynamic.m_ratio);
+							return false;
+						}
+						if (audio::algo::drain::biQuadCheck(_frequencyCut, _qualityFactor, _gain, m_sampleRate) == false) {
+							AA_DRAIN_ERROR("Can not design a dynamic bi-quad with f=" << _frequencyCut << " Q=" << _qualityFactor << " gain=" << _gain);
+							return false;
+						}
+						audio::algo::drain::EqualizerBand band(audio::algo::drain::biQuadDesign(_type, _frequencyCut, _qualityFactor, _gain, m_sampleRate),
+						                                       true, _type, _frequencyCut, _qualityFactor, _gain);
+						band.m_dynamic = true;
+						band.m_dynamicParam = _dynamic;
+						band.updateDynamic(m_sampleRate);
+						return addStage(_idChannel, band);
+					}
+					virtual bool setBiquad(int32_t _idChannel, int32_t _idStage, audio::algo::drain::biQuadType _type, double _frequencyCut, double _qualityFactor, double _gain, const audio::algo::drain::BiQuadCoefficient& _coef) {
+						for (int32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+							if (    _idChannel >= 0
+							     && _idChannel != ccc) {
+								continue;
+							}
+							if (    _idStage < 0
+							     || _idStage >= int32_t(m_bands[ccc].size())
+							     || m_bands[ccc][_idStage].m_dynamic == true) {
+								AA_DRAIN_ERROR("Request to set the stage " << _idStage << " of the channel " << ccc << " that does not exist (or is dynamic)");
+								return false;
+							}
+							audio::algo::drain::EqualizerBand& band = m_bands[ccc][_idStage];
+							band.m_parametric = true;
+							band.m_type = _type;
+							band.m_frequencyCut = _frequencyCut;
+							band.m_qualityFactor = _qualityFactor;
+							band.m_gain = _gain;
+							band.m_coef = _coef;
+							m_biquads[ccc][_idStage].updateBiquadCoef(_coef);
+						}
+						updateStagePrecision(_idStage);
+						updateCrossChannel();
+						return true;
+					}
+					virtual double getDynamicGain(int32_t _idChannel, int32_t _idStage) {
+						if (    _idChannel < 0
+						     || _idChannel >= m_nbChannel
+						     || _idStage < 0
+						     || _idStage >= int32_t(m_bands[_idChannel].size())) {
+							AA_DRAIN_ERROR("Request gain of the stage " << _idStage << " of the channel " << _idChannel << " that does not exist");
+							return 0.0;
+						}
+						const audio::algo::drain::EqualizerBand& band = m_bands[_idChannel][_idStage];
+						if (band.m_dynamic == false) {
+							return 0.0;
+						}
+						return band.m_gain < 0.0 ? -band.m_dynamicGain : band.m_dynamicGain;
+					}
 					virtual etk::Vector<etk::Pair<float,float> > calculateTheory() {
 						etk::Vector<etk::Pair<float,float> > out;
 						for (size_t iii=0; iii<m_biquads[0].size(); ++iii) {
@@ -170,7 +883,8 @@ namespace audio {
 	}
 }
 
-audio::algo::drain::Equalizer::Equalizer() {
+audio::algo::drain::Equalizer::Equalizer() :
+  m_format(audio::format_unknow) {
 	
 }
 
@@ -179,6 +893,7 @@ audio::algo::drain::Equalizer::~Equalizer() {
 }
 
 void audio::algo::drain::Equalizer::init(float _sampleRate, int8_t _nbChannel, enum audio::format _format) {
+	m_format = _format;
 	switch (_format) {
 		default:
 			AA_DRAIN_CRITICAL("Request format for equalizer that not exist ... : " << _format);
@@ -313,6 +1028,91 @@ void audio::algo::drain::Equalizer::process(void* _output, const void* _input, s
 	m_private->process(_output, _input, _nbChunk);
 }
 
+void audio::algo::drain::Equalizer::setSampleRate(float _sampleRate) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Equalizer does not init ...");
+		return;
+	}
+	m_private->setSampleRate(_sampleRate);
+}
+
+void audio::algo::drain::Equalizer::setKernel(enum audio::algo::drain::equalizerKernel _kernel) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Equalizer does not init ...");
+		return;
+	}
+	m_private->setKernel(_kernel);
+}
+
+enum audio::algo::drain::equalizerKernel audio::algo::drain::Equalizer::getKernel() {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Equalizer does not init ...");
+		return audio::algo::drain::equalizerKernel_directForm1;
+	}
+	return m_private->getKernel();
+}
+
+enum audio::algo::drain::equalizerKernel audio::algo::drain::Equalizer::calibrate(size_t _blockSize, const etk::String& _profileFileName) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Equalizer does not init ...");
+		return audio::algo::drain::equalizerKernel_directForm1;
+	}
+	// key of the configuration in the profile: "equalizer format nbChannel nbStage blockSize"
+	etk::String key =   "equalizer " + audio::getFormatString(m_format)
+	                  + " " + etk::toString(int32_t(m_private->getNbChannel()))
+	                  + " " + etk::toString(m_private->getNbStage())
+	                  + " " + etk::toString(_blockSize);
+	if (_profileFileName != "") {
+		ememory::SharedPtr<etk::io::Interface> fileIO = etk::uri::get(etk::Path(_profileFileName));
+		if (    fileIO != null
+		     && fileIO->open(etk::io::OpenMode::Read) == true) {
+			etk::String line;
+			while (fileIO->gets(line) == true) {
+				if (etk::start_with(line, key + " ") == false) {
+					continue;
+				}
+				enum audio::algo::drain::equalizerKernel kernel;
+				if (etk::from_string(kernel, etk::String(&line[key.size()+1])) == true) {
+					fileIO->close();
+					AA_DRAIN_DEBUG("Kernel from the profile: " << key << " ==> " << kernel);
+					m_private->setKernel(kernel);
+					return kernel;
+				}
+			}
+			fileIO->close();
+		}
+	}
+	enum audio::algo::drain::equalizerKernel kernel = m_private->calibrate(_blockSize);
+	AA_DRAIN_DEBUG("Kernel calibrated: " << key << " ==> " << kernel);
+	if (_profileFileName != "") {
+		ememory::SharedPtr<etk::io::Interface> fileIO = etk::uri::get(etk::Path(_profileFileName));
+		if (    fileIO == null
+		     || fileIO->open(etk::io::OpenMode::Append) == false) {
+			AA_DRAIN_ERROR("Can not write the profile file '" << _profileFileName << "'");
+			return kernel;
+		}
+		fileIO->puts(key + " " + etk::toString(kernel) + "\n");
+		fileIO->close();
+	}
+	return kernel;
+}
+
+void audio::algo::drain::Equalizer::setMixedPrecision(bool _enable, double _noiseFloor) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Equalizer does not init ...");
+		return;
+	}
+	m_private->setMixedPrecision(_enable, _noiseFloor);
+}
+
+int32_t audio::algo::drain::Equalizer::getNbDoubleStage() {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Equalizer does not init ...");
+		return 0;
+	}
+	return m_private->getNbDoubleStage();
+}
+
 bool audio::algo::drain::Equalizer::addBiquad(double _a0, double _a1, double _a2, double _b0, double _b1) {
 	if (m_private == null) {
 		AA_DRAIN_ERROR("Equalizer does not init ...");
@@ -342,6 +1142,37 @@ bool audio::algo::drain::Equalizer::addBiquad(int32_t _idChannel, audio::algo::d
 	}
 	return m_private->addBiquad(_idChannel, _type, _frequencyCut, _qualityFactor, _gain);
 }
+bool audio::algo::drain::Equalizer::addBiquad(int32_t _idChannel, audio::algo::drain::biQuadType _type, double _frequencyCut, double _qualityFactor, double _gain, const audio::algo::drain::BiQuadCoefficient& _coef) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Equalizer does not init ...");
+		return false;
+	}
+	return m_private->addBiquad(_idChannel, _type, _frequencyCut, _qualityFactor, _gain, _coef);
+}
+
+bool audio::algo::drain::Equalizer::addBiquad(int32_t _idChannel, audio::algo::drain::biQuadType _type, double _frequencyCut, double _qualityFactor, double _gain, const audio::algo::drain::EqualizerDynamic& _dynamic) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Equalizer does not init ...");
+		return false;
+	}
+	return m_private->addBiquad(_idChannel, _type, _frequencyCut, _qualityFactor, _gain, _dynamic);
+}
+
+bool audio::algo::drain::Equalizer::setBiquad(int32_t _idChannel, int32_t _idStage, audio::algo::drain::biQuadType _type, double _frequencyCut, double _qualityFactor, double _gain, const audio::algo::drain::BiQuadCoefficient& _coef) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Equalizer does not init ...");
+		return false;
+	}
+	return m_private->setBiquad(_idChannel, _idStage, _type, _frequencyCut, _qualityFactor, _gain, _coef);
+}
+
+double audio::algo::drain::Equalizer::getDynamicGain(int32_t _idChannel, int32_t _idStage) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Equalizer does not init ...");
+		return 0.0;
+	}
+	return m_private->getDynamicGain(_idChannel, _idStage);
+}
 
 etk::Vector<etk::Pair<float,float> > audio::algo::drain::Equalizer::calculateTheory() {
 	if (m_private == null) {
@@ -10,12 +10,43 @@
 #include <etk/Vector.hpp>
 #include <audio/format.hpp>
 #include <audio/algo/drain/BiQuadType.hpp>
+#include <audio/algo/drain/BiQuadDesign.hpp>
+#include <audio/algo/drain/EqualizerKernel.hpp>
+#include <etk/String.hpp>
 #include <etk/Pair.hpp>
 
 namespace audio {
 	namespace algo {
 		namespace drain {
 			class EqualizerPrivate;
+			/**
+			 * @brief Dynamic behavior of a band: the gain of the band follows the level of a side-chain band-pass filter on the input of the channel.
+			 * Under the threshold the band is flat (0 dB), over it the gain moves to the gain of the band: (level - threshold).(1 - 1/ratio), limited to the gain of the band.
+			 */
+			class EqualizerDynamic {
+				public:
+					double m_threshold; //!< level of the side-chain where the band starts to act (dB)
+					double m_ratio; //!< ratio of the gain change over the threshold [1..inf]
+					double m_sideChainFrequency; //!< center frequency of the side-chain band-pass (0: frequency of the band)
+					double m_sideChainQualityFactor; //!< Q of the side-chain band-pass (0: Q of the band)
+					double m_attack; //!< time constant of the gain move to the gain of the band (second)
+					double m_release; //!< time constant of the gain move back to 0 dB (second)
+				public:
+					EqualizerDynamic(double _threshold=-20.0,
+					                 double _ratio=2.0,
+					                 double _sideChainFrequency=0.0,
+					                 double _sideChainQualityFactor=0.0,
+					                 double _attack=0.005,
+					                 double _release=0.1) :
+					  m_threshold(_threshold),
+					  m_ratio(_ratio),
+					  m_sideChainFrequency(_sideChainFrequency),
+					  m_sideChainQualityFactor(_sideChainQualityFactor),
+					  m_attack(_attack),
+					  m_release(_release) {
+						
+					}
+			};
 			class Equalizer {
 				public:
 					/**
@@ -55,6 +86,44 @@ namespace audio {
 					 * @param[in] _nbChunk Number of chunk in the input buffer.
 					 */
 					virtual void process(void* _output, const void* _input, size_t _nbChunk);
+					/**
+					 * @brief Change the sample rate without removing the bi-quads.
+					 * @note The bi-quads added with a type are calculated again for the new sample rate (the ones added with direct coefficients are not modified).
+					 * @note The history of the filters is kept and there is no allocation: it can be called between two process.
+					 * @param[in] _sampleRate New sample rate of the stream.
+					 */
+					void setSampleRate(float _sampleRate);
+					/**
+					 * @brief Select the processing structure of the filters (the history is reset). Default: direct form I.
+					 * @param[in] _kernel New kernel.
+					 */
+					void setKernel(enum audio::algo::drain::equalizerKernel _kernel);
+					/**
+					 * @brief Get the processing structure in use.
+					 * @return Current kernel.
+					 */
+					enum audio::algo::drain::equalizerKernel getKernel();
+					/**
+					 * @brief Select the fastest kernel that give the same result as the direct form I (relative difference < -60 dB) for the current configuration.
+					 * It must be called after adding the bi-quads (the result depend on the number of channel and stage), out of the real-time thread (it takes some milli-seconds). The history is reset.
+					 * @param[in] _blockSize Number of chunk of the process calls.
+					 * @param[in] _profileFileName Per machine profile: the kernel is read in it if this configuration has already been measured, else the measure is added to it (empty: always measure).
+					 * @return The selected kernel.
+					 */
+					enum audio::algo::drain::equalizerKernel calibrate(size_t _blockSize=256, const etk::String& _profileFileName="");
+					/**
+					 * @brief Configure the mixed precision of the float flow (disable by default: all the stages in float).
+					 * The round-off noise of each stage is estimated from its poles (noise gain of the recursion): the stages over the noise floor (low frequency, high Q) are processed in double, the others stay in float.
+					 * At -100 dB only the low frequency, high Q stages are promoted (the peaks of 1 kHz and more stay in float).
+					 * @param[in] _enable Enable the mixed precision (false: all the stages in float).
+					 * @param[in] _noiseFloor Maximum round-off noise of a float stage (dB relative to the signal).
+					 */
+					void setMixedPrecision(bool _enable, double _noiseFloor=-100.0);
+					/**
+					 * @brief Get the number of stage processed in double.
+					 * @return Number of stage (sum on all the channels).
+					 */
+					int32_t getNbDoubleStage();
 				public:
 					/**
 					 * @brief add a biquad with his value.
@@ -71,10 +140,52 @@ namespace audio {
 					 */
 					bool addBiquad(audio::algo::drain::biQuadType _type, double _frequencyCut, double _qualityFactor, double _gain);
 					bool addBiquad(int32_t _idChannel, audio::algo::drain::biQuadType _type, double _frequencyCut, double _qualityFactor, double _gain);
+					/**
+					 * @brief add a bi-quad value and type with coefficients already calculated for the current sample rate (preset).
+					 * @param[in] _idChannel Id of the channel (-1 for all the channels).
+					 * @param[in] _type Type of biquad (used by setSampleRate).
+					 * @param[in] _frequencyCut Cut Frequency. [0..sampleRate/2]
+					 * @param[in] _qualityFactor Q factor of quality.
+					 * @param[in] _gain Gain to apply (dB).
+					 * @param[in] _coef Coefficients of the bi-quad at the current sample rate.
+					 */
+					bool addBiquad(int32_t _idChannel, audio::algo::drain::biQuadType _type, double _frequencyCut, double _qualityFactor, double _gain, const audio::algo::drain::BiQuadCoefficient& _coef);
+					/**
+					 * @brief add a dynamic bi-quad: its gain follows the level of a side-chain band (peak, lowShelf and highShelf only).
+					 * The coefficients are calculated again every 32 chunks without reset of the history (only the gain part of the design).
+					 * @note The precision of the stage (mixed precision) is selected with the design at the full gain.
+					 * @param[in] _idChannel Id of the channel (-1 for all the channels: each channel has its own side-chain).
+					 * @param[in] _type Type of biquad.
+					 * @param[in] _frequencyCut Cut Frequency. [0..sampleRate/2]
+					 * @param[in] _qualityFactor Q factor of quality.
+					 * @param[in] _gain Maximum gain of the band (dB, negative for a cut).
+					 * @param[in] _dynamic Threshold, ratio, side-chain and time constants.
+					 */
+					bool addBiquad(int32_t _idChannel, audio::algo::drain::biQuadType _type, double _frequencyCut, double _qualityFactor, double _gain, const audio::algo::drain::EqualizerDynamic& _dynamic);
+					/**
+					 * @brief Change the design of an existing bi-quad (no allocation and the history is kept: it can be called between two process, a graphic equalizer move its bands with it).
+					 * @param[in] _idChannel Id of the channel (-1 for all the channels).
+					 * @param[in] _idStage Id of the bi-quad in the channel (not a dynamic one).
+					 * @param[in] _type Type of biquad (used by setSampleRate).
+					 * @param[in] _frequencyCut Cut Frequency. [0..sampleRate/2]
+					 * @param[in] _qualityFactor Q factor of quality.
+					 * @param[in] _gain Gain to apply (dB).
+					 * @param[in] _coef Coefficients of the bi-quad at the current sample rate.
+					 * @return false The stage does not exist.
+					 */
+					bool setBiquad(int32_t _idChannel, int32_t _idStage, audio::algo::drain::biQuadType _type, double _frequencyCut, double _qualityFactor, double _gain, const audio::algo::drain::BiQuadCoefficient& _coef);
+					/**
+					 * @brief Get the current gain of a dynamic bi-quad.
+					 * @param[in] _idChannel Id of the channel.
+					 * @param[in] _idStage Id of the bi-quad in the channel.
+					 * @return Gain applied by the band (dB, 0 for a static band).
+					 */
+					double getDynamicGain(int32_t _idChannel, int32_t _idStage);
 				public:
 					// for debug & tools only
 					etk::Vector<etk::Pair<float,float> > calculateTheory();
 				protected:
+					enum audio::format m_format; //!< format of the data flow
 					ememory::SharedPtr<EqualizerPrivate> m_private; //!< private data (abstract the type of the data flow).
 			};
 		}
@@ -0,0 +1,376 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <audio/algo/drain/EqualizerBank.hpp>
+#include <audio/algo/drain/debug.hpp>
+#include <audio/algo/drain/BiQuadCache.hpp>
+
+// Number of stream processed at the same time (one lane of the vector per stream).
+static const int32_t laneSize = 16;
+// Number of sample processed between the load and the store of the biquad history.
+static const int32_t subBlockSize = 64;
+// Number of coefficient of a stage: a0, a1, a2, b0, b1
+static const int32_t nbCoef = 5;
+// Number of history value of a stage: x[n-1], x[n-2], y[n-1], y[n-2]
+static const int32_t nbHistory = 4;
+
+namespace audio {
+	namespace algo {
+		namespace drain {
+			/**
+			 * @brief Data of a group of laneSize streams. The group is allocated one time and never moved.
+			 */
+			class EqualizerBankGroup {
+				public:
+					etk::Vector<float> m_coef; //!< coefficients [stage][nbCoef][laneSize]
+					etk::Vector<float> m_history; //!< biquad history [stage][nbHistory][laneSize]
+					bool m_used[laneSize]; //!< the lane is attributed to a stream
+					int32_t m_nbStage[laneSize]; //!< number of configured stage of each lane (the next ones are bypassed)
+					int32_t m_nbUsed; //!< number of lane in use
+					int32_t m_nbStageActive; //!< number of stage to process for the group (max of m_nbStage)
+				public:
+					EqualizerBankGroup(int32_t _nbStage) :
+					  m_nbUsed(0),
+					  m_nbStageActive(0) {
+						m_coef.resize(_nbStage*nbCoef*laneSize, 0.0f);
+						m_history.resize(_nbStage*nbHistory*laneSize, 0.0f);
+						for (int32_t lll=0; lll<laneSize; ++lll) {
+							m_used[lll] = false;
+							m_nbStage[lll] = 0;
+						}
+						for (int32_t sss=0; sss<_nbStage; ++sss) {
+							for (int32_t lll=0; lll<laneSize; ++lll) {
+								m_coef[(sss*nbCoef)*laneSize + lll] = 1.0f;
+							}
+						}
+					}
+					void updateNbStageActive() {
+						m_nbStageActive = 0;
+						for (int32_t lll=0; lll<laneSize; ++lll) {
+							if (m_used[lll] == true) {
+								m_nbStageActive = etk::max(m_nbStageActive, m_nbStage[lll]);
+							}
+						}
+					}
+			};
+			class EqualizerBankPrivate {
+				protected:
+					float m_sampleRate;
+					int32_t m_nbStage;
+					etk::Vector<ememory::SharedPtr<EqualizerBankGroup> > m_groups; //!< all the groups of streams
+					etk::Vector<int32_t> m_free; //!< Id of the free stream slots
+					int32_t m_nbStream; //!< number of active stream
+					etk::Vector<float> m_buffer; //!< interleaved samples of a group [subBlockSize][laneSize]
+				public:
+					EqualizerBankPrivate() :
+					  m_sampleRate(48000),
+					  m_nbStage(0),
+					  m_nbStream(0) {
+						
+					}
+					void init(float _sampleRate, int32_t _nbStage) {
+						m_sampleRate = _sampleRate;
+						m_nbStage = _nbStage;
+						m_groups.clear();
+						m_free.clear();
+						m_nbStream = 0;
+						m_buffer.resize(subBlockSize*laneSize, 0.0f);
+					}
+					void reset() {
+						for (size_t ggg=0; ggg<m_groups.size(); ++ggg) {
+							etk::Vector<float>& history = m_groups[ggg]->m_history;
+							for (size_t iii=0; iii<history.size(); ++iii) {
+								history[iii] = 0.0f;
+							}
+						}
+					}
+					int32_t getNbStream() {
+						return m_nbStream;
+					}
+					int32_t addStream() {
+						if (m_free.size() == 0) {
+							ememory::SharedPtr<EqualizerBankGroup> group = ememory::makeShared<EqualizerBankGroup>(m_nbStage);
+							if (group == null) {
+								AA_DRAIN_ERROR("can not allocate a new stream group...");
+								return -1;
+							}
+							int32_t first = int32_t(m_groups.size())*laneSize;
+							m_groups.pushBack(group);
+							for (int32_t lll=laneSize-1; lll>=0; --lll) {
+								m_free.pushBack(first + lll);
+							}
+						}
+						// use the lowest free Id to keep the groups as full as possible
+						size_t best = 0;
+						for (size_t iii=1; iii<m_free.size(); ++iii) {
+							if (m_free[iii] < m_free[best]) {
+								best = iii;
+							}
+						}
+						int32_t id = m_free[best];
+						m_free[best] = m_free[m_free.size()-1];
+						m_free.popBack();
+						EqualizerBankGroup& group = *m_groups[id/laneSize];
+						int32_t lane = id%laneSize;
+						group.m_used[lane] = true;
+						group.m_nbStage[lane] = 0;
+						group.m_nbUsed++;
+						for (int32_t sss=0; sss<m_nbStage; ++sss) {
+							setLane(group.m_coef, sss, lane, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+						}
+						resetLane(group, lane);
+						m_nbStream++;
+						return id;
+					}
+					bool removeStream(int32_t _id) {
+						EqualizerBankGroup* group = getGroup(_id);
+						if (group == null) {
+							return false;
+						}
+						int32_t lane = _id%laneSize;
+						group->m_used[lane] = false;
+						group->m_nbUsed--;
+						group->updateNbStageActive();
+						m_free.pushBack(_id);
+						m_nbStream--;
+						return true;
+					}
+					void resetStream(int32_t _id) {
+						EqualizerBankGroup* group = getGroup(_id);
+						if (group == null) {
+							return;
+						}
+						resetLane(*group, _id%laneSize);
+					}
+					bool setBiquad(int32_t _id, int32_t _idStage, double _a0, double _a1, double _a2, double _b0, double _b1) {
+						EqualizerBankGroup* group = getGroup(_id);
+						if (group == null) {
+							return false;
+						}
+						if (    _idStage < 0
+						     || _idStage >= m_nbStage) {
+							AA_DRAIN_ERROR("Request stage " << _idStage << " with " << m_nbStage << " stage(s)");
+							return false;
+						}
+						int32_t lane = _id%laneSize;
+						setLane(group->m_coef, _idStage, lane, _a0, _a1, _a2, _b0, _b1);
+						group->m_nbStage[lane] = etk::max(group->m_nbStage[lane], _idStage+1);
+						group->updateNbStageActive();
+						return true;
+					}
+					bool setBiquad(int32_t _id, int32_t _idStage, audio::algo::drain::biQuadType _type, double _frequencyCut, double _qualityFactor, double _gain) {
+						audio::algo::drain::BiQuadCoefficient coef = audio::algo::drain::BiQuadCache::get(_type, _frequencyCut, _qualityFactor, _gain, m_sampleRate);
+						return setBiquad(_id, _idStage, coef.m_a[0], coef.m_a[1], coef.m_a[2], coef.m_b[0], coef.m_b[1]);
+					}
+					void process(float* const* _output, const float* const* _input, int32_t _nbStream, size_t _nbChunk) {
+						for (size_t ggg=0; ggg<m_groups.size(); ++ggg) {
+							EqualizerBankGroup& group = *m_groups[ggg];
+							if (group.m_nbUsed == 0) {
+								continue;
+							}
+							int32_t first = int32_t(ggg)*laneSize;
+							for (size_t offset=0; offset<_nbChunk; offset+=subBlockSize) {
+								int32_t nbSample = etk::min(size_t(subBlockSize), _nbChunk-offset);
+								// interleave the streams of the group (a missing stream receive silence)
+								for (int32_t lll=0; lll<laneSize; ++lll) {
+									const float* input = null;
+									if (    group.m_used[lll] == true
+									     && first + lll < _nbStream) {
+										input = _input[first + lll];
+									}
+									if (input == null) {
+										for (int32_t iii=0; iii<nbSample; ++iii) {
+											m_buffer[iii*laneSize + lll] = 0.0f;
+										}
+									} else {
+										input += offset;
+										for (int32_t iii=0; iii<nbSample; ++iii) {
+											m_buffer[iii*laneSize + lll] = input[iii];
+										}
+									}
+								}
+								for (int32_t sss=0; sss<group.m_nbStageActive; ++sss) {
+									processStage(&m_buffer[0], nbSample, &group.m_coef[sss*nbCoef*laneSize], &group.m_history[sss*nbHistory*laneSize]);
+								}
+								for (int32_t lll=0; lll<laneSize; ++lll) {
+									if (    group.m_used[lll] == false
+									     || first + lll >= _nbStream
+									     || _input[first + lll] == null
+									     || _output[first + lll] == null) {
+										continue;
+									}
+									float* output = _output[first + lll] + offset;
+									for (int32_t iii=0; iii<nbSample; ++iii) {
+										output[iii] = m_buffer[iii*laneSize + lll];
+									}
+								}
+							}
+						}
+					}
+				protected:
+					EqualizerBankGroup* getGroup(int32_t _id) {
+						if (    _id < 0
+						     || _id >= int32_t(m_groups.size())*laneSize
+						     || m_groups[_id/laneSize]->m_used[_id%laneSize] == false) {
+							AA_DRAIN_ERROR("Stream " << _id << " does not exist");
+							return null;
+						}
+						return m_groups[_id/laneSize].get();
+					}
+					void setLane(etk::Vector<float>& _coef, int32_t _idStage, int32_t _lane, double _a0, double _a1, double _a2, double _b0, double _b1) {
+						float* coef = &_coef[_idStage*nbCoef*laneSize + _lane];
+						coef[0*laneSize] = _a0;
+						coef[1*laneSize] = _a1;
+						coef[2*laneSize] = _a2;
+						coef[3*laneSize] = _b0;
+						coef[4*laneSize] = _b1;
+					}
+					void resetLane(EqualizerBankGroup& _group, int32_t _lane) {
+						for (int32_t iii=0; iii<m_nbStage*nbHistory; ++iii) {
+							_group.m_history[iii*laneSize + _lane] = 0.0f;
+						}
+					}
+					/**
+					 * @brief Process one stage on all the lanes of the interleaved buffer (the inner loop on the lanes is vectorized).
+					 * @param[in,out] _data Interleaved samples [_nbSample][laneSize].
+					 * @param[in] _nbSample Number of sample of each lane.
+					 * @param[in] _coef Coefficients of the stage [nbCoef][laneSize].
+					 * @param[in,out] _history History of the stage [nbHistory][laneSize].
+					 */
+					static void processStage(float* _data, int32_t _nbSample, const float* _coef, float* _history) {
+						const float* a0 = &_coef[0*laneSize];
+						const float* a1 = &_coef[1*laneSize];
+						const float* a2 = &_coef[2*laneSize];
+						const float* b0 = &_coef[3*laneSize];
+						const float* b1 = &_coef[4*laneSize];
+						// the history stay in memory: the lanes are loaded and stored with one vector access
+						float* x1 = &_history[0*laneSize];
+						float* x2 = &_history[1*laneSize];
+						float* y1 = &_history[2*laneSize];
+						float* y2 = &_history[3*laneSize];
+						for (int32_t iii=0; iii<_nbSample; ++iii) {
+							float* sample = &_data[iii*laneSize];
+							for (int32_t lll=0; lll<laneSize; ++lll) {
+								float input = sample[lll];
+								float result =   a0[lll] * input
+								               + a1[lll] * x1[lll]
+								               + a2[lll] * x2[lll]
+								               - b0[lll] * y1[lll]
+								               - b1[lll] * y2[lll];
+								x2[lll] = x1[lll];
+								x1[lll] = input;
+								y2[lll] = y1[lll];
+								y1[lll] = result;
+								sample[lll] = result;
+							}
+						}
+					}
+			};
+		}
+	}
+}
+
+audio::algo::drain::EqualizerBank::EqualizerBank() {
+	
+}
+
+audio::algo::drain::EqualizerBank::~EqualizerBank() {
+	
+}
+
+void audio::algo::drain::EqualizerBank::init(float _sampleRate, int32_t _nbStage, enum audio::format _format) {
+	switch (_format) {
+		default:
+			AA_DRAIN_CRITICAL("Request format for equalizer bank that not exist ... : " << _format);
+			break;
+		case audio::format_float:
+			{
+				m_private = ememory::makeShared<EqualizerBankPrivate>();
+				if (m_private == null) {
+					AA_DRAIN_ERROR("can not allocate private data...");
+					return;
+				}
+				m_private->init(_sampleRate, _nbStage);
+			}
+			break;
+	}
+}
+
+void audio::algo::drain::EqualizerBank::reset() {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("EqualizerBank does not init ...");
+		return;
+	}
+	m_private->reset();
+}
+
+etk::Vector<enum audio::format> audio::algo::drain::EqualizerBank::getSupportedFormat() {
+	etk::Vector<enum audio::format> out = audio::algo::drain::EqualizerBank::getNativeSupportedFormat();
+	return out;
+}
+
+etk::Vector<enum audio::format> audio::algo::drain::EqualizerBank::getNativeSupportedFormat() {
+	etk::Vector<enum audio::format> out;
+	out.pushBack(audio::format_float);
+	return out;
+}
+
+void audio::algo::drain::EqualizerBank::process(float* const* _output, const float* const* _input, int32_t _nbStream, size_t _nbChunk) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("EqualizerBank does not init ...");
+		return;
+	}
+	m_private->process(_output, _input, _nbStream, _nbChunk);
+}
+
+int32_t audio::algo::drain::EqualizerBank::addStream() {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("EqualizerBank does not init ...");
+		return -1;
+	}
+	return m_private->addStream();
+}
+
+bool audio::algo::drain::EqualizerBank::removeStream(int32_t _id) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("EqualizerBank does not init ...");
+		return false;
+	}
+	return m_private->removeStream(_id);
+}
+
+int32_t audio::algo::drain::EqualizerBank::getNbStream() {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("EqualizerBank does not init ...");
+		return 0;
+	}
+	return m_private->getNbStream();
+}
+
+void audio::algo::drain::EqualizerBank::resetStream(int32_t _id) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("EqualizerBank does not init ...");
+		return;
+	}
+	m_private->resetStream(_id);
+}
+
+bool audio::algo::drain::EqualizerBank::setBiquad(int32_t _id, int32_t _idStage, double _a0, double _a1, double _a2, double _b0, double _b1) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("EqualizerBank does not init ...");
+		return false;
+	}
+	return m_private->setBiquad(_id, _idStage, _a0, _a1, _a2, _b0, _b1);
+}
+
+bool audio::algo::drain::EqualizerBank::setBiquad(int32_t _id, int32_t _idStage, audio::algo::drain::biQuadType _type, double _frequencyCut, double _qualityFactor, double _gain) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("EqualizerBank does not init ...");
+		return false;
+	}
+	return m_private->setBiquad(_id, _idStage, _type, _frequencyCut, _qualityFactor, _gain);
+}
+
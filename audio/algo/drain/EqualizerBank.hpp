@@ -0,0 +1,107 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <etk/types.hpp>
+#include <ememory/memory.hpp>
+#include <etk/Vector.hpp>
+#include <audio/format.hpp>
+#include <audio/algo/drain/BiQuadType.hpp>
+
+namespace audio {
+	namespace algo {
+		namespace drain {
+			class EqualizerBankPrivate;
+			/**
+			 * @brief Bank of independent mono equalizers (one per stream) processed in a single call.
+			 * The streams are stored by group of 16 in a structure of array: the same stage of 16 streams is processed at the same time (vectorized across the streams).
+			 * Adding or removing a stream never move the data of the other streams (a new group is allocated when all the slots are used).
+			 */
+			class EqualizerBank {
+				public:
+					/**
+					 * @brief Constructor
+					 */
+					EqualizerBank();
+					/**
+					 * @brief Destructor
+					 */
+					virtual ~EqualizerBank();
+				public:
+					/**
+					 * @brief Reset all history of all the streams.
+					 */
+					void reset();
+					/**
+					 * @brief Initialize the Algorithm (remove all the streams).
+					 * @param[in] _sampleRate Sample rate of all the streams.
+					 * @param[in] _nbStage Maximum number of biquad of a stream.
+					 * @param[in] _format Input data format.
+					 */
+					virtual void init(float _sampleRate=48000, int32_t _nbStage=4, enum audio::format _format=audio::format_float);
+					/**
+					 * @brief Get list of format suported in input.
+					 * @return list of supported format
+					 */
+					virtual etk::Vector<enum audio::format> getSupportedFormat();
+					/**
+					 * @brief Get list of algorithm format suported. No format convertion.
+					 * @return list of supported format
+					 */
+					virtual etk::Vector<enum audio::format> getNativeSupportedFormat();
+					/**
+					 * @brief Process all the streams.
+					 * @param[out] _output Output buffer of each stream, indexed with the stream Id (can be the same as the input).
+					 * @param[in] _input Input buffer of each stream, indexed with the stream Id (null: the stream receive silence and his output is not written).
+					 * @param[in] _nbStream Number of pointer in _input and _output.
+					 * @param[in] _nbChunk Number of sample to process for each stream.
+					 */
+					virtual void process(float* const* _output, const float* const* _input, int32_t _nbStream, size_t _nbChunk);
+				public:
+					/**
+					 * @brief Add a new stream (all stages bypassed, history cleared).
+					 * @return Id of the stream or -1 on error.
+					 */
+					int32_t addStream();
+					/**
+					 * @brief Remove a stream (his Id can be reused by the next addStream).
+					 * @param[in] _id Id of the stream.
+					 * @return true The stream has been removed.
+					 */
+					bool removeStream(int32_t _id);
+					/**
+					 * @brief Get the number of active stream.
+					 * @return Number of stream.
+					 */
+					int32_t getNbStream();
+					/**
+					 * @brief Reset the history of one stream.
+					 * @param[in] _id Id of the stream.
+					 */
+					void resetStream(int32_t _id);
+					/**
+					 * @brief Set the coefficients of a stage of a stream.
+					 * @param[in] _id Id of the stream.
+					 * @param[in] _idStage Id of the stage [0..nbStage[.
+					 */
+					bool setBiquad(int32_t _id, int32_t _idStage, double _a0, double _a1, double _a2, double _b0, double _b1);
+					/**
+					 * @brief Set a stage of a stream with a bi-quad value and type.
+					 * @param[in] _id Id of the stream.
+					 * @param[in] _idStage Id of the stage [0..nbStage[.
+					 * @param[in] _type Type of biquad.
+					 * @param[in] _frequencyCut Cut Frequency. [0..sampleRate/2]
+					 * @param[in] _qualityFactor Q factor of quality (good value of 0.707 ==> permit to not ower gain) limit [0.01 .. 10]
+					 * @param[in] _gain Gain to apply (for notch, peak, lowShelf and highShelf) limit : -30, +30
+					 */
+					bool setBiquad(int32_t _id, int32_t _idStage, audio::algo::drain::biQuadType _type, double _frequencyCut, double _qualityFactor, double _gain);
+				protected:
+					ememory::SharedPtr<EqualizerBankPrivate> m_private; //!< private data.
+			};
+		}
+	}
+}
+
@@ -0,0 +1,590 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <audio/algo/drain/EqualizerFit.hpp>
+#include <audio/algo/drain/BiQuadDesign.hpp>
+#include <audio/algo/drain/VectorMath.hpp>
+#include <audio/algo/drain/Processor.hpp>
+#include <audio/algo/drain/debug.hpp>
+#include <ethread/Thread.hpp>
+extern "C" {
+	#include <math.h>
+	#include <string.h>
+}
+
+// The points are stored by group of 16 (the dot products have no tail, the padding points have a zero weight).
+static const int32_t pointAlign = 16;
+// Number of parameter of a band: log of the frequency, log of Q, gain in dB.
+static const int32_t nbParamBand = 3;
+// Maximum frequency of the target and of the bands (relative to the sample rate).
+static const float targetFrequencyMax = 0.49f;
+static const float bandFrequencyMax = 0.45f;
+// 10/ln(10): derivative of 10.log10(x) is dbFactor/x.
+static const float dbFactor = 4.342944819f;
+// Number of iteration of the partial optimizations of the initialization.
+static const int32_t initializeIteration = 20;
+
+/**
+ * @brief Add the response of a band (dB) and calculate its gradient on all the points.
+ * With t = tan(pi.f/sampleRate) and K = tan(pi.frequencyCut/sampleRate), the magnitudes of the designs of BiQuadDesign.hpp are (V = 10^(|gain|/20)):
+ * peak: biQuadPeakPower, low shelf: (V^2.K^4 + t^4) / (K^4 + t^4), high shelf: (K^4 + V^2.t^4) / (K^4 + t^4).
+ * A cut is the inverse of the boost: the response in dB is odd in the gain.
+ * @param[in] _type Type of the band (peak, lowShelf or highShelf).
+ * @param[in] _param Log of the frequency, log of Q, gain (dB).
+ * @param[in] _sampleRate Sample rate.
+ * @param[in] _tangent2 t^2 of each point.
+ * @param[in] _tangent4 t^4 of each point.
+ * @param[in] _nbPoint Number of point (multiple of pointAlign).
+ * @param[in,out] _response Response (dB) where the band is added.
+ * @param[out] _gradient Derivative of the response of the band for each parameter [parameter][point].
+ * @param[out] _ratio Temporary buffer (nbPoint).
+ */
+static void evaluateBand(enum audio::algo::drain::biQuadType _type,
+                         const double* _param,
+                         double _sampleRate,
+                         const float* _tangent2,
+                         const float* _tangent4,
+                         int32_t _nbPoint,
+                         float* _response,
+                         float* _gradient,
+                         float* _ratio) {
+	double angle = M_PI * exp(_param[0]) / _sampleRate;
+	double tangent = tan(angle);
+	float K2 = tangent * tangent;
+	float K3 = K2 * tangent;
+	float K4 = K2 * K2;
+	// dK/dlog(frequency)
+	float dK = angle * (1.0 + tangent * tangent);
+	float invQ2 = exp(-2.0 * _param[1]);
+	float sign = _param[2] < 0.0 ? -1.0f : 1.0f;
+	float V2 = pow(10.0, fabs(_param[2]) / 10.0);
+	float* gradientFrequency = _gradient;
+	float* gradientQuality = _gradient + _nbPoint;
+	float* gradientGain = _gradient + 2*_nbPoint;
+	switch (_type) {
+		case audio::algo::drain::biQuadType_peak:
+			for (int32_t iii=0; iii<_nbPoint; ++iii) {
+				float uuu = 0.0f;
+				float www = 0.0f;
+				_ratio[iii] = audio::algo::drain::biQuadPeakPower(K2, _tangent2[iii], invQ2, V2, uuu, www);
+				float invP = 1.0f / (uuu + V2 * www);
+				float invR = 1.0f / (uuu + www);
+				float dU = 4.0f * tangent * (K2 - _tangent2[iii]);
+				float dW = 2.0f * tangent * _tangent2[iii] * invQ2;
+				gradientFrequency[iii] = sign * dbFactor * dK * ((dU + V2 * dW) * invP - (dU + dW) * invR);
+				gradientQuality[iii] = sign * dbFactor * 2.0f * www * (invR - V2 * invP);
+				gradientGain[iii] = V2 * www * invP;
+			}
+			break;
+		case audio::algo::drain::biQuadType_lowShelf:
+			for (int32_t iii=0; iii<_nbPoint; ++iii) {
+				float invP = 1.0f / (V2 * K4 + _tangent4[iii]);
+				float invR = 1.0f / (K4 + _tangent4[iii]);
+				_ratio[iii] = (V2 * K4 + _tangent4[iii]) * invR;
+				gradientFrequency[iii] = sign * dbFactor * dK * 4.0f * K3 * (V2 * invP - invR);
+				gradientQuality[iii] = 0.0f;
+				gradientGain[iii] = V2 * K4 * invP;
+			}
+			break;
+		case audio::algo::drain::biQuadType_highShelf:
+			for (int32_t iii=0; iii<_nbPoint; ++iii) {
+				float invP = 1.0f / (K4 + V2 * _tangent4[iii]);
+				float invR = 1.0f / (K4 + _tangent4[iii]);
+				_ratio[iii] = (K4 + V2 * _tangent4[iii]) * invR;
+				gradientFrequency[iii] = sign * dbFactor * dK * 4.0f * K3 * (invP - invR);
+				gradientQuality[iii] = 0.0f;
+				gradientGain[iii] = V2 * _tangent4[iii] * invP;
+			}
+			break;
+		default:
+			AA_DRAIN_ERROR("Can not fit a band of type " << _type);
+			return;
+	}
+	audio::algo::drain::vectorMath::log10(_ratio, _ratio, _nbPoint);
+	float factor = 10.0f * sign;
+	for (int32_t iii=0; iii<_nbPoint; ++iii) {
+		_response[iii] += factor * _ratio[iii];
+	}
+}
+
+/**
+ * @brief Solve the symmetric positive definite system A.x = b (Cholesky decomposition, A is overwritten).
+ * @param[in,out] _matrix Matrix A [row][column] (replaced by its decomposition).
+ * @param[in,out] _vector Vector b (replaced by the solution x).
+ * @param[in] _size Size of the system.
+ * @return false The matrix is not positive definite.
+ */
+static bool choleskySolve(double* _matrix, double* _vector, int32_t _size) {
+	for (int32_t jjj=0; jjj<_size; ++jjj) {
+		double diagonal = _matrix[jjj*_size + jjj];
+		for (int32_t kkk=0; kkk<jjj; ++kkk) {
+			diagonal -= _matrix[jjj*_size + kkk] * _matrix[jjj*_size + kkk];
+		}
+		if (diagonal <= 0.0) {
+			return false;
+		}
+		diagonal = sqrt(diagonal);
+		_matrix[jjj*_size + jjj] = diagonal;
+		for (int32_t iii=jjj+1; iii<_size; ++iii) {
+			double value = _matrix[iii*_size + jjj];
+			for (int32_t kkk=0; kkk<jjj; ++kkk) {
+				value -= _matrix[iii*_size + kkk] * _matrix[jjj*_size + kkk];
+			}
+			_matrix[iii*_size + jjj] = value / diagonal;
+		}
+	}
+	// L.y = b then L^t.x = y
+	for (int32_t iii=0; iii<_size; ++iii) {
+		double value = _vector[iii];
+		for (int32_t kkk=0; kkk<iii; ++kkk) {
+			value -= _matrix[iii*_size + kkk] * _vector[kkk];
+		}
+		_vector[iii] = value / _matrix[iii*_size + iii];
+	}
+	for (int32_t iii=_size-1; iii>=0; --iii) {
+		double value = _vector[iii];
+		for (int32_t kkk=iii+1; kkk<_size; ++kkk) {
+			value -= _matrix[kkk*_size + iii] * _vector[kkk];
+		}
+		_vector[iii] = value / _matrix[iii*_size + iii];
+	}
+	return true;
+}
+
+namespace audio {
+	namespace algo {
+		namespace drain {
+			/**
+			 * @brief Levenberg-Marquardt solver of one restart (own buffers: one solver by thread).
+			 */
+			class EqualizerFitSolver {
+				protected:
+					const etk::Vector<enum audio::algo::drain::biQuadType>& m_type;
+					const etk::Vector<float>& m_frequency; //!< frequency of each point (padded)
+					const etk::Vector<float>& m_tangent2; //!< t^2 of each point
+					const etk::Vector<float>& m_tangent4; //!< t^4 of each point
+					const etk::Vector<float>& m_target; //!< target of each point (dB)
+					const etk::Vector<float>& m_scale; //!< square root of the weight of each point (0 for the padding)
+					double m_sampleRate;
+					int32_t m_nbPoint; //!< number of point with the padding
+					int32_t m_nbParam;
+					int32_t m_nbBand; //!< number of optimized band (the first ones, during the initialization)
+					etk::Vector<double> m_minimum; //!< limits of each parameter
+					etk::Vector<double> m_maximum;
+					etk::Vector<float> m_response; //!< response of the bands at the current parameters
+					etk::Vector<float> m_residual; //!< weighted error at the current parameters
+					etk::Vector<float> m_gradient; //!< weighted jacobian at the current parameters [parameter][point]
+					etk::Vector<float> m_responseTest; //!< same for the tested parameters
+					etk::Vector<float> m_residualTest;
+					etk::Vector<float> m_gradientTest;
+					etk::Vector<float> m_ratio;
+					etk::Vector<double> m_matrix; //!< normal equations: J^t.J
+					etk::Vector<double> m_vector; //!< J^t.residual
+					etk::Vector<double> m_system;
+					etk::Vector<double> m_step;
+					etk::Vector<double> m_paramTest;
+				public:
+					int32_t m_nbIteration; //!< number of iteration since the last initialization
+				public:
+					EqualizerFitSolver(const etk::Vector<enum audio::algo::drain::biQuadType>& _type,
+					                   const etk::Vector<float>& _frequency,
+					                   const etk::Vector<float>& _tangent2,
+					                   const etk::Vector<float>& _tangent4,
+					                   const etk::Vector<float>& _target,
+					                   const etk::Vector<float>& _scale,
+					                   double _sampleRate,
+					                   const etk::Vector<double>& _minimum,
+					                   const etk::Vector<double>& _maximum) :
+					  m_type(_type),
+					  m_frequency(_frequency),
+					  m_tangent2(_tangent2),
+					  m_tangent4(_tangent4),
+					  m_target(_target),
+					  m_scale(_scale),
+					  m_sampleRate(_sampleRate),
+					  m_nbPoint(_target.size()),
+					  m_nbParam(_type.size()*nbParamBand),
+					  m_nbBand(_type.size()),
+					  m_minimum(_minimum),
+					  m_maximum(_maximum),
+					  m_nbIteration(0) {
+						m_response.resize(m_nbPoint, 0.0f);
+						m_residual.resize(m_nbPoint, 0.0f);
+						m_gradient.resize(m_nbPoint*m_nbParam, 0.0f);
+						m_responseTest.resize(m_nbPoint, 0.0f);
+						m_residualTest.resize(m_nbPoint, 0.0f);
+						m_gradientTest.resize(m_nbPoint*m_nbParam, 0.0f);
+						m_ratio.resize(m_nbPoint, 0.0f);
+						m_matrix.resize(m_nbParam*m_nbParam, 0.0);
+						m_vector.resize(m_nbParam, 0.0);
+						m_system.resize(m_nbParam*m_nbParam, 0.0);
+						m_step.resize(m_nbParam, 0.0);
+						m_paramTest.resize(m_nbParam, 0.0);
+					}
+				protected:
+					/**
+					 * @brief Calculate the response, the weighted residual and the weighted jacobian of a set of parameters.
+					 * @return Sum of the squared weighted errors.
+					 */
+					double evaluate(const double* _param, float* _response, float* _residual, float* _gradient) {
+						for (int32_t iii=0; iii<m_nbPoint; ++iii) {
+							_response[iii] = 0.0f;
+						}
+						for (int32_t bbb=0; bbb<m_nbBand; ++bbb) {
+							evaluateBand(m_type[bbb], &_param[bbb*nbParamBand], m_sampleRate, &m_tangent2[0], &m_tangent4[0], m_nbPoint,
+							             _response, &_gradient[bbb*nbParamBand*m_nbPoint], &m_ratio[0]);
+						}
+						for (int32_t iii=0; iii<m_nbPoint; ++iii) {
+							_residual[iii] = m_scale[iii] * (_response[iii] - m_target[iii]);
+						}
+						for (int32_t ppp=0; ppp<m_nbBand*nbParamBand; ++ppp) {
+							float* gradient = &_gradient[ppp*m_nbPoint];
+							for (int32_t iii=0; iii<m_nbPoint; ++iii) {
+								gradient[iii] *= m_scale[iii];
+							}
+						}
+						return audio::algo::drain::vectorMath::dot(_residual, _residual, m_nbPoint);
+					}
+					/**
+					 * @brief Limit some parameters in their range.
+					 * @param[in,out] _param First parameter to limit.
+					 * @param[in] _idParam Id of the first parameter.
+					 * @param[in] _nbParam Number of parameter.
+					 */
+					void clamp(double* _param, int32_t _idParam, int32_t _nbParam) {
+						for (int32_t ppp=0; ppp<_nbParam; ++ppp) {
+							_param[ppp] = etk::max(m_minimum[_idParam+ppp], etk::min(m_maximum[_idParam+ppp], _param[ppp]));
+						}
+					}
+				public:
+					/**
+					 * @brief Create a starting point: the bands are added one by one, each peak on the biggest remaining error, and the bands already placed are optimized before the next one.
+					 * The restarts move the frequency and the Q of the peaks randomly.
+					 * @param[out] _param Parameters of all the bands.
+					 * @param[in] _idRestart Id of the restart (0: no random move).
+					 */
+					void initialize(etk::Vector<double>& _param, int32_t _idRestart) {
+						uint32_t seed = 12345 + 7919*_idRestart;
+						_param.resize(m_nbParam, 0.0);
+						m_nbIteration = 0;
+						// lowest and highest frequency of the target (level of the shelves)
+						int32_t idLow = 0;
+						int32_t idHigh = 0;
+						for (int32_t iii=0; iii<m_nbPoint; ++iii) {
+							if (m_frequency[iii] < m_frequency[idLow]) {
+								idLow = iii;
+							}
+							if (m_frequency[iii] > m_frequency[idHigh]) {
+								idHigh = iii;
+							}
+						}
+						for (int32_t iii=0; iii<m_nbPoint; ++iii) {
+							m_response[iii] = 0.0f;
+						}
+						for (size_t bbb=0; bbb<m_type.size(); ++bbb) {
+							double* param = &_param[bbb*nbParamBand];
+							param[1] = log(M_SQRT1_2);
+							if (m_type[bbb] == audio::algo::drain::biQuadType_lowShelf) {
+								param[0] = log(200.0);
+								param[2] = m_target[idLow] - m_response[idLow];
+							} else if (m_type[bbb] == audio::algo::drain::biQuadType_highShelf) {
+								param[0] = log(5000.0);
+								param[2] = m_target[idHigh] - m_response[idHigh];
+							} else {
+								int32_t idMax = 0;
+								float errorMax = -1.0f;
+								for (int32_t iii=0; iii<m_nbPoint; ++iii) {
+									float error = fabs(m_target[iii] - m_response[iii]) * m_scale[iii];
+									if (    error > errorMax
+									     && m_frequency[iii] >= exp(m_minimum[bbb*nbParamBand])
+									     && m_frequency[iii] <= exp(m_maximum[bbb*nbParamBand])) {
+										errorMax = error;
+										idMax = iii;
+									}
+								}
+								param[0] = log(m_frequency[idMax]);
+								param[1] = log(2.0);
+								param[2] = m_target[idMax] - m_response[idMax];
+								if (_idRestart != 0) {
+									// +/- half an octave, Q in [0.7..5], 50% to 100% of the gain
+									seed = seed*1664525 + 1013904223;
+									param[0] += (float(seed>>8)/float(1<<24) - 0.5f) * M_LN2;
+									seed = seed*1664525 + 1013904223;
+									param[1] = log(0.7) + float(seed>>8)/float(1<<24) * log(5.0/0.7);
+									seed = seed*1664525 + 1013904223;
+									param[2] *= 0.5 + 0.5*float(seed>>8)/float(1<<24);
+								}
+							}
+							clamp(param, bbb*nbParamBand, nbParamBand);
+							m_nbBand = bbb+1;
+							solve(_param, initializeIteration);
+						}
+					}
+					/**
+					 * @brief Optimize the parameters (Levenberg-Marquardt with the Marquardt scaling of the diagonal).
+					 * @param[in,out] _param Parameters of all the bands.
+					 * @param[in] _maxIteration Maximum number of iteration.
+					 * @return Sum of the squared weighted errors.
+					 */
+					double solve(etk::Vector<double>& _param, int32_t _maxIteration) {
+						int32_t nbParam = m_nbBand*nbParamBand;
+						double lambda = 1.0e-3;
+						double cost = evaluate(&_param[0], &m_response[0], &m_residual[0], &m_gradient[0]);
+						m_paramTest = _param;
+						for (int32_t iteration=0; iteration<_maxIteration; ++iteration) {
+							++m_nbIteration;
+							// normal equations (symmetric: the upper part is copied)
+							for (int32_t ppp=0; ppp<nbParam; ++ppp) {
+								const float* gradient = &m_gradient[ppp*m_nbPoint];
+								for (int32_t qqq=0; qqq<=ppp; ++qqq) {
+									double value = audio::algo::drain::vectorMath::dot(gradient, &m_gradient[qqq*m_nbPoint], m_nbPoint);
+									m_matrix[ppp*nbParam + qqq] = value;
+									m_matrix[qqq*nbParam + ppp] = value;
+								}
+								m_vector[ppp] = -audio::algo::drain::vectorMath::dot(gradient, &m_residual[0], m_nbPoint);
+							}
+							bool accepted = false;
+							double costTest = cost;
+							while (    accepted == false
+							        && lambda < 1.0e10) {
+								m_system = m_matrix;
+								for (int32_t ppp=0; ppp<nbParam; ++ppp) {
+									// the small constant keep the system definite for the parameters without effect (Q of a shelf, band without gain)
+									m_system[ppp*nbParam + ppp] += lambda * (m_matrix[ppp*nbParam + ppp] + 1.0e-9);
+									m_step[ppp] = m_vector[ppp];
+								}
+								if (choleskySolve(&m_system[0], &m_step[0], nbParam) == false) {
+									lambda *= 10.0;
+									continue;
+								}
+								for (int32_t ppp=0; ppp<nbParam; ++ppp) {
+									m_paramTest[ppp] = _param[ppp] + m_step[ppp];
+								}
+								clamp(&m_paramTest[0], 0, nbParam);
+								costTest = evaluate(&m_paramTest[0], &m_responseTest[0], &m_residualTest[0], &m_gradientTest[0]);
+								if (costTest < cost) {
+									accepted = true;
+									lambda = etk::max(lambda / 3.0, 1.0e-9);
+								} else {
+									lambda *= 4.0;
+								}
+							}
+							if (accepted == false) {
+								break;
+							}
+							_param = m_paramTest;
+							m_response.swap(m_responseTest);
+							m_residual.swap(m_residualTest);
+							m_gradient.swap(m_gradientTest);
+							double improvement = cost - costTest;
+							cost = costTest;
+							if (improvement <= 1.0e-7 * cost + 1.0e-12) {
+								break;
+							}
+						}
+						return cost;
+					}
+			};
+		}
+	}
+}
+
+audio::algo::drain::EqualizerFit::EqualizerFit() :
+  m_sampleRate(48000),
+  m_frequencyMin(20.0f),
+  m_frequencyMax(20000.0f),
+  m_qualityMin(0.3f),
+  m_qualityMax(10.0f),
+  m_gainMin(-20.0f),
+  m_gainMax(20.0f),
+  m_nbRestart(8),
+  m_nbThread(getNbProcessor()),
+  m_maxIteration(200),
+  m_error(0.0),
+  m_nbIteration(0) {
+	
+}
+
+void audio::algo::drain::EqualizerFit::init(float _sampleRate) {
+	m_sampleRate = _sampleRate;
+	m_frequency.clear();
+	m_target.clear();
+	m_weight.clear();
+	m_type.clear();
+	m_error = 0.0;
+	m_nbIteration = 0;
+}
+
+bool audio::algo::drain::EqualizerFit::setTarget(const etk::Vector<etk::Pair<float,float> >& _target, const etk::Vector<float>& _weight) {
+	if (    _weight.size() != 0
+	     && _weight.size() != _target.size()) {
+		AA_DRAIN_ERROR("Fit target of " << _target.size() << " points with " << _weight.size() << " weights");
+		return false;
+	}
+	m_frequency.clear();
+	m_target.clear();
+	m_weight.clear();
+	for (size_t iii=0; iii<_target.size(); ++iii) {
+		if (    _target[iii].first <= 0.0f
+		     || _target[iii].first >= m_sampleRate*targetFrequencyMax) {
+			continue;
+		}
+		m_frequency.pushBack(_target[iii].first);
+		m_target.pushBack(_target[iii].second);
+		m_weight.pushBack(_weight.size() == 0 ? 1.0f : etk::max(0.0f, _weight[iii]));
+	}
+	if (m_frequency.size() == 0) {
+		AA_DRAIN_ERROR("Fit target has no point in ]0.." << m_sampleRate*targetFrequencyMax << "[ Hz");
+		return false;
+	}
+	return true;
+}
+
+void audio::algo::drain::EqualizerFit::setBands(int32_t _nbPeak, bool _lowShelf, bool _highShelf) {
+	m_type.clear();
+	if (_lowShelf == true) {
+		m_type.pushBack(audio::algo::drain::biQuadType_lowShelf);
+	}
+	if (_highShelf == true) {
+		m_type.pushBack(audio::algo::drain::biQuadType_highShelf);
+	}
+	for (int32_t iii=0; iii<_nbPeak; ++iii) {
+		m_type.pushBack(audio::algo::drain::biQuadType_peak);
+	}
+}
+
+void audio::algo::drain::EqualizerFit::setFrequencyRange(float _frequencyMin, float _frequencyMax) {
+	if (    _frequencyMin <= 0.0f
+	     || _frequencyMax <= _frequencyMin) {
+		AA_DRAIN_ERROR("Wrong fit frequency range: " << _frequencyMin << " .. " << _frequencyMax);
+		return;
+	}
+	m_frequencyMin = _frequencyMin;
+	m_frequencyMax = _frequencyMax;
+}
+
+void audio::algo::drain::EqualizerFit::setQualityRange(float _qualityMin, float _qualityMax) {
+	if (    _qualityMin <= 0.0f
+	     || _qualityMax < _qualityMin) {
+		AA_DRAIN_ERROR("Wrong fit Q range: " << _qualityMin << " .. " << _qualityMax);
+		return;
+	}
+	m_qualityMin = _qualityMin;
+	m_qualityMax = _qualityMax;
+}
+
+void audio::algo::drain::EqualizerFit::setGainRange(float _gainMin, float _gainMax) {
+	if (_gainMax < _gainMin) {
+		AA_DRAIN_ERROR("Wrong fit gain range: " << _gainMin << " .. " << _gainMax);
+		return;
+	}
+	m_gainMin = _gainMin;
+	m_gainMax = _gainMax;
+}
+
+void audio::algo::drain::EqualizerFit::setNbRestart(int32_t _nbRestart) {
+	m_nbRestart = etk::max(int32_t(1), _nbRestart);
+}
+
+void audio::algo::drain::EqualizerFit::setNbThread(int32_t _nbThread) {
+	m_nbThread = etk::max(int32_t(1), _nbThread);
+}
+
+void audio::algo::drain::EqualizerFit::setMaxIteration(int32_t _maxIteration) {
+	m_maxIteration = etk::max(int32_t(1), _maxIteration);
+}
+
+audio::algo::drain::EqualizerPreset audio::algo::drain::EqualizerFit::fit() {
+	audio::algo::drain::EqualizerPreset out;
+	m_error = 0.0;
+	m_nbIteration = 0;
+	if (m_frequency.size() == 0) {
+		AA_DRAIN_ERROR("Fit without target");
+		return out;
+	}
+	if (m_type.size() == 0) {
+		return out;
+	}
+	// points padded to a multiple of pointAlign (zero weight)
+	int32_t nbPoint = (m_frequency.size() + pointAlign - 1) / pointAlign * pointAlign;
+	etk::Vector<float> frequency;
+	etk::Vector<float> tangent2;
+	etk::Vector<float> tangent4;
+	etk::Vector<float> target;
+	etk::Vector<float> scale;
+	double sumWeight = 0.0;
+	for (int32_t iii=0; iii<nbPoint; ++iii) {
+		size_t idPoint = etk::min(size_t(iii), m_frequency.size()-1);
+		double tangent = tan(M_PI * m_frequency[idPoint] / m_sampleRate);
+		frequency.pushBack(m_frequency[idPoint]);
+		tangent2.pushBack(tangent * tangent);
+		tangent4.pushBack(tangent * tangent * tangent * tangent);
+		target.pushBack(m_target[idPoint]);
+		scale.pushBack(size_t(iii) < m_frequency.size() ? sqrt(m_weight[idPoint]) : 0.0f);
+		if (size_t(iii) < m_frequency.size()) {
+			sumWeight += m_weight[idPoint];
+		}
+	}
+	if (sumWeight <= 0.0) {
+		AA_DRAIN_ERROR("Fit target has a null weight");
+		return out;
+	}
+	etk::Vector<double> minimum;
+	etk::Vector<double> maximum;
+	double frequencyMax = etk::min(double(m_frequencyMax), double(m_sampleRate)*bandFrequencyMax);
+	double frequencyMin = etk::min(double(m_frequencyMin), frequencyMax);
+	for (size_t bbb=0; bbb<m_type.size(); ++bbb) {
+		minimum.pushBack(log(frequencyMin));
+		maximum.pushBack(log(frequencyMax));
+		minimum.pushBack(log(m_qualityMin));
+		maximum.pushBack(log(m_qualityMax));
+		minimum.pushBack(m_gainMin);
+		maximum.pushBack(m_gainMax);
+	}
+	// the restarts are distributed on the threads
+	etk::Vector<etk::Vector<double> > result;
+	result.resize(m_nbRestart);
+	etk::Vector<double> cost;
+	cost.resize(m_nbRestart, 0.0);
+	etk::Vector<int32_t> nbIteration;
+	nbIteration.resize(m_nbRestart, 0);
+	int32_t nbThread = etk::min(m_nbThread, m_nbRestart);
+	etk::Function<void(int32_t)> processThread = [&](int32_t _id) {
+		audio::algo::drain::EqualizerFitSolver solver(m_type, frequency, tangent2, tangent4, target, scale, m_sampleRate, minimum, maximum);
+		for (int32_t rrr=_id; rrr<m_nbRestart; rrr+=nbThread) {
+			solver.initialize(result[rrr], rrr);
+			cost[rrr] = solver.solve(result[rrr], m_maxIteration);
+			nbIteration[rrr] = solver.m_nbIteration;
+		}
+	};
+	etk::Vector<ememory::SharedPtr<ethread::Thread> > threads;
+	for (int32_t ttt=1; ttt<nbThread; ++ttt) {
+		threads.pushBack(ememory::makeShared<ethread::Thread>([&processThread, ttt]() {
+		                                                          processThread(ttt);
+		                                                      },
+		                                                      "EqualizerFit"));
+	}
+	processThread(0);
+	for (size_t iii=0; iii<threads.size(); ++iii) {
+		threads[iii]->join();
+	}
+	int32_t idBest = 0;
+	for (int32_t rrr=0; rrr<m_nbRestart; ++rrr) {
+		m_nbIteration += nbIteration[rrr];
+		if (cost[rrr] < cost[idBest]) {
+			idBest = rrr;
+		}
+	}
+	m_error = sqrt(cost[idBest] / sumWeight);
+	for (size_t bbb=0; bbb<m_type.size(); ++bbb) {
+		const double* param = &result[idBest][bbb*nbParamBand];
+		double quality = m_type[bbb] == audio::algo::drain::biQuadType_peak ? exp(param[1]) : M_SQRT1_2;
+		out.addBand(-1, m_type[bbb], exp(param[0]), quality, param[2]);
+	}
+	out.addCoefficientSet(m_sampleRate);
+	AA_DRAIN_VERBOSE("Fit of " << m_type.size() << " bands: error=" << m_error << " dB after " << m_nbIteration << " iterations (best restart " << idBest << ")");
+	return out;
+}
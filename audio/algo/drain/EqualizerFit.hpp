@@ -0,0 +1,135 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <etk/types.hpp>
+#include <etk/Vector.hpp>
+#include <etk/Pair.hpp>
+#include <audio/algo/drain/BiQuadType.hpp>
+#include <audio/algo/drain/EqualizerPreset.hpp>
+
+namespace audio {
+	namespace algo {
+		namespace drain {
+			/**
+			 * @brief Fit peak and shelf bands on a target magnitude response (room or headphone correction).
+			 * The magnitude in dB of the peak and shelf bi-quads has a closed form in tan(pi.f/sampleRate): the response and its analytic gradient are evaluated in batch on all the frequencies (vectorized loops).
+			 * The parameters (log of the frequency, log of Q, gain) are optimized by Levenberg-Marquardt from several starting points, the restarts run in parallel threads and the best result is kept.
+			 */
+			class EqualizerFit {
+				protected:
+					float m_sampleRate; //!< sample rate of the equalizer
+					etk::Vector<float> m_frequency; //!< frequency of each point of the target
+					etk::Vector<float> m_target; //!< target response (dB)
+					etk::Vector<float> m_weight; //!< weight of each point of the target
+					etk::Vector<enum audio::algo::drain::biQuadType> m_type; //!< type of each band (peak, lowShelf or highShelf)
+					float m_frequencyMin; //!< range of the band frequencies
+					float m_frequencyMax;
+					float m_qualityMin; //!< range of the Q of the peaks
+					float m_qualityMax;
+					float m_gainMin; //!< range of the band gains (dB)
+					float m_gainMax;
+					int32_t m_nbRestart; //!< number of starting point
+					int32_t m_nbThread; //!< maximum number of thread
+					int32_t m_maxIteration; //!< maximum number of iteration of each restart
+					double m_error; //!< weighted RMS error of the last fit (dB)
+					int32_t m_nbIteration; //!< number of iteration of the last fit (all the restarts)
+				public:
+					/**
+					 * @brief Constructor
+					 */
+					EqualizerFit();
+				public:
+					/**
+					 * @brief Initialize the fit (the target and the bands are removed).
+					 * @param[in] _sampleRate Sample rate of the equalizer.
+					 */
+					void init(float _sampleRate=48000);
+					/**
+					 * @brief Set the target response (the frequencies over 0.49 x sampleRate are ignored).
+					 * @param[in] _target List of frequency/level in dB (as Equalizer::calculateTheory or SpectrumAnalyzer::getSpectrum).
+					 * @param[in] _weight Weight of each point (empty: 1.0 for all the points).
+					 * @return true The target is set.
+					 */
+					bool setTarget(const etk::Vector<etk::Pair<float,float> >& _target, const etk::Vector<float>& _weight=etk::Vector<float>());
+					/**
+					 * @brief Set the bands to fit.
+					 * @param[in] _nbPeak Number of peak band.
+					 * @param[in] _lowShelf Add a low shelf band.
+					 * @param[in] _highShelf Add a high shelf band.
+					 */
+					void setBands(int32_t _nbPeak, bool _lowShelf=false, bool _highShelf=false);
+					/**
+					 * @brief Set the range of the band frequencies (default: 20 Hz .. 20 kHz, limited to 0.45 x sampleRate).
+					 * @param[in] _frequencyMin Minimum frequency (Hz).
+					 * @param[in] _frequencyMax Maximum frequency (Hz).
+					 */
+					void setFrequencyRange(float _frequencyMin, float _frequencyMax);
+					/**
+					 * @brief Set the range of the Q of the peaks (default: 0.3 .. 10).
+					 * @param[in] _qualityMin Minimum Q.
+					 * @param[in] _qualityMax Maximum Q.
+					 */
+					void setQualityRange(float _qualityMin, float _qualityMax);
+					/**
+					 * @brief Set the range of the band gains (default: -20 .. +20 dB).
+					 * @param[in] _gainMin Minimum gain (dB).
+					 * @param[in] _gainMax Maximum gain (dB).
+					 */
+					void setGainRange(float _gainMin, float _gainMax);
+					/**
+					 * @brief Set the number of starting point (default: 8, the first one is the greedy placement on the biggest errors).
+					 * @param[in] _nbRestart Number of restart.
+					 */
+					void setNbRestart(int32_t _nbRestart);
+					/**
+					 * @brief Get the number of starting point.
+					 * @return Number of restart.
+					 */
+					int32_t getNbRestart() const {
+						return m_nbRestart;
+					}
+					/**
+					 * @brief Set the maximum number of thread (default: number of processor).
+					 * @param[in] _nbThread Number of thread.
+					 */
+					void setNbThread(int32_t _nbThread);
+					/**
+					 * @brief Get the maximum number of thread.
+					 * @return Number of thread.
+					 */
+					int32_t getNbThread() const {
+						return m_nbThread;
+					}
+					/**
+					 * @brief Set the maximum number of iteration of each restart (default: 200).
+					 * @param[in] _maxIteration Number of iteration.
+					 */
+					void setMaxIteration(int32_t _maxIteration);
+					/**
+					 * @brief Fit the bands on the target.
+					 * @return Preset of the bands (all the channels, with the coefficients precomputed for the sample rate), ready for EqualizerPreset::apply.
+					 */
+					audio::algo::drain::EqualizerPreset fit();
+					/**
+					 * @brief Get the error of the last fit.
+					 * @return Weighted RMS error between the bands and the target (dB).
+					 */
+					double getError() const {
+						return m_error;
+					}
+					/**
+					 * @brief Get the number of iteration of the last fit.
+					 * @return Number of Levenberg-Marquardt iteration (sum of all the restarts).
+					 */
+					int32_t getNbIteration() const {
+						return m_nbIteration;
+					}
+			};
+		}
+	}
+}
+
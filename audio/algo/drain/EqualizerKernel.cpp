@@ -0,0 +1,34 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <etk/types.hpp>
+#include <audio/algo/drain/debug.hpp>
+#include <audio/algo/drain/EqualizerKernel.hpp>
+
+static const char* listValues[] = {
+	"direct-form-1",
+	"direct-form-1-cascade",
+	"transposed-direct-form-2",
+	"cross-channel"
+};
+static int32_t listValuesSize = sizeof(listValues)/sizeof(char*);
+
+
+namespace etk {
+	template<> etk::String toString<enum audio::algo::drain::equalizerKernel>(const enum audio::algo::drain::equalizerKernel& _variable) {
+		return listValues[_variable];
+	}
+	template <> bool from_string<enum audio::algo::drain::equalizerKernel>(enum audio::algo::drain::equalizerKernel& _variableRet, const etk::String& _value) {
+		for (int32_t iii=0; iii<listValuesSize; ++iii) {
+			if (_value == listValues[iii]) {
+				_variableRet = static_cast<enum audio::algo::drain::equalizerKernel>(iii);
+				return true;
+			}
+		}
+		_variableRet = audio::algo::drain::equalizerKernel_directForm1;
+		return false;
+	}
+}
@@ -0,0 +1,22 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <ememory/memory.hpp>
+
+namespace audio {
+	namespace algo {
+		namespace drain {
+			enum equalizerKernel {
+				equalizerKernel_directForm1, //!< each bi-quad on the whole block of a channel, then the next bi-quad (reference)
+				equalizerKernel_directForm1Cascade, //!< each sample of a channel throw all the bi-quads
+				equalizerKernel_transposedDirectForm2, //!< each bi-quad on the whole block in transposed direct form II (2 states per bi-quad)
+				equalizerKernel_crossChannel, //!< each sample of all the channels throw the same bi-quad at the same time (vectorized across the channels)
+			};
+		}
+	}
+}
+
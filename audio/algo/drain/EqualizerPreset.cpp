@@ -0,0 +1,381 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <audio/algo/drain/EqualizerPreset.hpp>
+#include <audio/algo/drain/BiQuadCache.hpp>
+#include <audio/algo/drain/debug.hpp>
+#include <etk/uri/uri.hpp>
+extern "C" {
+	#include <string.h>
+	#include <stdio.h>
+}
+
+// Number of coefficient of a band in a coefficient set (a0, a1, a2, b0, b1).
+static const size_t nbCoef = 5;
+// Limits to refuse the corrupted files before any size calculation.
+static const uint32_t nbBandMax = 4096;
+static const uint32_t nbCoefficientSetMax = 64;
+
+static size_t getCoefficientSetSize(size_t _nbBand) {
+	return sizeof(audio::algo::drain::EqualizerPresetCoefficientSet) + _nbBand*nbCoef*sizeof(double);
+}
+
+static const audio::algo::drain::EqualizerPresetHeader& getHeader(const uint8_t* _data) {
+	return *reinterpret_cast<const audio::algo::drain::EqualizerPresetHeader*>(_data);
+}
+
+static const audio::algo::drain::EqualizerPresetCoefficientSet& getCoefficientSet(const uint8_t* _data, int32_t _id) {
+	size_t nbBand = getHeader(_data).m_nbBand;
+	size_t offset =   sizeof(audio::algo::drain::EqualizerPresetHeader)
+	                + nbBand*sizeof(audio::algo::drain::EqualizerPresetBand)
+	                + _id*getCoefficientSetSize(nbBand);
+	return *reinterpret_cast<const audio::algo::drain::EqualizerPresetCoefficientSet*>(&_data[offset]);
+}
+
+audio::algo::drain::EqualizerPreset::EqualizerPreset() :
+  m_data(null),
+  m_size(0) {
+	clear();
+}
+
+audio::algo::drain::EqualizerPreset::EqualizerPreset(const audio::algo::drain::EqualizerPreset& _obj) :
+  m_data(null),
+  m_size(0) {
+	*this = _obj;
+}
+
+audio::algo::drain::EqualizerPreset& audio::algo::drain::EqualizerPreset::operator=(const audio::algo::drain::EqualizerPreset& _obj) {
+	if (this == &_obj) {
+		return *this;
+	}
+	m_storage = _obj.m_storage;
+	m_size = _obj.m_size;
+	if (    _obj.m_storage.size() != 0
+	     && _obj.m_data == reinterpret_cast<const uint8_t*>(&_obj.m_storage[0])) {
+		m_data = reinterpret_cast<const uint8_t*>(&m_storage[0]);
+	} else {
+		m_data = _obj.m_data;
+	}
+	return *this;
+}
+
+bool audio::algo::drain::EqualizerPreset::check(const uint8_t* _data, size_t _size) {
+	if (    _data == null
+	     || _size < sizeof(audio::algo::drain::EqualizerPresetHeader)) {
+		AA_DRAIN_ERROR("Preset too small: " << _size << " bytes");
+		return false;
+	}
+	const audio::algo::drain::EqualizerPresetHeader& header = getHeader(_data);
+	if (    header.m_magic[0] != 'D'
+	     || header.m_magic[1] != 'R'
+	     || header.m_magic[2] != 'E'
+	     || header.m_magic[3] != 'Q') {
+		AA_DRAIN_ERROR("Not an equalizer preset");
+		return false;
+	}
+	if (header.m_version != audio::algo::drain::equalizerPresetVersion) {
+		AA_DRAIN_ERROR("Preset version " << header.m_version << " not supported (only " << audio::algo::drain::equalizerPresetVersion << ")");
+		return false;
+	}
+	if (    header.m_nbBand > nbBandMax
+	     || header.m_nbCoefficientSet > nbCoefficientSetMax) {
+		AA_DRAIN_ERROR("Preset with " << header.m_nbBand << " bands and " << header.m_nbCoefficientSet << " coefficient sets: corrupted");
+		return false;
+	}
+	size_t size =   sizeof(audio::algo::drain::EqualizerPresetHeader)
+	              + header.m_nbBand*sizeof(audio::algo::drain::EqualizerPresetBand)
+	              + header.m_nbCoefficientSet*getCoefficientSetSize(header.m_nbBand);
+	if (size != _size) {
+		AA_DRAIN_ERROR("Preset size " << _size << " bytes, expected " << size);
+		return false;
+	}
+	const audio::algo::drain::EqualizerPresetBand* bands = reinterpret_cast<const audio::algo::drain::EqualizerPresetBand*>(&_data[sizeof(audio::algo::drain::EqualizerPresetHeader)]);
+	for (uint32_t iii=0; iii<header.m_nbBand; ++iii) {
+		if (bands[iii].m_type > uint32_t(audio::algo::drain::biQuadType_highShelf)) {
+			AA_DRAIN_ERROR("Preset band " << iii << " with a wrong type: " << bands[iii].m_type);
+			return false;
+		}
+		if (bands[iii].m_idChannel < -1) {
+			AA_DRAIN_ERROR("Preset band " << iii << " with a wrong channel: " << bands[iii].m_idChannel);
+			return false;
+		}
+	}
+	for (uint32_t iii=0; iii<header.m_nbCoefficientSet; ++iii) {
+		if (getCoefficientSet(_data, iii).m_sampleRate <= 0.0) {
+			AA_DRAIN_ERROR("Preset coefficient set " << iii << " with a wrong sample rate");
+			return false;
+		}
+	}
+	return true;
+}
+
+bool audio::algo::drain::EqualizerPreset::load(const void* _data, size_t _size) {
+	const uint8_t* data = reinterpret_cast<const uint8_t*>(_data);
+	if (check(data, _size) == false) {
+		return false;
+	}
+	if ((reinterpret_cast<size_t>(data) & (sizeof(double)-1)) == 0) {
+		// zero copy
+		m_storage.clear();
+		m_data = data;
+		m_size = _size;
+		return true;
+	}
+	AA_DRAIN_WARNING("Preset data not aligned: copy it");
+	m_storage.resize((_size + sizeof(uint64_t) - 1) / sizeof(uint64_t), 0);
+	memcpy(&m_storage[0], data, _size);
+	m_data = reinterpret_cast<const uint8_t*>(&m_storage[0]);
+	m_size = _size;
+	return true;
+}
+
+bool audio::algo::drain::EqualizerPreset::loadFile(const etk::String& _fileName) {
+	ememory::SharedPtr<etk::io::Interface> fileIO = etk::uri::get(etk::Path(_fileName));
+	if (    fileIO == null
+	     || fileIO->open(etk::io::OpenMode::Read) == false) {
+		AA_DRAIN_ERROR("Can not open preset file '" << _fileName << "'");
+		return false;
+	}
+	size_t size = fileIO->size();
+	etk::Vector<uint64_t> storage;
+	storage.resize((size + sizeof(uint64_t) - 1) / sizeof(uint64_t) + 1, 0);
+	size_t sizeRead = fileIO->read(&storage[0], 1, size);
+	fileIO->close();
+	if (sizeRead != size) {
+		AA_DRAIN_ERROR("Can not read preset file '" << _fileName << "'");
+		return false;
+	}
+	if (check(reinterpret_cast<const uint8_t*>(&storage[0]), size) == false) {
+		AA_DRAIN_ERROR("    in file '" << _fileName << "'");
+		return false;
+	}
+	m_storage = storage;
+	m_data = reinterpret_cast<const uint8_t*>(&m_storage[0]);
+	m_size = size;
+	return true;
+}
+
+bool audio::algo::drain::EqualizerPreset::storeFile(const etk::String& _fileName) const {
+	ememory::SharedPtr<etk::io::Interface> fileIO = etk::uri::get(etk::Path(_fileName));
+	if (    fileIO == null
+	     || fileIO->open(etk::io::OpenMode::Write) == false) {
+		AA_DRAIN_ERROR("Can not open preset file '" << _fileName << "'");
+		return false;
+	}
+	bool ret = size_t(fileIO->write(m_data, 1, m_size)) == m_size;
+	fileIO->close();
+	return ret;
+}
+
+void audio::algo::drain::EqualizerPreset::clear() {
+	build(etk::Vector<audio::algo::drain::EqualizerPresetBand>(), etk::Vector<double>());
+}
+
+void audio::algo::drain::EqualizerPreset::build(const etk::Vector<audio::algo::drain::EqualizerPresetBand>& _bands, const etk::Vector<double>& _sampleRates) {
+	size_t size =   sizeof(audio::algo::drain::EqualizerPresetHeader)
+	              + _bands.size()*sizeof(audio::algo::drain::EqualizerPresetBand)
+	              + _sampleRates.size()*getCoefficientSetSize(_bands.size());
+	etk::Vector<uint64_t> storage;
+	storage.resize(size/sizeof(uint64_t), 0);
+	uint8_t* data = reinterpret_cast<uint8_t*>(&storage[0]);
+	audio::algo::drain::EqualizerPresetHeader* header = reinterpret_cast<audio::algo::drain::EqualizerPresetHeader*>(data);
+	header->m_magic[0] = 'D';
+	header->m_magic[1] = 'R';
+	header->m_magic[2] = 'E';
+	header->m_magic[3] = 'Q';
+	header->m_version = audio::algo::drain::equalizerPresetVersion;
+	header->m_nbBand = _bands.size();
+	header->m_nbCoefficientSet = _sampleRates.size();
+	audio::algo::drain::EqualizerPresetBand* bands = reinterpret_cast<audio::algo::drain::EqualizerPresetBand*>(&data[sizeof(audio::algo::drain::EqualizerPresetHeader)]);
+	for (size_t iii=0; iii<_bands.size(); ++iii) {
+		bands[iii] = _bands[iii];
+	}
+	for (size_t sss=0; sss<_sampleRates.size(); ++sss) {
+		audio::algo::drain::EqualizerPresetCoefficientSet& set = const_cast<audio::algo::drain::EqualizerPresetCoefficientSet&>(getCoefficientSet(data, sss));
+		set.m_sampleRate = _sampleRates[sss];
+		set.m_topology = audio::algo::drain::equalizerPresetTopologyDirectForm1;
+		set.m_reserved = 0;
+		double* coef = reinterpret_cast<double*>(&set + 1);
+		for (size_t iii=0; iii<_bands.size(); ++iii) {
+			audio::algo::drain::BiQuadCoefficient design = audio::algo::drain::BiQuadCache::get(audio::algo::drain::biQuadType(_bands[iii].m_type),
+			                                                                                     _bands[iii].m_frequencyCut,
+			                                                                                     _bands[iii].m_qualityFactor,
+			                                                                                     _bands[iii].m_gain,
+			                                                                                     _sampleRates[sss]);
+			coef[iii*nbCoef + 0] = design.m_a[0];
+			coef[iii*nbCoef + 1] = design.m_a[1];
+			coef[iii*nbCoef + 2] = design.m_a[2];
+			coef[iii*nbCoef + 3] = design.m_b[0];
+			coef[iii*nbCoef + 4] = design.m_b[1];
+		}
+	}
+	m_storage = storage;
+	m_data = reinterpret_cast<const uint8_t*>(&m_storage[0]);
+	m_size = size;
+}
+
+void audio::algo::drain::EqualizerPreset::extract(etk::Vector<audio::algo::drain::EqualizerPresetBand>& _bands, etk::Vector<double>& _sampleRates) const {
+	_bands.clear();
+	_sampleRates.clear();
+	for (int32_t iii=0; iii<getNbBand(); ++iii) {
+		_bands.pushBack(getBand(iii));
+	}
+	for (int32_t iii=0; iii<getNbCoefficientSet(); ++iii) {
+		_sampleRates.pushBack(getCoefficientSetSampleRate(iii));
+	}
+}
+
+void audio::algo::drain::EqualizerPreset::addBand(int32_t _idChannel, enum audio::algo::drain::biQuadType _type, double _frequencyCut, double _qualityFactor, double _gain) {
+	etk::Vector<audio::algo::drain::EqualizerPresetBand> bands;
+	etk::Vector<double> sampleRates;
+	extract(bands, sampleRates);
+	audio::algo::drain::EqualizerPresetBand band;
+	band.m_idChannel = etk::max(_idChannel, int32_t(-1));
+	band.m_type = uint32_t(_type);
+	band.m_frequencyCut = _frequencyCut;
+	band.m_qualityFactor = _qualityFactor;
+	band.m_gain = _gain;
+	bands.pushBack(band);
+	build(bands, sampleRates);
+}
+
+void audio::algo::drain::EqualizerPreset::addCoefficientSet(double _sampleRate) {
+	if (_sampleRate <= 0.0) {
+		AA_DRAIN_ERROR("Can not add a coefficient set for the sample rate " << _sampleRate);
+		return;
+	}
+	etk::Vector<audio::algo::drain::EqualizerPresetBand> bands;
+	etk::Vector<double> sampleRates;
+	extract(bands, sampleRates);
+	for (size_t iii=0; iii<sampleRates.size(); ++iii) {
+		if (sampleRates[iii] == _sampleRate) {
+			return;
+		}
+	}
+	sampleRates.pushBack(_sampleRate);
+	build(bands, sampleRates);
+}
+
+int32_t audio::algo::drain::EqualizerPreset::getNbBand() const {
+	return getHeader(m_data).m_nbBand;
+}
+
+const audio::algo::drain::EqualizerPresetBand& audio::algo::drain::EqualizerPreset::getBand(int32_t _id) const {
+	const audio::algo::drain::EqualizerPresetBand* bands = reinterpret_cast<const audio::algo::drain::EqualizerPresetBand*>(&m_data[sizeof(audio::algo::drain::EqualizerPresetHeader)]);
+	return bands[_id];
+}
+
+int32_t audio::algo::drain::EqualizerPreset::getNbCoefficientSet() const {
+	return getHeader(m_data).m_nbCoefficientSet;
+}
+
+double audio::algo::drain::EqualizerPreset::getCoefficientSetSampleRate(int32_t _id) const {
+	return getCoefficientSet(m_data, _id).m_sampleRate;
+}
+
+const double* audio::algo::drain::EqualizerPreset::getCoefficient(double _sampleRate, uint32_t _topology) const {
+	for (int32_t iii=0; iii<getNbCoefficientSet(); ++iii) {
+		const audio::algo::drain::EqualizerPresetCoefficientSet& set = getCoefficientSet(m_data, iii);
+		if (    set.m_sampleRate == _sampleRate
+		     && set.m_topology == _topology) {
+			return reinterpret_cast<const double*>(&set + 1);
+		}
+	}
+	return null;
+}
+
+bool audio::algo::drain::EqualizerPreset::apply(audio::algo::drain::Equalizer& _equalizer, double _sampleRate) const {
+	const double* coef = getCoefficient(_sampleRate);
+	bool ret = true;
+	for (int32_t iii=0; iii<getNbBand(); ++iii) {
+		const audio::algo::drain::EqualizerPresetBand& band = getBand(iii);
+		audio::algo::drain::BiQuadCoefficient design;
+		if (coef != null) {
+			design = audio::algo::drain::BiQuadCoefficient(coef[iii*nbCoef + 0],
+			                                               coef[iii*nbCoef + 1],
+			                                               coef[iii*nbCoef + 2],
+			                                               coef[iii*nbCoef + 3],
+			                                               coef[iii*nbCoef + 4]);
+		} else {
+			design = audio::algo::drain::BiQuadCache::get(audio::algo::drain::biQuadType(band.m_type), band.m_frequencyCut, band.m_qualityFactor, band.m_gain, _sampleRate);
+		}
+		ret = _equalizer.addBiquad(band.m_idChannel,
+		                           audio::algo::drain::biQuadType(band.m_type),
+		                           band.m_frequencyCut,
+		                           band.m_qualityFactor,
+		                           band.m_gain,
+		                           design) && ret;
+	}
+	return ret;
+}
+
+etk::String audio::algo::drain::EqualizerPreset::toText() const {
+	etk::String out = "# audio-algo-drain equalizer preset\n";
+	char line[1024];
+	for (int32_t iii=0; iii<getNbBand(); ++iii) {
+		const audio::algo::drain::EqualizerPresetBand& band = getBand(iii);
+		snprintf(line, sizeof(line), "band %d %s %.17g %.17g %.17g\n",
+		         band.m_idChannel,
+		         etk::toString(audio::algo::drain::biQuadType(band.m_type)).c_str(),
+		         band.m_frequencyCut,
+		         band.m_qualityFactor,
+		         band.m_gain);
+		out += line;
+	}
+	for (int32_t iii=0; iii<getNbCoefficientSet(); ++iii) {
+		snprintf(line, sizeof(line), "coefficient %.17g\n", getCoefficientSetSampleRate(iii));
+		out += line;
+	}
+	return out;
+}
+
+bool audio::algo::drain::EqualizerPreset::fromText(const etk::String& _text) {
+	etk::Vector<audio::algo::drain::EqualizerPresetBand> bands;
+	etk::Vector<double> sampleRates;
+	etk::Vector<etk::String> lines = etk::split(_text, '\n');
+	for (size_t lll=0; lll<lines.size(); ++lll) {
+		etk::Vector<etk::String> list;
+		etk::Vector<etk::String> elements = etk::split(lines[lll], ' ');
+		for (size_t iii=0; iii<elements.size(); ++iii) {
+			if (elements[iii].size() != 0) {
+				list.pushBack(elements[iii]);
+			}
+		}
+		if (    list.size() == 0
+		     || list[0][0] == '#') {
+			continue;
+		}
+		if (    list[0] == "band"
+		     && list.size() == 6) {
+			audio::algo::drain::EqualizerPresetBand band;
+			enum audio::algo::drain::biQuadType type;
+			if (etk::from_string(type, list[2]) == false) {
+				AA_DRAIN_ERROR("Preset line " << lll+1 << ": unknown type '" << list[2] << "'");
+				return false;
+			}
+			band.m_idChannel = etk::max(etk::string_to_int32_t(list[1]), int32_t(-1));
+			band.m_type = uint32_t(type);
+			band.m_frequencyCut = etk::string_to_double(list[3]);
+			band.m_qualityFactor = etk::string_to_double(list[4]);
+			band.m_gain = etk::string_to_double(list[5]);
+			bands.pushBack(band);
+		} else if (    list[0] == "coefficient"
+		            && list.size() == 2) {
+			double sampleRate = etk::string_to_double(list[1]);
+			if (sampleRate <= 0.0) {
+				AA_DRAIN_ERROR("Preset line " << lll+1 << ": wrong sample rate '" << list[1] << "'");
+				return false;
+			}
+			sampleRates.pushBack(sampleRate);
+		} else {
+			AA_DRAIN_ERROR("Preset line " << lll+1 << ": can not parse '" << lines[lll] << "'");
+			return false;
+		}
+	}
+	build(bands, sampleRates);
+	return true;
+}
+
@@ -0,0 +1,191 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <etk/types.hpp>
+#include <etk/Vector.hpp>
+#include <etk/String.hpp>
+#include <audio/algo/drain/BiQuadType.hpp>
+#include <audio/algo/drain/BiQuadDesign.hpp>
+#include <audio/algo/drain/Equalizer.hpp>
+
+namespace audio {
+	namespace algo {
+		namespace drain {
+			//! Version of the binary preset format.
+			static const uint32_t equalizerPresetVersion = 1;
+			//! Topology of the precomputed coefficients: direct form I (the Equalizer structure).
+			static const uint32_t equalizerPresetTopologyDirectForm1 = 0;
+			/**
+			 * @brief Header of a binary preset: "DREQ", version, nbBand, nbCoefficientSet (native byte order, little endian on all the supported targets).
+			 * It is followed by nbBand EqualizerPresetBand then nbCoefficientSet (EqualizerPresetCoefficientSet + nbBand*5 double).
+			 */
+			class EqualizerPresetHeader {
+				public:
+					char m_magic[4]; //!< "DREQ"
+					uint32_t m_version; //!< equalizerPresetVersion
+					uint32_t m_nbBand; //!< number of band
+					uint32_t m_nbCoefficientSet; //!< number of precomputed coefficient set
+			};
+			/**
+			 * @brief Parametric description of a band in a binary preset.
+			 */
+			class EqualizerPresetBand {
+				public:
+					int32_t m_idChannel; //!< channel of the band (-1 for all the channels)
+					uint32_t m_type; //!< enum audio::algo::drain::biQuadType
+					double m_frequencyCut; //!< cut frequency
+					double m_qualityFactor; //!< Q factor
+					double m_gain; //!< gain in dB
+			};
+			/**
+			 * @brief Header of a set of precomputed coefficients in a binary preset (followed by a0, a1, a2, b0, b1 of each band).
+			 */
+			class EqualizerPresetCoefficientSet {
+				public:
+					double m_sampleRate; //!< sample rate used for the design
+					uint32_t m_topology; //!< filter structure of the coefficients (equalizerPresetTopologyDirectForm1)
+					uint32_t m_reserved; //!< 0 (alignment)
+			};
+			/**
+			 * @brief Equalizer preset: list of parametric band with optional precomputed coefficients for some sample rates.
+			 * The binary form can be used directly from memory (file mapped in memory, embedded data) without copy.
+			 * The text form is for human edition:
+			 * @code
+			 * # comment
+			 * band <channel|-1> <type> <frequency> <Q> <gain>
+			 * coefficient <sampleRate>
+			 * @endcode
+			 */
+			class EqualizerPreset {
+				protected:
+					etk::Vector<uint64_t> m_storage; //!< owned binary data (uint64_t to be aligned for the doubles)
+					const uint8_t* m_data; //!< binary preset in use (in m_storage or in an external buffer)
+					size_t m_size; //!< size of the binary preset
+				public:
+					/**
+					 * @brief Constructor (empty preset)
+					 */
+					EqualizerPreset();
+					/**
+					 * @brief Copy constructor (the external data are still referenced, the owned data are copied).
+					 */
+					EqualizerPreset(const EqualizerPreset& _obj);
+					EqualizerPreset& operator=(const EqualizerPreset& _obj);
+				public:
+					/**
+					 * @brief Use a binary preset without copy (the buffer must stay valid while the preset is used).
+					 * @param[in] _data Pointer on the binary preset (8 bytes aligned, else it is copied).
+					 * @param[in] _size Size of the buffer.
+					 * @return true The preset is valid.
+					 */
+					bool load(const void* _data, size_t _size);
+					/**
+					 * @brief Load a binary preset file.
+					 * @param[in] _fileName Name of the file.
+					 * @return true The preset is valid.
+					 */
+					bool loadFile(const etk::String& _fileName);
+					/**
+					 * @brief Get the binary form of the preset.
+					 * @return Pointer on the binary data.
+					 */
+					const void* getData() const {
+						return m_data;
+					}
+					/**
+					 * @brief Get the size of the binary form of the preset.
+					 * @return Number of bytes.
+					 */
+					size_t getSize() const {
+						return m_size;
+					}
+					/**
+					 * @brief Write the binary form in a file.
+					 * @param[in] _fileName Name of the file.
+					 * @return true The file is written.
+					 */
+					bool storeFile(const etk::String& _fileName) const;
+					/**
+					 * @brief Get the text form of the preset.
+					 * @return Text of the preset.
+					 */
+					etk::String toText() const;
+					/**
+					 * @brief Set the preset from its text form.
+					 * @param[in] _text Text of the preset.
+					 * @return true The preset is valid.
+					 */
+					bool fromText(const etk::String& _text);
+				public:
+					/**
+					 * @brief Remove all the bands and coefficient sets.
+					 */
+					void clear();
+					/**
+					 * @brief Add a band (the existing coefficient sets are calculated again).
+					 * @param[in] _idChannel Channel of the band (-1 for all the channels).
+					 * @param[in] _type Type of biquad.
+					 * @param[in] _frequencyCut Cut Frequency. [0..sampleRate/2]
+					 * @param[in] _qualityFactor Q factor of quality.
+					 * @param[in] _gain Gain to apply (dB).
+					 */
+					void addBand(int32_t _idChannel, enum audio::algo::drain::biQuadType _type, double _frequencyCut, double _qualityFactor, double _gain);
+					/**
+					 * @brief Add the precomputed coefficients of all the bands for a sample rate.
+					 * @param[in] _sampleRate Sample rate of the design.
+					 */
+					void addCoefficientSet(double _sampleRate);
+					/**
+					 * @brief Get the number of band.
+					 */
+					int32_t getNbBand() const;
+					/**
+					 * @brief Get a band.
+					 * @param[in] _id Id of the band [0..getNbBand()[.
+					 */
+					const audio::algo::drain::EqualizerPresetBand& getBand(int32_t _id) const;
+					/**
+					 * @brief Get the number of precomputed coefficient set.
+					 */
+					int32_t getNbCoefficientSet() const;
+					/**
+					 * @brief Get the sample rate of a precomputed coefficient set.
+					 * @param[in] _id Id of the set [0..getNbCoefficientSet()[.
+					 */
+					double getCoefficientSetSampleRate(int32_t _id) const;
+					/**
+					 * @brief Get the precomputed coefficients for a sample rate (pointer in the binary data, no copy).
+					 * @param[in] _sampleRate Requested sample rate.
+					 * @param[in] _topology Requested filter structure.
+					 * @return a0, a1, a2, b0, b1 of each band or null if not precomputed.
+					 */
+					const double* getCoefficient(double _sampleRate, uint32_t _topology=audio::algo::drain::equalizerPresetTopologyDirectForm1) const;
+					/**
+					 * @brief Add all the bands in an Equalizer (with the precomputed coefficients if they exist, else with the design cache).
+					 * @param[in,out] _equalizer Equalizer to configure (already initialized).
+					 * @param[in] _sampleRate Sample rate of the Equalizer.
+					 * @return true All the bands have been added.
+					 */
+					bool apply(audio::algo::drain::Equalizer& _equalizer, double _sampleRate) const;
+				protected:
+					/**
+					 * @brief Check the binary data.
+					 */
+					static bool check(const uint8_t* _data, size_t _size);
+					/**
+					 * @brief Create the owned binary data.
+					 */
+					void build(const etk::Vector<audio::algo::drain::EqualizerPresetBand>& _bands, const etk::Vector<double>& _sampleRates);
+					/**
+					 * @brief Get all the bands and sample rates of the preset.
+					 */
+					void extract(etk::Vector<audio::algo::drain::EqualizerPresetBand>& _bands, etk::Vector<double>& _sampleRates) const;
+			};
+		}
+	}
+}
+
@@ -0,0 +1,158 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <audio/algo/drain/EqualizerRenderer.hpp>
+#include <audio/algo/drain/BiQuadCache.hpp>
+#include <audio/algo/drain/Processor.hpp>
+#include <audio/algo/drain/debug.hpp>
+#include <ethread/Thread.hpp>
+extern "C" {
+	#include <math.h>
+	#include <string.h>
+}
+
+// A segment shorter than this number of warm-up is not worth a thread (more than 25% of the time is lost in the warm-up).
+static const size_t segmentMinWarmUp = 4;
+
+/**
+ * @brief Get the radius of the biggest pole of a bi-quad: roots of z^2 + b0.z + b1.
+ */
+static double getPoleRadius(const audio::algo::drain::BiQuadCoefficient& _coef) {
+	double delta = _coef.m_b[0]*_coef.m_b[0] - 4.0*_coef.m_b[1];
+	if (delta < 0.0) {
+		// complex conjugate poles: |p|^2 = p.conj(p) = b1
+		return sqrt(_coef.m_b[1]);
+	}
+	double root0 = (-_coef.m_b[0] + sqrt(delta)) * 0.5;
+	double root1 = (-_coef.m_b[0] - sqrt(delta)) * 0.5;
+	return etk::max(fabs(root0), fabs(root1));
+}
+
+audio::algo::drain::EqualizerRenderer::EqualizerRenderer() :
+  m_sampleRate(48000),
+  m_nbChannel(2),
+  m_format(audio::format_float),
+  m_nbThread(getNbProcessor()),
+  m_seamThreshold(1.0e-6),
+  m_warmUpSize(0),
+  m_nbSegment(0) {
+	
+}
+
+void audio::algo::drain::EqualizerRenderer::init(const audio::algo::drain::EqualizerPreset& _preset, float _sampleRate, int8_t _nbChannel, enum audio::format _format) {
+	m_preset = _preset;
+	m_sampleRate = _sampleRate;
+	m_nbChannel = _nbChannel;
+	m_format = _format;
+	m_equalizers.clear();
+	m_warmUp.clear();
+	calculateWarmUp();
+}
+
+void audio::algo::drain::EqualizerRenderer::setNbThread(int32_t _nbThread) {
+	m_nbThread = etk::max(int32_t(1), _nbThread);
+}
+
+void audio::algo::drain::EqualizerRenderer::setSeamThreshold(double _threshold) {
+	if (    _threshold <= 0.0
+	     || _threshold >= 1.0) {
+		AA_DRAIN_ERROR("Seam threshold must be in ]0..1[ : " << _threshold);
+		return;
+	}
+	m_seamThreshold = _threshold;
+	calculateWarmUp();
+}
+
+void audio::algo::drain::EqualizerRenderer::calculateWarmUp() {
+	// The history left by the samples before the warm-up decrease as r^n (r: radius of the biggest pole).
+	// On a cascade the decays are added: the sum of the length of each stage is a safe bound (the repeated poles give a n^k.r^n response).
+	etk::Vector<double> channelSize;
+	channelSize.resize(m_nbChannel, 0.0);
+	const double* coef = m_preset.getCoefficient(m_sampleRate);
+	for (int32_t iii=0; iii<m_preset.getNbBand(); ++iii) {
+		const audio::algo::drain::EqualizerPresetBand& band = m_preset.getBand(iii);
+		audio::algo::drain::BiQuadCoefficient design;
+		if (coef != null) {
+			design = audio::algo::drain::BiQuadCoefficient(coef[iii*5 + 0], coef[iii*5 + 1], coef[iii*5 + 2], coef[iii*5 + 3], coef[iii*5 + 4]);
+		} else {
+			design = audio::algo::drain::BiQuadCache::get(audio::algo::drain::biQuadType(band.m_type), band.m_frequencyCut, band.m_qualityFactor, band.m_gain, m_sampleRate);
+		}
+		double radius = getPoleRadius(design);
+		if (radius >= 1.0) {
+			AA_DRAIN_WARNING("Band " << iii << " is not stable (pole radius=" << radius << "): no parallel process");
+			m_warmUpSize = 0;
+			return;
+		}
+		// 2 samples of history even without feedback
+		double size = 2.0;
+		if (radius > 0.0) {
+			size += log(m_seamThreshold) / log(radius);
+		}
+		for (int32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+			if (    band.m_idChannel == -1
+			     || band.m_idChannel == ccc) {
+				channelSize[ccc] += size;
+			}
+		}
+	}
+	double size = 0.0;
+	for (int32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+		size = etk::max(size, channelSize[ccc]);
+	}
+	m_warmUpSize = size_t(ceil(size));
+	AA_DRAIN_VERBOSE("Warm-up size=" << m_warmUpSize << " chunks for a seam threshold of " << m_seamThreshold);
+}
+
+void audio::algo::drain::EqualizerRenderer::process(void* _output, const void* _input, size_t _nbChunk) {
+	size_t chunkSize = audio::getFormatBytes(m_format) * m_nbChannel;
+	// number of segment:
+	m_nbSegment = 1;
+	if (m_warmUpSize != 0) {
+		m_nbSegment = int32_t(etk::min(size_t(m_nbThread), _nbChunk / (m_warmUpSize*segmentMinWarmUp)));
+		m_nbSegment = etk::max(int32_t(1), m_nbSegment);
+	}
+	// create the equalizers (only once)
+	while (m_equalizers.size() < size_t(m_nbSegment)) {
+		ememory::SharedPtr<audio::algo::drain::Equalizer> tmp = ememory::makeShared<audio::algo::drain::Equalizer>();
+		tmp->init(m_sampleRate, m_nbChannel, m_format);
+		m_preset.apply(*tmp, m_sampleRate);
+		m_equalizers.pushBack(tmp);
+	}
+	m_warmUp.resize(m_nbSegment);
+	const uint8_t* input = reinterpret_cast<const uint8_t*>(_input);
+	uint8_t* output = reinterpret_cast<uint8_t*>(_output);
+	etk::Vector<size_t> start;
+	for (int32_t sss=0; sss<=m_nbSegment; ++sss) {
+		start.pushBack(_nbChunk * sss / m_nbSegment);
+	}
+	// copy the warm-up input before any thread write in the output (process in place).
+	for (int32_t sss=1; sss<m_nbSegment; ++sss) {
+		size_t warmUpStart = start[sss] - etk::min(m_warmUpSize, start[sss]);
+		m_warmUp[sss].resize((start[sss] - warmUpStart) * chunkSize, 0);
+		memcpy(&m_warmUp[sss][0], &input[warmUpStart*chunkSize], m_warmUp[sss].size());
+	}
+	etk::Function<void(int32_t)> processSegment = [&](int32_t _id) {
+		audio::algo::drain::Equalizer& equalizer = *m_equalizers[_id];
+		equalizer.reset();
+		if (m_warmUp[_id].size() != 0) {
+			// the result of the warm-up is dropped (process in place in the copy)
+			equalizer.process(&m_warmUp[_id][0], &m_warmUp[_id][0], m_warmUp[_id].size()/chunkSize);
+		}
+		equalizer.process(&output[start[_id]*chunkSize], &input[start[_id]*chunkSize], start[_id+1] - start[_id]);
+	};
+	etk::Vector<ememory::SharedPtr<ethread::Thread> > threads;
+	for (int32_t sss=1; sss<m_nbSegment; ++sss) {
+		threads.pushBack(ememory::makeShared<ethread::Thread>([&processSegment, sss]() {
+		                                                          processSegment(sss);
+		                                                      },
+		                                                      "EqualizerRenderer"));
+	}
+	processSegment(0);
+	for (size_t iii=0; iii<threads.size(); ++iii) {
+		threads[iii]->join();
+	}
+}
+
@@ -0,0 +1,97 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <etk/types.hpp>
+#include <ememory/memory.hpp>
+#include <etk/Vector.hpp>
+#include <audio/format.hpp>
+#include <audio/algo/drain/Equalizer.hpp>
+#include <audio/algo/drain/EqualizerPreset.hpp>
+
+namespace audio {
+	namespace algo {
+		namespace drain {
+			/**
+			 * @brief Offline equalizer of a long stream on several threads.
+			 * The stream is cut in one segment per thread. Each segment is processed by its own Equalizer, after a warm-up on the samples before the segment:
+			 * the impulse response of the filters has decreased under the seam threshold at the end of the warm-up, then the result of the segment is the same as a sequential process (except an error under the threshold).
+			 */
+			class EqualizerRenderer {
+				protected:
+					float m_sampleRate; //!< sample rate of the stream
+					int8_t m_nbChannel; //!< number of channel of the stream
+					enum audio::format m_format; //!< format of the samples
+					audio::algo::drain::EqualizerPreset m_preset; //!< configuration of all the equalizers
+					int32_t m_nbThread; //!< maximum number of thread
+					double m_seamThreshold; //!< maximum relative amplitude of the seam error
+					size_t m_warmUpSize; //!< number of chunk processed before a segment
+					etk::Vector<ememory::SharedPtr<audio::algo::drain::Equalizer> > m_equalizers; //!< one equalizer per segment
+					etk::Vector<etk::Vector<uint8_t> > m_warmUp; //!< copy of the input before each segment (the output can be the input)
+					int32_t m_nbSegment; //!< number of segment of the last process
+				public:
+					/**
+					 * @brief Constructor
+					 */
+					EqualizerRenderer();
+				public:
+					/**
+					 * @brief Initialize the Algorithm
+					 * @param[in] _preset Bands of the equalizer.
+					 * @param[in] _sampleRate Sample rate of the stream.
+					 * @param[in] _nbChannel Number of channel in the stream.
+					 * @param[in] _format Input data format.
+					 */
+					void init(const audio::algo::drain::EqualizerPreset& _preset, float _sampleRate=48000, int8_t _nbChannel=2, enum audio::format _format=audio::format_float);
+					/**
+					 * @brief Set the maximum number of thread (default: number of processor).
+					 * @param[in] _nbThread Number of thread.
+					 */
+					void setNbThread(int32_t _nbThread);
+					/**
+					 * @brief Get the maximum number of thread.
+					 * @return Number of thread.
+					 */
+					int32_t getNbThread() const {
+						return m_nbThread;
+					}
+					/**
+					 * @brief Set the maximum error on the segment seam, relative to the signal amplitude (default 1e-6: -120 dB).
+					 * @note With the float formats, the rounding of the filters already give a bigger error than this one (the result of the warm-up can not be closer than the rounding of the sequential process).
+					 * @param[in] _threshold Linear threshold ]0..1[.
+					 */
+					void setSeamThreshold(double _threshold);
+					/**
+					 * @brief Get the number of chunk processed before each segment to reach the seam threshold.
+					 * @return Number of chunk (0 if the filters are unstable: the stream is processed on one thread).
+					 */
+					size_t getWarmUpSize() const {
+						return m_warmUpSize;
+					}
+					/**
+					 * @brief Get the number of segment used by the last process.
+					 * @return Number of segment.
+					 */
+					int32_t getNbSegment() const {
+						return m_nbSegment;
+					}
+					/**
+					 * @brief Process a complete stream (the history starts from zero at each call).
+					 * @param[out] _output Output data (interleaved, can be the same as the input).
+					 * @param[in] _input Input data (interleaved).
+					 * @param[in] _nbChunk Number of chunk in the input buffer.
+					 */
+					void process(void* _output, const void* _input, size_t _nbChunk);
+				protected:
+					/**
+					 * @brief Calculate the warm-up size from the decay of the poles of all the bi-quads.
+					 */
+					void calculateWarmUp();
+			};
+		}
+	}
+}
+
@@ -0,0 +1,147 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <audio/algo/drain/Fft.hpp>
+#include <audio/algo/drain/debug.hpp>
+
+// The real transform of N point is done with a complex transform of N/2 point:
+// even samples in the real part, odd samples in the imaginary part, then a split pass.
+
+audio::algo::drain::Fft::Fft() :
+  m_size(0) {
+	
+}
+
+bool audio::algo::drain::Fft::init(int32_t _size) {
+	if (    _size < 4
+	     || (_size & (_size-1)) != 0) {
+		AA_DRAIN_ERROR("FFT size must be a power of 2 >= 4 : " << _size);
+		m_size = 0;
+		return false;
+	}
+	m_size = _size;
+	int32_t nbPoint = m_size/2;
+	int32_t nbBit = 0;
+	while ((1<<nbBit) < nbPoint) {
+		nbBit++;
+	}
+	m_bitReverse.resize(nbPoint, 0);
+	for (int32_t iii=0; iii<nbPoint; ++iii) {
+		int32_t value = 0;
+		for (int32_t bbb=0; bbb<nbBit; ++bbb) {
+			if ((iii & (1<<bbb)) != 0) {
+				value |= 1<<(nbBit-1-bbb);
+			}
+		}
+		m_bitReverse[iii] = value;
+	}
+	m_twiddleReal.resize(nbPoint/2+1, 0.0f);
+	m_twiddleImag.resize(nbPoint/2+1, 0.0f);
+	for (int32_t iii=0; iii<=nbPoint/2; ++iii) {
+		double angle = 2.0 * M_PI * double(iii) / double(nbPoint);
+		m_twiddleReal[iii] = etk::cos(angle);
+		m_twiddleImag[iii] = etk::sin(angle);
+	}
+	m_splitReal.resize(nbPoint+1, 0.0f);
+	m_splitImag.resize(nbPoint+1, 0.0f);
+	for (int32_t iii=0; iii<=nbPoint; ++iii) {
+		double angle = 2.0 * M_PI * double(iii) / double(m_size);
+		m_splitReal[iii] = etk::cos(angle);
+		m_splitImag[iii] = etk::sin(angle);
+	}
+	m_bufferReal.resize(nbPoint, 0.0f);
+	m_bufferImag.resize(nbPoint, 0.0f);
+	return true;
+}
+
+void audio::algo::drain::Fft::complexTransform(float _sign) {
+	int32_t nbPoint = m_size/2;
+	float* real = &m_bufferReal[0];
+	float* imag = &m_bufferImag[0];
+	for (int32_t iii=0; iii<nbPoint; ++iii) {
+		int32_t jjj = m_bitReverse[iii];
+		if (iii < jjj) {
+			float tmp = real[iii];
+			real[iii] = real[jjj];
+			real[jjj] = tmp;
+			tmp = imag[iii];
+			imag[iii] = imag[jjj];
+			imag[jjj] = tmp;
+		}
+	}
+	for (int32_t len=2; len<=nbPoint; len<<=1) {
+		int32_t half = len>>1;
+		int32_t step = nbPoint/len;
+		for (int32_t jjj=0; jjj<half; ++jjj) {
+			float twReal = m_twiddleReal[jjj*step];
+			float twImag = _sign * m_twiddleImag[jjj*step];
+			for (int32_t iii=jjj; iii<nbPoint; iii+=len) {
+				int32_t kkk = iii + half;
+				float vReal = real[kkk]*twReal - imag[kkk]*twImag;
+				float vImag = real[kkk]*twImag + imag[kkk]*twReal;
+				real[kkk] = real[iii] - vReal;
+				imag[kkk] = imag[iii] - vImag;
+				real[iii] += vReal;
+				imag[iii] += vImag;
+			}
+		}
+	}
+}
+
+void audio::algo::drain::Fft::forward(float* _real, float* _imag, const float* _input) {
+	if (m_size == 0) {
+		AA_DRAIN_ERROR("FFT does not init ...");
+		return;
+	}
+	int32_t nbPoint = m_size/2;
+	for (int32_t iii=0; iii<nbPoint; ++iii) {
+		m_bufferReal[iii] = _input[2*iii];
+		m_bufferImag[iii] = _input[2*iii+1];
+	}
+	complexTransform(-1.0f);
+	for (int32_t kkk=0; kkk<=nbPoint; ++kkk) {
+		int32_t id = kkk%nbPoint;
+		int32_t idMirror = (nbPoint-kkk)%nbPoint;
+		// spectrum of the even samples
+		float evenReal = 0.5f * (m_bufferReal[id] + m_bufferReal[idMirror]);
+		float evenImag = 0.5f * (m_bufferImag[id] - m_bufferImag[idMirror]);
+		// spectrum of the odd samples
+		float oddReal = 0.5f * (m_bufferImag[id] + m_bufferImag[idMirror]);
+		float oddImag = -0.5f * (m_bufferReal[id] - m_bufferReal[idMirror]);
+		float twReal = m_splitReal[kkk];
+		float twImag = m_splitImag[kkk];
+		_real[kkk] = evenReal + twReal*oddReal + twImag*oddImag;
+		_imag[kkk] = evenImag + twReal*oddImag - twImag*oddReal;
+	}
+}
+
+void audio::algo::drain::Fft::inverse(float* _output, const float* _real, const float* _imag) {
+	if (m_size == 0) {
+		AA_DRAIN_ERROR("FFT does not init ...");
+		return;
+	}
+	int32_t nbPoint = m_size/2;
+	for (int32_t kkk=0; kkk<nbPoint; ++kkk) {
+		int32_t idMirror = nbPoint-kkk;
+		float evenReal = 0.5f * (_real[kkk] + _real[idMirror]);
+		float evenImag = 0.5f * (_imag[kkk] - _imag[idMirror]);
+		float deltaReal = 0.5f * (_real[kkk] - _real[idMirror]);
+		float deltaImag = 0.5f * (_imag[kkk] + _imag[idMirror]);
+		float twReal = m_splitReal[kkk];
+		float twImag = m_splitImag[kkk];
+		float oddReal = deltaReal*twReal - deltaImag*twImag;
+		float oddImag = deltaReal*twImag + deltaImag*twReal;
+		m_bufferReal[kkk] = evenReal - oddImag;
+		m_bufferImag[kkk] = evenImag + oddReal;
+	}
+	complexTransform(1.0f);
+	float scale = 1.0f / float(nbPoint);
+	for (int32_t iii=0; iii<nbPoint; ++iii) {
+		_output[2*iii] = m_bufferReal[iii] * scale;
+		_output[2*iii+1] = m_bufferImag[iii] * scale;
+	}
+}
+
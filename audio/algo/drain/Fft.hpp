@@ -0,0 +1,77 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <etk/types.hpp>
+#include <etk/Vector.hpp>
+
+namespace audio {
+	namespace algo {
+		namespace drain {
+			/**
+			 * @brief Real FFT (radix 2) with precomputed twiddles. Complex data are stored in separate real and imaginary buffers.
+			 * @note No allocation is done after init.
+			 */
+			class Fft {
+				public:
+					/**
+					 * @brief Constructor
+					 */
+					Fft();
+					/**
+					 * @brief Initialize the FFT tables.
+					 * @param[in] _size Number of real sample of a frame (power of 2, >= 4).
+					 * @return true The FFT is ready.
+					 */
+					bool init(int32_t _size);
+					/**
+					 * @brief Get the number of real sample of a frame.
+					 * @return Size of the FFT.
+					 */
+					int32_t getSize() const {
+						return m_size;
+					}
+					/**
+					 * @brief Get the number of bin generated by the forward transformation (size/2+1).
+					 * @return Number of bin.
+					 */
+					int32_t getNbBin() const {
+						return m_size/2 + 1;
+					}
+					/**
+					 * @brief Forward transformation (not normalized).
+					 * @param[out] _real Real part of the spectrum (size/2+1 bins).
+					 * @param[out] _imag Imaginary part of the spectrum (size/2+1 bins).
+					 * @param[in] _input Real input signal (size samples).
+					 */
+					void forward(float* _real, float* _imag, const float* _input);
+					/**
+					 * @brief Inverse transformation (normalized: inverse(forward(x)) == x).
+					 * @param[out] _output Real output signal (size samples).
+					 * @param[in] _real Real part of the spectrum (size/2+1 bins).
+					 * @param[in] _imag Imaginary part of the spectrum (size/2+1 bins).
+					 */
+					void inverse(float* _output, const float* _real, const float* _imag);
+				protected:
+					/**
+					 * @brief In place complex FFT of size/2 points on the internal buffers.
+					 * @param[in] _sign -1 for forward, +1 for inverse (not normalized).
+					 */
+					void complexTransform(float _sign);
+				protected:
+					int32_t m_size; //!< number of real sample
+					etk::Vector<int32_t> m_bitReverse; //!< bit reverse permutation of the size/2 complex points
+					etk::Vector<float> m_twiddleReal; //!< cos(2.pi.k/(size/2)) for the complex transform
+					etk::Vector<float> m_twiddleImag; //!< sin(2.pi.k/(size/2)) for the complex transform
+					etk::Vector<float> m_splitReal; //!< cos(2.pi.k/size) to split the packed real transform
+					etk::Vector<float> m_splitImag; //!< sin(2.pi.k/size) to split the packed real transform
+					etk::Vector<float> m_bufferReal; //!< working buffer (real part)
+					etk::Vector<float> m_bufferImag; //!< working buffer (imaginary part)
+			};
+		}
+	}
+}
+
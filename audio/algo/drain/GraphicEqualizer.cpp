@@ -0,0 +1,448 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <audio/algo/drain/GraphicEqualizer.hpp>
+#include <audio/algo/drain/Equalizer.hpp>
+#include <audio/algo/drain/BiQuadDesign.hpp>
+#include <audio/algo/drain/VectorMath.hpp>
+#include <audio/algo/drain/debug.hpp>
+#include <ethread/Mutex.hpp>
+extern "C" {
+	#include <math.h>
+}
+
+// Limit of the sliders (dB).
+static const float sliderGainMax = 24.0f;
+// Limit of the gain of a band after the interaction correction (dB).
+static const double bandGainMax = 36.0;
+// Gain of the bands used to measure their interaction (dB): middle of the range of the sliders.
+static const double prototypeGain = 12.0;
+// Number of correction of the gains on the real response of the bands (the bands are not linear in their gain).
+static const int32_t nbRefinement = 3;
+// Maximum frequency of a band (relative to the sample rate).
+static const float bandFrequencyMax = 0.45f;
+
+/**
+ * @brief Calculate the response (dB) of the bands at their center frequencies.
+ * The bands are peaks: their magnitude is the closed form of biQuadPeakPower (a cut is the inverse of the boost).
+ * @param[out] _response Response at the center of each band (dB).
+ * @param[in] _gain Gain of each band (dB).
+ * @param[in] _tangent tan(pi.frequency/sampleRate) of the center of each band.
+ * @param[in] _nbBand Number of band.
+ * @param[in] _qualityBase Q of a band at 0 dB (the Q is qualityBase x sqrt(V)).
+ * @param[out] _ratio Temporary buffer (nbBand x nbBand).
+ * @param[out] _level Temporary buffer (nbBand x nbBand).
+ */
+static void bandResponse(double* _response, const double* _gain, const float* _tangent, int32_t _nbBand, double _qualityBase, float* _ratio, float* _level) {
+	for (int32_t bbb=0; bbb<_nbBand; ++bbb) {
+		float V2 = pow(10.0, fabs(_gain[bbb]) / 10.0);
+		// (K.t/Q)^2 with Q^2 = qualityBase^2 x V
+		float K2 = _tangent[bbb] * _tangent[bbb];
+		float invQ2 = 1.0 / (_qualityBase * _qualityBase * sqrt(V2));
+		float* ratio = &_ratio[bbb*_nbBand];
+		for (int32_t iii=0; iii<_nbBand; ++iii) {
+			ratio[iii] = audio::algo::drain::biQuadPeakPower(K2, _tangent[iii] * _tangent[iii], invQ2, V2);
+		}
+	}
+	audio::algo::drain::vectorMath::log10(_level, _ratio, _nbBand*_nbBand);
+	for (int32_t iii=0; iii<_nbBand; ++iii) {
+		_response[iii] = 0.0;
+	}
+	for (int32_t bbb=0; bbb<_nbBand; ++bbb) {
+		double sign = _gain[bbb] < 0.0 ? -10.0 : 10.0;
+		const float* level = &_level[bbb*_nbBand];
+		for (int32_t iii=0; iii<_nbBand; ++iii) {
+			_response[iii] += sign * level[iii];
+		}
+	}
+}
+
+/**
+ * @brief Invert a square matrix (Gauss-Jordan with partial pivoting).
+ * @param[out] _inverse Inverse matrix [row][column].
+ * @param[in,out] _matrix Matrix to invert [row][column] (destroyed).
+ * @param[in] _size Number of row.
+ * @return false The matrix is singular.
+ */
+static bool invertMatrix(double* _inverse, double* _matrix, int32_t _size) {
+	for (int32_t iii=0; iii<_size; ++iii) {
+		for (int32_t jjj=0; jjj<_size; ++jjj) {
+			_inverse[iii*_size + jjj] = iii == jjj ? 1.0 : 0.0;
+		}
+	}
+	for (int32_t ccc=0; ccc<_size; ++ccc) {
+		int32_t pivot = ccc;
+		for (int32_t rrr=ccc+1; rrr<_size; ++rrr) {
+			if (fabs(_matrix[rrr*_size + ccc]) > fabs(_matrix[pivot*_size + ccc])) {
+				pivot = rrr;
+			}
+		}
+		if (fabs(_matrix[pivot*_size + ccc]) < 1.0e-12) {
+			return false;
+		}
+		if (pivot != ccc) {
+			for (int32_t jjj=0; jjj<_size; ++jjj) {
+				double tmp = _matrix[ccc*_size + jjj];
+				_matrix[ccc*_size + jjj] = _matrix[pivot*_size + jjj];
+				_matrix[pivot*_size + jjj] = tmp;
+				tmp = _inverse[ccc*_size + jjj];
+				_inverse[ccc*_size + jjj] = _inverse[pivot*_size + jjj];
+				_inverse[pivot*_size + jjj] = tmp;
+			}
+		}
+		double scale = 1.0 / _matrix[ccc*_size + ccc];
+		for (int32_t jjj=0; jjj<_size; ++jjj) {
+			_matrix[ccc*_size + jjj] *= scale;
+			_inverse[ccc*_size + jjj] *= scale;
+		}
+		for (int32_t rrr=0; rrr<_size; ++rrr) {
+			double factor = _matrix[rrr*_size + ccc];
+			if (    rrr == ccc
+			     || factor == 0.0) {
+				continue;
+			}
+			for (int32_t jjj=0; jjj<_size; ++jjj) {
+				_matrix[rrr*_size + jjj] -= factor * _matrix[ccc*_size + jjj];
+				_inverse[rrr*_size + jjj] -= factor * _inverse[ccc*_size + jjj];
+			}
+		}
+	}
+	return true;
+}
+
+namespace audio {
+	namespace algo {
+		namespace drain {
+			class GraphicEqualizerPrivate {
+				protected:
+					float m_sampleRate;
+					int32_t m_nbBand;
+					double m_qualityBase; //!< Q of a band at 0 dB
+					etk::Vector<float> m_frequency; //!< center frequency of each band
+					etk::Vector<float> m_tangent; //!< tan(pi.frequency/sampleRate) of each band
+					etk::Vector<double> m_inverse; //!< inverse of the interaction matrix [band][slider]
+					audio::algo::drain::Equalizer m_equalizer;
+					ethread::Mutex m_mutex; //!< protect the sliders and the pending coefficients (the process only try to lock it)
+					etk::Vector<float> m_slider; //!< level of the sliders (dB)
+					etk::Vector<double> m_bandGain; //!< gain of the bands after the correction (dB)
+					etk::Vector<double> m_quality; //!< Q of the bands
+					etk::Vector<audio::algo::drain::BiQuadCoefficient> m_coef; //!< coefficients of the bands
+					bool m_pending; //!< the coefficients are not in the equalizer
+					// temporary buffers of the correction (no allocation on a slider change)
+					etk::Vector<double> m_response;
+					etk::Vector<double> m_error;
+					etk::Vector<float> m_ratio;
+					etk::Vector<float> m_level;
+				public:
+					GraphicEqualizerPrivate() :
+					  m_sampleRate(48000),
+					  m_nbBand(0),
+					  m_qualityBase(1.0),
+					  m_pending(false) {
+						
+					}
+					void init(float _sampleRate, int8_t _nbChannel, enum audio::format _format, int32_t _bandPerOctave) {
+						m_sampleRate = _sampleRate;
+						m_frequency = audio::algo::drain::GraphicEqualizer::createBandFrequency(_bandPerOctave);
+						while (    m_frequency.size() > 0
+						        && m_frequency[m_frequency.size()-1] > _sampleRate*bandFrequencyMax) {
+							m_frequency.popBack();
+						}
+						m_nbBand = m_frequency.size();
+						// bandwidth at half of the gain (dB) = band spacing r: |K/t - t/K| = sqrt(V)/Q at the edges t/K = r^(+-1/2)
+						double spacing = pow(2.0, 1.0/double(_bandPerOctave));
+						m_qualityBase = sqrt(spacing) / (spacing - 1.0);
+						m_tangent.resize(m_nbBand);
+						for (int32_t bbb=0; bbb<m_nbBand; ++bbb) {
+							m_tangent[bbb] = tan(M_PI * m_frequency[bbb] / m_sampleRate);
+						}
+						m_slider.resize(m_nbBand, 0.0f);
+						m_bandGain.resize(m_nbBand, 0.0);
+						m_quality.resize(m_nbBand, m_qualityBase);
+						m_coef.resize(m_nbBand);
+						m_response.resize(m_nbBand, 0.0);
+						m_error.resize(m_nbBand, 0.0);
+						m_ratio.resize(m_nbBand*m_nbBand, 1.0f);
+						m_level.resize(m_nbBand*m_nbBand, 0.0f);
+						// interaction matrix: response at the center of each band of a band at the prototype gain (linear model of the bands)
+						etk::Vector<double> matrix;
+						matrix.resize(m_nbBand*m_nbBand, 0.0);
+						etk::Vector<double> gain;
+						gain.resize(m_nbBand, 0.0);
+						for (int32_t bbb=0; bbb<m_nbBand; ++bbb) {
+							gain[bbb] = prototypeGain;
+							bandResponse(&m_response[0], &gain[0], &m_tangent[0], m_nbBand, m_qualityBase, &m_ratio[0], &m_level[0]);
+							gain[bbb] = 0.0;
+							for (int32_t iii=0; iii<m_nbBand; ++iii) {
+								matrix[iii*m_nbBand + bbb] = m_response[iii] / prototypeGain;
+							}
+						}
+						m_inverse.resize(m_nbBand*m_nbBand, 0.0);
+						if (    m_nbBand > 0
+						     && invertMatrix(&m_inverse[0], &matrix[0], m_nbBand) == false) {
+							AA_DRAIN_ERROR("Can not invert the interaction matrix of the graphic equalizer");
+							for (int32_t iii=0; iii<m_nbBand; ++iii) {
+								for (int32_t jjj=0; jjj<m_nbBand; ++jjj) {
+									m_inverse[iii*m_nbBand + jjj] = iii == jjj ? 1.0 : 0.0;
+								}
+							}
+						}
+						m_equalizer.init(_sampleRate, _nbChannel, _format);
+						for (int32_t bbb=0; bbb<m_nbBand; ++bbb) {
+							m_coef[bbb] = audio::algo::drain::biQuadDesignTangent(audio::algo::drain::biQuadType_peak, m_tangent[bbb], m_qualityBase, 0.0, 1.0);
+							m_equalizer.addBiquad(-1, audio::algo::drain::biQuadType_peak, m_frequency[bbb], m_qualityBase, 0.0, m_coef[bbb]);
+						}
+						m_equalizer.calibrate();
+						m_pending = false;
+					}
+					void reset() {
+						m_equalizer.reset();
+					}
+					etk::Vector<enum audio::format> getSupportedFormat() {
+						return m_equalizer.getSupportedFormat();
+					}
+					void process(void* _output, const void* _input, size_t _nbChunk) {
+						// apply the last slider change only if the UI does not have the lock: the audio thread never wait
+						if (m_mutex.tryLock() == true) {
+							if (m_pending == true) {
+								for (int32_t bbb=0; bbb<m_nbBand; ++bbb) {
+									m_equalizer.setBiquad(-1, bbb, audio::algo::drain::biQuadType_peak, m_frequency[bbb], m_quality[bbb], m_bandGain[bbb], m_coef[bbb]);
+								}
+								m_pending = false;
+							}
+							m_mutex.unlock();
+						}
+						m_equalizer.process(_output, _input, _nbChunk);
+					}
+					int32_t getNbBand() {
+						return m_nbBand;
+					}
+					float getFrequency(int32_t _idBand) {
+						if (    _idBand < 0
+						     || _idBand >= m_nbBand) {
+							AA_DRAIN_ERROR("Request frequency of band " << _idBand << " that does not exist");
+							return 0.0f;
+						}
+						return m_frequency[_idBand];
+					}
+					bool setGain(int32_t _idBand, float _gain) {
+						if (    _idBand < 0
+						     || _idBand >= m_nbBand) {
+							AA_DRAIN_ERROR("Request set gain of band " << _idBand << " that does not exist");
+							return false;
+						}
+						m_mutex.lock();
+						m_slider[_idBand] = etk::max(-sliderGainMax, etk::min(sliderGainMax, _gain));
+						update();
+						m_mutex.unlock();
+						return true;
+					}
+					bool setGains(const etk::Vector<float>& _gain) {
+						if (int32_t(_gain.size()) != m_nbBand) {
+							AA_DRAIN_ERROR("Request set " << _gain.size() << " gains on " << m_nbBand << " bands");
+							return false;
+						}
+						m_mutex.lock();
+						for (int32_t bbb=0; bbb<m_nbBand; ++bbb) {
+							m_slider[bbb] = etk::max(-sliderGainMax, etk::min(sliderGainMax, _gain[bbb]));
+						}
+						update();
+						m_mutex.unlock();
+						return true;
+					}
+					float getGain(int32_t _idBand) {
+						if (    _idBand < 0
+						     || _idBand >= m_nbBand) {
+							AA_DRAIN_ERROR("Request gain of band " << _idBand << " that does not exist");
+							return 0.0f;
+						}
+						m_mutex.lock();
+						float out = m_slider[_idBand];
+						m_mutex.unlock();
+						return out;
+					}
+					float getBandGain(int32_t _idBand) {
+						if (    _idBand < 0
+						     || _idBand >= m_nbBand) {
+							AA_DRAIN_ERROR("Request band gain of band " << _idBand << " that does not exist");
+							return 0.0f;
+						}
+						m_mutex.lock();
+						float out = m_bandGain[_idBand];
+						m_mutex.unlock();
+						return out;
+					}
+					etk::Vector<etk::Pair<float,float> > calculateTheory() {
+						// the equalizer can have an old design (not processed yet): the response is calculated on the last one
+						audio::algo::drain::Equalizer equalizer;
+						equalizer.init(m_sampleRate, 1, audio::format_float);
+						m_mutex.lock();
+						for (int32_t bbb=0; bbb<m_nbBand; ++bbb) {
+							equalizer.addBiquad(-1, audio::algo::drain::biQuadType_peak, m_frequency[bbb], m_quality[bbb], m_bandGain[bbb], m_coef[bbb]);
+						}
+						m_mutex.unlock();
+						return equalizer.calculateTheory();
+					}
+				protected:
+					/**
+					 * @brief Calculate the gains of the bands from the sliders and design the bands (m_mutex locked).
+					 * The interaction matrix gives the first estimation, the error of the real response at the centers is then corrected with the same matrix.
+					 */
+					void update() {
+						for (int32_t bbb=0; bbb<m_nbBand; ++bbb) {
+							m_error[bbb] = m_slider[bbb];
+							m_bandGain[bbb] = 0.0;
+						}
+						for (int32_t rrr=0; rrr<=nbRefinement; ++rrr) {
+							if (rrr != 0) {
+								bandResponse(&m_response[0], &m_bandGain[0], &m_tangent[0], m_nbBand, m_qualityBase, &m_ratio[0], &m_level[0]);
+								for (int32_t iii=0; iii<m_nbBand; ++iii) {
+									m_error[iii] = m_slider[iii] - m_response[iii];
+								}
+							}
+							for (int32_t bbb=0; bbb<m_nbBand; ++bbb) {
+								const double* inverse = &m_inverse[bbb*m_nbBand];
+								double delta = 0.0;
+								for (int32_t iii=0; iii<m_nbBand; ++iii) {
+									delta += inverse[iii] * m_error[iii];
+								}
+								m_bandGain[bbb] = etk::max(-bandGainMax, etk::min(bandGainMax, m_bandGain[bbb] + delta));
+							}
+						}
+						for (int32_t bbb=0; bbb<m_nbBand; ++bbb) {
+							double gainLinear = pow(10.0, fabs(m_bandGain[bbb]) / 20.0);
+							m_quality[bbb] = m_qualityBase * sqrt(gainLinear);
+							m_coef[bbb] = audio::algo::drain::biQuadDesignTangent(audio::algo::drain::biQuadType_peak, m_tangent[bbb], m_quality[bbb], m_bandGain[bbb], gainLinear);
+						}
+						m_pending = true;
+					}
+			};
+		}
+	}
+}
+
+audio::algo::drain::GraphicEqualizer::GraphicEqualizer() {
+	
+}
+
+audio::algo::drain::GraphicEqualizer::~GraphicEqualizer() {
+	
+}
+
+void audio::algo::drain::GraphicEqualizer::init(float _sampleRate, int8_t _nbChannel, enum audio::format _format, int32_t _bandPerOctave) {
+	if (    _bandPerOctave <= 0
+	     || _bandPerOctave > 24) {
+		AA_DRAIN_ERROR("Request graphic equalizer with " << _bandPerOctave << " band(s) per octave");
+		return;
+	}
+	m_private = ememory::makeShared<GraphicEqualizerPrivate>();
+	if (m_private == null) {
+		AA_DRAIN_ERROR("can not allocate private data...");
+		return;
+	}
+	m_private->init(_sampleRate, _nbChannel, _format, _bandPerOctave);
+}
+
+void audio::algo::drain::GraphicEqualizer::reset() {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("GraphicEqualizer does not init ...");
+		return;
+	}
+	m_private->reset();
+}
+
+etk::Vector<enum audio::format> audio::algo::drain::GraphicEqualizer::getSupportedFormat() {
+	if (m_private == null) {
+		return audio::algo::drain::GraphicEqualizer::getNativeSupportedFormat();
+	}
+	return m_private->getSupportedFormat();
+}
+
+etk::Vector<enum audio::format> audio::algo::drain::GraphicEqualizer::getNativeSupportedFormat() {
+	etk::Vector<enum audio::format> out;
+	out.pushBack(audio::format_float);
+	return out;
+}
+
+void audio::algo::drain::GraphicEqualizer::process(void* _output, const void* _input, size_t _nbChunk) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("GraphicEqualizer does not init ...");
+		return;
+	}
+	m_private->process(_output, _input, _nbChunk);
+}
+
+etk::Vector<float> audio::algo::drain::GraphicEqualizer::createBandFrequency(int32_t _bandPerOctave) {
+	etk::Vector<float> out;
+	if (_bandPerOctave <= 0) {
+		return out;
+	}
+	// the centers are in the third octave bands of 20 Hz and 20 kHz (ISO 266: 31 bands in third octave, 10 bands in octave)
+	double minimum = 20.0 * pow(2.0, -1.0/6.0);
+	double maximum = 20000.0 * pow(2.0, 1.0/6.0);
+	int32_t first = ceil(log2(minimum/1000.0) * _bandPerOctave - 1.0e-6);
+	int32_t last = floor(log2(maximum/1000.0) * _bandPerOctave + 1.0e-6);
+	for (int32_t kkk=first; kkk<=last; ++kkk) {
+		out.pushBack(1000.0 * pow(2.0, double(kkk)/double(_bandPerOctave)));
+	}
+	return out;
+}
+
+int32_t audio::algo::drain::GraphicEqualizer::getNbBand() {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("GraphicEqualizer does not init ...");
+		return 0;
+	}
+	return m_private->getNbBand();
+}
+
+float audio::algo::drain::GraphicEqualizer::getFrequency(int32_t _idBand) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("GraphicEqualizer does not init ...");
+		return 0.0f;
+	}
+	return m_private->getFrequency(_idBand);
+}
+
+bool audio::algo::drain::GraphicEqualizer::setGain(int32_t _idBand, float _gain) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("GraphicEqualizer does not init ...");
+		return false;
+	}
+	return m_private->setGain(_idBand, _gain);
+}
+
+bool audio::algo::drain::GraphicEqualizer::setGains(const etk::Vector<float>& _gain) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("GraphicEqualizer does not init ...");
+		return false;
+	}
+	return m_private->setGains(_gain);
+}
+
+float audio::algo::drain::GraphicEqualizer::getGain(int32_t _idBand) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("GraphicEqualizer does not init ...");
+		return 0.0f;
+	}
+	return m_private->getGain(_idBand);
+}
+
+float audio::algo::drain::GraphicEqualizer::getBandGain(int32_t _idBand) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("GraphicEqualizer does not init ...");
+		return 0.0f;
+	}
+	return m_private->getBandGain(_idBand);
+}
+
+etk::Vector<etk::Pair<float,float> > audio::algo::drain::GraphicEqualizer::calculateTheory() {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("GraphicEqualizer does not init ...");
+		return etk::Vector<etk::Pair<float,float> >();
+	}
+	return m_private->calculateTheory();
+}
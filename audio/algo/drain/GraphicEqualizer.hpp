@@ -0,0 +1,118 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <etk/types.hpp>
+#include <ememory/memory.hpp>
+#include <etk/Vector.hpp>
+#include <etk/Pair.hpp>
+#include <audio/format.hpp>
+
+namespace audio {
+	namespace algo {
+		namespace drain {
+			class GraphicEqualizerPrivate;
+			/**
+			 * @brief Graphic equalizer: a bank of peak bands on a fixed 1/N octave grid, driven by sliders.
+			 * The Q of each band is proportional to its gain (the bandwidth at half of the gain in dB is the band spacing, whatever the gain): the shape of the bands stays the same and the neighbours interact the same way.
+			 * The response of the bands is corrected for their interaction: the gains of the bands are calculated so that the response at the center of each band is the level of its slider.
+			 * The bands are the stages of an Equalizer (calibrated on the fastest kernel), a slider change only update the coefficients (no allocation, the history is kept).
+			 */
+			class GraphicEqualizer {
+				public:
+					/**
+					 * @brief Constructor
+					 */
+					GraphicEqualizer();
+					/**
+					 * @brief Destructor
+					 */
+					virtual ~GraphicEqualizer();
+				public:
+					/**
+					 * @brief Reset all history of the Algo.
+					 */
+					void reset();
+					/**
+					 * @brief Initialize the Algorithm (all the sliders at 0 dB).
+					 * @param[in] _sampleRate Sample rate of the stream.
+					 * @param[in] _nbChannel Number of channel in the stream.
+					 * @param[in] _format Input/output data format.
+					 * @param[in] _bandPerOctave Number of band per octave (1: 10 bands, 3: 31 bands).
+					 */
+					virtual void init(float _sampleRate=48000, int8_t _nbChannel=2, enum audio::format _format=audio::format_float, int32_t _bandPerOctave=3);
+					/**
+					 * @brief Get list of format suported in input.
+					 * @return list of supported format
+					 */
+					virtual etk::Vector<enum audio::format> getSupportedFormat();
+					/**
+					 * @brief Get list of algorithm format suported. No format convertion.
+					 * @return list of supported format
+					 */
+					virtual etk::Vector<enum audio::format> getNativeSupportedFormat();
+					/**
+					 * @brief Main input algo process (the last slider change is applied at the start of the block).
+					 * @param[out] _output Output data.
+					 * @param[in] _input Input data.
+					 * @param[in] _nbChunk Number of chunk in the input buffer.
+					 */
+					virtual void process(void* _output, const void* _input, size_t _nbChunk);
+				public:
+					/**
+					 * @brief Create the center frequencies of the bands (1000 Hz x 2^(k/bandPerOctave) from 20 Hz to 20 kHz).
+					 * @param[in] _bandPerOctave Number of band per octave.
+					 * @return List of frequency (Hz, increasing).
+					 */
+					static etk::Vector<float> createBandFrequency(int32_t _bandPerOctave);
+					/**
+					 * @brief Get the number of band (the bands over 0.45 x sampleRate are removed).
+					 * @return Number of band.
+					 */
+					int32_t getNbBand();
+					/**
+					 * @brief Get the center frequency of a band.
+					 * @param[in] _idBand Id of the band.
+					 * @return Frequency (Hz).
+					 */
+					float getFrequency(int32_t _idBand);
+					/**
+					 * @brief Set the level of a slider (can be called from an other thread than the process).
+					 * @param[in] _idBand Id of the band.
+					 * @param[in] _gain Level at the center of the band (dB, limited to -24..+24 dB).
+					 * @return true The slider is set.
+					 */
+					bool setGain(int32_t _idBand, float _gain);
+					/**
+					 * @brief Set the level of all the sliders (can be called from an other thread than the process).
+					 * @param[in] _gain Level at the center of each band (dB, getNbBand() values).
+					 * @return true The sliders are set.
+					 */
+					bool setGains(const etk::Vector<float>& _gain);
+					/**
+					 * @brief Get the level of a slider.
+					 * @param[in] _idBand Id of the band.
+					 * @return Level of the slider (dB).
+					 */
+					float getGain(int32_t _idBand);
+					/**
+					 * @brief Get the gain of the peak of a band after the interaction correction.
+					 * @param[in] _idBand Id of the band.
+					 * @return Gain of the band (dB).
+					 */
+					float getBandGain(int32_t _idBand);
+					/**
+					 * @brief Calculate the theoretical response of the equalizer (gains of the last slider change).
+					 * @return list of frequency/gain (dB).
+					 */
+					etk::Vector<etk::Pair<float,float> > calculateTheory();
+				protected:
+					ememory::SharedPtr<GraphicEqualizerPrivate> m_private; //!< private data.
+			};
+		}
+	}
+}
+
@@ -0,0 +1,455 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <audio/algo/drain/LoudnessMeter.hpp>
+#include <audio/algo/drain/BiQuadDesign.hpp>
+#include <audio/algo/drain/debug.hpp>
+extern "C" {
+	#include <math.h>
+}
+
+// see ITU-R BS.1770-4 and EBU Tech 3341
+// see https://github.com/jiixyj/libebur128 (design of the K-weighting at any sample rate)
+
+// Duration of an accumulation block (second): step of the gating blocks.
+static const double subBlockDuration = 0.1;
+// Number of accumulation block of the momentary loudness (400 ms).
+static const int32_t momentaryNbSubBlock = 4;
+// Number of accumulation block of the short-term loudness (3 s).
+static const int32_t shortTermNbSubBlock = 30;
+// Offset of the loudness (dB).
+static const double loudnessOffset = -0.691;
+// Absolute gate (LUFS).
+static const double absoluteGate = -70.0;
+// Relative gate (LU).
+static const double relativeGate = -10.0;
+// Histogram of the gating blocks: bins of 0.1 LU from the absolute gate to +10 LUFS (louder blocks are in the last bin).
+static const double histogramStep = 0.1;
+static const int32_t histogramNbBin = 800;
+// Number of tap of each phase of the true peak interpolator (48 taps at 4x).
+static const int32_t truePeakNbTap = 12;
+// Number of sample processed at the same time by the true peak interpolator.
+static const int32_t truePeakBlockSize = 256;
+
+/**
+ * @brief K-weighting first stage: high-shelf of +4 dB (head effect).
+ */
+static audio::algo::drain::BiQuadCoefficient designKWeightingShelf(double _sampleRate) {
+	double frequency = 1681.974450955533;
+	double gain = 3.999843853973347;
+	double qualityFactor = 0.7071752369554196;
+	double K = tan(M_PI * frequency / _sampleRate);
+	double Vh = pow(10.0, gain / 20.0);
+	double Vb = pow(Vh, 0.4996667741545416);
+	double norm = 1.0 / (1.0 + K / qualityFactor + K * K);
+	return audio::algo::drain::BiQuadCoefficient((Vh + Vb * K / qualityFactor + K * K) * norm,
+	                                             2.0 * (K * K - Vh) * norm,
+	                                             (Vh - Vb * K / qualityFactor + K * K) * norm,
+	                                             2.0 * (K * K - 1.0) * norm,
+	                                             (1.0 - K / qualityFactor + K * K) * norm);
+}
+
+/**
+ * @brief K-weighting second stage: RLB high-pass at 38 Hz.
+ */
+static audio::algo::drain::BiQuadCoefficient designKWeightingHighPass(double _sampleRate) {
+	double frequency = 38.13547087602444;
+	double qualityFactor = 0.5003270373238773;
+	double K = tan(M_PI * frequency / _sampleRate);
+	double norm = 1.0 / (1.0 + K / qualityFactor + K * K);
+	return audio::algo::drain::BiQuadCoefficient(1.0,
+	                                             -2.0,
+	                                             1.0,
+	                                             2.0 * (K * K - 1.0) * norm,
+	                                             (1.0 - K / qualityFactor + K * K) * norm);
+}
+
+static double energyToLoudness(double _energy) {
+	if (_energy <= 0.0) {
+		return -HUGE_VAL;
+	}
+	return loudnessOffset + 10.0*log10(_energy);
+}
+
+namespace audio {
+	namespace algo {
+		namespace drain {
+			class LoudnessMeterPrivate {
+				protected:
+					float m_sampleRate;
+					int32_t m_nbChannel;
+					etk::Vector<float> m_weight; //!< weight of each channel
+					float m_coef[2][5]; //!< coefficients of the 2 K-weighting stages (a0, a1, a2, b0, b1)
+					etk::Vector<float> m_history; //!< history of the K-weighting [x1, x2, y1, y2, w1, w2][channel] (x: input, y: first stage, w: second stage)
+					int32_t m_subBlockSize; //!< number of chunk of an accumulation block
+					int32_t m_subBlockCount; //!< number of chunk in the current accumulation block
+					etk::Vector<double> m_sum; //!< sum of the square of the current accumulation block [channel]
+					double m_energy[shortTermNbSubBlock]; //!< mean square (weighted sum of the channels) of the last accumulation blocks
+					int32_t m_energyPos; //!< position of the next accumulation block in m_energy
+					int64_t m_nbSubBlock; //!< number of completed accumulation block
+					double m_histogramEnergy[histogramNbBin]; //!< sum of the energy of the gating blocks of each bin
+					uint64_t m_histogramCount[histogramNbBin]; //!< number of gating block in each bin
+					int32_t m_oversampling; //!< over-sampling factor of the true peak
+					etk::Vector<float> m_truePeakCoef; //!< interpolator coefficients [phase][tap]
+					etk::Vector<float> m_truePeakHistory; //!< last samples of each channel [channel][truePeakNbTap-1]
+					etk::Vector<float> m_truePeak; //!< maximum absolute over-sampled value [channel]
+					etk::Vector<float> m_tmp; //!< one channel of a block with its history
+					etk::Vector<float> m_value; //!< over-sampled values of a phase
+				public:
+					LoudnessMeterPrivate() :
+					  m_sampleRate(48000),
+					  m_nbChannel(0),
+					  m_subBlockSize(4800),
+					  m_subBlockCount(0),
+					  m_energyPos(0),
+					  m_nbSubBlock(0),
+					  m_oversampling(4) {
+						
+					}
+					void init(float _sampleRate, int8_t _nbChannel) {
+						m_sampleRate = _sampleRate;
+						m_nbChannel = _nbChannel;
+						m_weight.clear();
+						m_weight.resize(m_nbChannel, 1.0f);
+						audio::algo::drain::BiQuadCoefficient coef[2] = {designKWeightingShelf(m_sampleRate), designKWeightingHighPass(m_sampleRate)};
+						for (int32_t sss=0; sss<2; ++sss) {
+							m_coef[sss][0] = coef[sss].m_a[0];
+							m_coef[sss][1] = coef[sss].m_a[1];
+							m_coef[sss][2] = coef[sss].m_a[2];
+							m_coef[sss][3] = coef[sss].m_b[0];
+							m_coef[sss][4] = coef[sss].m_b[1];
+						}
+						m_history.resize(6*m_nbChannel, 0.0f);
+						m_subBlockSize = int32_t(m_sampleRate*subBlockDuration + 0.5);
+						m_sum.resize(m_nbChannel, 0.0);
+						// over-sampling up to 192 kHz
+						m_oversampling = 1;
+						while (m_sampleRate*m_oversampling < 191999.0f) {
+							m_oversampling *= 2;
+						}
+						// windowed sinc: the phase 0 is the original signal
+						int32_t nbCoef = m_oversampling*truePeakNbTap;
+						int32_t center = nbCoef/2;
+						m_truePeakCoef.resize(nbCoef, 0.0f);
+						for (int32_t ppp=0; ppp<m_oversampling; ++ppp) {
+							for (int32_t kkk=0; kkk<truePeakNbTap; ++kkk) {
+								int32_t id = ppp + kkk*m_oversampling;
+								double position = double(id - center) / double(m_oversampling);
+								double sinc = id == center ? 1.0 : sin(M_PI*position) / (M_PI*position);
+								double window = 0.42 - 0.5*cos(2.0*M_PI*id/nbCoef) + 0.08*cos(4.0*M_PI*id/nbCoef);
+								m_truePeakCoef[ppp*truePeakNbTap + kkk] = sinc * window;
+							}
+						}
+						m_truePeakHistory.resize(m_nbChannel*(truePeakNbTap-1), 0.0f);
+						m_truePeak.resize(m_nbChannel, 0.0f);
+						m_tmp.resize(truePeakNbTap-1 + truePeakBlockSize, 0.0f);
+						m_value.resize(truePeakBlockSize, 0.0f);
+						reset();
+					}
+					void reset() {
+						for (size_t iii=0; iii<m_history.size(); ++iii) {
+							m_history[iii] = 0.0f;
+						}
+						for (int32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+							m_sum[ccc] = 0.0;
+							m_truePeak[ccc] = 0.0f;
+						}
+						for (size_t iii=0; iii<m_truePeakHistory.size(); ++iii) {
+							m_truePeakHistory[iii] = 0.0f;
+						}
+						for (int32_t iii=0; iii<shortTermNbSubBlock; ++iii) {
+							m_energy[iii] = 0.0;
+						}
+						for (int32_t iii=0; iii<histogramNbBin; ++iii) {
+							m_histogramEnergy[iii] = 0.0;
+							m_histogramCount[iii] = 0;
+						}
+						m_subBlockCount = 0;
+						m_energyPos = 0;
+						m_nbSubBlock = 0;
+					}
+					void setChannelWeight(int32_t _idChannel, float _weight) {
+						if (    _idChannel < 0
+						     || _idChannel >= m_nbChannel) {
+							AA_DRAIN_ERROR("Request weight on channel " << _idChannel << " out of [0.." << m_nbChannel << "[");
+							return;
+						}
+						m_weight[_idChannel] = _weight;
+					}
+					bool process(const float* _input, size_t _nbChunk) {
+						bool newBlock = false;
+						while (_nbChunk > 0) {
+							int32_t nbSample = etk::min(size_t(m_subBlockSize - m_subBlockCount), _nbChunk);
+							filter(_input, nbSample);
+							for (int32_t offset=0; offset<nbSample; offset+=truePeakBlockSize) {
+								detectTruePeak(&_input[offset*m_nbChannel], etk::min(truePeakBlockSize, nbSample-offset));
+							}
+							m_subBlockCount += nbSample;
+							if (m_subBlockCount == m_subBlockSize) {
+								endSubBlock();
+								newBlock = true;
+							}
+							_input += nbSample*m_nbChannel;
+							_nbChunk -= nbSample;
+						}
+						return newBlock;
+					}
+					double getMomentary() {
+						return energyToLoudness(getMeanEnergy(momentaryNbSubBlock));
+					}
+					double getShortTerm() {
+						return energyToLoudness(getMeanEnergy(shortTermNbSubBlock));
+					}
+					double getIntegrated() {
+						// absolute gate: all the blocks of the histogram
+						double energy = 0.0;
+						uint64_t count = 0;
+						for (int32_t iii=0; iii<histogramNbBin; ++iii) {
+							energy += m_histogramEnergy[iii];
+							count += m_histogramCount[iii];
+						}
+						if (count == 0) {
+							return absoluteGate;
+						}
+						// relative gate: the bins over the threshold (the bin of the threshold is included)
+						double threshold = energyToLoudness(energy/double(count)) + relativeGate;
+						int32_t start = etk::max(int32_t(0), int32_t(floor((threshold - absoluteGate) / histogramStep)));
+						energy = 0.0;
+						count = 0;
+						for (int32_t iii=start; iii<histogramNbBin; ++iii) {
+							energy += m_histogramEnergy[iii];
+							count += m_histogramCount[iii];
+						}
+						if (count == 0) {
+							return absoluteGate;
+						}
+						return energyToLoudness(energy/double(count));
+					}
+					double getTruePeak(int32_t _idChannel) {
+						float peak = 0.0f;
+						for (int32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+							if (    _idChannel == -1
+							     || _idChannel == ccc) {
+								peak = etk::max(peak, m_truePeak[ccc]);
+							}
+						}
+						if (peak <= 0.0f) {
+							return -HUGE_VAL;
+						}
+						return 20.0*log10(peak);
+					}
+				protected:
+					/**
+					 * @brief K-weighting and sum of the square: the channels are in the inner loop (vectorized by the compiler).
+					 */
+					void filter(const float* _input, int32_t _nbSample) {
+						int32_t nbChannel = m_nbChannel;
+						float* x1 = &m_history[0];
+						float* x2 = &m_history[nbChannel];
+						float* y1 = &m_history[2*nbChannel];
+						float* y2 = &m_history[3*nbChannel];
+						// the output of the first stage is the input of the second one: y1/y2 are x1/x2 of the second stage
+						float* w1 = &m_history[4*nbChannel];
+						float* w2 = &m_history[5*nbChannel];
+						const float a0 = m_coef[0][0];
+						const float a1 = m_coef[0][1];
+						const float a2 = m_coef[0][2];
+						const float b0 = m_coef[0][3];
+						const float b1 = m_coef[0][4];
+						const float c0 = m_coef[1][0];
+						const float c1 = m_coef[1][1];
+						const float c2 = m_coef[1][2];
+						const float d0 = m_coef[1][3];
+						const float d1 = m_coef[1][4];
+						double* sum = &m_sum[0];
+						for (int32_t iii=0; iii<_nbSample; ++iii) {
+							const float* input = &_input[iii*nbChannel];
+							for (int32_t ccc=0; ccc<nbChannel; ++ccc) {
+								float sample = input[ccc];
+								float shelf = a0*sample + a1*x1[ccc] + a2*x2[ccc] - b0*y1[ccc] - b1*y2[ccc];
+								x2[ccc] = x1[ccc];
+								x1[ccc] = sample;
+								float highPass = c0*shelf + c1*y1[ccc] + c2*y2[ccc] - d0*w1[ccc] - d1*w2[ccc];
+								y2[ccc] = y1[ccc];
+								y1[ccc] = shelf;
+								w2[ccc] = w1[ccc];
+								w1[ccc] = highPass;
+								sum[ccc] += double(highPass*highPass);
+							}
+						}
+					}
+					/**
+					 * @brief Over-sample a block and update the true peak of each channel (a tap on all the samples at once: vectorized by the compiler).
+					 */
+					void detectTruePeak(const float* _input, int32_t _nbSample) {
+						for (int32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+							float* history = &m_truePeakHistory[ccc*(truePeakNbTap-1)];
+							float* data = &m_tmp[0];
+							for (int32_t iii=0; iii<truePeakNbTap-1; ++iii) {
+								data[iii] = history[iii];
+							}
+							for (int32_t iii=0; iii<_nbSample; ++iii) {
+								data[truePeakNbTap-1 + iii] = _input[iii*m_nbChannel + ccc];
+							}
+							float peak = m_truePeak[ccc];
+							float* value = &m_value[0];
+							for (int32_t ppp=0; ppp<m_oversampling; ++ppp) {
+								const float* coef = &m_truePeakCoef[ppp*truePeakNbTap];
+								for (int32_t iii=0; iii<_nbSample; ++iii) {
+									value[iii] = 0.0f;
+								}
+								for (int32_t kkk=0; kkk<truePeakNbTap; ++kkk) {
+									// sample[iii] = x[n - kkk]
+									const float* sample = &data[truePeakNbTap-1 - kkk];
+									float tap = coef[kkk];
+									for (int32_t iii=0; iii<_nbSample; ++iii) {
+										value[iii] += tap * sample[iii];
+									}
+								}
+								for (int32_t iii=0; iii<_nbSample; ++iii) {
+									float absolute = value[iii] < 0.0f ? -value[iii] : value[iii];
+									peak = absolute > peak ? absolute : peak;
+								}
+							}
+							m_truePeak[ccc] = peak;
+							for (int32_t iii=0; iii<truePeakNbTap-1; ++iii) {
+								history[iii] = data[_nbSample + iii];
+							}
+						}
+					}
+					/**
+					 * @brief Store the energy of the completed accumulation block and add the new gating block in the histogram.
+					 */
+					void endSubBlock() {
+						double energy = 0.0;
+						for (int32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+							energy += m_weight[ccc] * m_sum[ccc];
+							m_sum[ccc] = 0.0;
+						}
+						m_energy[m_energyPos] = energy / double(m_subBlockSize);
+						m_energyPos = (m_energyPos + 1) % shortTermNbSubBlock;
+						m_subBlockCount = 0;
+						m_nbSubBlock++;
+						if (m_nbSubBlock < momentaryNbSubBlock) {
+							// the first gating block is complete after 400 ms
+							return;
+						}
+						double blockEnergy = getMeanEnergy(momentaryNbSubBlock);
+						double loudness = energyToLoudness(blockEnergy);
+						if (loudness <= absoluteGate) {
+							return;
+						}
+						int32_t bin = etk::min(histogramNbBin-1, int32_t((loudness - absoluteGate) / histogramStep));
+						m_histogramEnergy[bin] += blockEnergy;
+						m_histogramCount[bin]++;
+					}
+					/**
+					 * @brief Get the mean of the energy of the last accumulation blocks.
+					 */
+					double getMeanEnergy(int32_t _nbSubBlock) {
+						double energy = 0.0;
+						for (int32_t iii=1; iii<=_nbSubBlock; ++iii) {
+							energy += m_energy[(m_energyPos - iii + shortTermNbSubBlock) % shortTermNbSubBlock];
+						}
+						return energy / double(_nbSubBlock);
+					}
+			};
+		}
+	}
+}
+
+audio::algo::drain::LoudnessMeter::LoudnessMeter() {
+	
+}
+
+audio::algo::drain::LoudnessMeter::~LoudnessMeter() {
+	
+}
+
+void audio::algo::drain::LoudnessMeter::init(float _sampleRate, int8_t _nbChannel, enum audio::format _format) {
+	if (_format != audio::format_float) {
+		AA_DRAIN_CRITICAL("Request format for loudness meter that not exist ... : " << _format);
+		return;
+	}
+	if (_nbChannel <= 0) {
+		AA_DRAIN_ERROR("Request loudness meter with " << int32_t(_nbChannel) << " channel(s)");
+		return;
+	}
+	m_private = ememory::makeShared<LoudnessMeterPrivate>();
+	if (m_private == null) {
+		AA_DRAIN_ERROR("can not allocate private data...");
+		return;
+	}
+	m_private->init(_sampleRate, _nbChannel);
+}
+
+void audio::algo::drain::LoudnessMeter::reset() {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("LoudnessMeter does not init ...");
+		return;
+	}
+	m_private->reset();
+}
+
+etk::Vector<enum audio::format> audio::algo::drain::LoudnessMeter::getSupportedFormat() {
+	etk::Vector<enum audio::format> out = audio::algo::drain::LoudnessMeter::getNativeSupportedFormat();
+	return out;
+}
+
+etk::Vector<enum audio::format> audio::algo::drain::LoudnessMeter::getNativeSupportedFormat() {
+	etk::Vector<enum audio::format> out;
+	out.pushBack(audio::format_float);
+	return out;
+}
+
+bool audio::algo::drain::LoudnessMeter::process(const void* _input, size_t _nbChunk) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("LoudnessMeter does not init ...");
+		return false;
+	}
+	return m_private->process(reinterpret_cast<const float*>(_input), _nbChunk);
+}
+
+void audio::algo::drain::LoudnessMeter::setChannelWeight(int32_t _idChannel, float _weight) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("LoudnessMeter does not init ...");
+		return;
+	}
+	m_private->setChannelWeight(_idChannel, _weight);
+}
+
+double audio::algo::drain::LoudnessMeter::getMomentary() {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("LoudnessMeter does not init ...");
+		return -HUGE_VAL;
+	}
+	return m_private->getMomentary();
+}
+
+double audio::algo::drain::LoudnessMeter::getShortTerm() {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("LoudnessMeter does not init ...");
+		return -HUGE_VAL;
+	}
+	return m_private->getShortTerm();
+}
+
+double audio::algo::drain::LoudnessMeter::getIntegrated() {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("LoudnessMeter does not init ...");
+		return -HUGE_VAL;
+	}
+	return m_private->getIntegrated();
+}
+
+double audio::algo::drain::LoudnessMeter::getTruePeak(int32_t _idChannel) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("LoudnessMeter does not init ...");
+		return -HUGE_VAL;
+	}
+	return m_private->getTruePeak(_idChannel);
+}
+
@@ -0,0 +1,97 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <etk/types.hpp>
+#include <ememory/memory.hpp>
+#include <etk/Vector.hpp>
+#include <audio/format.hpp>
+
+namespace audio {
+	namespace algo {
+		namespace drain {
+			class LoudnessMeterPrivate;
+			/**
+			 * @brief Loudness meter (ITU-R BS.1770-4 / EBU R128): momentary (400 ms), short-term (3 s) and integrated (gated) loudness, true peak.
+			 * The signal is K-weighted (high-shelf + high-pass bi-quads), the mean square is accumulated by block of 100 ms.
+			 * The integrated loudness uses an histogram of the 400 ms blocks (0.1 LU bins with the sum of the energy of each bin): the memory does not grow with the stream duration.
+			 * The true peak is the maximum of the signal over-sampled by 4 (2 at 96 kHz, none at 192 kHz).
+			 * The stream is considered silent before its start (the momentary and short-term values are valid after 400 ms and 3 s).
+			 */
+			class LoudnessMeter {
+				public:
+					/**
+					 * @brief Constructor
+					 */
+					LoudnessMeter();
+					/**
+					 * @brief Destructor
+					 */
+					virtual ~LoudnessMeter();
+				public:
+					/**
+					 * @brief Reset all history of the Algo (and the integrated loudness and true peak).
+					 */
+					void reset();
+					/**
+					 * @brief Initialize the Algorithm
+					 * @param[in] _sampleRate Sample rate of the stream.
+					 * @param[in] _nbChannel Number of channel in the stream.
+					 * @param[in] _format Input data format.
+					 */
+					virtual void init(float _sampleRate=48000, int8_t _nbChannel=2, enum audio::format _format=audio::format_float);
+					/**
+					 * @brief Get list of format suported in input.
+					 * @return list of supported format
+					 */
+					virtual etk::Vector<enum audio::format> getSupportedFormat();
+					/**
+					 * @brief Get list of algorithm format suported. No format convertion.
+					 * @return list of supported format
+					 */
+					virtual etk::Vector<enum audio::format> getNativeSupportedFormat();
+					/**
+					 * @brief Main input algo process (analysis only, no allocation).
+					 * @param[in] _input Input data (interleaved, nbChannel).
+					 * @param[in] _nbChunk Number of chunk in the input buffer.
+					 * @return true A 100 ms block has been completed: new momentary and short-term values.
+					 */
+					virtual bool process(const void* _input, size_t _nbChunk);
+				public:
+					/**
+					 * @brief Set the weight of a channel in the sum (default 1.0; BS.1770: 1.41 for the surround channels, 0 for the LFE).
+					 * @param[in] _idChannel Id of the channel.
+					 * @param[in] _weight Weight of the power of the channel.
+					 */
+					void setChannelWeight(int32_t _idChannel, float _weight);
+					/**
+					 * @brief Get the momentary loudness (last 400 ms).
+					 * @return Loudness (LUFS).
+					 */
+					double getMomentary();
+					/**
+					 * @brief Get the short-term loudness (last 3 s).
+					 * @return Loudness (LUFS).
+					 */
+					double getShortTerm();
+					/**
+					 * @brief Get the integrated loudness since the init or the reset (absolute gate -70 LUFS, relative gate -10 LU).
+					 * @return Loudness (LUFS, -70 if all the blocks are under the absolute gate).
+					 */
+					double getIntegrated();
+					/**
+					 * @brief Get the true peak since the init or the reset.
+					 * @param[in] _idChannel Id of the channel (-1: maximum of all the channels).
+					 * @return True peak (dBTP).
+					 */
+					double getTruePeak(int32_t _idChannel=-1);
+				protected:
+					ememory::SharedPtr<LoudnessMeterPrivate> m_private; //!< private data.
+			};
+		}
+	}
+}
+
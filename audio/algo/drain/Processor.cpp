@@ -0,0 +1,22 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <audio/algo/drain/Processor.hpp>
+extern "C" {
+	#if !defined(__TARGET_OS__Windows)
+		#include <unistd.h>
+	#endif
+}
+
+int32_t audio::algo::drain::getNbProcessor() {
+	#if !defined(__TARGET_OS__Windows)
+		long nbProcessor = sysconf(_SC_NPROCESSORS_ONLN);
+		if (nbProcessor > 0) {
+			return int32_t(nbProcessor);
+		}
+	#endif
+	return 1;
+}
@@ -0,0 +1,21 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <etk/types.hpp>
+
+namespace audio {
+	namespace algo {
+		namespace drain {
+			/**
+			 * @brief Get the number of processor online (default number of thread of the parallel processing).
+			 * @return Number of processor (1 when it can not be read).
+			 */
+			int32_t getNbProcessor();
+		}
+	}
+}
+
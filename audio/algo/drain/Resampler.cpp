@@ -0,0 +1,437 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <audio/algo/drain/Resampler.hpp>
+#include <audio/algo/drain/VectorMath.hpp>
+#include <audio/algo/drain/debug.hpp>
+extern "C" {
+	#include <math.h>
+	#include <string.h>
+}
+
+// Number of input chunk added in the history at a time.
+static const int32_t blockSize = 1024;
+// Maximum number of filter of the exact table (ratio L/M with L > this value use the interpolated table).
+static const int64_t rationalMaxNbPhase = 1024;
+// Maximum size of the exact table (float).
+static const int64_t rationalMaxTableSize = 256*1024;
+// Maximum length of a filter (strong down-sampling).
+static const int32_t maxNbTap = 4096;
+// Filter of each quality: number of tap (on up-sampling), Kaiser window beta and number of filter of the interpolated table.
+static const int32_t qualityNbTap[] = {8, 16, 24, 32, 48, 64, 80, 96, 128, 192, 256};
+static const float qualityBeta[] = {4.0f, 5.0f, 6.0f, 7.0f, 8.0f, 8.5f, 9.0f, 9.5f, 10.0f, 11.0f, 12.0f};
+static const int32_t qualityNbPhase[] = {32, 32, 64, 64, 128, 128, 256, 256, 512, 512, 1024};
+static const int32_t qualityMax = sizeof(qualityNbTap)/sizeof(int32_t) - 1;
+
+/**
+ * @brief Modified Bessel function of the first kind, order 0 (Kaiser window).
+ */
+static double besselI0(double _value) {
+	double sum = 1.0;
+	double term = 1.0;
+	double halfValue = _value * 0.5;
+	for (int32_t kkk=1; kkk<100; ++kkk) {
+		term *= halfValue / kkk;
+		double squareTerm = term * term;
+		sum += squareTerm;
+		if (squareTerm < sum * 1e-16) {
+			break;
+		}
+	}
+	return sum;
+}
+
+static inline float toFloat(float _value) {
+	return _value;
+}
+
+static inline float toFloat(int16_t _value) {
+	return float(_value) * (1.0f/32768.0f);
+}
+
+static inline void fromFloat(float& _output, float _value) {
+	_output = _value;
+}
+
+static inline void fromFloat(int16_t& _output, float _value) {
+	float value = _value * 32768.0f;
+	value = value > 32767.0f ? 32767.0f : value;
+	value = value < -32768.0f ? -32768.0f : value;
+	_output = int16_t(lrintf(value));
+}
+
+static int64_t greatestCommonDivisor(int64_t _aaa, int64_t _bbb) {
+	while (_bbb != 0) {
+		int64_t tmp = _aaa % _bbb;
+		_aaa = _bbb;
+		_bbb = tmp;
+	}
+	return _aaa;
+}
+
+namespace audio {
+	namespace algo {
+		namespace drain {
+			class ResamplerPrivate {
+				protected:
+					float m_sampleRateIn;
+					float m_sampleRateOut;
+					int32_t m_nbChannel;
+					int32_t m_nbTap; //!< length of a filter (multiple of 8)
+					bool m_rational; //!< exact table: one filter per phase
+					uint32_t m_nbPhase; //!< number of phase of the table (the interpolated table has one more filter)
+					etk::Vector<float> m_table; //!< filters [phase][tap]
+					etk::Vector<float> m_coef; //!< interpolated filter of the current output
+					size_t m_stepInt; //!< integer part of the input advance per output sample
+					uint32_t m_stepFrac; //!< fractional part of the advance (unit 1/m_nbPhase on the exact table, 1/2^32 on the interpolated table)
+					size_t m_historyStride; //!< size of the history of a channel
+					etk::Vector<float> m_history; //!< planar history [channel][sample]
+					size_t m_count; //!< number of sample in the history
+					size_t m_position; //!< position of the first tap of the next output sample in the history
+					uint32_t m_phase; //!< fractional position of the next output sample (same unit as m_stepFrac)
+					etk::Vector<const float*> m_inputFloat; //!< pointer on each input channel (no allocation in process)
+					etk::Vector<float*> m_outputFloat; //!< pointer on each output channel
+					etk::Vector<const int16_t*> m_inputInt16;
+					etk::Vector<int16_t*> m_outputInt16;
+				public:
+					ResamplerPrivate() :
+					  m_sampleRateIn(48000),
+					  m_sampleRateOut(48000),
+					  m_nbChannel(1),
+					  m_nbTap(8),
+					  m_rational(true),
+					  m_nbPhase(1),
+					  m_stepInt(1),
+					  m_stepFrac(0),
+					  m_historyStride(0),
+					  m_count(0),
+					  m_position(0),
+					  m_phase(0) {
+						
+					}
+					void init(float _sampleRateIn, float _sampleRateOut, int32_t _nbChannel, int32_t _quality) {
+						m_sampleRateIn = _sampleRateIn;
+						m_sampleRateOut = _sampleRateOut;
+						m_nbChannel = _nbChannel;
+						int32_t quality = etk::max(int32_t(0), etk::min(_quality, qualityMax));
+						double ratio = double(m_sampleRateOut) / double(m_sampleRateIn);
+						// cut-off in the middle of the transition band: the stop-band start at the Nyquist frequency
+						double beta = qualityBeta[quality];
+						double attenuation = beta / 0.1102 + 8.7;
+						double transition = (attenuation - 8.0) / (2.285 * M_PI * qualityNbTap[quality]);
+						double cutOff = 1.0 - transition;
+						m_nbTap = qualityNbTap[quality];
+						if (ratio < 1.0) {
+							// down-sampling: the filter is scaled on the output Nyquist frequency
+							cutOff *= ratio;
+							m_nbTap = etk::min(maxNbTap, int32_t(ceil(m_nbTap / ratio / 8.0)) * 8);
+						} else if (ratio == 1.0) {
+							// no conversion: the filter is a delay
+							cutOff = 1.0;
+						}
+						// ratio out/in = L/M
+						m_rational = false;
+						if (    m_sampleRateIn == floor(m_sampleRateIn)
+						     && m_sampleRateOut == floor(m_sampleRateOut)
+						     && m_sampleRateIn > 0.0f
+						     && m_sampleRateOut > 0.0f) {
+							int64_t rateIn = int64_t(m_sampleRateIn);
+							int64_t rateOut = int64_t(m_sampleRateOut);
+							int64_t divisor = greatestCommonDivisor(rateIn, rateOut);
+							int64_t nbPhase = rateOut / divisor;
+							int64_t advance = rateIn / divisor;
+							if (    nbPhase <= rationalMaxNbPhase
+							     && nbPhase * m_nbTap <= rationalMaxTableSize) {
+								m_rational = true;
+								m_nbPhase = nbPhase;
+								m_stepInt = advance / nbPhase;
+								m_stepFrac = advance % nbPhase;
+							}
+						}
+						if (m_rational == false) {
+							m_nbPhase = qualityNbPhase[quality];
+							double step = double(m_sampleRateIn) / double(m_sampleRateOut);
+							m_stepInt = size_t(floor(step));
+							m_stepFrac = uint32_t(etk::min(4294967295.0, floor((step - floor(step)) * 4294967296.0 + 0.5)));
+						}
+						// filter of the phase p: output at the time (nbTap/2 - 1 + p/nbPhase) of the history
+						int32_t nbFilter = m_nbPhase + (m_rational == true ? 0 : 1);
+						m_table.resize(nbFilter * m_nbTap, 0.0f);
+						double halfLength = m_nbTap / 2;
+						double windowNorm = 1.0 / besselI0(beta);
+						for (int32_t ppp=0; ppp<nbFilter; ++ppp) {
+							double phase = double(ppp) / double(m_nbPhase);
+							double sum = 0.0;
+							float* coef = &m_table[ppp*m_nbTap];
+							for (int32_t kkk=0; kkk<m_nbTap; ++kkk) {
+								double position = kkk - (halfLength - 1.0) - phase;
+								double value = cutOff;
+								if (fabs(position) > 1e-9) {
+									value = sin(M_PI * cutOff * position) / (M_PI * position);
+								}
+								double windowPos = position / halfLength;
+								windowPos = etk::min(1.0, windowPos * windowPos);
+								value *= besselI0(beta * sqrt(1.0 - windowPos)) * windowNorm;
+								coef[kkk] = value;
+								sum += value;
+							}
+							// unitary gain of each filter (no modulation of the DC by the phase)
+							for (int32_t kkk=0; kkk<m_nbTap; ++kkk) {
+								coef[kkk] = double(coef[kkk]) / sum;
+							}
+						}
+						m_coef.resize(m_nbTap, 0.0f);
+						m_historyStride = m_nbTap + blockSize;
+						m_history.resize(m_historyStride * m_nbChannel, 0.0f);
+						m_inputFloat.resize(m_nbChannel, null);
+						m_outputFloat.resize(m_nbChannel, null);
+						m_inputInt16.resize(m_nbChannel, null);
+						m_outputInt16.resize(m_nbChannel, null);
+						AA_DRAIN_VERBOSE("Resampler " << m_sampleRateIn << " ==> " << m_sampleRateOut << " Hz: " << m_nbTap << " taps, "
+						                 << (m_rational == true ? "exact" : "interpolated") << " table of " << m_nbPhase << " phases");
+						reset();
+					}
+					void reset() {
+						for (size_t iii=0; iii<m_history.size(); ++iii) {
+							m_history[iii] = 0.0f;
+						}
+						// the first output is the first input sample: in the middle of the filter
+						m_count = m_nbTap/2 - 1;
+						m_position = 0;
+						m_phase = 0;
+					}
+					size_t getMaxOutputSize(size_t _nbChunk) {
+						return size_t(double(_nbChunk) * double(m_sampleRateOut) / double(m_sampleRateIn)) + 2;
+					}
+					int32_t getLatency() {
+						return int32_t(ceil(double(m_nbTap/2) * double(m_sampleRateOut) / double(m_sampleRateIn)));
+					}
+					int32_t getNbTap() {
+						return m_nbTap;
+					}
+					bool isRational() {
+						return m_rational;
+					}
+					size_t process(float* _output, const float* _input, size_t _nbChunk) {
+						for (int32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+							m_inputFloat[ccc] = &_input[ccc];
+							m_outputFloat[ccc] = &_output[ccc];
+						}
+						return processType(&m_outputFloat[0], &m_inputFloat[0], m_nbChannel, _nbChunk);
+					}
+					size_t process(int16_t* _output, const int16_t* _input, size_t _nbChunk) {
+						for (int32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+							m_inputInt16[ccc] = &_input[ccc];
+							m_outputInt16[ccc] = &_output[ccc];
+						}
+						return processType(&m_outputInt16[0], &m_inputInt16[0], m_nbChannel, _nbChunk);
+					}
+					size_t processPlanar(float* const* _output, const float* const* _input, size_t _nbChunk) {
+						return processType(_output, _input, 1, _nbChunk);
+					}
+				protected:
+					/**
+					 * @brief Resample a stream with a pointer on each channel.
+					 * @param[in] _stride Distance between two samples of a channel (number of channel for interleaved data, 1 for planar data).
+					 */
+					template<typename TYPE>
+					size_t processType(TYPE* const* _output, const TYPE* const* _input, size_t _stride, size_t _nbChunk) {
+						size_t nbOutput = 0;
+						size_t offset = 0;
+						while (offset < _nbChunk) {
+							size_t nbChunk = etk::min(size_t(blockSize), _nbChunk - offset);
+							// add the input in the history (conversion in float)
+							for (int32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+								const TYPE* input = &_input[ccc][offset*_stride];
+								float* history = &m_history[ccc*m_historyStride + m_count];
+								for (size_t iii=0; iii<nbChunk; ++iii) {
+									history[iii] = toFloat(input[iii*_stride]);
+								}
+							}
+							m_count += nbChunk;
+							offset += nbChunk;
+							if (m_rational == true) {
+								nbOutput += filterRational(_output, _stride, nbOutput);
+							} else {
+								nbOutput += filterInterpolated(_output, _stride, nbOutput);
+							}
+							// keep only the samples needed by the next outputs
+							if (m_position >= m_count) {
+								m_position -= m_count;
+								m_count = 0;
+							} else if (m_position > 0) {
+								for (int32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+									float* history = &m_history[ccc*m_historyStride];
+									memmove(history, &history[m_position], (m_count - m_position) * sizeof(float));
+								}
+								m_count -= m_position;
+								m_position = 0;
+							}
+						}
+						return nbOutput;
+					}
+					/**
+					 * @brief Generate the output samples available in the history with the exact table.
+					 * @return Number of output sample.
+					 */
+					template<typename TYPE>
+					size_t filterRational(TYPE* const* _output, size_t _stride, size_t _offset) {
+						size_t nbOutput = 0;
+						while (m_position + m_nbTap <= m_count) {
+							const float* coef = &m_table[m_phase*m_nbTap];
+							size_t outputPos = (_offset + nbOutput) * _stride;
+							for (int32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+								fromFloat(_output[ccc][outputPos], audio::algo::drain::vectorMath::dot(coef, &m_history[ccc*m_historyStride + m_position], m_nbTap));
+							}
+							nbOutput++;
+							m_position += m_stepInt;
+							m_phase += m_stepFrac;
+							if (m_phase >= m_nbPhase) {
+								m_phase -= m_nbPhase;
+								m_position++;
+							}
+						}
+						return nbOutput;
+					}
+					/**
+					 * @brief Generate the output samples available in the history with the interpolation of the two nearest filters.
+					 * @return Number of output sample.
+					 */
+					template<typename TYPE>
+					size_t filterInterpolated(TYPE* const* _output, size_t _stride, size_t _offset) {
+						size_t nbOutput = 0;
+						while (m_position + m_nbTap <= m_count) {
+							// the filter is interpolated once for all the channels
+							uint64_t phase = uint64_t(m_phase) * m_nbPhase;
+							const float* coefA = &m_table[(phase >> 32) * m_nbTap];
+							const float* coefB = &coefA[m_nbTap];
+							float alpha = float(uint32_t(phase)) * (1.0f/4294967296.0f);
+							for (int32_t kkk=0; kkk<m_nbTap; ++kkk) {
+								m_coef[kkk] = coefA[kkk] + alpha * (coefB[kkk] - coefA[kkk]);
+							}
+							size_t outputPos = (_offset + nbOutput) * _stride;
+							for (int32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+								fromFloat(_output[ccc][outputPos], audio::algo::drain::vectorMath::dot(&m_coef[0], &m_history[ccc*m_historyStride + m_position], m_nbTap));
+							}
+							nbOutput++;
+							uint64_t fraction = uint64_t(m_phase) + m_stepFrac;
+							m_position += m_stepInt + size_t(fraction >> 32);
+							m_phase = uint32_t(fraction);
+						}
+						return nbOutput;
+					}
+			};
+		}
+	}
+}
+
+audio::algo::drain::Resampler::Resampler() :
+  m_format(audio::format_float) {
+	
+}
+
+audio::algo::drain::Resampler::~Resampler() {
+	
+}
+
+void audio::algo::drain::Resampler::init(float _sampleRateIn, float _sampleRateOut, int8_t _nbChannel, enum audio::format _format, int32_t _quality) {
+	if (    _format != audio::format_float
+	     && _format != audio::format_int16) {
+		AA_DRAIN_CRITICAL("Request format for resampler that not exist ... : " << _format);
+		return;
+	}
+	if (_nbChannel <= 0) {
+		AA_DRAIN_ERROR("Request resampler with " << int32_t(_nbChannel) << " channel(s)");
+		return;
+	}
+	if (    _sampleRateIn <= 0.0f
+	     || _sampleRateOut <= 0.0f) {
+		AA_DRAIN_ERROR("Request resampler with a wrong sample rate: " << _sampleRateIn << " ==> " << _sampleRateOut);
+		return;
+	}
+	m_private = ememory::makeShared<ResamplerPrivate>();
+	if (m_private == null) {
+		AA_DRAIN_ERROR("can not allocate private data...");
+		return;
+	}
+	m_format = _format;
+	m_private->init(_sampleRateIn, _sampleRateOut, _nbChannel, _quality);
+}
+
+void audio::algo::drain::Resampler::reset() {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Resampler does not init ...");
+		return;
+	}
+	m_private->reset();
+}
+
+etk::Vector<enum audio::format> audio::algo::drain::Resampler::getSupportedFormat() {
+	etk::Vector<enum audio::format> out = audio::algo::drain::Resampler::getNativeSupportedFormat();
+	return out;
+}
+
+etk::Vector<enum audio::format> audio::algo::drain::Resampler::getNativeSupportedFormat() {
+	etk::Vector<enum audio::format> out;
+	out.pushBack(audio::format_float);
+	out.pushBack(audio::format_int16);
+	return out;
+}
+
+size_t audio::algo::drain::Resampler::process(void* _output, const void* _input, size_t _nbChunk) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Resampler does not init ...");
+		return 0;
+	}
+	if (m_format == audio::format_int16) {
+		return m_private->process(reinterpret_cast<int16_t*>(_output), reinterpret_cast<const int16_t*>(_input), _nbChunk);
+	}
+	return m_private->process(reinterpret_cast<float*>(_output), reinterpret_cast<const float*>(_input), _nbChunk);
+}
+
+size_t audio::algo::drain::Resampler::processPlanar(float* const* _output, const float* const* _input, size_t _nbChunk) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Resampler does not init ...");
+		return 0;
+	}
+	if (m_format != audio::format_float) {
+		AA_DRAIN_ERROR("Resampler planar process is only in float");
+		return 0;
+	}
+	return m_private->processPlanar(_output, _input, _nbChunk);
+}
+
+size_t audio::algo::drain::Resampler::getMaxOutputSize(size_t _nbChunk) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Resampler does not init ...");
+		return 0;
+	}
+	return m_private->getMaxOutputSize(_nbChunk);
+}
+
+int32_t audio::algo::drain::Resampler::getLatency() {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Resampler does not init ...");
+		return 0;
+	}
+	return m_private->getLatency();
+}
+
+int32_t audio::algo::drain::Resampler::getNbTap() {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Resampler does not init ...");
+		return 0;
+	}
+	return m_private->getNbTap();
+}
+
+bool audio::algo::drain::Resampler::isRational() {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("Resampler does not init ...");
+		return false;
+	}
+	return m_private->isRational();
+}
@@ -0,0 +1,103 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <etk/types.hpp>
+#include <ememory/memory.hpp>
+#include <etk/Vector.hpp>
+#include <audio/format.hpp>
+
+namespace audio {
+	namespace algo {
+		namespace drain {
+			class ResamplerPrivate;
+			/**
+			 * @brief Polyphase sample rate converter (Kaiser windowed sinc).
+			 * When the ratio out/in is a small fraction L/M (48000/44100 = 160/147), a table of L filters is used: one FIR per output sample, no approximation.
+			 * Other ratios use a finely sampled table: the output is the linear interpolation of the two nearest filters.
+			 * On down-sampling, the cut-off frequency follow the output Nyquist frequency (the filter is longer).
+			 * The output timeline is aligned on the input: the output sample m is the input signal at the time m*in/out (the first output is the first input).
+			 */
+			class Resampler {
+				public:
+					/**
+					 * @brief Constructor
+					 */
+					Resampler();
+					/**
+					 * @brief Destructor
+					 */
+					virtual ~Resampler();
+				public:
+					/**
+					 * @brief Reset all history of the Algo.
+					 */
+					void reset();
+					/**
+					 * @brief Initialize the Algorithm (allocate the filter table: not in the real-time thread).
+					 * @param[in] _sampleRateIn Sample rate of the input stream.
+					 * @param[in] _sampleRateOut Sample rate of the output stream.
+					 * @param[in] _nbChannel Number of channel in the stream.
+					 * @param[in] _format Data format (float or int16).
+					 * @param[in] _quality Quality [0..10]: length of the filter (8 to 256 taps), width of the transition band and stop-band attenuation.
+					 */
+					virtual void init(float _sampleRateIn=48000, float _sampleRateOut=48000, int8_t _nbChannel=2, enum audio::format _format=audio::format_float, int32_t _quality=4);
+					/**
+					 * @brief Get list of format suported in input.
+					 * @return list of supported format
+					 */
+					virtual etk::Vector<enum audio::format> getSupportedFormat();
+					/**
+					 * @brief Get list of algorithm format suported. No format convertion.
+					 * @return list of supported format
+					 */
+					virtual etk::Vector<enum audio::format> getNativeSupportedFormat();
+					/**
+					 * @brief Main input algo process on interleaved data (no allocation).
+					 * @param[out] _output Output data (at least getMaxOutputSize(_nbChunk) chunks).
+					 * @param[in] _input Input data.
+					 * @param[in] _nbChunk Number of chunk in the input buffer (all are used).
+					 * @return Number of chunk written in the output buffer.
+					 */
+					virtual size_t process(void* _output, const void* _input, size_t _nbChunk);
+					/**
+					 * @brief Process planar float data (one buffer per channel, no allocation).
+					 * @param[out] _output Output buffer of each channel (at least getMaxOutputSize(_nbChunk) samples).
+					 * @param[in] _input Input buffer of each channel.
+					 * @param[in] _nbChunk Number of sample in each input buffer (all are used).
+					 * @return Number of sample written in each output buffer.
+					 */
+					size_t processPlanar(float* const* _output, const float* const* _input, size_t _nbChunk);
+				public:
+					/**
+					 * @brief Get the maximum number of output chunk generated by a process call.
+					 * @param[in] _nbChunk Number of input chunk.
+					 * @return Size of the output buffer to provide (chunk).
+					 */
+					size_t getMaxOutputSize(size_t _nbChunk);
+					/**
+					 * @brief Get the algorithm latency: the output is generated when the input has reached the end of the filter.
+					 * @return Latency in output chunk (half of the filter length).
+					 */
+					int32_t getLatency();
+					/**
+					 * @brief Get the number of tap of a filter (down-sampling increase it).
+					 * @return Number of multiply-add by output sample and channel (the interpolated table add the same number once by output sample).
+					 */
+					int32_t getNbTap();
+					/**
+					 * @brief Check if the ratio use the exact table (no interpolation of the filters).
+					 * @return true The ratio is a fraction of the table size.
+					 */
+					bool isRational();
+				protected:
+					enum audio::format m_format; //!< format of the data.
+					ememory::SharedPtr<ResamplerPrivate> m_private; //!< private data.
+			};
+		}
+	}
+}
+
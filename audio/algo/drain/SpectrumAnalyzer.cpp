@@ -0,0 +1,433 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <audio/algo/drain/SpectrumAnalyzer.hpp>
+#include <audio/algo/drain/Fft.hpp>
+#include <audio/algo/drain/VectorMath.hpp>
+#include <audio/algo/drain/debug.hpp>
+#include <ethread/Mutex.hpp>
+extern "C" {
+	#include <math.h>
+}
+
+// Level of the silence (dB).
+static const float levelFloor = -200.0f;
+// Default grid: logarithmic from this frequency to the Nyquist frequency.
+static const float defaultGridFrequencyMin = 20.0f;
+static const int32_t defaultGridNbPoint = 256;
+
+namespace audio {
+	namespace algo {
+		namespace drain {
+			class SpectrumAnalyzerPrivate {
+				protected:
+					float m_sampleRate;
+					int32_t m_nbChannel;
+					int32_t m_fftSize;
+					int32_t m_hopSize;
+					audio::algo::drain::Fft m_fft;
+					enum audio::algo::drain::spectrumWindow m_windowType;
+					etk::Vector<float> m_window; //!< window with the normalization (a full scale sine is 0 dB)
+					etk::Vector<float> m_history; //!< circular buffer of the last fftSize samples of each channel [channel][sample]
+					int32_t m_historyPos; //!< position of the oldest sample in the history
+					int32_t m_count; //!< number of sample since the last frame
+					etk::Vector<float> m_frame; //!< windowed frame
+					etk::Vector<float> m_real; //!< spectrum of the frame
+					etk::Vector<float> m_imag;
+					etk::Vector<float> m_power; //!< power of each bin (mean of the channels)
+					etk::Vector<float> m_average; //!< averaged power of each bin
+					float m_averageCoef; //!< weight of the previous average for a frame
+					bool m_averageInit; //!< the average contain at least one frame
+					etk::Vector<float> m_gridFrequency; //!< frequency of each point of the result
+					etk::Vector<int32_t> m_gridStart; //!< first bin of the band of each point
+					etk::Vector<int32_t> m_gridCount; //!< number of bin in the band (0: interpolation of the bins m_gridStart and m_gridStart+1)
+					etk::Vector<float> m_gridAlpha; //!< interpolation position between the two bins
+					etk::Vector<float> m_gridLevel; //!< level of each point (power then dB)
+					etk::Vector<float> m_peakLevel; //!< peak-hold level of each point (dB)
+					etk::Vector<int32_t> m_peakHold; //!< number of frame before the decrease of the peak
+					int32_t m_peakHoldFrame; //!< hold time (frame)
+					float m_peakDecay; //!< decrease of the peak after the hold time (dB/frame)
+					float m_averageTime;
+					float m_peakHoldTime;
+					float m_peakDecayRate;
+					// published data (protected by m_mutex, the audio thread never wait it):
+					ethread::Mutex m_mutex;
+					etk::Vector<float> m_publishLevel;
+					etk::Vector<float> m_publishPeak;
+					uint64_t m_publishNbFrame;
+				public:
+					SpectrumAnalyzerPrivate() :
+					  m_sampleRate(48000),
+					  m_nbChannel(1),
+					  m_fftSize(0),
+					  m_hopSize(1),
+					  m_windowType(audio::algo::drain::spectrumWindow_hann),
+					  m_historyPos(0),
+					  m_count(0),
+					  m_averageCoef(0.0f),
+					  m_averageInit(false),
+					  m_peakHoldFrame(0),
+					  m_peakDecay(0.0f),
+					  m_averageTime(0.3f),
+					  m_peakHoldTime(2.0f),
+					  m_peakDecayRate(10.0f),
+					  m_publishNbFrame(0) {
+						
+					}
+					bool init(float _sampleRate, int32_t _nbChannel, int32_t _fftSize, int32_t _hopSize) {
+						if (m_fft.init(_fftSize) == false) {
+							AA_DRAIN_ERROR("Spectrum analyzer FFT size must be a power of 2: " << _fftSize);
+							return false;
+						}
+						m_sampleRate = _sampleRate;
+						m_nbChannel = _nbChannel;
+						m_fftSize = _fftSize;
+						m_hopSize = etk::max(int32_t(1), etk::min(_hopSize, _fftSize));
+						m_history.resize(m_fftSize*m_nbChannel, 0.0f);
+						m_frame.resize(m_fftSize, 0.0f);
+						m_real.resize(m_fft.getNbBin(), 0.0f);
+						m_imag.resize(m_fft.getNbBin(), 0.0f);
+						m_power.resize(m_fft.getNbBin(), 0.0f);
+						m_average.resize(m_fft.getNbBin(), 0.0f);
+						setWindow(m_windowType);
+						setAveraging(m_averageTime);
+						setPeakHold(m_peakHoldTime, m_peakDecayRate);
+						setGrid(audio::algo::drain::SpectrumAnalyzer::createLogGrid(defaultGridFrequencyMin, m_sampleRate*0.5f, defaultGridNbPoint));
+						reset();
+						return true;
+					}
+					void reset() {
+						for (size_t iii=0; iii<m_history.size(); ++iii) {
+							m_history[iii] = 0.0f;
+						}
+						m_historyPos = 0;
+						m_count = 0;
+						m_averageInit = false;
+						for (size_t iii=0; iii<m_average.size(); ++iii) {
+							m_average[iii] = 0.0f;
+						}
+						for (size_t iii=0; iii<m_peakLevel.size(); ++iii) {
+							m_peakLevel[iii] = levelFloor;
+							m_peakHold[iii] = 0;
+						}
+					}
+					void setWindow(enum audio::algo::drain::spectrumWindow _window) {
+						m_windowType = _window;
+						m_window.resize(m_fftSize, 0.0f);
+						double sum = 0.0;
+						for (int32_t iii=0; iii<m_fftSize; ++iii) {
+							// periodic window: the overlapped frames sum to a constant
+							double angle = 2.0 * M_PI * double(iii) / double(m_fftSize);
+							double value = 0.5 - 0.5*cos(angle);
+							if (m_windowType == audio::algo::drain::spectrumWindow_blackmanHarris) {
+								value = 0.35875 - 0.48829*cos(angle) + 0.14128*cos(2.0*angle) - 0.01168*cos(3.0*angle);
+							}
+							m_window[iii] = value;
+							sum += value;
+						}
+						// a sine of amplitude A give a bin of magnitude A.sum/2: the power is normalized by (2/sum)^2
+						double norm = 2.0 / sum;
+						for (int32_t iii=0; iii<m_fftSize; ++iii) {
+							m_window[iii] = double(m_window[iii]) * norm;
+						}
+					}
+					void setAveraging(float _time) {
+						m_averageTime = _time;
+						m_averageCoef = 0.0f;
+						if (_time > 0.0f) {
+							m_averageCoef = exp(-double(m_hopSize) / (double(_time) * double(m_sampleRate)));
+						}
+					}
+					void setPeakHold(float _holdTime, float _decay) {
+						m_peakHoldTime = _holdTime;
+						m_peakDecayRate = _decay;
+						m_peakHoldFrame = int32_t(etk::max(0.0f, _holdTime) * m_sampleRate / m_hopSize);
+						m_peakDecay = etk::max(0.0f, _decay) * m_hopSize / m_sampleRate;
+					}
+					void setGrid(const etk::Vector<float>& _frequency) {
+						int32_t nbPoint = _frequency.size();
+						int32_t nbBin = m_fft.getNbBin();
+						double binWidth = double(m_sampleRate) / double(m_fftSize);
+						m_gridStart.resize(nbPoint, 0);
+						m_gridCount.resize(nbPoint, 0);
+						m_gridAlpha.resize(nbPoint, 0.0f);
+						m_gridLevel.resize(nbPoint, 0.0f);
+						m_peakLevel.resize(nbPoint, levelFloor);
+						m_peakHold.resize(nbPoint, 0);
+						for (int32_t iii=0; iii<nbPoint; ++iii) {
+							// band: from the middle with the previous point to the middle with the next point
+							double frequency = _frequency[iii];
+							double low = frequency;
+							double high = frequency;
+							if (iii > 0) {
+								low = 0.5 * (frequency + _frequency[iii-1]);
+							}
+							if (iii < nbPoint-1) {
+								high = 0.5 * (frequency + _frequency[iii+1]);
+							}
+							if (iii == 0) {
+								low = frequency - (high - frequency);
+							}
+							if (iii == nbPoint-1) {
+								high = frequency + (frequency - low);
+							}
+							int32_t start = etk::max(0, etk::min(int32_t(ceil(low / binWidth)), nbBin));
+							int32_t stop = etk::max(0, etk::min(int32_t(ceil(high / binWidth)), nbBin));
+							if (stop > start) {
+								m_gridStart[iii] = start;
+								m_gridCount[iii] = stop - start;
+								m_gridAlpha[iii] = 0.0f;
+							} else {
+								// band narrower than a bin
+								double position = etk::max(0.0, etk::min(frequency / binWidth, double(nbBin - 1)));
+								int32_t id = etk::min(int32_t(position), nbBin - 2);
+								m_gridStart[iii] = id;
+								m_gridCount[iii] = 0;
+								m_gridAlpha[iii] = position - id;
+							}
+							m_peakLevel[iii] = levelFloor;
+							m_peakHold[iii] = 0;
+						}
+						ethread::UniqueLock lock(m_mutex);
+						m_gridFrequency = _frequency;
+						m_publishLevel.resize(nbPoint, levelFloor);
+						m_publishPeak.resize(nbPoint, levelFloor);
+					}
+					void process(const float* _input, size_t _nbChunk) {
+						int32_t mask = m_fftSize - 1;
+						while (_nbChunk > 0) {
+							int32_t nbSample = etk::min(size_t(m_hopSize - m_count), _nbChunk);
+							for (int32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+								float* history = &m_history[ccc*m_fftSize];
+								for (int32_t iii=0; iii<nbSample; ++iii) {
+									history[(m_historyPos + iii) & mask] = _input[iii*m_nbChannel + ccc];
+								}
+							}
+							m_historyPos = (m_historyPos + nbSample) & mask;
+							m_count += nbSample;
+							_input += nbSample*m_nbChannel;
+							_nbChunk -= nbSample;
+							if (m_count == m_hopSize) {
+								m_count = 0;
+								processFrame();
+							}
+						}
+					}
+					etk::Vector<etk::Pair<float,float> > get(bool _peak) {
+						etk::Vector<etk::Pair<float,float> > out;
+						ethread::UniqueLock lock(m_mutex);
+						const etk::Vector<float>& level = _peak == true ? m_publishPeak : m_publishLevel;
+						out.reserve(level.size());
+						for (size_t iii=0; iii<level.size(); ++iii) {
+							out.pushBack(etk::makePair<float,float>(m_gridFrequency[iii], level[iii]));
+						}
+						return out;
+					}
+					uint64_t getNbFrame() {
+						ethread::UniqueLock lock(m_mutex);
+						return m_publishNbFrame;
+					}
+				protected:
+					void processFrame() {
+						int32_t nbBin = m_fft.getNbBin();
+						float channelNorm = 1.0f / float(m_nbChannel);
+						for (int32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+							// unwrap the history from the oldest sample
+							const float* history = &m_history[ccc*m_fftSize];
+							int32_t sizeEnd = m_fftSize - m_historyPos;
+							for (int32_t iii=0; iii<sizeEnd; ++iii) {
+								m_frame[iii] = history[m_historyPos + iii] * m_window[iii];
+							}
+							for (int32_t iii=sizeEnd; iii<m_fftSize; ++iii) {
+								m_frame[iii] = history[iii - sizeEnd] * m_window[iii];
+							}
+							m_fft.forward(&m_real[0], &m_imag[0], &m_frame[0]);
+							if (ccc == 0) {
+								for (int32_t iii=0; iii<nbBin; ++iii) {
+									m_power[iii] = (m_real[iii]*m_real[iii] + m_imag[iii]*m_imag[iii]) * channelNorm;
+								}
+							} else {
+								for (int32_t iii=0; iii<nbBin; ++iii) {
+									m_power[iii] += (m_real[iii]*m_real[iii] + m_imag[iii]*m_imag[iii]) * channelNorm;
+								}
+							}
+						}
+						// exponential average (the first frame initialize it)
+						float coef = m_averageInit == true ? m_averageCoef : 0.0f;
+						for (int32_t iii=0; iii<nbBin; ++iii) {
+							m_average[iii] = coef * m_average[iii] + (1.0f - coef) * m_power[iii];
+						}
+						m_averageInit = true;
+						// level of the grid points
+						for (size_t iii=0; iii<m_gridLevel.size(); ++iii) {
+							const float* power = &m_average[m_gridStart[iii]];
+							float value;
+							if (m_gridCount[iii] == 0) {
+								value = power[0] + m_gridAlpha[iii] * (power[1] - power[0]);
+							} else {
+								value = power[0];
+								for (int32_t jjj=1; jjj<m_gridCount[iii]; ++jjj) {
+									value = power[jjj] > value ? power[jjj] : value;
+								}
+							}
+							m_gridLevel[iii] = value;
+						}
+						if (m_gridLevel.size() == 0) {
+							return;
+						}
+						audio::algo::drain::vectorMath::powerToDb(&m_gridLevel[0], &m_gridLevel[0], m_gridLevel.size(), levelFloor);
+						// peak-hold
+						for (size_t iii=0; iii<m_gridLevel.size(); ++iii) {
+							if (m_gridLevel[iii] >= m_peakLevel[iii]) {
+								m_peakLevel[iii] = m_gridLevel[iii];
+								m_peakHold[iii] = m_peakHoldFrame;
+							} else if (m_peakHold[iii] > 0) {
+								m_peakHold[iii]--;
+							} else {
+								m_peakLevel[iii] = etk::max(m_gridLevel[iii], m_peakLevel[iii] - m_peakDecay);
+							}
+						}
+						// publish only if no reader has the lock: the audio thread never wait
+						if (m_mutex.tryLock() == false) {
+							return;
+						}
+						for (size_t iii=0; iii<m_gridLevel.size(); ++iii) {
+							m_publishLevel[iii] = m_gridLevel[iii];
+							m_publishPeak[iii] = m_peakLevel[iii];
+						}
+						m_publishNbFrame++;
+						m_mutex.unlock();
+					}
+			};
+		}
+	}
+}
+
+audio::algo::drain::SpectrumAnalyzer::SpectrumAnalyzer() {
+	
+}
+
+audio::algo::drain::SpectrumAnalyzer::~SpectrumAnalyzer() {
+	
+}
+
+void audio::algo::drain::SpectrumAnalyzer::init(float _sampleRate, int8_t _nbChannel, enum audio::format _format, int32_t _fftSize, int32_t _hopSize) {
+	if (_format != audio::format_float) {
+		AA_DRAIN_CRITICAL("Request format for spectrum analyzer that not exist ... : " << _format);
+		return;
+	}
+	if (_nbChannel <= 0) {
+		AA_DRAIN_ERROR("Request spectrum analyzer with " << int32_t(_nbChannel) << " channel(s)");
+		return;
+	}
+	m_private = ememory::makeShared<SpectrumAnalyzerPrivate>();
+	if (m_private == null) {
+		AA_DRAIN_ERROR("can not allocate private data...");
+		return;
+	}
+	if (m_private->init(_sampleRate, _nbChannel, _fftSize, _hopSize) == false) {
+		m_private.reset();
+	}
+}
+
+void audio::algo::drain::SpectrumAnalyzer::reset() {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("SpectrumAnalyzer does not init ...");
+		return;
+	}
+	m_private->reset();
+}
+
+etk::Vector<enum audio::format> audio::algo::drain::SpectrumAnalyzer::getSupportedFormat() {
+	etk::Vector<enum audio::format> out = audio::algo::drain::SpectrumAnalyzer::getNativeSupportedFormat();
+	return out;
+}
+
+etk::Vector<enum audio::format> audio::algo::drain::SpectrumAnalyzer::getNativeSupportedFormat() {
+	etk::Vector<enum audio::format> out;
+	out.pushBack(audio::format_float);
+	return out;
+}
+
+void audio::algo::drain::SpectrumAnalyzer::process(const void* _input, size_t _nbChunk) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("SpectrumAnalyzer does not init ...");
+		return;
+	}
+	m_private->process(reinterpret_cast<const float*>(_input), _nbChunk);
+}
+
+void audio::algo::drain::SpectrumAnalyzer::setWindow(enum audio::algo::drain::spectrumWindow _window) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("SpectrumAnalyzer does not init ...");
+		return;
+	}
+	m_private->setWindow(_window);
+}
+
+void audio::algo::drain::SpectrumAnalyzer::setAveraging(float _time) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("SpectrumAnalyzer does not init ...");
+		return;
+	}
+	m_private->setAveraging(_time);
+}
+
+void audio::algo::drain::SpectrumAnalyzer::setPeakHold(float _holdTime, float _decay) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("SpectrumAnalyzer does not init ...");
+		return;
+	}
+	m_private->setPeakHold(_holdTime, _decay);
+}
+
+void audio::algo::drain::SpectrumAnalyzer::setGrid(const etk::Vector<float>& _frequency) {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("SpectrumAnalyzer does not init ...");
+		return;
+	}
+	m_private->setGrid(_frequency);
+}
+
+etk::Vector<float> audio::algo::drain::SpectrumAnalyzer::createLogGrid(float _frequencyMin, float _frequencyMax, int32_t _nbPoint) {
+	etk::Vector<float> out;
+	if (    _nbPoint <= 0
+	     || _frequencyMin <= 0.0f
+	     || _frequencyMax < _frequencyMin) {
+		AA_DRAIN_ERROR("Wrong logarithmic grid: " << _nbPoint << " points [" << _frequencyMin << ".." << _frequencyMax << "]");
+		return out;
+	}
+	out.reserve(_nbPoint);
+	double ratio = log(double(_frequencyMax) / double(_frequencyMin));
+	for (int32_t iii=0; iii<_nbPoint; ++iii) {
+		out.pushBack(_frequencyMin * exp(ratio * iii / etk::max(1, _nbPoint - 1)));
+	}
+	return out;
+}
+
+etk::Vector<etk::Pair<float,float> > audio::algo::drain::SpectrumAnalyzer::getSpectrum() {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("SpectrumAnalyzer does not init ...");
+		return etk::Vector<etk::Pair<float,float> >();
+	}
+	return m_private->get(false);
+}
+
+etk::Vector<etk::Pair<float,float> > audio::algo::drain::SpectrumAnalyzer::getPeakHold() {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("SpectrumAnalyzer does not init ...");
+		return etk::Vector<etk::Pair<float,float> >();
+	}
+	return m_private->get(true);
+}
+
+uint64_t audio::algo::drain::SpectrumAnalyzer::getNbFrame() {
+	if (m_private == null) {
+		AA_DRAIN_ERROR("SpectrumAnalyzer does not init ...");
+		return 0;
+	}
+	return m_private->getNbFrame();
+}
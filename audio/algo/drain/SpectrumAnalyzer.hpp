@@ -0,0 +1,122 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <etk/types.hpp>
+#include <ememory/memory.hpp>
+#include <etk/Vector.hpp>
+#include <etk/Pair.hpp>
+#include <audio/format.hpp>
+
+namespace audio {
+	namespace algo {
+		namespace drain {
+			/**
+			 * @brief Window applied on each frame of the spectrum analyzer.
+			 */
+			enum spectrumWindow {
+				spectrumWindow_hann, //!< good frequency resolution (side lobes -31 dB)
+				spectrumWindow_blackmanHarris, //!< large dynamic (side lobes -92 dB), wider peaks
+			};
+			class SpectrumAnalyzerPrivate;
+			/**
+			 * @brief Streaming spectrum analyzer: overlapping windowed FFT frames, exponential averaging and peak-hold on a frequency grid.
+			 * The result is a list of frequency/level in dB, as Equalizer::calculateTheory: the measure can be drawn on the theory curve.
+			 * The level of each grid point is the maximum of the FFT bins of its band (a full scale sine is 0 dB), narrow bands are interpolated.
+			 * The audio thread never wait: each frame is published only if no reader has the lock (the next frame is published else).
+			 */
+			class SpectrumAnalyzer {
+				public:
+					/**
+					 * @brief Constructor
+					 */
+					SpectrumAnalyzer();
+					/**
+					 * @brief Destructor
+					 */
+					virtual ~SpectrumAnalyzer();
+				public:
+					/**
+					 * @brief Reset all history of the Algo (average and peak-hold).
+					 */
+					void reset();
+					/**
+					 * @brief Initialize the Algorithm (allocate all the buffers: not in the real-time thread).
+					 * @param[in] _sampleRate Sample rate of the stream.
+					 * @param[in] _nbChannel Number of channel in the stream (the power of the channels is averaged).
+					 * @param[in] _format Input data format.
+					 * @param[in] _fftSize Number of sample of a frame (power of 2).
+					 * @param[in] _hopSize Number of sample between two frames [1..fftSize].
+					 */
+					virtual void init(float _sampleRate=48000, int8_t _nbChannel=2, enum audio::format _format=audio::format_float, int32_t _fftSize=2048, int32_t _hopSize=512);
+					/**
+					 * @brief Get list of format suported in input.
+					 * @return list of supported format
+					 */
+					virtual etk::Vector<enum audio::format> getSupportedFormat();
+					/**
+					 * @brief Get list of algorithm format suported. No format convertion.
+					 * @return list of supported format
+					 */
+					virtual etk::Vector<enum audio::format> getNativeSupportedFormat();
+					/**
+					 * @brief Main input algo process (analysis only, no allocation, never wait the readers).
+					 * @param[in] _input Input data (interleaved, nbChannel).
+					 * @param[in] _nbChunk Number of chunk in the input buffer.
+					 */
+					virtual void process(const void* _input, size_t _nbChunk);
+				public:
+					/**
+					 * @brief Set the window of the frames (default: hann).
+					 * @param[in] _window Type of window.
+					 */
+					void setWindow(enum audio::algo::drain::spectrumWindow _window);
+					/**
+					 * @brief Set the averaging of the power of the frames (default: 0.3 s).
+					 * @param[in] _time Time constant of the exponential average (second, 0: no average).
+					 */
+					void setAveraging(float _time);
+					/**
+					 * @brief Set the peak-hold (default: 2 s, 10 dB/s).
+					 * @param[in] _holdTime Time the peak is kept (second).
+					 * @param[in] _decay Decrease of the peak after the hold time (dB/s).
+					 */
+					void setPeakHold(float _holdTime, float _decay);
+					/**
+					 * @brief Set the frequency of the points of the result (allocation: not in the real-time thread).
+					 * @param[in] _frequency List of frequency (Hz, increasing), for example the frequencies of Equalizer::calculateTheory.
+					 */
+					void setGrid(const etk::Vector<float>& _frequency);
+					/**
+					 * @brief Create a logarithmic frequency grid (the default grid is 256 points from 20 Hz to the Nyquist frequency).
+					 * @param[in] _frequencyMin First frequency (Hz).
+					 * @param[in] _frequencyMax Last frequency (Hz).
+					 * @param[in] _nbPoint Number of frequency.
+					 * @return List of frequency.
+					 */
+					static etk::Vector<float> createLogGrid(float _frequencyMin, float _frequencyMax, int32_t _nbPoint);
+					/**
+					 * @brief Get the last published averaged spectrum (for an analysis or display thread).
+					 * @return List of frequency/level in dB (a full scale sine is 0 dB).
+					 */
+					etk::Vector<etk::Pair<float,float> > getSpectrum();
+					/**
+					 * @brief Get the last published peak-hold spectrum.
+					 * @return List of frequency/level in dB.
+					 */
+					etk::Vector<etk::Pair<float,float> > getPeakHold();
+					/**
+					 * @brief Get the number of published frames (a reader can detect a new spectrum).
+					 * @return Number of frame.
+					 */
+					uint64_t getNbFrame();
+				protected:
+					ememory::SharedPtr<SpectrumAnalyzerPrivate> m_private; //!< private data.
+			};
+		}
+	}
+}
+
@@ -0,0 +1,175 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <etk/types.hpp>
+#include <etk/Vector.hpp>
+#include <etk/Pair.hpp>
+#include <audio/algo/drain/BiQuad.hpp>
+#include <audio/algo/drain/BiQuadDesign.hpp>
+
+namespace audio {
+	namespace algo {
+		namespace drain {
+			/**
+			 * @brief Equalizer with a fixed number of channel and stage (no allocation, no virtual call).
+			 * All the loops have a compile time size: the compiler unroll them and keep the history in register during a process call.
+			 * The stages not configured are pass threw.
+			 * @param[in] TYPE Type of the sample (audio::float_t, audio::int16_16_t ...)
+			 * @param[in] NbChannel Number of channel of the interleaved stream.
+			 * @param[in] NbStage Number of bi-quad of each channel.
+			 */
+			template<typename TYPE, int32_t NbChannel, int32_t NbStage> class StaticEqualizer {
+				protected:
+					float m_sampleRate; //!< sample rate used to calculate the bi-quad
+					int32_t m_nbStage[NbChannel]; //!< number of stage added on each channel
+					audio::algo::drain::BiQuad<TYPE> m_biquads[NbChannel][NbStage]; //!< all the filters
+				public:
+					/**
+					 * @brief Constructor
+					 * @param[in] _sampleRate Sample rate of the stream.
+					 */
+					StaticEqualizer(float _sampleRate=48000) {
+						init(_sampleRate);
+					}
+					/**
+					 * @brief Constructor with a preset (same stages on all the channels).
+					 * @param[in] _preset Coefficients of each stage (can be calculated at compile time with biQuadDesign).
+					 * @param[in] _sampleRate Sample rate of the stream.
+					 */
+					StaticEqualizer(const audio::algo::drain::BiQuadCoefficient (&_preset)[NbStage], float _sampleRate=48000) {
+						init(_sampleRate);
+						for (int32_t sss=0; sss<NbStage; ++sss) {
+							addBiquad(_preset[sss]);
+						}
+					}
+				public:
+					/**
+					 * @brief Initialize the Algorithm (remove all the stages).
+					 * @param[in] _sampleRate Sample rate of the stream.
+					 */
+					void init(float _sampleRate=48000) {
+						m_sampleRate = _sampleRate;
+						for (int32_t ccc=0; ccc<NbChannel; ++ccc) {
+							m_nbStage[ccc] = 0;
+							for (int32_t sss=0; sss<NbStage; ++sss) {
+								m_biquads[ccc][sss].setBiquadCoef(audio::algo::drain::BiQuadCoefficient());
+							}
+						}
+					}
+					/**
+					 * @brief Reset all history of the Algo.
+					 */
+					void reset() {
+						for (int32_t ccc=0; ccc<NbChannel; ++ccc) {
+							for (int32_t sss=0; sss<NbStage; ++sss) {
+								m_biquads[ccc][sss].reset();
+							}
+						}
+					}
+					/**
+					 * @brief Main input algo process.
+					 * @param[in,out] _output Output data (interleaved, can be the same as the input).
+					 * @param[in] _input Input data (interleaved).
+					 * @param[in] _nbChunk Number of chunk in the input buffer.
+					 */
+					void process(TYPE* _output, const TYPE* _input, size_t _nbChunk) {
+						// local copy: the compiler can not keep the history in register if the output can write on it
+						audio::algo::drain::BiQuad<TYPE> biquads[NbChannel][NbStage];
+						for (int32_t ccc=0; ccc<NbChannel; ++ccc) {
+							for (int32_t sss=0; sss<NbStage; ++sss) {
+								biquads[ccc][sss] = m_biquads[ccc][sss];
+							}
+						}
+						for (size_t iii=0; iii<_nbChunk; ++iii) {
+							for (int32_t ccc=0; ccc<NbChannel; ++ccc) {
+								TYPE sample = _input[ccc];
+								for (int32_t sss=0; sss<NbStage; ++sss) {
+									sample = biquads[ccc][sss].process(sample);
+								}
+								_output[ccc] = sample;
+							}
+							_input += NbChannel;
+							_output += NbChannel;
+						}
+						for (int32_t ccc=0; ccc<NbChannel; ++ccc) {
+							for (int32_t sss=0; sss<NbStage; ++sss) {
+								m_biquads[ccc][sss] = biquads[ccc][sss];
+							}
+						}
+					}
+				public:
+					/**
+					 * @brief add a biquad on all the channels.
+					 * @param[in] _coef Coefficients of the bi-quad (see biQuadDesign).
+					 * @return false The stages are all used.
+					 */
+					bool addBiquad(const audio::algo::drain::BiQuadCoefficient& _coef) {
+						bool ret = true;
+						for (int32_t ccc=0; ccc<NbChannel; ++ccc) {
+							ret = addBiquad(ccc, _coef) && ret;
+						}
+						return ret;
+					}
+					/**
+					 * @brief add a biquad on one channel.
+					 * @param[in] _idChannel Id of the channel.
+					 * @param[in] _coef Coefficients of the bi-quad (see biQuadDesign).
+					 * @return false The channel does not exist or the stages are all used.
+					 */
+					bool addBiquad(int32_t _idChannel, const audio::algo::drain::BiQuadCoefficient& _coef) {
+						if (    _idChannel < 0
+						     || _idChannel >= NbChannel
+						     || m_nbStage[_idChannel] >= NbStage) {
+							return false;
+						}
+						m_biquads[_idChannel][m_nbStage[_idChannel]].setBiquadCoef(_coef);
+						m_nbStage[_idChannel]++;
+						return true;
+					}
+					/**
+					 * @brief add a biquad with his value.
+					 */
+					bool addBiquad(double _a0, double _a1, double _a2, double _b0, double _b1) {
+						return addBiquad(audio::algo::drain::BiQuadCoefficient(_a0, _a1, _a2, _b0, _b1));
+					}
+					bool addBiquad(int32_t _idChannel, double _a0, double _a1, double _a2, double _b0, double _b1) {
+						return addBiquad(_idChannel, audio::algo::drain::BiQuadCoefficient(_a0, _a1, _a2, _b0, _b1));
+					}
+					/**
+					 * @brief add a bi-quad value and type
+					 * @param[in] _type Type of biquad.
+					 * @param[in] _frequencyCut Cut Frequency. [0..sampleRate/2]
+					 * @param[in] _qualityFactor Q factor of quality (good value of 0.707 ==> permit to not ower gain) limit [0.01 .. 10]
+					 * @param[in] _gain Gain to apply (for notch, peak, lowShelf and highShelf) limit : -30, +30
+					 */
+					bool addBiquad(audio::algo::drain::biQuadType _type, double _frequencyCut, double _qualityFactor, double _gain) {
+						return addBiquad(audio::algo::drain::biQuadDesign(_type, _frequencyCut, _qualityFactor, _gain, m_sampleRate));
+					}
+					bool addBiquad(int32_t _idChannel, audio::algo::drain::biQuadType _type, double _frequencyCut, double _qualityFactor, double _gain) {
+						return addBiquad(_idChannel, audio::algo::drain::biQuadDesign(_type, _frequencyCut, _qualityFactor, _gain, m_sampleRate));
+					}
+				public:
+					// for debug & tools only
+					etk::Vector<etk::Pair<float,float> > calculateTheory() {
+						etk::Vector<etk::Pair<float,float> > out;
+						for (int32_t sss=0; sss<m_nbStage[0]; ++sss) {
+							if (sss == 0) {
+								out = m_biquads[0][sss].calculateTheory(m_sampleRate);
+							} else {
+								etk::Vector<etk::Pair<float,float> > tmp = m_biquads[0][sss].calculateTheory(m_sampleRate);
+								for (size_t jjj=0; jjj< out.size(); ++jjj) {
+									out[jjj].second += tmp[jjj].second;
+								}
+							}
+						}
+						return out;
+					}
+			};
+		}
+	}
+}
+
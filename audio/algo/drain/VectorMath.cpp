@@ -0,0 +1,125 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <audio/algo/drain/VectorMath.hpp>
+extern "C" {
+	#include <string.h>
+}
+
+// Polynomial approximations from the cephes library (http://www.netlib.org/cephes/)
+
+// 2/pi
+static const float twoOverPi = 0.636619772367581343f;
+// pi/2 splitted in 3 float (Cody & Waite argument reduction)
+static const float piOver2High = 1.5703125f;
+static const float piOver2Medium = 4.837512969970703125e-4f;
+static const float piOver2Low = 7.54978995489188216e-8f;
+// binary representation of the smallest normal float (1.17549435e-38)
+static const int32_t floatMinNormalBits = 0x00800000;
+// log10(2) splitted in 2 float
+static const float log10Of2High = 0.30102539f;
+static const float log10Of2Low = 4.6050389e-6f;
+// log10(e)
+static const float log10OfE = 0.434294481903251828f;
+// log2(10)/20: dB to power of 2 of an amplitude
+static const float dbToLog2 = 0.166096404744368118f;
+
+void audio::algo::drain::vectorMath::sinCos(float* _sin, float* _cos, const float* _angle, size_t _nbSample) {
+	for (size_t iii=0; iii<_nbSample; ++iii) {
+		float angle = _angle[iii];
+		// angle = quadrant*pi/2 + rest, rest in [-pi/4..pi/4]
+		int32_t quadrant = int32_t(angle*twoOverPi + (angle >= 0.0f ? 0.5f : -0.5f));
+		float quadrantFloat = float(quadrant);
+		float rest = ((angle - quadrantFloat*piOver2High) - quadrantFloat*piOver2Medium) - quadrantFloat*piOver2Low;
+		float rest2 = rest*rest;
+		float valueSin = rest + rest*rest2*(-1.6666654611e-1f + rest2*(8.3321608736e-3f + rest2*-1.9515295891e-4f));
+		float valueCos = 1.0f - 0.5f*rest2 + rest2*rest2*(4.166664568298827e-2f + rest2*(-1.388731625493765e-3f + rest2*2.443315711809948e-5f));
+		// quadrant 0: (s, c), 1: (c, -s), 2: (-s, -c), 3: (-c, s)
+		int32_t swap = quadrant & 1;
+		float outSin = swap != 0 ? valueCos : valueSin;
+		float outCos = swap != 0 ? valueSin : valueCos;
+		_sin[iii] = (quadrant & 2) != 0 ? -outSin : outSin;
+		_cos[iii] = ((quadrant+1) & 2) != 0 ? -outCos : outCos;
+	}
+}
+
+void audio::algo::drain::vectorMath::log10(float* _output, const float* _input, size_t _nbSample) {
+	for (size_t iii=0; iii<_nbSample; ++iii) {
+		// value = mantissa * 2^exponent, mantissa in [0.5..1[
+		int32_t bits;
+		memcpy(&bits, &_input[iii], sizeof(float));
+		// clamp on the smallest normal float (negative values have the sign bit ==> negative integer)
+		bits = bits > floatMinNormalBits ? bits : floatMinNormalBits;
+		int32_t exponent = ((bits >> 23) & 0xFF) - 126;
+		bits = (bits & 0x007FFFFF) | 0x3F000000;
+		float mantissa;
+		memcpy(&mantissa, &bits, sizeof(float));
+		// mantissa in [sqrt(0.5)..sqrt(2)[ to minimize the polynomial error
+		int32_t small = mantissa < 0.707106781186547524f;
+		exponent -= small;
+		mantissa = mantissa + mantissa*float(small) - 1.0f;
+		float mantissa2 = mantissa*mantissa;
+		float poly = 7.0376836292e-2f;
+		poly = poly*mantissa - 1.1514610310e-1f;
+		poly = poly*mantissa + 1.1676998740e-1f;
+		poly = poly*mantissa - 1.2420140846e-1f;
+		poly = poly*mantissa + 1.4249322787e-1f;
+		poly = poly*mantissa - 1.6668057665e-1f;
+		poly = poly*mantissa + 2.0000714765e-1f;
+		poly = poly*mantissa - 2.4999993993e-1f;
+		poly = poly*mantissa + 3.3333331174e-1f;
+		// natural logarithm of the mantissa
+		float logMantissa = mantissa + (poly*mantissa*mantissa2 - 0.5f*mantissa2);
+		float exponentFloat = float(exponent);
+		_output[iii] = exponentFloat*log10Of2High + (exponentFloat*log10Of2Low + logMantissa*log10OfE);
+	}
+}
+
+void audio::algo::drain::vectorMath::powerToDb(float* _output, const float* _input, size_t _nbSample, float _floor) {
+	audio::algo::drain::vectorMath::log10(_output, _input, _nbSample);
+	for (size_t iii=0; iii<_nbSample; ++iii) {
+		float value = 10.0f * _output[iii];
+		_output[iii] = value > _floor ? value : _floor;
+	}
+}
+
+void audio::algo::drain::vectorMath::magnitudeToDb(float* _output, const float* _real, const float* _imag, size_t _nbSample, float _floor) {
+	for (size_t iii=0; iii<_nbSample; ++iii) {
+		_output[iii] = _real[iii]*_real[iii] + _imag[iii]*_imag[iii];
+	}
+	audio::algo::drain::vectorMath::powerToDb(_output, _output, _nbSample, _floor);
+}
+
+void audio::algo::drain::vectorMath::exp2(float* _output, const float* _input, size_t _nbSample) {
+	for (size_t iii=0; iii<_nbSample; ++iii) {
+		float value = _input[iii];
+		value = value > -126.0f ? value : -126.0f;
+		value = value < 127.499f ? value : 127.499f;
+		// value = exponent + rest, rest in [-0.5..0.5]
+		int32_t exponent = int32_t(value + (value >= 0.0f ? 0.5f : -0.5f));
+		float rest = value - float(exponent);
+		float poly = 1.535336188319500e-4f;
+		poly = poly*rest + 1.339887440266574e-3f;
+		poly = poly*rest + 9.618437357674640e-3f;
+		poly = poly*rest + 5.550332471162809e-2f;
+		poly = poly*rest + 2.402264791363012e-1f;
+		poly = poly*rest + 6.931472028550421e-1f;
+		poly = poly*rest + 1.0f;
+		// 2^exponent (0 < exponent+127 < 255: always a normal float)
+		int32_t bits = (exponent + 127) << 23;
+		float scale;
+		memcpy(&scale, &bits, sizeof(float));
+		_output[iii] = poly*scale;
+	}
+}
+
+void audio::algo::drain::vectorMath::dbToGain(float* _output, const float* _input, size_t _nbSample) {
+	for (size_t iii=0; iii<_nbSample; ++iii) {
+		_output[iii] = _input[iii] * dbToLog2;
+	}
+	audio::algo::drain::vectorMath::exp2(_output, _output, _nbSample);
+}
+
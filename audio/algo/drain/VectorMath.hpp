@@ -0,0 +1,106 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2011, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <etk/types.hpp>
+
+namespace audio {
+	namespace algo {
+		namespace drain {
+			/**
+			 * @brief Batch math functions on float arrays. The loops have no branch and no call so they are vectorized by the compiler.
+			 * The accuracy is enough for response display and analysis, not for bit exact signal generation.
+			 */
+			namespace vectorMath {
+				/**
+				 * @brief Calculate the sine and the cosine of a list of angle.
+				 * @note Absolute error < 2e-7 for |angle| < 8192 rad (the argument reduction lose precision above).
+				 * @param[out] _sin Sine of each angle (can not be the same as _angle).
+				 * @param[out] _cos Cosine of each angle (can not be the same as _angle).
+				 * @param[in] _angle List of angle in radian.
+				 * @param[in] _nbSample Number of angle.
+				 */
+				void sinCos(float* _sin, float* _cos, const float* _angle, size_t _nbSample);
+				/**
+				 * @brief Calculate the decimal logarithm of a list of value.
+				 * @note Absolute error < 5e-8 for value in [0.5..2], relative error < 1e-7 on all the float range (the float rounding of the result: absolute error < 2e-6 near +-38). The values < 1.17e-38 (smallest normal float, and negative values) are clamped (log10 = -37.93).
+				 * @param[out] _output Logarithm of each value (can be the same as _input).
+				 * @param[in] _input List of value.
+				 * @param[in] _nbSample Number of value.
+				 */
+				void log10(float* _output, const float* _input, size_t _nbSample);
+				/**
+				 * @brief Convert a list of power (squared magnitude) in dB: 10.log10(power).
+				 * @note Absolute error < 1e-5 dB for power in [1e-10..1e10], < 2e-5 dB in [1e-20..1e20] (the float rounding of the result).
+				 * @param[out] _output Power in dB (can be the same as _input).
+				 * @param[in] _input List of power.
+				 * @param[in] _nbSample Number of value.
+				 * @param[in] _floor Minimum value of the result (dB).
+				 */
+				void powerToDb(float* _output, const float* _input, size_t _nbSample, float _floor=-200.0f);
+				/**
+				 * @brief Convert a list of complex value in dB of their magnitude: 20.log10(|real + j.imag|).
+				 * @note Absolute error < 1e-5 dB for magnitude in [1e-5..1e5], < 2e-5 dB in [1e-10..1e10] (the float rounding of the result).
+				 * @param[out] _output Magnitude in dB (can be the same as _real or _imag).
+				 * @param[in] _real Real part of the values.
+				 * @param[in] _imag Imaginary part of the values.
+				 * @param[in] _nbSample Number of value.
+				 * @param[in] _floor Minimum value of the result (dB).
+				 */
+				void magnitudeToDb(float* _output, const float* _real, const float* _imag, size_t _nbSample, float _floor=-200.0f);
+				/**
+				 * @brief Calculate the power of 2 of a list of value.
+				 * @note Relative error < 2e-7. The values are clamped in [-126..127.5] (normal float range).
+				 * @param[out] _output 2^value (can be the same as _input).
+				 * @param[in] _input List of value.
+				 * @param[in] _nbSample Number of value.
+				 */
+				void exp2(float* _output, const float* _input, size_t _nbSample);
+				/**
+				 * @brief Convert a list of gain in dB in linear amplitude gain: 10^(gain/20).
+				 * @note Relative error < 1e-6 for gain in [-120..120] dB (5e-6 in [-750..760] dB).
+				 * @param[out] _output Linear gain (can be the same as _input).
+				 * @param[in] _input List of gain in dB.
+				 * @param[in] _nbSample Number of value.
+				 */
+				void dbToGain(float* _output, const float* _input, size_t _nbSample);
+				/**
+				 * @brief Calculate the dot product of two list of value: sum(inputA[i].inputB[i]).
+				 * @note The 2x8 partial sums are independent (two SIMD registers, two chains of multiply-add hide the latency): the result is not the one of a sequential sum. Inline: it is called for each output sample of the filters.
+				 * @param[in] _inputA First list of value.
+				 * @param[in] _inputB Second list of value.
+				 * @param[in] _nbSample Number of value (a multiple of 16 has no tail).
+				 * @return Dot product.
+				 */
+				inline float dot(const float* _inputA, const float* _inputB, size_t _nbSample) {
+					float sumA[8] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+					float sumB[8] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+					size_t iii = 0;
+					for (; iii+16<=_nbSample; iii+=16) {
+						for (size_t ppp=0; ppp<8; ++ppp) {
+							sumA[ppp] += _inputA[iii+ppp] * _inputB[iii+ppp];
+							sumB[ppp] += _inputA[iii+8+ppp] * _inputB[iii+8+ppp];
+						}
+					}
+					if (iii+8 <= _nbSample) {
+						for (size_t ppp=0; ppp<8; ++ppp) {
+							sumA[ppp] += _inputA[iii+ppp] * _inputB[iii+ppp];
+						}
+						iii += 8;
+					}
+					for (size_t ppp=0; iii<_nbSample; ++iii, ++ppp) {
+						sumB[ppp] += _inputA[iii] * _inputB[iii];
+					}
+					for (size_t ppp=0; ppp<8; ++ppp) {
+						sumA[ppp] += sumB[ppp];
+					}
+					return ((sumA[0] + sumA[4]) + (sumA[1] + sumA[5])) + ((sumA[2] + sumA[6]) + (sumA[3] + sumA[7]));
+				}
+			}
+		}
+	}
+}
+
@@ -28,17 +28,63 @@ def get_version():
 def configure(target, my_module):
 	my_module.add_src_file([
 	    'audio/algo/drain/debug.cpp',
+	    'audio/algo/drain/Processor.cpp',
 	    'audio/algo/drain/BiQuad.cpp',
 	    'audio/algo/drain/BiQuadType.cpp',
-	    'audio/algo/drain/Equalizer.cpp'
+	    'audio/algo/drain/BiQuadCache.cpp',
+	    'audio/algo/drain/EqualizerKernel.cpp',
+	    'audio/algo/drain/Equalizer.cpp',
+	    'audio/algo/drain/ArrayGeometry.cpp',
+	    'audio/algo/drain/Beamformer.cpp',
+	    'audio/algo/drain/Fft.cpp',
+	    'audio/algo/drain/BeamformerStft.cpp',
+	    'audio/algo/drain/DirectionOfArrival.cpp',
+	    'audio/algo/drain/VectorMath.cpp',
+	    'audio/algo/drain/EqualizerBank.cpp',
+	    'audio/algo/drain/EqualizerPreset.cpp',
+	    'audio/algo/drain/EqualizerRenderer.cpp',
+	    'audio/algo/drain/Chain.cpp',
+	    'audio/algo/drain/Dynamics.cpp',
+	    'audio/algo/drain/LoudnessMeter.cpp',
+	    'audio/algo/drain/Resampler.cpp',
+	    'audio/algo/drain/SpectrumAnalyzer.cpp',
+	    'audio/algo/drain/ChannelMixer.cpp',
+	    'audio/algo/drain/Crossover.cpp',
+	    'audio/algo/drain/EqualizerFit.cpp',
+	    'audio/algo/drain/GraphicEqualizer.cpp'
 	    ])
 	my_module.add_header_file([
+	    'audio/algo/drain/Processor.hpp',
 	    'audio/algo/drain/BiQuad.hpp',
 	    'audio/algo/drain/BiQuadType.hpp',
-	    'audio/algo/drain/Equalizer.hpp'
+	    'audio/algo/drain/BiQuadDesign.hpp',
+	    'audio/algo/drain/BiQuadCache.hpp',
+	    'audio/algo/drain/EqualizerKernel.hpp',
+	    'audio/algo/drain/Equalizer.hpp',
+	    'audio/algo/drain/StaticEqualizer.hpp',
+	    'audio/algo/drain/ArrayGeometry.hpp',
+	    'audio/algo/drain/Beamformer.hpp',
+	    'audio/algo/drain/Fft.hpp',
+	    'audio/algo/drain/BeamformerStft.hpp',
+	    'audio/algo/drain/DirectionOfArrival.hpp',
+	    'audio/algo/drain/VectorMath.hpp',
+	    'audio/algo/drain/EqualizerBank.hpp',
+	    'audio/algo/drain/EqualizerPreset.hpp',
+	    'audio/algo/drain/EqualizerRenderer.hpp',
+	    'audio/algo/drain/Chain.hpp',
+	    'audio/algo/drain/Dynamics.hpp',
+	    'audio/algo/drain/LoudnessMeter.hpp',
+	    'audio/algo/drain/Resampler.hpp',
+	    'audio/algo/drain/SpectrumAnalyzer.hpp',
+	    'audio/algo/drain/ChannelMixer.hpp',
+	    'audio/algo/drain/Crossover.hpp',
+	    'audio/algo/drain/EqualizerFit.hpp',
+	    'audio/algo/drain/GraphicEqualizer.hpp'
 	    ])
 	my_module.add_depend([
 	    'etk',
+	    'ethread',
+	    'echrono',
 	    'audio'
 	    ])
 	my_module.add_path(".")
@@ -7,11 +7,46 @@
 #include <test-debug/debug.hpp>
 #include <etk/etk.hpp>
 #include <audio/algo/drain/Equalizer.hpp>
+#include <audio/algo/drain/Beamformer.hpp>
+#include <audio/algo/drain/BeamformerStft.hpp>
+#include <audio/algo/drain/DirectionOfArrival.hpp>
+#include <audio/algo/drain/VectorMath.hpp>
+#include <audio/algo/drain/Fft.hpp>
+#include <audio/algo/drain/EqualizerBank.hpp>
+#include <audio/algo/drain/StaticEqualizer.hpp>
+#include <audio/algo/drain/BiQuadCache.hpp>
+#include <audio/algo/drain/EqualizerPreset.hpp>
+#include <audio/algo/drain/EqualizerRenderer.hpp>
+#include <audio/algo/drain/Chain.hpp>
+#include <audio/algo/drain/Dynamics.hpp>
+#include <audio/algo/drain/LoudnessMeter.hpp>
+#include <audio/algo/drain/Resampler.hpp>
+#include <audio/algo/drain/SpectrumAnalyzer.hpp>
+#include <audio/algo/drain/ChannelMixer.hpp>
+#include <audio/algo/drain/Crossover.hpp>
+#include <audio/algo/drain/EqualizerFit.hpp>
+#include <audio/algo/drain/GraphicEqualizer.hpp>
+#include <audio/types.hpp>
 #include <echrono/echrono.hpp>
 #include <ethread/Thread.hpp>
+#include <ethread/Mutex.hpp>
 #include <ethread/tools.hpp>
 #include <echrono/Steady.hpp>
 #include <echrono/Duration.hpp>
+#include <etk/uri/uri.hpp>
+extern "C" {
+	#include <string.h>
+	#if    defined(__TARGET_OS__Linux) \
+	    || defined(__TARGET_OS__MacOs) \
+	    || defined(__TARGET_OS__Android)
+		#define TEST_POSIX
+		#include <time.h>
+		#include <sys/mman.h>
+		#include <sys/stat.h>
+		#include <fcntl.h>
+		#include <unistd.h>
+	#endif
+}
 
 class Performance {
 	private:
@@ -113,113 +148,2790 @@ void performanceEqualizer() {
 	performanceEqualizerType(audio::format_int64);
 }
 
-int main(int _argc, const char** _argv) {
-	// the only one init for etk:
-	etk::init(_argc, _argv);
-	etk::String inputName = "";
-	etk::String outputName = "output.raw";
-	bool performance = false;
-	bool perf = false;
-	int64_t sampleRateIn = 48000;
-	int64_t sampleRateOut = 48000;
-	int32_t nbChan = 1;
-	int32_t quality = 4;
-	etk::String test = "";
-	for (int32_t iii=0; iii<_argc ; ++iii) {
-		etk::String data = _argv[iii];
-		if (etk::start_with(data,"--in=")) {
-			inputName = &data[5];
-		} else if (etk::start_with(data,"--out=")) {
-			outputName = &data[6];
-		} else if (data == "--performance") {
-			performance = true;
-		} else if (data == "--perf") {
-			perf = true;
-		} else if (etk::start_with(data,"--test=")) {
-			data = &data[7];
-			sampleRateIn = etk::string_to_int32_t(data);
-		} else if (etk::start_with(data,"--sample-rate-in=")) {
-			data = &data[17];
-			sampleRateIn = etk::string_to_int32_t(data);
-		} else if (etk::start_with(data,"--sample-rate-out=")) {
-			data = &data[18];
-			sampleRateOut = etk::string_to_int32_t(data);
-		} else if (etk::start_with(data,"--nb=")) {
-			data = &data[5];
-			nbChan = etk::string_to_int32_t(data);
-		} else if (etk::start_with(data,"--quality=")) {
-			data = &data[10];
-			quality = etk::string_to_int32_t(data);
-		} else if (    data == "-h"
-		            || data == "--help") {
-			TEST_PRINT("Help : ");
-			TEST_PRINT("    ./xxx --fb=file.raw --mic=file.raw");
-			TEST_PRINT("        --in=YYY.raw            input file");
-			TEST_PRINT("        --out=zzz.raw           output file");
-			TEST_PRINT("        --performance           Generate signal to force algo to maximum process time");
-			TEST_PRINT("        --perf                  Enable performence test (little slower but real performence test)");
-			TEST_PRINT("        --test=XXXX             some test availlable ...");
-			TEST_PRINT("            EQUALIZER          Test resampling data 16 bit mode");
-			TEST_PRINT("                --sample-rate=XXXX   Input signal sample rate (default 48000)");
-			
-			exit(0);
+/**
+ * @brief Add a plane wave sine on all the microphones of an array (exact delay of each microphone).
+ * @param[in,out] _output Interleaved buffer (nbSample x nbMicrophone).
+ * @param[in] _positions Position of the microphones.
+ * @param[in] _direction Direction of the source.
+ * @param[in] _frequency Frequency of the sine (Hz).
+ * @param[in] _phase Phase of the sine at the center of the array (rad).
+ * @param[in] _amplitude Amplitude of the sine.
+ * @param[in] _sampleRate Sample rate.
+ */
+static void arrayAddTone(etk::Vector<float>& _output, const etk::Vector<vec3>& _positions, const audio::algo::drain::Direction& _direction,
+                         double _frequency, double _phase, double _amplitude, float _sampleRate) {
+	int32_t nbChannel = _positions.size();
+	int32_t nbSample = _output.size() / nbChannel;
+	for (int32_t ccc=0; ccc<nbChannel; ++ccc) {
+		double delay = audio::algo::drain::calculateDelay(_positions[ccc], _direction);
+		for (int32_t iii=0; iii<nbSample; ++iii) {
+			_output[iii*nbChannel + ccc] += _amplitude * sin(2.0*M_PI*_frequency*(double(iii)/_sampleRate - delay) + _phase);
 		}
 	}
-	// PERFORMANCE test only ....
-	if (performance == true) {
-		performanceEqualizer();
-		return 0;
+}
+
+/**
+ * @brief Create a uniform linear array on the X axis (centered on 0).
+ * @param[in] _nbMicrophone Number of microphone.
+ * @param[in] _spacing Distance between two microphones (m).
+ */
+static etk::Vector<vec3> arrayLinear(int32_t _nbMicrophone, float _spacing) {
+	etk::Vector<vec3> out;
+	for (int32_t iii=0; iii<_nbMicrophone; ++iii) {
+		out.pushBack(vec3((float(iii) - 0.5f*float(_nbMicrophone-1)) * _spacing, 0.0f, 0.0f));
 	}
-	if (test == "EQUALIZER") {
-		/*
-		TEST_INFO("Start resampling test ... ");
-		if (inputName == "") {
-			TEST_ERROR("Can not Process missing parameters...");
-			exit(-1);
+	return out;
+}
+
+/**
+ * @brief Level of a mono signal in dB relative to a sine of amplitude 1 (RMS).
+ */
+static double toneLevel(const float* _data, int32_t _nbSample) {
+	double sum = 0.0;
+	for (int32_t iii=0; iii<_nbSample; ++iii) {
+		sum += double(_data[iii]) * double(_data[iii]);
+	}
+	return 10.0*log10(2.0 * sum / double(etk::max(1, _nbSample)) + 1.0e-30);
+}
+
+/**
+ * @brief Theoretical gain of a delay and sum on a uniform linear array (array factor sin(N.psi/2)/(N.sin(psi/2)) in dB).
+ */
+static double arrayFactor(int32_t _nbMicrophone, double _spacing, double _frequency, double _angle, double _angleSteering) {
+	double psi = 2.0*M_PI*_frequency*_spacing*(sin(_angle) - sin(_angleSteering)) / audio::algo::drain::speedSound;
+	if (fabs(sin(0.5*psi)) < 1.0e-12) {
+		return 0.0;
+	}
+	return 20.0*log10(fabs(sin(0.5*_nbMicrophone*psi) / (_nbMicrophone * sin(0.5*psi))));
+}
+
+void testBeamformer() {
+	float sampleRate = 48000;
+	int32_t nbMicrophone = 8;
+	float spacing = 0.04f;
+	double frequency = 4000.0;
+	int32_t nbSample = 16384;
+	int32_t blockSize = 128;
+	etk::Vector<vec3> positions = arrayLinear(nbMicrophone, spacing);
+	audio::algo::drain::Direction target(0.0, 0.0);
+	// first side lobe of the array: N.psi/2 = 1.4303.pi
+	double sideLobe = asin(2.0*1.4303*M_PI/double(nbMicrophone) * audio::algo::drain::speedSound / (2.0*M_PI*frequency*spacing));
+	audio::algo::drain::Direction listDirection[] = {target, audio::algo::drain::Direction(sideLobe, 0.0), audio::algo::drain::Direction(M_PI*0.5, 0.0)};
+	etk::Vector<float> output;
+	output.resize(nbSample, 0.0f);
+	for (size_t ddd=0; ddd<sizeof(listDirection)/sizeof(audio::algo::drain::Direction); ++ddd) {
+		etk::Vector<float> input;
+		input.resize(nbSample*nbMicrophone, 0.0f);
+		arrayAddTone(input, positions, listDirection[ddd], frequency, 0.0, 1.0, sampleRate);
+		audio::algo::drain::Beamformer beamformer;
+		beamformer.init(sampleRate, nbMicrophone, audio::format_float);
+		beamformer.setMicrophonePosition(positions);
+		beamformer.setSteering(target);
+		beamformer.process(&output[0], &input[0], nbSample);
+		// the first samples are the filling of the delay lines
+		double level = toneLevel(&output[4096], nbSample-4096);
+		double theory = arrayFactor(nbMicrophone, spacing, frequency, listDirection[ddd].angleAlpha, target.angleAlpha);
+		TEST_PRINT("beamformer " << nbMicrophone << " microphones, source at " << listDirection[ddd].angleAlpha*180.0/M_PI << " degree: gain="
+		           << level << " dB (theory " << theory << " dB)");
+		if (fabs(level - theory) > 0.5) {
+			TEST_ERROR("beamformer gain error: " << level << " dB, expected " << theory << " dB");
 		}
-		TEST_INFO("Read input:");
-		etk::Vector<int16_t> inputData = etk::FSNodeReadAllDataType<int16_t>(inputName);
-		TEST_INFO("    " << inputData.size() << " samples");
-		// resize output :
-		etk::Vector<int16_t> output;
-		output.resize(inputData.size()*sampleRateOut/sampleRateIn+5000, 0);
-		// process in chunk of 256 samples
-		int32_t blockSize = 256*nbChan;
-		
+	}
+	// steering change: the block after the change is a linear cross-fade between the old and the new steering
+	etk::Vector<float> input;
+	input.resize(nbSample*nbMicrophone, 0.0f);
+	arrayAddTone(input, positions, target, frequency, 0.0, 1.0, sampleRate);
+	arrayAddTone(input, positions, listDirection[1], frequency*0.75, 1.0, 0.5, sampleRate);
+	etk::Vector<float> outputOld;
+	outputOld.resize(nbSample, 0.0f);
+	etk::Vector<float> outputNew;
+	outputNew.resize(nbSample, 0.0f);
+	audio::algo::drain::Beamformer beamformerOld;
+	beamformerOld.init(sampleRate, nbMicrophone, audio::format_float);
+	beamformerOld.setMicrophonePosition(positions);
+	beamformerOld.setSteering(target);
+	beamformerOld.process(&outputOld[0], &input[0], nbSample);
+	audio::algo::drain::Beamformer beamformerNew;
+	beamformerNew.init(sampleRate, nbMicrophone, audio::format_float);
+	beamformerNew.setMicrophonePosition(positions);
+	beamformerNew.setSteering(listDirection[1]);
+	beamformerNew.process(&outputNew[0], &input[0], nbSample);
+	audio::algo::drain::Beamformer beamformer;
+	beamformer.init(sampleRate, nbMicrophone, audio::format_float);
+	beamformer.setMicrophonePosition(positions);
+	beamformer.setSteering(target);
+	int32_t change = 64*blockSize;
+	beamformer.process(&output[0], &input[0], change);
+	beamformer.setSteering(listDirection[1]);
+	beamformer.process(&output[change], &input[change*nbMicrophone], nbSample-change);
+	double errorBefore = 0.0;
+	double errorFade = 0.0;
+	double errorAfter = 0.0;
+	for (int32_t iii=1024; iii<nbSample; ++iii) {
+		if (iii < change) {
+			errorBefore = etk::max(errorBefore, double(fabs(output[iii] - outputOld[iii])));
+		} else if (iii < change + blockSize) {
+			float gain = float(iii - change + 1) / float(blockSize);
+			float reference = outputOld[iii] + (outputNew[iii] - outputOld[iii]) * gain;
+			errorFade = etk::max(errorFade, double(fabs(output[iii] - reference)));
+		} else {
+			errorAfter = etk::max(errorAfter, double(fabs(output[iii] - outputNew[iii])));
+		}
+	}
+	TEST_PRINT("beamformer steering change: error before=" << errorBefore << ", error of the cross-fade=" << errorFade << ", error after=" << errorAfter
+	           << " (latency " << beamformer.getLatency() << " samples)");
+	if (etk::max(errorBefore, etk::max(errorFade, errorAfter)) > 1.0e-5) {
+		TEST_ERROR("beamformer steering cross-fade does not match the two steering");
+	}
+	// latency of the steering: no delay in front of the array, the full aperture of the array at 90 degree
+	audio::algo::drain::Beamformer beamformerLatency;
+	beamformerLatency.init(sampleRate, nbMicrophone, audio::format_float);
+	beamformerLatency.setMicrophonePosition(positions);
+	beamformerLatency.setSteering(target);
+	int32_t latencyFront = beamformerLatency.getLatency();
+	beamformerLatency.setSteering(listDirection[2]);
+	int32_t latencySide = beamformerLatency.getLatency();
+	int32_t theorySide = int32_t(double(nbMicrophone-1)*spacing/audio::algo::drain::speedSound*sampleRate + 1.0 + 0.5);
+	TEST_PRINT("beamformer latency: front=" << latencyFront << " (theory 1) side=" << latencySide << " (theory " << theorySide << ") samples");
+	if (    latencyFront != 1
+	     || latencySide != theorySide) {
+		TEST_ERROR("beamformer latency does not follow the steering");
+	}
+}
+
+/**
+ * @brief Level of a sine at a frequency in a signal (dB relative to a sine of amplitude 1, the signal must have an integer number of period).
+ */
+static double toneLevelAt(const float* _data, int32_t _nbSample, double _frequency, float _sampleRate) {
+	double real = 0.0;
+	double imag = 0.0;
+	for (int32_t iii=0; iii<_nbSample; ++iii) {
+		double angle = 2.0 * M_PI * _frequency * iii / _sampleRate;
+		real += _data[iii] * cos(angle);
+		imag -= _data[iii] * sin(angle);
+	}
+	return 10.0*log10(real*real + imag*imag + 1.0e-30) - 20.0*log10(0.5*_nbSample);
+}
+
+void testBeamformerStft() {
+	// FFT compared with a direct DFT (double)
+	int32_t listSize[] = {16, 512, 4096};
+	for (size_t sss=0; sss<sizeof(listSize)/sizeof(int32_t); ++sss) {
+		int32_t size = listSize[sss];
+		audio::algo::drain::Fft fft;
+		fft.init(size);
+		etk::Vector<float> signal;
+		signal.resize(size, 0.0f);
+		uint32_t seed = 12345;
+		for (int32_t iii=0; iii<size; ++iii) {
+			seed = seed*1664525 + 1013904223;
+			signal[iii] = float(seed>>8)/float(1<<24) - 0.5f;
+		}
+		etk::Vector<float> real;
+		real.resize(fft.getNbBin(), 0.0f);
+		etk::Vector<float> imag;
+		imag.resize(fft.getNbBin(), 0.0f);
+		fft.forward(&real[0], &imag[0], &signal[0]);
+		double error = 0.0;
+		double norm = 0.0;
+		for (int32_t bbb=0; bbb<fft.getNbBin(); ++bbb) {
+			double refReal = 0.0;
+			double refImag = 0.0;
+			for (int32_t iii=0; iii<size; ++iii) {
+				double angle = -2.0 * M_PI * double(bbb) * double(iii) / double(size);
+				refReal += signal[iii] * cos(angle);
+				refImag += signal[iii] * sin(angle);
+			}
+			error = etk::max(error, sqrt((real[bbb]-refReal)*(real[bbb]-refReal) + (imag[bbb]-refImag)*(imag[bbb]-refImag)));
+			norm = etk::max(norm, sqrt(refReal*refReal + refImag*refImag));
+		}
+		etk::Vector<float> output;
+		output.resize(size, 0.0f);
+		fft.inverse(&output[0], &real[0], &imag[0]);
+		double errorInverse = 0.0;
+		for (int32_t iii=0; iii<size; ++iii) {
+			errorInverse = etk::max(errorInverse, double(fabs(output[iii] - signal[iii])));
+		}
+		TEST_PRINT("fft " << size << " points: error / direct DFT=" << error/norm << " (relative), inverse error=" << errorInverse);
+		if (    error/norm > 1.0e-5
+		     || errorInverse > 1.0e-5) {
+			TEST_ERROR("fft " << size << " points does not match the direct DFT");
+		}
+	}
+	// delay and sum and MVDR: target at 2 kHz ahead, interference at 3 kHz on 40 degree
+	float sampleRate = 48000;
+	int32_t nbMicrophone = 8;
+	float spacing = 0.04f;
+	int32_t nbSample = 96000;
+	int32_t nbMeasure = 24000;
+	double frequencyTarget = 2000.0;
+	double frequencyInterference = 3000.0;
+	etk::Vector<vec3> positions = arrayLinear(nbMicrophone, spacing);
+	audio::algo::drain::Direction target(0.0, 0.0);
+	audio::algo::drain::Direction interference(40.0*M_PI/180.0, 0.0);
+	etk::Vector<float> input;
+	input.resize(nbSample*nbMicrophone, 0.0f);
+	arrayAddTone(input, positions, target, frequencyTarget, 0.0, 1.0, sampleRate);
+	arrayAddTone(input, positions, interference, frequencyInterference, 0.5, 1.0, sampleRate);
+	uint32_t seed = 6789;
+	for (size_t iii=0; iii<input.size(); ++iii) {
+		seed = seed*1664525 + 1013904223;
+		input[iii] += (float(seed>>8)/float(1<<24) - 0.5f) * 0.01f;
+	}
+	etk::Vector<float> output;
+	output.resize(nbSample, 0.0f);
+	enum audio::algo::drain::beamformerStftMode listMode[] = {audio::algo::drain::beamformerStftMode_delayAndSum, audio::algo::drain::beamformerStftMode_mvdr};
+	for (size_t mmm=0; mmm<sizeof(listMode)/sizeof(enum audio::algo::drain::beamformerStftMode); ++mmm) {
+		audio::algo::drain::BeamformerStft beamformer;
+		beamformer.init(sampleRate, nbMicrophone, audio::format_float, 512);
+		beamformer.setMicrophonePosition(positions);
+		beamformer.setMode(listMode[mmm]);
+		beamformer.setSteering(target);
+		for (int32_t iii=0; iii<nbSample; iii+=480) {
+			beamformer.process(&output[iii], &input[iii*nbMicrophone], 480);
+		}
+		double levelTarget = toneLevelAt(&output[nbSample-nbMeasure], nbMeasure, frequencyTarget, sampleRate);
+		double levelInterference = toneLevelAt(&output[nbSample-nbMeasure], nbMeasure, frequencyInterference, sampleRate);
+		double theory = arrayFactor(nbMicrophone, spacing, frequencyInterference, interference.angleAlpha, 0.0);
+		TEST_PRINT("beamformer STFT " << (mmm == 0 ? "delay and sum" : "MVDR") << ": target gain=" << levelTarget << " dB, interference gain=" << levelInterference
+		           << " dB (delay and sum theory " << theory << " dB)");
+		if (    fabs(levelTarget) > 0.5
+		     || (    listMode[mmm] == audio::algo::drain::beamformerStftMode_delayAndSum
+		          && fabs(levelInterference - theory) > 1.0)
+		     || (    listMode[mmm] == audio::algo::drain::beamformerStftMode_mvdr
+		          && levelInterference > theory - 10.0)) {
+			TEST_ERROR("beamformer STFT gain error: target " << levelTarget << " dB, interference " << levelInterference << " dB");
+		}
+	}
+	// elevation out of the steering cache: the steering is calculated
+	audio::algo::drain::Direction elevated(0.3, 30.0*M_PI/180.0);
+	for (size_t iii=0; iii<input.size(); ++iii) {
+		input[iii] = 0.0f;
+	}
+	arrayAddTone(input, positions, elevated, frequencyInterference, 0.0, 1.0, sampleRate);
+	audio::algo::drain::BeamformerStft beamformer;
+	beamformer.init(sampleRate, nbMicrophone, audio::format_float, 512);
+	beamformer.setMicrophonePosition(positions);
+	beamformer.setSteering(elevated);
+	beamformer.process(&output[0], &input[0], nbSample);
+	double level = toneLevelAt(&output[nbSample-nbMeasure], nbMeasure, frequencyInterference, sampleRate);
+	TEST_PRINT("beamformer STFT source and steering at 30 degree of elevation: gain=" << level << " dB");
+	if (fabs(level) > 0.5) {
+		TEST_ERROR("beamformer STFT elevated steering gain error: " << level << " dB");
+	}
+}
+
+void testDirectionOfArrival() {
+	float sampleRate = 48000;
+	int32_t nbMicrophone = 8;
+	int32_t nbSample = 24000;
+	// circular array on the horizontal plane (XZ), radius 10 cm
+	etk::Vector<vec3> positions;
+	for (int32_t iii=0; iii<nbMicrophone; ++iii) {
+		double angle = 2.0*M_PI*iii/nbMicrophone;
+		positions.pushBack(vec3(0.1*cos(angle), 0.0, 0.1*sin(angle)));
+	}
+	etk::Vector<etk::Vector<double> > listSource;
+	listSource.pushBack(etk::Vector<double>());
+	listSource.back().pushBack(-60.0);
+	listSource.back().pushBack(45.0);
+	listSource.pushBack(etk::Vector<double>());
+	listSource.back().pushBack(-120.0);
+	listSource.back().pushBack(10.0);
+	listSource.back().pushBack(150.0);
+	// two near sources: the refinement of the second one must not go in the zone of the first one
+	listSource.pushBack(etk::Vector<double>());
+	listSource.back().pushBack(0.0);
+	listSource.back().pushBack(30.0);
+	for (size_t lll=0; lll<listSource.size(); ++lll) {
+		// each source is a sum of sines at different frequencies (uncorrelated broadband sources)
+		etk::Vector<float> input;
+		input.resize(nbSample*nbMicrophone, 0.0f);
+		uint32_t seed = 4242;
+		for (size_t sss=0; sss<listSource[lll].size(); ++sss) {
+			audio::algo::drain::Direction direction(listSource[lll][sss]*M_PI/180.0, 0.0);
+			for (int32_t ttt=0; ttt<60; ++ttt) {
+				seed = seed*1664525 + 1013904223;
+				double frequency = 300.0 + double(seed>>8)/double(1<<24) * 5000.0;
+				seed = seed*1664525 + 1013904223;
+				double phase = double(seed>>8)/double(1<<24) * 2.0*M_PI;
+				arrayAddTone(input, positions, direction, frequency, phase, 0.1, sampleRate);
+			}
+		}
+		audio::algo::drain::DirectionOfArrival doa;
+		doa.init(sampleRate, nbMicrophone, audio::format_float, 1024);
+		doa.setGrid(10.0, 1.0, 0.0, 0.0);
+		doa.setMicrophonePosition(positions);
+		doa.setNbSource(listSource[lll].size());
+		doa.process(&input[0], nbSample);
+		etk::Vector<etk::Pair<audio::algo::drain::Direction, float> > result = doa.getDirections();
+		etk::String text;
+		double errorMax = 0.0;
+		for (size_t sss=0; sss<listSource[lll].size(); ++sss) {
+			double error = 360.0;
+			for (size_t rrr=0; rrr<result.size(); ++rrr) {
+				double delta = fabs(result[rrr].first.angleAlpha*180.0/M_PI - listSource[lll][sss]);
+				error = etk::min(error, etk::min(delta, 360.0 - delta));
+			}
+			errorMax = etk::max(errorMax, error);
+		}
+		for (size_t rrr=0; rrr<result.size(); ++rrr) {
+			text += " " + etk::toString(int32_t(floor(result[rrr].first.angleAlpha*180.0/M_PI + 0.5)));
+		}
+		TEST_PRINT("direction of arrival " << listSource[lll].size() << " sources: found" << text << " degree, max error=" << errorMax << " degree");
+		if (errorMax > 5.0) {
+			TEST_ERROR("direction of arrival error: " << errorMax << " degree");
+		}
+	}
+}
+
+/**
+ * @brief Create a list of value spread on a logarithmic scale (the mantissa change at each value).
+ */
+static etk::Vector<float> vectorMathLogRange(double _minimum, double _maximum, int32_t _nbValue) {
+	etk::Vector<float> out;
+	for (int32_t iii=0; iii<_nbValue; ++iii) {
+		out.pushBack(_minimum * pow(_maximum/_minimum, double(iii)/double(_nbValue-1)));
+	}
+	return out;
+}
+
+void testVectorMath() {
+	int32_t nbValue = 200000;
+	// sinCos
+	double listAngle[] = {M_PI, 8192.0};
+	for (size_t rrr=0; rrr<sizeof(listAngle)/sizeof(double); ++rrr) {
+		etk::Vector<float> angle;
+		for (int32_t iii=0; iii<nbValue; ++iii) {
+			angle.pushBack(listAngle[rrr] * (2.0*double(iii)/double(nbValue-1) - 1.0));
+		}
+		etk::Vector<float> valueSin;
+		valueSin.resize(nbValue, 0.0f);
+		etk::Vector<float> valueCos;
+		valueCos.resize(nbValue, 0.0f);
+		audio::algo::drain::vectorMath::sinCos(&valueSin[0], &valueCos[0], &angle[0], nbValue);
+		double error = 0.0;
+		for (int32_t iii=0; iii<nbValue; ++iii) {
+			error = etk::max(error, fabs(valueSin[iii] - sin(double(angle[iii]))));
+			error = etk::max(error, fabs(valueCos[iii] - cos(double(angle[iii]))));
+		}
+		TEST_PRINT("vectorMath sinCos |angle| < " << listAngle[rrr] << ": absolute error=" << error);
+		if (error > 2.0e-7) {
+			TEST_ERROR("vectorMath sinCos error " << error);
+		}
+	}
+	// log10: absolute error on the mantissa range, relative error on all the float range
+	etk::Vector<float> value = vectorMathLogRange(0.5, 2.0, nbValue);
+	etk::Vector<float> output;
+	output.resize(nbValue, 0.0f);
+	audio::algo::drain::vectorMath::log10(&output[0], &value[0], nbValue);
+	double errorLog = 0.0;
+	for (int32_t iii=0; iii<nbValue; ++iii) {
+		errorLog = etk::max(errorLog, fabs(output[iii] - log10(double(value[iii]))));
+	}
+	value = vectorMathLogRange(1.18e-38, 3.4e38, nbValue);
+	audio::algo::drain::vectorMath::log10(&output[0], &value[0], nbValue);
+	double errorLogRelative = 0.0;
+	double errorLogAbsolute = 0.0;
+	for (int32_t iii=0; iii<nbValue; ++iii) {
+		double reference = log10(double(value[iii]));
+		errorLogAbsolute = etk::max(errorLogAbsolute, fabs(output[iii] - reference));
+		errorLogRelative = etk::max(errorLogRelative, fabs(output[iii] - reference) / etk::max(1.0, fabs(reference)));
+	}
+	TEST_PRINT("vectorMath log10: absolute error=" << errorLog << " in [0.5..2], " << errorLogAbsolute << " on all the float range (relative " << errorLogRelative << ")");
+	if (    errorLog > 5.0e-8
+	     || errorLogAbsolute > 2.0e-6
+	     || errorLogRelative > 1.0e-7) {
+		TEST_ERROR("vectorMath log10 error " << errorLog << " / " << errorLogAbsolute << " / " << errorLogRelative);
+	}
+	// powerToDb and dbToGain
+	double listPower[] = {1.0e10, 1.0e20};
+	double listPowerLimit[] = {1.0e-5, 2.0e-5};
+	for (size_t rrr=0; rrr<sizeof(listPower)/sizeof(double); ++rrr) {
+		value = vectorMathLogRange(1.0/listPower[rrr], listPower[rrr], nbValue);
+		audio::algo::drain::vectorMath::powerToDb(&output[0], &value[0], nbValue);
+		double errorDb = 0.0;
+		for (int32_t iii=0; iii<nbValue; ++iii) {
+			errorDb = etk::max(errorDb, fabs(output[iii] - 10.0*log10(double(value[iii]))));
+		}
+		TEST_PRINT("vectorMath powerToDb: absolute error=" << errorDb << " dB in [" << 1.0/listPower[rrr] << ".." << listPower[rrr] << "]");
+		if (errorDb > listPowerLimit[rrr]) {
+			TEST_ERROR("vectorMath powerToDb error " << errorDb << " dB");
+		}
+	}
+	double listGain[] = {120.0, 750.0};
+	double errorGain[2] = {0.0, 0.0};
+	for (size_t rrr=0; rrr<sizeof(listGain)/sizeof(double); ++rrr) {
+		for (int32_t iii=0; iii<nbValue; ++iii) {
+			value[iii] = listGain[rrr] * (2.0*double(iii)/double(nbValue-1) - 1.0);
+		}
+		audio::algo::drain::vectorMath::dbToGain(&output[0], &value[0], nbValue);
+		for (int32_t iii=0; iii<nbValue; ++iii) {
+			double reference = pow(10.0, double(value[iii])/20.0);
+			errorGain[rrr] = etk::max(errorGain[rrr], fabs(output[iii] - reference) / reference);
+		}
+		TEST_PRINT("vectorMath dbToGain in [-" << listGain[rrr] << ".." << listGain[rrr] << "] dB: relative error=" << errorGain[rrr]);
+	}
+	if (    errorGain[0] > 1.0e-6
+	     || errorGain[1] > 5.0e-6) {
+		TEST_ERROR("vectorMath dbToGain error " << errorGain[0] << " / " << errorGain[1]);
+	}
+	// dot: all the length of tail (16 blocks, 8 block and the last values)
+	for (int32_t iii=0; iii<64; ++iii) {
+		value[iii] = sin(0.37*iii);
+		output[iii] = cos(0.91*iii);
+	}
+	double errorDot = 0.0;
+	for (size_t nnn=0; nnn<=64; ++nnn) {
+		double reference = 0.0;
+		for (size_t iii=0; iii<nnn; ++iii) {
+			reference += double(value[iii]) * double(output[iii]);
+		}
+		errorDot = etk::max(errorDot, fabs(audio::algo::drain::vectorMath::dot(&value[0], &output[0], nnn) - reference));
+	}
+	TEST_PRINT("vectorMath dot of 0..64 values: absolute error=" << errorDot);
+	if (errorDot > 1.0e-5) {
+		TEST_ERROR("vectorMath dot error " << errorDot);
+	}
+}
+
+void performanceEqualizerBank(int32_t _nbStream) {
+	int32_t blockSize = 480;
+	double sampleRate = 48000;
+	etk::Vector<float> input;
+	input.resize(_nbStream*blockSize, 0);
+	etk::Vector<float> output;
+	output.resize(_nbStream*blockSize, 0);
+	for (size_t iii=0; iii<input.size(); iii++) {
+		input[iii] = cos(2.0*M_PI/sampleRate * 480.0 * iii) * 5.0;
+	}
+	etk::Vector<const float*> inputs;
+	etk::Vector<float*> outputs;
+	for (int32_t sss=0; sss<_nbStream; ++sss) {
+		inputs.pushBack(&input[sss*blockSize]);
+		outputs.pushBack(&output[sss*blockSize]);
+	}
+	TEST_INFO("Start " << _nbStream << " Equalizer (4 biquad) ...");
+	Performance perfoSingle;
+	{
+		etk::Vector<ememory::SharedPtr<audio::algo::drain::Equalizer> > algo;
+		for (int32_t sss=0; sss<_nbStream; ++sss) {
+			ememory::SharedPtr<audio::algo::drain::Equalizer> tmp = ememory::makeShared<audio::algo::drain::Equalizer>();
+			tmp->init(sampleRate, 1, audio::format_float);
+			for (int32_t bbb=0; bbb<4; ++bbb) {
+				tmp->addBiquad(audio::algo::drain::biQuadType_peak, 100.0*(bbb+1) + sss, 0.7, 3.0);
+			}
+			algo.pushBack(tmp);
+		}
+		for (int32_t iii=0; iii<100; ++iii) {
+			perfoSingle.tic();
+			for (int32_t sss=0; sss<_nbStream; ++sss) {
+				algo[sss]->process(outputs[sss], inputs[sss], blockSize);
+			}
+			perfoSingle.toc();
+		}
+	}
+	TEST_INFO("Start EqualizerBank of " << _nbStream << " streams (4 biquad) ...");
+	Performance perfoBank;
+	{
+		audio::algo::drain::EqualizerBank algo;
+		algo.init(sampleRate, 4, audio::format_float);
+		for (int32_t sss=0; sss<_nbStream; ++sss) {
+			int32_t id = algo.addStream();
+			for (int32_t bbb=0; bbb<4; ++bbb) {
+				algo.setBiquad(id, bbb, audio::algo::drain::biQuadType_peak, 100.0*(bbb+1) + sss, 0.7, 3.0);
+			}
+		}
+		for (int32_t iii=0; iii<100; ++iii) {
+			perfoBank.tic();
+			algo.process(&outputs[0], &inputs[0], _nbStream, blockSize);
+			perfoBank.toc();
+		}
+	}
+	double single = perfoSingle.getTotalTimeProcessing().toSeconds()*1000000.0/perfoSingle.getTotalIteration();
+	double bank = perfoBank.getTotalTimeProcessing().toSeconds()*1000000.0/perfoBank.getTotalIteration();
+	TEST_PRINT("nbStream=" << _nbStream << " block=" << blockSize << " Equalizer: " << single << "us EqualizerBank: " << bank << "us (x" << single/bank << ")");
+}
+
+// 5 bands stereo preset calculated at compile time
+static constexpr audio::algo::drain::BiQuadCoefficient stereoPreset[5] = {
+	audio::algo::drain::biQuadDesign(audio::algo::drain::biQuadType_lowShelf, 100.0, 0.707, 3.0, 48000.0),
+	audio::algo::drain::biQuadDesign(audio::algo::drain::biQuadType_peak, 400.0, 1.0, -2.0, 48000.0),
+	audio::algo::drain::biQuadDesign(audio::algo::drain::biQuadType_peak, 1500.0, 1.0, 2.0, 48000.0),
+	audio::algo::drain::biQuadDesign(audio::algo::drain::biQuadType_peak, 5000.0, 1.0, -1.0, 48000.0),
+	audio::algo::drain::biQuadDesign(audio::algo::drain::biQuadType_highShelf, 10000.0, 0.707, 2.0, 48000.0)
+};
+
+void performanceStaticEqualizer() {
+	int32_t blockSize = 1024;
+	double sampleRate = 48000;
+	etk::Vector<audio::float_t> input;
+	input.resize(blockSize*2, 0);
+	for (size_t iii=0; iii<input.size(); iii++) {
+		input[iii] = cos(2.0*M_PI/sampleRate * 480.0 * (iii/2)) * 0.5;
+	}
+	etk::Vector<audio::float_t> outputDynamic;
+	outputDynamic.resize(input.size(), 0);
+	etk::Vector<audio::float_t> outputStatic;
+	outputStatic.resize(input.size(), 0);
+	audio::algo::drain::Equalizer algoDynamic;
+	algoDynamic.init(sampleRate, 2, audio::format_float);
+	// same float arithmetic as the StaticEqualizer
+	algoDynamic.setMixedPrecision(false);
+	for (int32_t sss=0; sss<5; ++sss) {
+		algoDynamic.addBiquad(stereoPreset[sss].m_a[0], stereoPreset[sss].m_a[1], stereoPreset[sss].m_a[2], stereoPreset[sss].m_b[0], stereoPreset[sss].m_b[1]);
+	}
+	audio::algo::drain::StaticEqualizer<audio::float_t, 2, 5> algoStatic(stereoPreset, sampleRate);
+	Performance perfoDynamic;
+	Performance perfoStatic;
+	double maxError = 0.0;
+	for (int32_t iii=0; iii<1024; ++iii) {
+		perfoDynamic.tic();
+		algoDynamic.process(&outputDynamic[0], &input[0], blockSize);
+		perfoDynamic.toc();
+		perfoStatic.tic();
+		algoStatic.process(&outputStatic[0], &input[0], blockSize);
+		perfoStatic.toc();
+		for (size_t jjj=0; jjj<outputStatic.size(); ++jjj) {
+			maxError = etk::max(maxError, etk::abs((outputStatic[jjj] - outputDynamic[jjj]).getDouble()));
+		}
+	}
+	double timeDynamic = perfoDynamic.getTotalTimeProcessing().toSeconds()*1000000000.0/perfoDynamic.getTotalIteration();
+	double timeStatic = perfoStatic.getTotalTimeProcessing().toSeconds()*1000000000.0/perfoStatic.getTotalIteration();
+	TEST_PRINT("stereo 5 bands block=" << blockSize << " Equalizer: " << timeDynamic << "ns StaticEqualizer: " << timeStatic << "ns (x" << timeDynamic/timeStatic << ") max error=" << maxError);
+}
+
+void testBiQuadDesignLimit() {
+	// a non finite parameter gives a pass threw design (no infinite loop in the constant expression math)
+	double listValue[] = {INFINITY, -INFINITY, NAN};
+	int32_t nbWrong = 0;
+	for (size_t iii=0; iii<sizeof(listValue)/sizeof(double); ++iii) {
+		audio::algo::drain::BiQuadCoefficient listCoef[] = {
+			audio::algo::drain::biQuadDesign(audio::algo::drain::biQuadType_peak, 1000.0, 1.0, listValue[iii], 48000),
+			audio::algo::drain::biQuadDesign(audio::algo::drain::biQuadType_lowShelf, listValue[iii], 0.707, 3.0, 48000),
+			audio::algo::drain::biQuadDesign(audio::algo::drain::biQuadType_highShelf, 1000.0, listValue[iii], 3.0, 48000),
+			audio::algo::drain::BiQuadCache::get(audio::algo::drain::biQuadType_peak, 1000.0, 1.0, listValue[iii], 48000)
+		};
+		for (size_t ccc=0; ccc<sizeof(listCoef)/sizeof(audio::algo::drain::BiQuadCoefficient); ++ccc) {
+			if (    listCoef[ccc].m_a[0] != 1.0
+			     || listCoef[ccc].m_a[1] != 0.0
+			     || listCoef[ccc].m_a[2] != 0.0
+			     || listCoef[ccc].m_b[0] != 0.0
+			     || listCoef[ccc].m_b[1] != 0.0) {
+				nbWrong++;
+			}
+		}
+	}
+	TEST_PRINT("bi-quad design with inf/nan parameters: " << nbWrong << " design not pass threw");
+	if (nbWrong != 0) {
+		TEST_ERROR("bi-quad design with inf/nan parameters is not pass threw");
+	}
+}
+
+void performancePresetLoad(int32_t _nbInstance) {
+	audio::algo::drain::BiQuadCache::clear();
+	Performance perfo;
+	etk::Vector<ememory::SharedPtr<audio::algo::drain::Equalizer> > algo;
+	for (int32_t iii=0; iii<_nbInstance; ++iii) {
+		perfo.tic();
+		ememory::SharedPtr<audio::algo::drain::Equalizer> tmp = ememory::makeShared<audio::algo::drain::Equalizer>();
+		tmp->init(48000, 2, audio::format_float);
+		tmp->addBiquad(audio::algo::drain::biQuadType_lowShelf, 100.0, 0.707, 3.0);
+		tmp->addBiquad(audio::algo::drain::biQuadType_peak, 400.0, 1.0, -2.0);
+		tmp->addBiquad(audio::algo::drain::biQuadType_peak, 1500.0, 1.0, 2.0);
+		tmp->addBiquad(audio::algo::drain::biQuadType_peak, 5000.0, 1.0, -1.0);
+		tmp->addBiquad(audio::algo::drain::biQuadType_highShelf, 10000.0, 0.707, 2.0);
+		perfo.toc();
+		algo.pushBack(tmp);
+	}
+	TEST_PRINT("preset load (5 bands) x" << _nbInstance << ": first=" << perfo.getMaxProcessing()
+	           << " avg=" << perfo.getTotalTimeProcessing().toSeconds()*1000000000.0/perfo.getTotalIteration() << "ns"
+	           << " cache size=" << audio::algo::drain::BiQuadCache::getSize() << " hit=" << audio::algo::drain::BiQuadCache::getNbHit());
+}
+
+void testBiQuadCache() {
+	audio::algo::drain::BiQuadCache::clear();
+	size_t capacity = audio::algo::drain::BiQuadCache::getCapacity();
+	// more designs than the capacity: the size is bounded and each design is the direct calculation
+	int32_t nbDesign = int32_t(capacity*4);
+	double maxError = 0.0;
+	for (int32_t iii=0; iii<nbDesign; ++iii) {
+		double frequency = 20.0 + iii*5.0;
+		audio::algo::drain::BiQuadCoefficient cache = audio::algo::drain::BiQuadCache::get(audio::algo::drain::biQuadType_peak, frequency, 1.0, 3.0, 48000);
+		audio::algo::drain::BiQuadCoefficient direct = audio::algo::drain::biQuadDesign(audio::algo::drain::biQuadType_peak, frequency, 1.0, 3.0, 48000);
+		for (int32_t jjj=0; jjj<3; ++jjj) {
+			maxError = etk::max(maxError, etk::abs(cache.m_a[jjj] - direct.m_a[jjj]));
+		}
+		for (int32_t jjj=0; jjj<2; ++jjj) {
+			maxError = etk::max(maxError, etk::abs(cache.m_b[jjj] - direct.m_b[jjj]));
+		}
+	}
+	size_t size = audio::algo::drain::BiQuadCache::getSize();
+	TEST_PRINT("bi-quad cache: " << nbDesign << " designs => size=" << size << "/" << capacity << " max error=" << maxError);
+	if (size > capacity) {
+		TEST_ERROR("bi-quad cache: size " << size << " over the capacity " << capacity);
+	}
+	if (maxError != 0.0) {
+		TEST_ERROR("bi-quad cache: design differ from biQuadDesign");
+	}
+	// a preset read by many threads while an other thread add new designs: the reads never get a wrong design
+	audio::algo::drain::BiQuadCache::clear();
+	ethread::Mutex mutex;
+	bool stop = false;
+	int64_t nbWrite = 0;
+	ethread::Thread writer([&]() {
+	                           for (int32_t iii=0; ; ++iii) {
+	                               {
+	                                   ethread::UniqueLock lock(mutex);
+	                                   if (stop == true) {
+	                                       return;
+	                                   }
+	                               }
+	                               audio::algo::drain::BiQuadCache::get(audio::algo::drain::biQuadType_lowPass, 100.0 + (iii%100000)*0.1, 0.707, 0.0, 44100);
+	                               nbWrite++;
+	                           }
+	                       },
+	                       "writer");
+	audio::algo::drain::BiQuadCoefficient reference[5];
+	for (int32_t bbb=0; bbb<5; ++bbb) {
+		reference[bbb] = audio::algo::drain::biQuadDesign(audio::algo::drain::biQuadType_peak, 100.0*(bbb+1), 1.0, -2.0, 48000);
+	}
+	int32_t nbRead = 200000;
+	int32_t nbWrong = 0;
+	Performance perfo;
+	for (int32_t iii=0; iii<nbRead; ++iii) {
+		int32_t bbb = iii%5;
+		perfo.tic();
+		audio::algo::drain::BiQuadCoefficient coef = audio::algo::drain::BiQuadCache::get(audio::algo::drain::biQuadType_peak, 100.0*(bbb+1), 1.0, -2.0, 48000);
+		perfo.toc();
+		if (    coef.m_a[0] != reference[bbb].m_a[0]
+		     || coef.m_a[1] != reference[bbb].m_a[1]
+		     || coef.m_a[2] != reference[bbb].m_a[2]
+		     || coef.m_b[0] != reference[bbb].m_b[0]
+		     || coef.m_b[1] != reference[bbb].m_b[1]) {
+			nbWrong++;
+		}
+	}
+	{
+		ethread::UniqueLock lock(mutex);
+		stop = true;
+	}
+	writer.join();
+	TEST_PRINT("bi-quad cache: " << nbRead << " reads (avg=" << perfo.getTotalTimeProcessing().toSeconds()*1000000000.0/perfo.getTotalIteration() << "ns)"
+	           << " during " << nbWrite << " insertions: wrong=" << nbWrong << " size=" << audio::algo::drain::BiQuadCache::getSize() << " hit=" << audio::algo::drain::BiQuadCache::getNbHit());
+	if (nbWrong != 0) {
+		TEST_ERROR("bi-quad cache: " << nbWrong << " wrong designs read during the insertions");
+	}
+}
+
+/**
+ * @brief Add the 5 bands of the reference preset to an equalizer.
+ */
+static void addPresetBand(audio::algo::drain::Equalizer& _algo) {
+	_algo.addBiquad(audio::algo::drain::biQuadType_lowShelf, 100.0, 0.707, 3.0);
+	_algo.addBiquad(audio::algo::drain::biQuadType_peak, 400.0, 1.0, -2.0);
+	_algo.addBiquad(audio::algo::drain::biQuadType_peak, 1500.0, 1.0, 2.0);
+	_algo.addBiquad(audio::algo::drain::biQuadType_peak, 5000.0, 1.0, -1.0);
+	_algo.addBiquad(audio::algo::drain::biQuadType_highShelf, 10000.0, 0.707, 2.0);
+}
+
+void testSetSampleRate() {
+	int32_t nbChunk = 4096;
+	// the bands redesigned by setSampleRate are the ones of an equalizer created at the new rate
+	audio::algo::drain::Equalizer algoChange;
+	algoChange.init(48000, 2, audio::format_float);
+	addPresetBand(algoChange);
+	algoChange.setSampleRate(44100);
+	audio::algo::drain::Equalizer algoNew;
+	algoNew.init(44100, 2, audio::format_float);
+	addPresetBand(algoNew);
+	etk::Vector<etk::Pair<float,float> > theoryChange = algoChange.calculateTheory();
+	etk::Vector<etk::Pair<float,float> > theoryNew = algoNew.calculateTheory();
+	double errorTheory = 0.0;
+	for (size_t iii=0; iii<theoryChange.size() && iii<theoryNew.size(); ++iii) {
+		errorTheory = etk::max(errorTheory, double(etk::abs(theoryChange[iii].second - theoryNew[iii].second)));
+	}
+	if (theoryChange.size() != theoryNew.size()) {
+		TEST_ERROR("setSampleRate: theory size " << theoryChange.size() << " != " << theoryNew.size());
+		errorTheory = 1.0;
+	}
+	etk::Vector<float> impulse;
+	impulse.resize(nbChunk*2, 0.0f);
+	impulse[0] = 1.0f;
+	impulse[1] = 1.0f;
+	etk::Vector<float> outputChange;
+	outputChange.resize(nbChunk*2, 0.0f);
+	etk::Vector<float> outputNew;
+	outputNew.resize(nbChunk*2, 0.0f);
+	algoChange.reset();
+	algoChange.process(&outputChange[0], &impulse[0], nbChunk);
+	algoNew.process(&outputNew[0], &impulse[0], nbChunk);
+	double errorImpulse = 0.0;
+	for (size_t iii=0; iii<outputChange.size(); ++iii) {
+		errorImpulse = etk::max(errorImpulse, double(etk::abs(outputChange[iii] - outputNew[iii])));
+	}
+	TEST_PRINT("setSampleRate 48000=>44100: theory error=" << errorTheory << " dB impulse error=" << errorImpulse);
+	if (errorTheory > 1e-6 || errorImpulse > 1e-7) {
+		TEST_ERROR("setSampleRate: the design differ from an equalizer created at the new rate");
+	}
+	// the history is kept: a band with direct coefficients is not modified, the output is the one of an equalizer without change
+	audio::algo::drain::BiQuadCoefficient coef = audio::algo::drain::biQuadDesign(audio::algo::drain::biQuadType_peak, 1000.0, 1.0, 6.0, 48000);
+	audio::algo::drain::Equalizer algoKeep;
+	algoKeep.init(48000, 2, audio::format_float);
+	algoKeep.addBiquad(coef.m_a[0], coef.m_a[1], coef.m_a[2], coef.m_b[0], coef.m_b[1]);
+	audio::algo::drain::Equalizer algoRef;
+	algoRef.init(48000, 2, audio::format_float);
+	algoRef.addBiquad(coef.m_a[0], coef.m_a[1], coef.m_a[2], coef.m_b[0], coef.m_b[1]);
+	etk::Vector<float> input;
+	input.resize(nbChunk*2, 0.0f);
+	for (int32_t iii=0; iii<nbChunk; ++iii) {
+		input[iii*2] = 0.5f*sin(2.0*M_PI*1000.0*iii/48000.0);
+		input[iii*2+1] = 0.5f*sin(2.0*M_PI*250.0*iii/48000.0);
+	}
+	etk::Vector<float> outputKeep;
+	outputKeep.resize(nbChunk*2, 0.0f);
+	etk::Vector<float> outputRef;
+	outputRef.resize(nbChunk*2, 0.0f);
+	int32_t nbHalf = nbChunk/2;
+	algoKeep.process(&outputKeep[0], &input[0], nbHalf);
+	algoKeep.setSampleRate(44100);
+	algoKeep.process(&outputKeep[nbHalf*2], &input[nbHalf*2], nbChunk-nbHalf);
+	algoRef.process(&outputRef[0], &input[0], nbChunk);
+	double errorKeep = 0.0;
+	for (size_t iii=0; iii<outputKeep.size(); ++iii) {
+		errorKeep = etk::max(errorKeep, double(etk::abs(outputKeep[iii] - outputRef[iii])));
+	}
+	// the parametric bands: the output just after the change stays close to the one of an equalizer at the new rate since the start (a reset restart from a null history)
+	algoChange.reset();
+	algoNew.reset();
+	audio::algo::drain::Equalizer algoReset;
+	algoReset.init(48000, 2, audio::format_float);
+	addPresetBand(algoReset);
+	algoChange.setSampleRate(48000);
+	algoChange.process(&outputKeep[0], &input[0], nbHalf);
+	algoChange.setSampleRate(44100);
+	algoChange.process(&outputKeep[nbHalf*2], &input[nbHalf*2], nbChunk-nbHalf);
+	algoReset.process(&outputRef[0], &input[0], nbHalf);
+	algoReset.setSampleRate(44100);
+	algoReset.reset();
+	algoReset.process(&outputRef[nbHalf*2], &input[nbHalf*2], nbChunk-nbHalf);
+	etk::Vector<float> outputTarget;
+	outputTarget.resize(nbChunk*2, 0.0f);
+	algoNew.process(&outputTarget[0], &input[0], nbChunk);
+	double errorChange = 0.0;
+	double errorReset = 0.0;
+	for (int32_t iii=nbHalf*2; iii<(nbHalf+64)*2; ++iii) {
+		errorChange = etk::max(errorChange, double(etk::abs(outputKeep[iii] - outputTarget[iii])));
+		errorReset = etk::max(errorReset, double(etk::abs(outputRef[iii] - outputTarget[iii])));
+	}
+	TEST_PRINT("setSampleRate history: direct band error=" << errorKeep << " first 64 samples after the change: error=" << errorChange << " (with reset: " << errorReset << ")");
+	if (errorKeep != 0.0) {
+		TEST_ERROR("setSampleRate: the history of the direct band is not kept");
+	}
+	if (errorChange > 0.25*errorReset) {
+		TEST_ERROR("setSampleRate: the history of the parametric bands is not kept");
+	}
+}
+
+void performancePresetBinary(int32_t _nbInstance) {
+	audio::algo::drain::EqualizerPreset preset;
+	preset.addBand(-1, audio::algo::drain::biQuadType_lowShelf, 100.0, 0.707, 3.0);
+	preset.addBand(-1, audio::algo::drain::biQuadType_peak, 400.0, 1.0, -2.0);
+	preset.addBand(0, audio::algo::drain::biQuadType_peak, 1500.0, 1.0, 2.0);
+	preset.addBand(1, audio::algo::drain::biQuadType_peak, 5000.0, 1.0, -1.0);
+	preset.addBand(-1, audio::algo::drain::biQuadType_highShelf, 10000.0, 0.707, 2.0);
+	preset.addCoefficientSet(48000);
+	preset.addCoefficientSet(96000);
+	// round trip in text:
+	audio::algo::drain::EqualizerPreset presetText;
+	if (    presetText.fromText(preset.toText()) == false
+	     || presetText.getSize() != preset.getSize()
+	     || memcmp(presetText.getData(), preset.getData(), preset.getSize()) != 0) {
+		TEST_ERROR("preset text round trip failed:\n" << preset.toText());
+	}
+	// zero copy load of the binary form (as a mapped file):
+	etk::Vector<uint64_t> binary;
+	binary.resize(preset.getSize()/sizeof(uint64_t), 0);
+	memcpy(&binary[0], preset.getData(), preset.getSize());
+	Performance perfo;
+	etk::Vector<ememory::SharedPtr<audio::algo::drain::Equalizer> > algo;
+	for (int32_t iii=0; iii<_nbInstance; ++iii) {
+		perfo.tic();
+		audio::algo::drain::EqualizerPreset tmpPreset;
+		tmpPreset.load(&binary[0], preset.getSize());
+		ememory::SharedPtr<audio::algo::drain::Equalizer> tmp = ememory::makeShared<audio::algo::drain::Equalizer>();
+		tmp->init(96000, 2, audio::format_float);
+		tmpPreset.apply(*tmp, 96000);
+		perfo.toc();
+		algo.pushBack(tmp);
+	}
+	// a corrupted preset is refused:
+	binary[1] = 0xFFFFFFFF;
+	audio::algo::drain::EqualizerPreset presetCorrupted;
+	bool corruptedRefused = presetCorrupted.load(&binary[0], preset.getSize()) == false;
+	TEST_PRINT("binary preset (" << preset.getSize() << " bytes) load+apply x" << _nbInstance << ": first=" << perfo.getMaxProcessing()
+	           << " avg=" << perfo.getTotalTimeProcessing().toSeconds()*1000000000.0/perfo.getTotalIteration() << "ns"
+	           << " corrupted refused=" << corruptedRefused);
+}
+
+void performanceParallelRender(int32_t _nbSecond) {
+	float sampleRate = 48000;
+	int32_t nbChannel = 2;
+	audio::algo::drain::EqualizerPreset preset;
+	preset.addBand(-1, audio::algo::drain::biQuadType_lowShelf, 100.0, 0.707, 3.0);
+	preset.addBand(-1, audio::algo::drain::biQuadType_peak, 400.0, 1.0, -2.0);
+	preset.addBand(-1, audio::algo::drain::biQuadType_peak, 1500.0, 1.0, 2.0);
+	preset.addBand(-1, audio::algo::drain::biQuadType_peak, 5000.0, 1.0, -1.0);
+	preset.addBand(-1, audio::algo::drain::biQuadType_highShelf, 10000.0, 0.707, 2.0);
+	// long white noise (reproducible)
+	etk::Vector<float> input;
+	input.resize(size_t(_nbSecond*sampleRate)*nbChannel, 0.0f);
+	uint32_t seed = 12345;
+	for (size_t iii=0; iii<input.size(); ++iii) {
+		seed = seed*1664525 + 1013904223;
+		input[iii] = (float(seed>>8)/float(1<<24) - 0.5f) * 1.8f;
+	}
+	size_t nbChunk = input.size()/nbChannel;
+	// sequential reference
+	etk::Vector<float> outputSequential;
+	outputSequential.resize(input.size(), 0.0f);
+	audio::algo::drain::Equalizer algo;
+	algo.init(sampleRate, nbChannel, audio::format_float);
+	preset.apply(algo, sampleRate);
+	Performance perfoSequential;
+	perfoSequential.tic();
+	algo.process(&outputSequential[0], &input[0], nbChunk);
+	perfoSequential.toc();
+	// segmented on all the processors
+	etk::Vector<float> outputParallel;
+	outputParallel.resize(input.size(), 0.0f);
+	audio::algo::drain::EqualizerRenderer renderer;
+	renderer.init(preset, sampleRate, nbChannel, audio::format_float);
+	renderer.setSeamThreshold(1.0e-6);
+	Performance perfoParallel;
+	perfoParallel.tic();
+	renderer.process(&outputParallel[0], &input[0], nbChunk);
+	perfoParallel.toc();
+	// the float process can not be more accurate than its own rounding: compare with a process in double
+	etk::Vector<double> inputDouble;
+	inputDouble.resize(input.size(), 0.0);
+	for (size_t iii=0; iii<input.size(); ++iii) {
+		inputDouble[iii] = input[iii];
+	}
+	audio::algo::drain::Equalizer algoDouble;
+	algoDouble.init(sampleRate, nbChannel, audio::format_double);
+	preset.apply(algoDouble, sampleRate);
+	algoDouble.process(&inputDouble[0], &inputDouble[0], nbChunk);
+	double maxError = 0.0;
+	double maxRounding = 0.0;
+	double maxValue = 0.0;
+	for (size_t iii=0; iii<input.size(); ++iii) {
+		maxError = etk::max(maxError, etk::abs(double(outputParallel[iii]) - double(outputSequential[iii])));
+		maxRounding = etk::max(maxRounding, etk::abs(double(outputSequential[iii]) - inputDouble[iii]));
+		maxValue = etk::max(maxValue, etk::abs(inputDouble[iii]));
+	}
+	double timeSequential = perfoSequential.getTotalTimeProcessing().toSeconds();
+	double timeParallel = perfoParallel.getTotalTimeProcessing().toSeconds();
+	TEST_PRINT("parallel render " << _nbSecond << "s stereo 5 bands: " << renderer.getNbSegment() << " segments, warm-up=" << renderer.getWarmUpSize()
+	           << " sequential=" << timeSequential*1000.0 << "ms parallel=" << timeParallel*1000.0 << "ms (x" << timeSequential/timeParallel << ")"
+	           << " seam error=" << maxError/maxValue << " (threshold 1e-06, float rounding=" << maxRounding/maxValue << ")");
+}
+
+void performanceEqualizerKernel(int32_t _nbChannel, int32_t _nbStage, int32_t _blockSize) {
+	static const enum audio::algo::drain::equalizerKernel listKernel[] = {
+		audio::algo::drain::equalizerKernel_directForm1,
+		audio::algo::drain::equalizerKernel_directForm1Cascade,
+		audio::algo::drain::equalizerKernel_transposedDirectForm2,
+		audio::algo::drain::equalizerKernel_crossChannel
+	};
+	float sampleRate = 48000;
+	audio::algo::drain::Equalizer algo;
+	algo.init(sampleRate, _nbChannel, audio::format_float);
+	for (int32_t iii=0; iii<_nbStage; ++iii) {
+		algo.addBiquad(audio::algo::drain::biQuadType_peak, 100.0*(iii+1), 1.0, 3.0);
+	}
+	etk::Vector<float> input;
+	input.resize(_blockSize*_nbChannel, 0.0f);
+	uint32_t seed = 12345;
+	for (size_t iii=0; iii<input.size(); ++iii) {
+		seed = seed*1664525 + 1013904223;
+		input[iii] = float(seed>>8)/float(1<<24) - 0.5f;
+	}
+	etk::Vector<float> output;
+	output.resize(input.size(), 0.0f);
+	int32_t nbBlock = etk::max(int32_t(1), int32_t(sampleRate*10/_blockSize));
+	etk::String result;
+	for (size_t kkk=0; kkk<sizeof(listKernel)/sizeof(listKernel[0]); ++kkk) {
+		algo.setKernel(listKernel[kkk]);
 		Performance perfo;
-		audio::algo::speex::Resampler algo;
-		algo.init(nbChan, sampleRateIn, sampleRateOut, quality);
-		int32_t lastPourcent = -1;
-		size_t outputPosition = 0;
-		for (int32_t iii=0; iii<inputData.size()/blockSize; ++iii) {
-			if (lastPourcent != 100*iii / (inputData.size()/blockSize)) {
-				lastPourcent = 100*iii / (inputData.size()/blockSize);
-				TEST_INFO("Process : " << iii*blockSize << "/" << int32_t(inputData.size()/blockSize)*blockSize << " " << lastPourcent << "/100");
-			} else {
-				TEST_VERBOSE("Process : " << iii*blockSize << "/" << int32_t(inputData.size()/blockSize)*blockSize);
+		perfo.tic();
+		for (int32_t iii=0; iii<nbBlock; ++iii) {
+			algo.process(&output[0], &input[0], _blockSize);
+		}
+		perfo.toc();
+		double duration = double(nbBlock)*double(_blockSize)/sampleRate;
+		result += " " + etk::toString(listKernel[kkk]) + "=x" + etk::toString(int32_t(duration/perfo.getTotalTimeProcessing().toSeconds()));
+	}
+	enum audio::algo::drain::equalizerKernel selected = algo.calibrate(_blockSize);
+	TEST_PRINT("kernels channel=" << _nbChannel << " stage=" << _nbStage << " block=" << _blockSize << " (x realtime):" << result << " calibrate ==> " << etk::toString(selected));
+}
+
+void performanceMixedPrecision() {
+	float sampleRate = 48000;
+	int32_t blockSize = 1024;
+	// low frequency, high Q: the float recursion is noisy
+	etk::Vector<float> input;
+	input.resize(blockSize, 0.0f);
+	uint32_t seed = 12345;
+	etk::Vector<double> inputDouble;
+	inputDouble.resize(blockSize, 0.0);
+	etk::Vector<float> output;
+	output.resize(blockSize, 0.0f);
+	etk::Vector<double> outputDouble;
+	outputDouble.resize(blockSize, 0.0);
+	audio::algo::drain::Equalizer algoFloat;
+	audio::algo::drain::Equalizer algoMixed;
+	audio::algo::drain::Equalizer algoDouble;
+	algoFloat.init(sampleRate, 1, audio::format_float);
+	algoFloat.setMixedPrecision(false);
+	algoMixed.init(sampleRate, 1, audio::format_float);
+	algoMixed.setMixedPrecision(true);
+	algoDouble.init(sampleRate, 1, audio::format_double);
+	audio::algo::drain::Equalizer* list[] = {&algoFloat, &algoMixed, &algoDouble};
+	for (int32_t iii=0; iii<3; ++iii) {
+		list[iii]->addBiquad(audio::algo::drain::biQuadType_highPass, 20.0, 0.707, 0.0);
+		list[iii]->addBiquad(audio::algo::drain::biQuadType_peak, 40.0, 8.0, -12.0);
+		list[iii]->addBiquad(audio::algo::drain::biQuadType_lowShelf, 80.0, 0.707, 6.0);
+		list[iii]->addBiquad(audio::algo::drain::biQuadType_peak, 1000.0, 1.0, 3.0);
+		list[iii]->addBiquad(audio::algo::drain::biQuadType_peak, 4000.0, 2.0, -3.0);
+		list[iii]->addBiquad(audio::algo::drain::biQuadType_highShelf, 10000.0, 0.707, 2.0);
+	}
+	Performance perfo[3];
+	double noise[2] = {0.0, 0.0};
+	double power = 0.0;
+	for (int32_t bbb=0; bbb<500; ++bbb) {
+		for (int32_t iii=0; iii<blockSize; ++iii) {
+			seed = seed*1664525 + 1013904223;
+			input[iii] = float(seed>>8)/float(1<<24) - 0.5f;
+			inputDouble[iii] = input[iii];
+		}
+		perfo[2].tic();
+		algoDouble.process(&outputDouble[0], &inputDouble[0], blockSize);
+		perfo[2].toc();
+		for (int32_t ppp=0; ppp<2; ++ppp) {
+			perfo[ppp].tic();
+			list[ppp]->process(&output[0], &input[0], blockSize);
+			perfo[ppp].toc();
+			for (int32_t iii=0; iii<blockSize; ++iii) {
+				double error = double(output[iii]) - outputDouble[iii];
+				noise[ppp] += error*error;
 			}
-			size_t availlableSize = (output.size() - outputPosition) / nbChan;
-			perfo.tic();
-			algo.process(&output[outputPosition], availlableSize, &inputData[iii*blockSize], blockSize, audio::format_int16);
-			if (perf == true) {
-				perfo.toc();
-				ethread::sleepMilliSeconds((1));
-			}
-			outputPosition += availlableSize*nbChan;
-		}
-		if (perf == true) {
-			TEST_INFO("Performance Result: ");
-			TEST_INFO("    blockSize=" << blockSize << " sample");
-			TEST_INFO("    min=" << perfo.getMinProcessing().count() << " ns");
-			TEST_INFO("    max=" << perfo.getMaxProcessing().count() << " ns");
-			TEST_INFO("    avg=" << perfo.getTotalTimeProcessing().count()/perfo.getTotalIteration() << " ns");
-			
-			TEST_INFO("    min=" << (float((perfo.getMinProcessing().count()*sampleRateIn)/blockSize)/1000000000.0)*100.0 << " %");
-			TEST_INFO("    max=" << (float((perfo.getMaxProcessing().count()*sampleRateIn)/blockSize)/1000000000.0)*100.0 << " %");
-			TEST_INFO("    avg=" << (float(((perfo.getTotalTimeProcessing().count()/perfo.getTotalIteration())*sampleRateIn)/blockSize)/1000000000.0)*100.0 << " %");
 		}
-		etk::FSNodeWriteAllDataType<int16_t>(outputName, output);
-		*/
+		for (int32_t iii=0; iii<blockSize; ++iii) {
+			power += outputDouble[iii]*outputDouble[iii];
+		}
+	}
+	TEST_PRINT("mixed precision 6 bands: double stages=" << algoMixed.getNbDoubleStage()
+	           << " noise: float=" << 10.0*log10(noise[0]/power) << "dB mixed=" << 10.0*log10(noise[1]/power) << "dB"
+	           << " time: float=" << perfo[0].getTotalTimeProcessing().toSeconds()*1000.0 << "ms mixed=" << perfo[1].getTotalTimeProcessing().toSeconds()*1000.0
+	           << "ms double=" << perfo[2].getTotalTimeProcessing().toSeconds()*1000.0 << "ms");
+}
+
+void testMixedPrecisionHistory() {
+	float sampleRate = 48000;
+	int32_t nbChunk = 9600;
+	int32_t third = nbChunk/3;
+	// a running stage promoted to double (move to a low frequency) then back to float: the history follows the stage
+	etk::Vector<float> input;
+	input.resize(nbChunk*2, 0.0f);
+	etk::Vector<double> inputDouble;
+	inputDouble.resize(nbChunk*2, 0.0);
+	for (int32_t iii=0; iii<nbChunk; ++iii) {
+		input[iii*2] = 0.5f*sin(2.0*M_PI*100.0*iii/sampleRate);
+		input[iii*2+1] = 0.5f*sin(2.0*M_PI*130.0*iii/sampleRate);
+		inputDouble[iii*2] = input[iii*2];
+		inputDouble[iii*2+1] = input[iii*2+1];
+	}
+	audio::algo::drain::BiQuadCoefficient coefHigh = audio::algo::drain::biQuadDesign(audio::algo::drain::biQuadType_peak, 4000.0, 1.0, 6.0, sampleRate);
+	audio::algo::drain::BiQuadCoefficient coefLow = audio::algo::drain::biQuadDesign(audio::algo::drain::biQuadType_peak, 150.0, 1.0, 6.0, sampleRate);
+	static const enum audio::algo::drain::equalizerKernel listKernel[] = {
+		audio::algo::drain::equalizerKernel_directForm1,
+		audio::algo::drain::equalizerKernel_directForm1Cascade,
+		audio::algo::drain::equalizerKernel_transposedDirectForm2,
+		audio::algo::drain::equalizerKernel_crossChannel
+	};
+	for (size_t kkk=0; kkk<sizeof(listKernel)/sizeof(listKernel[0]); ++kkk) {
+		// 0: all the stages in float, 1: mixed precision, 2: double flow (reference)
+		etk::Vector<float> output[2];
+		etk::Vector<double> outputDouble;
+		outputDouble.resize(nbChunk*2, 0.0);
+		int32_t nbDouble[3] = {0, 0, 0};
+		for (int32_t ppp=0; ppp<3; ++ppp) {
+			audio::algo::drain::Equalizer algo;
+			algo.init(sampleRate, 2, ppp == 2 ? audio::format_double : audio::format_float);
+			algo.setMixedPrecision(ppp == 1, -100.0);
+			algo.setKernel(listKernel[kkk]);
+			algo.addBiquad(audio::algo::drain::biQuadType_peak, 1000.0, 1.0, -3.0);
+			algo.addBiquad(-1, audio::algo::drain::biQuadType_peak, 4000.0, 1.0, 6.0, coefHigh);
+			uint8_t* data = reinterpret_cast<uint8_t*>(&outputDouble[0]);
+			const uint8_t* dataInput = reinterpret_cast<const uint8_t*>(&inputDouble[0]);
+			size_t chunkSize = 2*sizeof(double);
+			if (ppp != 2) {
+				output[ppp].resize(nbChunk*2, 0.0f);
+				data = reinterpret_cast<uint8_t*>(&output[ppp][0]);
+				dataInput = reinterpret_cast<const uint8_t*>(&input[0]);
+				chunkSize = 2*sizeof(float);
+			}
+			algo.process(data, dataInput, third);
+			nbDouble[0] = ppp == 1 ? algo.getNbDoubleStage() : nbDouble[0];
+			algo.setBiquad(-1, 1, audio::algo::drain::biQuadType_peak, 150.0, 1.0, 6.0, coefLow);
+			algo.process(&data[third*chunkSize], &dataInput[third*chunkSize], third);
+			if (ppp == 1) {
+				nbDouble[1] = algo.getNbDoubleStage();
+				algo.setMixedPrecision(false, -100.0);
+				nbDouble[2] = algo.getNbDoubleStage();
+			}
+			algo.process(&data[2*third*chunkSize], &dataInput[2*third*chunkSize], nbChunk-2*third);
+		}
+		// the mixed stream must stay on the double one while the stage is in double, and never be worse than the float stream
+		double errorFloat = 0.0;
+		double errorMixed = 0.0;
+		double errorMixedDouble = 0.0;
+		for (int32_t iii=0; iii<nbChunk*2; ++iii) {
+			errorFloat = etk::max(errorFloat, etk::abs(double(output[0][iii]) - outputDouble[iii]));
+			errorMixed = etk::max(errorMixed, etk::abs(double(output[1][iii]) - outputDouble[iii]));
+			if (    iii >= third*2
+			     && iii < third*4) {
+				errorMixedDouble = etk::max(errorMixedDouble, etk::abs(double(output[1][iii]) - outputDouble[iii]));
+			}
+		}
+		TEST_PRINT("mixed precision history " << listKernel[kkk] << ": double stages=" << nbDouble[0] << "=>" << nbDouble[1] << "=>" << nbDouble[2]
+		           << " error/double flow: float=" << errorFloat << " mixed=" << errorMixed << " (stage in double: " << errorMixedDouble << ")");
+		if (    nbDouble[0] != 0
+		     || nbDouble[1] != 2
+		     || nbDouble[2] != 0) {
+			TEST_ERROR("mixed precision history: the stage did not change of precision");
+		}
+		if (    errorMixedDouble > 1.0e-5
+		     || errorMixed > errorFloat*1.5) {
+			TEST_ERROR("mixed precision history: discontinuity when the stage change of precision");
+		}
+	}
+}
+
+void performanceChain(int32_t _blockSize) {
+	float sampleRate = 48000;
+	// 3 stereo equalizers, a down-mix (not in place) then a mono equalizer
+	etk::Vector<ememory::SharedPtr<audio::algo::drain::Equalizer> > stereo;
+	for (int32_t iii=0; iii<3; ++iii) {
+		ememory::SharedPtr<audio::algo::drain::Equalizer> tmp = ememory::makeShared<audio::algo::drain::Equalizer>();
+		tmp->init(sampleRate, 2, audio::format_float);
+		for (int32_t sss=0; sss<4; ++sss) {
+			tmp->addBiquad(audio::algo::drain::biQuadType_peak, 200.0*(iii*4+sss+1), 1.0, 2.0);
+		}
+		stereo.pushBack(tmp);
+	}
+	ememory::SharedPtr<audio::algo::drain::Equalizer> mono = ememory::makeShared<audio::algo::drain::Equalizer>();
+	mono->init(sampleRate, 1, audio::format_float);
+	mono->addBiquad(audio::algo::drain::biQuadType_highPass, 40.0, 0.707, 0.0);
+	etk::Function<void(void*, const void*, size_t)> downMix = [](void* _output, const void* _input, size_t _nbChunk) {
+		float* output = reinterpret_cast<float*>(_output);
+		const float* input = reinterpret_cast<const float*>(_input);
+		for (size_t iii=0; iii<_nbChunk; ++iii) {
+			output[iii] = (input[iii*2] + input[iii*2+1]) * 0.5f;
+		}
+	};
+	audio::algo::drain::Chain chain;
+	chain.init(sampleRate, 2, audio::format_float);
+	for (size_t iii=0; iii<stereo.size(); ++iii) {
+		chain.addStage(stereo[iii]);
+	}
+	chain.addStage(downMix, 1, false, "down-mix");
+	chain.addStage(mono);
+	etk::Vector<float> input;
+	input.resize(_blockSize*2, 0.0f);
+	uint32_t seed = 12345;
+	for (size_t iii=0; iii<input.size(); ++iii) {
+		seed = seed*1664525 + 1013904223;
+		input[iii] = float(seed>>8)/float(1<<24) - 0.5f;
+	}
+	etk::Vector<float> output;
+	output.resize(_blockSize, 0.0f);
+	etk::Vector<float> reference;
+	reference.resize(_blockSize, 0.0f);
+	// the application way: one call per algorithm on the full block, with intermediate buffers
+	etk::Vector<float> temporary;
+	temporary.resize(_blockSize*2, 0.0f);
+	int32_t nbBlock = etk::max(int32_t(1), int32_t(sampleRate*20/_blockSize));
+	Performance perfoChain;
+	Performance perfoAlone;
+	for (int32_t bbb=0; bbb<nbBlock; ++bbb) {
+		perfoAlone.tic();
+		stereo[0]->process(&temporary[0], &input[0], _blockSize);
+		stereo[1]->process(&temporary[0], &temporary[0], _blockSize);
+		stereo[2]->process(&temporary[0], &temporary[0], _blockSize);
+		downMix(&reference[0], &temporary[0], _blockSize);
+		mono->process(&reference[0], &reference[0], _blockSize);
+		perfoAlone.toc();
+	}
+	for (size_t iii=0; iii<stereo.size(); ++iii) {
+		stereo[iii]->reset();
+	}
+	mono->reset();
+	for (int32_t bbb=0; bbb<nbBlock; ++bbb) {
+		perfoChain.tic();
+		chain.process(&output[0], &input[0], _blockSize);
+		perfoChain.toc();
+	}
+	float maxError = 0.0f;
+	for (int32_t iii=0; iii<_blockSize; ++iii) {
+		maxError = etk::max(maxError, float(fabs(output[iii] - reference[iii])));
+	}
+	double timeAlone = perfoAlone.getTotalTimeProcessing().toSeconds();
+	double timeChain = perfoChain.getTotalTimeProcessing().toSeconds();
+	TEST_PRINT("chain 5 stages block=" << _blockSize << ": buffers=" << chain.getNbBuffer() << " sub-block=" << chain.getSubBlockSize()
+	           << " separate=" << timeAlone*1000.0 << "ms chain=" << timeChain*1000.0 << "ms (x" << timeAlone/timeChain << ") max error=" << maxError);
+}
+
+void performanceDynamics(int32_t _nbChannel, bool _link, enum audio::algo::drain::dynamicsDetector _detector) {
+	float sampleRate = 48000;
+	int32_t blockSize = 256;
+	float ceiling = -1.0f;
+	audio::algo::drain::Dynamics algo;
+	algo.init(sampleRate, _nbChannel, audio::format_float);
+	algo.setDetector(_detector);
+	algo.setCompressor(-20.0f, 4.0f, 6.0f);
+	algo.setGate(-60.0f);
+	algo.setTime(0.005f, 0.1f);
+	algo.setMakeUpGain(12.0f);
+	algo.setLimiter(true, ceiling, 0.005f);
+	algo.setLink(_link);
+	// 10 s of noise, the level change every 100 ms from -70 dB to +6 dB
+	int32_t nbChunk = sampleRate*10;
+	etk::Vector<float> input;
+	input.resize(nbChunk*_nbChannel, 0.0f);
+	uint32_t seed = 12345;
+	for (int32_t iii=0; iii<nbChunk; ++iii) {
+		float level = pow(10.0f, (-70.0f + float((iii/4800)%20)*4.0f)/20.0f);
+		for (int32_t ccc=0; ccc<_nbChannel; ++ccc) {
+			seed = seed*1664525 + 1013904223;
+			input[iii*_nbChannel+ccc] = (float(seed>>8)/float(1<<24) - 0.5f) * 2.0f * level;
+		}
+	}
+	etk::Vector<float> output;
+	output.resize(input.size(), 0.0f);
+	Performance perfo;
+	for (int32_t iii=0; iii+blockSize<=nbChunk; iii+=blockSize) {
+		perfo.tic();
+		algo.process(&output[iii*_nbChannel], &input[iii*_nbChannel], blockSize);
+		perfo.toc();
+	}
+	float peak = 0.0f;
+	for (size_t iii=0; iii<output.size(); ++iii) {
+		peak = etk::max(peak, float(fabs(output[iii])));
+	}
+	double duration = double(nbChunk)/sampleRate;
+	TEST_PRINT("dynamics channel=" << _nbChannel << (_link == true ? " linked" : " unlinked") << (_detector == audio::algo::drain::dynamicsDetector_rms ? " rms" : " peak")
+	           << ": x" << int32_t(duration/perfo.getTotalTimeProcessing().toSeconds()) << " realtime (" << perfo.getTotalTimeProcessing().toSeconds()*1000000000.0/(double(nbChunk)*_nbChannel) << "ns/sample)"
+	           << " latency=" << algo.getLatency() << " output peak=" << 20.0*log10(peak) << "dB (ceiling " << ceiling << "dB)");
+}
+
+void performanceDynamicEqualizer(int32_t _nbChannel, int32_t _nbBand) {
+	float sampleRate = 48000;
+	int32_t blockSize = 256;
+	audio::algo::drain::Equalizer algoStatic;
+	audio::algo::drain::Equalizer algoDynamic;
+	algoStatic.init(sampleRate, _nbChannel, audio::format_float);
+	algoDynamic.init(sampleRate, _nbChannel, audio::format_float);
+	for (int32_t iii=0; iii<_nbBand; ++iii) {
+		double frequency = 62.5 * pow(2.0, iii);
+		algoStatic.addBiquad(audio::algo::drain::biQuadType_peak, frequency, 2.0, -6.0);
+		algoDynamic.addBiquad(-1, audio::algo::drain::biQuadType_peak, frequency, 2.0, -6.0, audio::algo::drain::EqualizerDynamic(-30.0, 4.0));
+	}
+	etk::Vector<float> input;
+	input.resize(blockSize*_nbChannel, 0.0f);
+	uint32_t seed = 12345;
+	for (size_t iii=0; iii<input.size(); ++iii) {
+		seed = seed*1664525 + 1013904223;
+		input[iii] = float(seed>>8)/float(1<<24) - 0.5f;
+	}
+	etk::Vector<float> output;
+	output.resize(input.size(), 0.0f);
+	int32_t nbBlock = int32_t(sampleRate*10/blockSize);
+	Performance perfoStatic;
+	Performance perfoDynamic;
+	for (int32_t iii=0; iii<nbBlock; ++iii) {
+		perfoStatic.tic();
+		algoStatic.process(&output[0], &input[0], blockSize);
+		perfoStatic.toc();
+		perfoDynamic.tic();
+		algoDynamic.process(&output[0], &input[0], blockSize);
+		perfoDynamic.toc();
+	}
+	double duration = double(nbBlock)*double(blockSize)/sampleRate;
+	TEST_PRINT("dynamic equalizer channel=" << _nbChannel << " band=" << _nbBand << ": static=x" << int32_t(duration/perfoStatic.getTotalTimeProcessing().toSeconds())
+	           << " dynamic=x" << int32_t(duration/perfoDynamic.getTotalTimeProcessing().toSeconds()) << " realtime, gain of the band 1000Hz=" << algoDynamic.getDynamicGain(0, 4) << "dB");
+}
+
+void testDynamicEqualizer() {
+	float sampleRate = 48000;
+	// 1 kHz at -6 dB: the side-chain is 24 dB over the threshold ==> 18 dB of cut, limited to 12 dB
+	audio::algo::drain::Equalizer algo;
+	algo.init(sampleRate, 1, audio::format_float);
+	algo.addBiquad(-1, audio::algo::drain::biQuadType_peak, 1000.0, 1.0, -12.0, audio::algo::drain::EqualizerDynamic(-30.0, 4.0, 0.0, 0.0, 0.005, 0.1));
+	etk::Vector<float> data;
+	data.resize(sampleRate, 0.0f);
+	for (size_t iii=0; iii<data.size(); ++iii) {
+		data[iii] = 0.5f * sin(2.0*M_PI*1000.0*double(iii)/sampleRate);
+	}
+	algo.process(&data[0], &data[0], data.size());
+	float peak = 0.0f;
+	for (size_t iii=data.size()/2; iii<data.size(); ++iii) {
+		peak = etk::max(peak, float(fabs(data[iii])));
+	}
+	TEST_PRINT("dynamic equalizer 1kHz -6dB: band gain=" << algo.getDynamicGain(0, 0) << "dB output=" << 20.0*log10(peak) << "dB (expected -18dB)");
+}
+
+void testLoudnessMeter() {
+	float sampleRate = 48000;
+	// EBU Tech 3341 case 1: stereo 1 kHz sine at -23 dBFS ==> -23 LUFS
+	audio::algo::drain::LoudnessMeter meter;
+	meter.init(sampleRate, 2, audio::format_float);
+	etk::Vector<float> data;
+	data.resize(sampleRate*20*2, 0.0f);
+	float amplitude = pow(10.0, -23.0/20.0);
+	for (size_t iii=0; iii<data.size()/2; ++iii) {
+		data[iii*2] = amplitude * sin(2.0*M_PI*1000.0*double(iii)/sampleRate);
+		data[iii*2+1] = data[iii*2];
+	}
+	meter.process(&data[0], data.size()/2);
+	TEST_PRINT("loudness 1kHz -23dBFS: momentary=" << meter.getMomentary() << " short-term=" << meter.getShortTerm()
+	           << " integrated=" << meter.getIntegrated() << " LUFS (expected -23)");
+	// sine at fs/4 with a phase of 45 degree: sample peak -3 dB, true peak 0 dB
+	meter.reset();
+	float samplePeak = 0.0f;
+	for (size_t iii=0; iii<data.size()/2; ++iii) {
+		data[iii*2] = sin(2.0*M_PI*double(iii)/4.0 + M_PI/4.0);
+		data[iii*2+1] = 0.5f * data[iii*2];
+		samplePeak = etk::max(samplePeak, float(fabs(data[iii*2])));
+	}
+	meter.process(&data[0], data.size()/2);
+	TEST_PRINT("true peak 12kHz 0dBFS: sample peak=" << 20.0*log10(samplePeak) << "dB true peak=" << meter.getTruePeak() << "dBTP channel 1=" << meter.getTruePeak(1) << "dBTP (expected 0 and -6)");
+}
+
+void performanceLoudnessMeter(int32_t _nbChannel) {
+	float sampleRate = 48000;
+	int32_t blockSize = 1024;
+	audio::algo::drain::LoudnessMeter meter;
+	meter.init(sampleRate, _nbChannel, audio::format_float);
+	etk::Vector<float> input;
+	input.resize(blockSize*_nbChannel, 0.0f);
+	uint32_t seed = 12345;
+	for (size_t iii=0; iii<input.size(); ++iii) {
+		seed = seed*1664525 + 1013904223;
+		input[iii] = (float(seed>>8)/float(1<<24) - 0.5f) * 0.2f;
+	}
+	int32_t nbBlock = int32_t(sampleRate*60/blockSize);
+	Performance perfo;
+	perfo.tic();
+	for (int32_t iii=0; iii<nbBlock; ++iii) {
+		meter.process(&input[0], blockSize);
+	}
+	perfo.toc();
+	double duration = double(nbBlock)*double(blockSize)/sampleRate;
+	TEST_PRINT("loudness meter channel=" << _nbChannel << ": x" << int32_t(duration/perfo.getTotalTimeProcessing().toSeconds()) << " realtime ("
+	           << perfo.getTotalTimeProcessing().toSeconds()*1000000000.0/(double(nbBlock)*blockSize*_nbChannel) << "ns/sample) integrated=" << meter.getIntegrated() << " LUFS");
+}
+
+/**
+ * @brief Resample a sine and compare it to the same sine generated at the output rate (the output timeline is aligned on the input).
+ * @return Error (dB relative to the sine).
+ */
+float testResamplerRatio(float _sampleRateIn, float _sampleRateOut, float _frequency, int32_t _quality) {
+	audio::algo::drain::Resampler algo;
+	algo.init(_sampleRateIn, _sampleRateOut, 1, audio::format_float, _quality);
+	etk::Vector<float> input;
+	input.resize(size_t(_sampleRateIn), 0.0f);
+	for (size_t iii=0; iii<input.size(); ++iii) {
+		input[iii] = 0.5 * sin(2.0*M_PI*_frequency*double(iii)/_sampleRateIn);
+	}
+	etk::Vector<float> output;
+	output.resize(algo.getMaxOutputSize(input.size()), 0.0f);
+	// process by random size block
+	size_t nbOutput = 0;
+	uint32_t seed = 12345;
+	for (size_t iii=0; iii<input.size();) {
+		seed = seed*1664525 + 1013904223;
+		size_t nbChunk = etk::min(size_t(seed>>22) + 1, input.size()-iii);
+		nbOutput += algo.process(&output[nbOutput], &input[iii], nbChunk);
+		iii += nbChunk;
+	}
+	// the sine is not band limited at its start: skip the filter length
+	double errorPower = 0.0;
+	int32_t nbError = 0;
+	for (size_t iii=algo.getLatency()*2; iii<nbOutput; ++iii) {
+		double delta = output[iii] - 0.5 * sin(2.0*M_PI*_frequency*double(iii)/_sampleRateOut);
+		errorPower += delta*delta;
+		nbError++;
+	}
+	float error = 10.0*log10(errorPower / etk::max(nbError, int32_t(1)) / 0.125 + 1e-30);
+	TEST_PRINT("resampler " << _sampleRateIn << " ==> " << _sampleRateOut << "Hz quality=" << _quality << " tap=" << algo.getNbTap()
+	           << (algo.isRational() == true ? " exact" : " interpolated") << " latency=" << algo.getLatency()
+	           << ": sine " << _frequency << "Hz error=" << error << "dB");
+	return error;
+}
+
+void testResampler() {
+	testResamplerRatio(44100, 48000, 1000, 4);
+	testResamplerRatio(48000, 44100, 1000, 4);
+	testResamplerRatio(48000, 96000, 15000, 4);
+	testResamplerRatio(48000, 16000, 5000, 4);
+	testResamplerRatio(44100, 47999.5, 1000, 4);
+	testResamplerRatio(44100, 48000, 1000, 10);
+	testResamplerRatio(44100, 47999.5, 1000, 10);
+	// a frequency over the output Nyquist frequency must be removed
+	audio::algo::drain::Resampler algo;
+	algo.init(48000, 16000, 1, audio::format_float, 4);
+	etk::Vector<float> input;
+	input.resize(48000, 0.0f);
+	for (size_t iii=0; iii<input.size(); ++iii) {
+		input[iii] = sin(2.0*M_PI*10000.0*double(iii)/48000.0);
+	}
+	etk::Vector<float> output;
+	output.resize(algo.getMaxOutputSize(input.size()), 0.0f);
+	size_t nbOutput = algo.process(&output[0], &input[0], input.size());
+	float peak = 0.0f;
+	for (size_t iii=algo.getLatency()*2; iii<nbOutput; ++iii) {
+		peak = etk::max(peak, float(fabs(output[iii])));
+	}
+	TEST_PRINT("resampler 48000 ==> 16000Hz: sine 10kHz 0dB (aliasing) output=" << 20.0*log10(peak + 1e-30) << "dB");
+}
+
+void performanceResampler(int32_t _nbChannel, float _sampleRateIn, float _sampleRateOut, int32_t _quality, bool _planar=false) {
+	int32_t blockSize = 480;
+	audio::algo::drain::Resampler algo;
+	algo.init(_sampleRateIn, _sampleRateOut, _nbChannel, audio::format_float, _quality);
+	etk::Vector<float> input;
+	input.resize(blockSize*_nbChannel, 0.0f);
+	uint32_t seed = 12345;
+	for (size_t iii=0; iii<input.size(); ++iii) {
+		seed = seed*1664525 + 1013904223;
+		input[iii] = float(seed>>8)/float(1<<24) - 0.5f;
+	}
+	size_t outputSize = algo.getMaxOutputSize(blockSize);
+	etk::Vector<float> output;
+	output.resize(outputSize*_nbChannel, 0.0f);
+	etk::Vector<const float*> inputPlanar;
+	etk::Vector<float*> outputPlanar;
+	for (int32_t ccc=0; ccc<_nbChannel; ++ccc) {
+		inputPlanar.pushBack(&input[ccc*blockSize]);
+		outputPlanar.pushBack(&output[ccc*outputSize]);
+	}
+	int32_t nbBlock = int32_t(_sampleRateIn*10/blockSize);
+	size_t nbOutput = 0;
+	Performance perfo;
+	perfo.tic();
+	for (int32_t iii=0; iii<nbBlock; ++iii) {
+		if (_planar == true) {
+			nbOutput += algo.processPlanar(&outputPlanar[0], &inputPlanar[0], blockSize);
+		} else {
+			nbOutput += algo.process(&output[0], &input[0], blockSize);
+		}
+	}
+	perfo.toc();
+	double duration = double(nbBlock)*double(blockSize)/_sampleRateIn;
+	TEST_PRINT("resampler " << _sampleRateIn << " ==> " << _sampleRateOut << "Hz channel=" << _nbChannel << (_planar == true ? " planar" : " interleaved")
+	           << " quality=" << _quality << " tap=" << algo.getNbTap() << ": x" << int32_t(duration/perfo.getTotalTimeProcessing().toSeconds()) << " realtime ("
+	           << perfo.getTotalTimeProcessing().toSeconds()*1000000000.0/(double(nbOutput)*_nbChannel) << "ns/output sample)");
+}
+
+void testSpectrumAnalyzer() {
+	float sampleRate = 48000;
+	// sine at -6 dB on the center of a bin (no scalloping loss of the window) ==> -6 dB at 1.5 kHz
+	audio::algo::drain::SpectrumAnalyzer analyzer;
+	analyzer.init(sampleRate, 1, audio::format_float, 4096, 1024);
+	etk::Vector<float> data;
+	data.resize(sampleRate*2, 0.0f);
+	for (size_t iii=0; iii<data.size(); ++iii) {
+		data[iii] = 0.5 * sin(2.0*M_PI*1500.0*double(iii)/sampleRate);
+	}
+	analyzer.process(&data[0], data.size());
+	etk::Vector<etk::Pair<float,float> > spectrum = analyzer.getSpectrum();
+	etk::Pair<float,float> peak(0.0f, -1000.0f);
+	for (size_t iii=0; iii<spectrum.size(); ++iii) {
+		if (spectrum[iii].second > peak.second) {
+			peak = spectrum[iii];
+		}
+	}
+	TEST_PRINT("spectrum analyzer sine 1.5kHz -6dB: maximum=" << peak.second << "dB at " << peak.first << "Hz (expected -6dB at 1.5kHz)");
+	// white noise throw an equalizer, measured on the grid of the theory curve
+	audio::algo::drain::Equalizer algo;
+	algo.init(sampleRate, 1, audio::format_float);
+	algo.addBiquad(audio::algo::drain::biQuadType_lowShelf, 200.0, 0.707, -6.0);
+	algo.addBiquad(audio::algo::drain::biQuadType_peak, 2000.0, 1.0, 9.0);
+	algo.addBiquad(audio::algo::drain::biQuadType_highShelf, 10000.0, 0.707, -3.0);
+	etk::Vector<etk::Pair<float,float> > theory = algo.calculateTheory();
+	etk::Vector<float> grid;
+	for (size_t iii=0; iii<theory.size(); ++iii) {
+		grid.pushBack(theory[iii].first);
+	}
+	analyzer.setGrid(grid);
+	analyzer.setAveraging(5.0f);
+	analyzer.reset();
+	data.resize(sampleRate*60, 0.0f);
+	uint32_t seed = 12345;
+	for (size_t iii=0; iii<data.size(); ++iii) {
+		seed = seed*1664525 + 1013904223;
+		data[iii] = (float(seed>>8)/float(1<<24) - 0.5f) * 0.1f;
+	}
+	algo.process(&data[0], &data[0], data.size());
+	analyzer.process(&data[0], data.size());
+	spectrum = analyzer.getSpectrum();
+	// the level of the noise is unknown: compare the shape (remove the mean offset)
+	double offset = 0.0;
+	int32_t count = 0;
+	for (size_t iii=0; iii<spectrum.size(); ++iii) {
+		if (    spectrum[iii].first >= 100.0f
+		     && spectrum[iii].first <= 20000.0f) {
+			offset += spectrum[iii].second - theory[iii].second;
+			count++;
+		}
+	}
+	offset /= etk::max(count, int32_t(1));
+	double error = 0.0;
+	for (size_t iii=0; iii<spectrum.size(); ++iii) {
+		if (    spectrum[iii].first >= 100.0f
+		     && spectrum[iii].first <= 20000.0f) {
+			double delta = spectrum[iii].second - theory[iii].second - offset;
+			error += delta*delta;
+		}
+	}
+	TEST_PRINT("spectrum analyzer noise throw equalizer: " << count << " points, RMS distance to the theory=" << sqrt(error/etk::max(count, int32_t(1))) << "dB");
+}
+
+void performanceSpectrumAnalyzer(int32_t _nbChannel, int32_t _fftSize, int32_t _hopSize) {
+	float sampleRate = 48000;
+	int32_t blockSize = 256;
+	audio::algo::drain::SpectrumAnalyzer analyzer;
+	analyzer.init(sampleRate, _nbChannel, audio::format_float, _fftSize, _hopSize);
+	etk::Vector<float> input;
+	input.resize(blockSize*_nbChannel, 0.0f);
+	uint32_t seed = 12345;
+	for (size_t iii=0; iii<input.size(); ++iii) {
+		seed = seed*1664525 + 1013904223;
+		input[iii] = float(seed>>8)/float(1<<24) - 0.5f;
+	}
+	// a display thread read the spectrum each milli-second: the audio thread must never wait it
+	ethread::Mutex mutex;
+	bool stop = false;
+	int64_t nbRead = 0;
+	ethread::Thread reader([&]() {
+	                           while (true) {
+	                               {
+	                                   ethread::UniqueLock lock(mutex);
+	                                   if (stop == true) {
+	                                       return;
+	                                   }
+	                               }
+	                               etk::Vector<etk::Pair<float,float> > spectrum = analyzer.getSpectrum();
+	                               nbRead++;
+	                               ethread::sleepMilliSeconds(1);
+	                           }
+	                       },
+	                       "reader");
+	int32_t nbBlock = int32_t(sampleRate*30/blockSize);
+	Performance perfo;
+	for (int32_t iii=0; iii<nbBlock; ++iii) {
+		perfo.tic();
+		analyzer.process(&input[0], blockSize);
+		perfo.toc();
+	}
+	{
+		ethread::UniqueLock lock(mutex);
+		stop = true;
+	}
+	reader.join();
+	double duration = double(nbBlock)*double(blockSize)/sampleRate;
+	int64_t nbFrame = int64_t(duration*sampleRate/_hopSize);
+	TEST_PRINT("spectrum analyzer channel=" << _nbChannel << " fft=" << _fftSize << " hop=" << _hopSize << ": x" << int32_t(duration/perfo.getTotalTimeProcessing().toSeconds()) << " realtime"
+	           << " block max=" << perfo.getMaxProcessing() << " published " << analyzer.getNbFrame() << "/" << nbFrame << " frames, " << nbRead << " reads");
+}
+
+/**
+ * @brief Reference of the channel mixer: dense matrix on each chunk.
+ */
+static void channelMixerReference(float* _output, const float* _input, size_t _nbChunk, const etk::Vector<float>& _gain, int32_t _nbChannelIn, int32_t _nbChannelOut) {
+	for (size_t iii=0; iii<_nbChunk; ++iii) {
+		for (int32_t ooo=0; ooo<_nbChannelOut; ++ooo) {
+			float value = 0.0f;
+			for (int32_t jjj=0; jjj<_nbChannelIn; ++jjj) {
+				value += _gain[ooo*_nbChannelIn + jjj] * _input[iii*_nbChannelIn + jjj];
+			}
+			_output[iii*_nbChannelOut + ooo] = value;
+		}
+	}
+}
+
+void testChannelMixer() {
+	float sampleRate = 48000;
+	int32_t nbChunk = 1000;
+	etk::Vector<float> input;
+	input.resize(nbChunk*8, 0.0f);
+	uint32_t seed = 12345;
+	for (size_t iii=0; iii<input.size(); ++iii) {
+		seed = seed*1664525 + 1013904223;
+		input[iii] = float(seed>>8)/float(1<<24) - 0.5f;
+	}
+	etk::Vector<float> output;
+	output.resize(nbChunk*8, 0.0f);
+	etk::Vector<float> reference;
+	reference.resize(nbChunk*8, 0.0f);
+	// standard layouts, a permutation, a selection and a sparse matrix
+	int32_t listIn[] = {2, 6, 8, 8, 2, 6, 4, 8};
+	int32_t listOut[] = {2, 2, 2, 6, 6, 1, 4, 2};
+	const char* listName[] = {"stereo", "5.1 ==> stereo", "7.1 ==> stereo", "7.1 ==> 5.1", "stereo ==> 5.1", "5.1 ==> mono", "permutation 4", "selection 8 ==> 2"};
+	for (size_t ttt=0; ttt<sizeof(listIn)/sizeof(int32_t); ++ttt) {
+		audio::algo::drain::ChannelMixer mixer;
+		mixer.init(sampleRate, listIn[ttt], listOut[ttt], audio::format_float);
+		etk::Vector<float> gain = mixer.getMatrix();
+		if (ttt == 6) {
+			for (size_t iii=0; iii<gain.size(); ++iii) {
+				gain[iii] = 0.0f;
+			}
+			gain[0*4+2] = 1.0f;
+			gain[1*4+0] = 1.0f;
+			gain[2*4+3] = -1.0f;
+			gain[3*4+1] = 0.5f;
+			mixer.setMatrix(gain);
+		} else if (ttt == 7) {
+			for (size_t iii=0; iii<gain.size(); ++iii) {
+				gain[iii] = 0.0f;
+			}
+			gain[0*8+5] = 1.0f;
+			gain[1*8+6] = 1.0f;
+			mixer.setMatrix(gain);
+		}
+		channelMixerReference(&reference[0], &input[0], nbChunk, gain, listIn[ttt], listOut[ttt]);
+		// in place when the output is smaller
+		etk::Vector<float> data = input;
+		float* out = listOut[ttt] <= listIn[ttt] ? &data[0] : &output[0];
+		mixer.process(out, &data[0], nbChunk);
+		float error = 0.0f;
+		for (int32_t iii=0; iii<nbChunk*listOut[ttt]; ++iii) {
+			error = etk::max(error, float(fabs(out[iii] - reference[iii])));
+		}
+		TEST_PRINT("channel mixer " << listName[ttt] << ": kernel=" << int32_t(mixer.getKernel()) << " max error=" << error);
+	}
+	// ramp of the matrix: a constant input give a linear output (no step)
+	audio::algo::drain::ChannelMixer mixer;
+	mixer.init(sampleRate, 2, 2, audio::format_float);
+	etk::Vector<float> gain = mixer.getMatrix();
+	gain[0] = 0.0f;
+	gain[1] = 1.0f;
+	gain[2] = 1.0f;
+	gain[3] = 0.0f;
+	mixer.setMatrix(gain, 0.01f);
+	etk::Vector<float> constant;
+	constant.resize(2*1000, 0.0f);
+	for (size_t iii=0; iii<constant.size()/2; ++iii) {
+		constant[iii*2] = 1.0f;
+		constant[iii*2+1] = -1.0f;
+	}
+	float maxStep = 0.0f;
+	float previous = 1.0f;
+	for (size_t iii=0; iii<constant.size()/2; iii+=100) {
+		mixer.process(&output[0], &constant[iii*2], 100);
+		for (size_t jjj=0; jjj<100; ++jjj) {
+			maxStep = etk::max(maxStep, float(fabs(output[jjj*2] - previous)));
+			previous = output[jjj*2];
+		}
+	}
+	TEST_PRINT("channel mixer swap ramp 10ms: left " << constant[0] << " ==> " << previous << " max step=" << maxStep << " (expected 2/480) kernel after=" << int32_t(mixer.getKernel()));
+}
+
+/**
+ * @param[in] _matrix "standard", "permutation" (reverse order) or "dense" (all the gains are set).
+ */
+void performanceChannelMixer(int32_t _nbChannelIn, int32_t _nbChannelOut, const etk::String& _matrix) {
+	float sampleRate = 48000;
+	int32_t blockSize = 256;
+	audio::algo::drain::ChannelMixer mixer;
+	mixer.init(sampleRate, _nbChannelIn, _nbChannelOut, audio::format_float);
+	etk::Vector<float> gain = mixer.getMatrix();
+	if (_matrix == "permutation") {
+		for (size_t iii=0; iii<gain.size(); ++iii) {
+			gain[iii] = 0.0f;
+		}
+		for (int32_t ooo=0; ooo<_nbChannelOut; ++ooo) {
+			gain[ooo*_nbChannelIn + (_nbChannelIn-1-ooo%_nbChannelIn)] = 1.0f;
+		}
+		mixer.setMatrix(gain);
+	} else if (_matrix == "dense") {
+		for (size_t iii=0; iii<gain.size(); ++iii) {
+			gain[iii] = 1.0f / (1.0f + iii%7);
+		}
+		mixer.setMatrix(gain);
+	}
+	etk::Vector<float> input;
+	input.resize(blockSize*_nbChannelIn, 0.1f);
+	etk::Vector<float> output;
+	output.resize(blockSize*_nbChannelOut, 0.0f);
+	int32_t nbBlock = int32_t(sampleRate*60/blockSize);
+	Performance perfoMixer;
+	Performance perfoReference;
+	perfoMixer.tic();
+	for (int32_t iii=0; iii<nbBlock; ++iii) {
+		mixer.process(&output[0], &input[0], blockSize);
+	}
+	perfoMixer.toc();
+	perfoReference.tic();
+	for (int32_t iii=0; iii<nbBlock; ++iii) {
+		channelMixerReference(&output[0], &input[0], blockSize, gain, _nbChannelIn, _nbChannelOut);
+	}
+	perfoReference.toc();
+	double duration = double(nbBlock)*double(blockSize)/sampleRate;
+	TEST_PRINT("channel mixer " << _nbChannelIn << " ==> " << _nbChannelOut << " " << _matrix << " kernel=" << int32_t(mixer.getKernel())
+	           << ": x" << int32_t(duration/perfoMixer.getTotalTimeProcessing().toSeconds()) << " realtime, dense loop x"
+	           << int32_t(duration/perfoReference.getTotalTimeProcessing().toSeconds()) << " realtime");
+}
+
+/**
+ * @brief Level of a signal at one frequency (discrete Fourier transform of an impulse response).
+ * @param[in] _data Impulse response.
+ * @param[in] _nbSample Number of sample.
+ * @param[in] _stride Distance between two samples.
+ * @param[in] _frequency Frequency (Hz).
+ * @param[in] _sampleRate Sample rate.
+ * @return Level in dB.
+ */
+static double impulseLevel(const float* _data, int32_t _nbSample, int32_t _stride, double _frequency, double _sampleRate) {
+	double real = 0.0;
+	double imag = 0.0;
+	for (int32_t iii=0; iii<_nbSample; ++iii) {
+		double angle = 2.0 * M_PI * _frequency * iii / _sampleRate;
+		real += _data[iii*_stride] * cos(angle);
+		imag -= _data[iii*_stride] * sin(angle);
+	}
+	return 10.0*log10(real*real + imag*imag + 1.0e-30);
+}
+
+void testCrossover() {
+	float sampleRate = 48000;
+	int32_t nbSample = 16384;
+	etk::Vector<float> frequency;
+	frequency.pushBack(120.0f);
+	frequency.pushBack(1000.0f);
+	frequency.pushBack(6000.0f);
+	int32_t listOrder[] = {2, 4, 8};
+	for (size_t ooo=0; ooo<sizeof(listOrder)/sizeof(int32_t); ++ooo) {
+		audio::algo::drain::Crossover crossover;
+		crossover.init(sampleRate, 2, audio::format_float);
+		crossover.setCrossover(frequency, listOrder[ooo]);
+		int32_t nbBand = crossover.getNbBand();
+		int32_t nbChannelOut = crossover.getOutputNbChannel();
+		// impulse on the left, inverted impulse on the right
+		etk::Vector<float> input;
+		input.resize(nbSample*2, 0.0f);
+		input[0] = 1.0f;
+		input[1] = -1.0f;
+		etk::Vector<float> output;
+		output.resize(nbSample*nbChannelOut, 0.0f);
+		for (int32_t iii=0; iii<nbSample; iii+=1000) {
+			int32_t nbChunk = etk::min(1000, nbSample-iii);
+			crossover.process(&output[iii*nbChannelOut], &input[iii*2], nbChunk);
+		}
+		// sum of the bands of each channel: flat magnitude
+		etk::Vector<float> sum;
+		sum.resize(nbSample*2, 0.0f);
+		for (int32_t iii=0; iii<nbSample; ++iii) {
+			for (int32_t bbb=0; bbb<nbBand; ++bbb) {
+				sum[iii*2] += output[iii*nbChannelOut + bbb*2];
+				sum[iii*2+1] += output[iii*nbChannelOut + bbb*2 + 1];
+			}
+		}
+		double errorSum = 0.0;
+		double errorChannel = 0.0;
+		for (double freq=20.0; freq<20000.0; freq*=1.1) {
+			errorSum = etk::max(errorSum, fabs(impulseLevel(&sum[0], nbSample, 2, freq, sampleRate)));
+		}
+		for (size_t iii=0; iii<sum.size(); iii+=2) {
+			errorChannel = etk::max(errorChannel, double(fabs(sum[iii] + sum[iii+1])));
+		}
+		// the two bands of a split are at -6 dB on the crossover frequency
+		double errorCross = 0.0;
+		for (size_t sss=0; sss<frequency.size(); ++sss) {
+			errorCross = etk::max(errorCross, fabs(impulseLevel(&output[sss*2], nbSample, nbChannelOut, frequency[sss], sampleRate) + 6.0206));
+			errorCross = etk::max(errorCross, fabs(impulseLevel(&output[(sss+1)*2], nbSample, nbChannelOut, frequency[sss], sampleRate) + 6.0206));
+		}
+		// out of band attenuation of the low band one decade over its crossover
+		double attenuation = impulseLevel(&output[0], nbSample, nbChannelOut, frequency[0]*10.0, sampleRate);
+		// planar process give the same result
+		crossover.reset();
+		etk::Vector<float> inputLeft;
+		inputLeft.resize(nbSample, 0.0f);
+		inputLeft[0] = 1.0f;
+		etk::Vector<float> inputRight;
+		inputRight.resize(nbSample, 0.0f);
+		inputRight[0] = -1.0f;
+		const float* inputPlanar[2] = {&inputLeft[0], &inputRight[0]};
+		etk::Vector<float> outputPlanar;
+		outputPlanar.resize(nbSample*nbChannelOut, 0.0f);
+		etk::Vector<float*> pointer;
+		for (int32_t ccc=0; ccc<nbChannelOut; ++ccc) {
+			pointer.pushBack(&outputPlanar[ccc*nbSample]);
+		}
+		crossover.processPlanar(&pointer[0], inputPlanar, nbSample);
+		float errorPlanar = 0.0f;
+		for (int32_t iii=0; iii<nbSample; ++iii) {
+			for (int32_t ccc=0; ccc<nbChannelOut; ++ccc) {
+				errorPlanar = etk::max(errorPlanar, float(fabs(outputPlanar[ccc*nbSample + iii] - output[iii*nbChannelOut + ccc])));
+			}
+		}
+		TEST_PRINT("crossover LR" << listOrder[ooo] << " " << nbBand << " bands: sum max deviation=" << errorSum << " dB, crossover level error=" << errorCross
+		           << " dB, low band at 10xfc=" << attenuation << " dB, channel error=" << errorChannel << ", planar error=" << errorPlanar);
+	}
+}
+
+/**
+ * @brief Create the cascade of one band of a crossover in an equalizer (without phase compensation).
+ * @param[in,out] _equalizer Equalizer to configure.
+ * @param[in] _frequency Crossover frequencies.
+ * @param[in] _idBand Id of the band.
+ * @param[in] _order Order of the Linkwitz-Riley filters (4 or 8).
+ */
+static void crossoverReferenceBand(audio::algo::drain::Equalizer& _equalizer, const etk::Vector<float>& _frequency, int32_t _idBand, int32_t _order) {
+	double listQuality[] = {M_SQRT1_2, M_SQRT1_2, 0.54119610, 1.30656296, 0.54119610, 1.30656296};
+	int32_t start = _order == 4 ? 0 : 2;
+	for (int32_t sss=0; sss<int32_t(_frequency.size()); ++sss) {
+		if (sss > _idBand) {
+			break;
+		}
+		enum audio::algo::drain::biQuadType type = sss == _idBand ? audio::algo::drain::biQuadType_lowPass : audio::algo::drain::biQuadType_highPass;
+		for (int32_t kkk=0; kkk<_order/2; ++kkk) {
+			_equalizer.addBiquad(type, _frequency[sss], listQuality[start+kkk], 0);
+		}
+	}
+}
+
+void performanceCrossover(int32_t _nbChannel, int32_t _nbBand, int32_t _order) {
+	float sampleRate = 48000;
+	int32_t blockSize = 256;
+	etk::Vector<float> frequency;
+	for (int32_t bbb=1; bbb<_nbBand; ++bbb) {
+		frequency.pushBack(100.0f * pow(80.0f, float(bbb-1)/etk::max(1, _nbBand-2)));
+	}
+	audio::algo::drain::Crossover crossover;
+	crossover.init(sampleRate, _nbChannel, audio::format_float);
+	crossover.setCrossover(frequency, _order);
+	// reference: one equalizer by band, each one read the input
+	etk::Vector<ememory::SharedPtr<audio::algo::drain::Equalizer> > listEqualizer;
+	for (int32_t bbb=0; bbb<_nbBand; ++bbb) {
+		ememory::SharedPtr<audio::algo::drain::Equalizer> equalizer = ememory::makeShared<audio::algo::drain::Equalizer>();
+		equalizer->init(sampleRate, _nbChannel, audio::format_float);
+		crossoverReferenceBand(*equalizer, frequency, bbb, _order);
+		listEqualizer.pushBack(equalizer);
+	}
+	etk::Vector<float> input;
+	input.resize(blockSize*_nbChannel, 0.0f);
+	uint32_t seed = 12345;
+	for (size_t iii=0; iii<input.size(); ++iii) {
+		seed = seed*1664525 + 1013904223;
+		input[iii] = float(seed>>8)/float(1<<24) - 0.5f;
+	}
+	etk::Vector<float> output;
+	output.resize(blockSize*_nbChannel*_nbBand, 0.0f);
+	int32_t nbBlock = int32_t(sampleRate*60/blockSize);
+	Performance perfoCrossover;
+	Performance perfoReference;
+	perfoCrossover.tic();
+	for (int32_t iii=0; iii<nbBlock; ++iii) {
+		crossover.process(&output[0], &input[0], blockSize);
+	}
+	perfoCrossover.toc();
+	perfoReference.tic();
+	for (int32_t iii=0; iii<nbBlock; ++iii) {
+		for (int32_t bbb=0; bbb<_nbBand; ++bbb) {
+			listEqualizer[bbb]->process(&output[bbb*blockSize*_nbChannel], &input[0], blockSize);
+		}
+	}
+	perfoReference.toc();
+	double duration = double(nbBlock)*double(blockSize)/sampleRate;
+	TEST_PRINT("crossover LR" << _order << " " << _nbChannel << " channel(s) " << _nbBand << " bands: x"
+	           << int32_t(duration/perfoCrossover.getTotalTimeProcessing().toSeconds()) << " realtime, one equalizer by band x"
+	           << int32_t(duration/perfoReference.getTotalTimeProcessing().toSeconds()) << " realtime");
+}
+
+/**
+ * @brief Weighted RMS difference between a response and a target on the same frequencies (dB, points over 0.49 x sampleRate are ignored).
+ */
+static double equalizerFitError(const etk::Vector<etk::Pair<float,float> >& _response, const etk::Vector<etk::Pair<float,float> >& _target, float _sampleRate) {
+	double sum = 0.0;
+	int32_t nbPoint = 0;
+	for (size_t iii=0; iii<_target.size(); ++iii) {
+		if (    _target[iii].first <= 0.0f
+		     || _target[iii].first >= _sampleRate*0.49f) {
+			continue;
+		}
+		double delta = _response[iii].second - _target[iii].second;
+		sum += delta*delta;
+		nbPoint++;
+	}
+	return sqrt(sum / etk::max(1, nbPoint));
+}
+
+/**
+ * @brief Smooth correction curve (bass boost, presence bump, treble dip and a ripple) on a logarithmic grid.
+ */
+static etk::Vector<etk::Pair<float,float> > equalizerFitHeadphoneTarget() {
+	etk::Vector<float> grid = audio::algo::drain::SpectrumAnalyzer::createLogGrid(20.0f, 20000.0f, 256);
+	etk::Vector<etk::Pair<float,float> > out;
+	for (size_t iii=0; iii<grid.size(); ++iii) {
+		double octave = log2(grid[iii]/20.0);
+		double value = 6.0 / (1.0 + pow(grid[iii]/120.0, 2.0))
+		             + 4.0 * exp(-pow(log2(grid[iii]/3000.0)/0.5, 2.0))
+		             - 5.0 * exp(-pow(log2(grid[iii]/8000.0)/0.3, 2.0))
+		             + 1.5 * sin(3.0 * octave);
+		out.pushBack(etk::makePair(grid[iii], float(value)));
+	}
+	return out;
+}
+
+void testEqualizerFit() {
+	float sampleRate = 48000;
+	// the response of known bands is found again
+	audio::algo::drain::Equalizer reference;
+	reference.init(sampleRate, 1, audio::format_float);
+	reference.addBiquad(audio::algo::drain::biQuadType_lowShelf, 100, 0.707, 4);
+	reference.addBiquad(audio::algo::drain::biQuadType_highShelf, 8000, 0.707, -3);
+	reference.addBiquad(audio::algo::drain::biQuadType_peak, 250, 1.5, -6);
+	reference.addBiquad(audio::algo::drain::biQuadType_peak, 1200, 3.0, 5);
+	reference.addBiquad(audio::algo::drain::biQuadType_peak, 3500, 2.0, -4);
+	reference.addBiquad(audio::algo::drain::biQuadType_peak, 6000, 4.0, 3);
+	etk::Vector<etk::Pair<float,float> > target = reference.calculateTheory();
+	audio::algo::drain::EqualizerFit fit;
+	fit.init(sampleRate);
+	fit.setTarget(target);
+	fit.setBands(4, true, true);
+	audio::algo::drain::EqualizerPreset preset = fit.fit();
+	// the preset is loaded in an equalizer: its response has the error of the fit
+	audio::algo::drain::Equalizer equalizer;
+	equalizer.init(sampleRate, 1, audio::format_float);
+	preset.apply(equalizer, sampleRate);
+	double error = equalizerFitError(equalizer.calculateTheory(), target, sampleRate);
+	TEST_PRINT("equalizer fit of 6 known bands: error=" << fit.getError() << " dB, error of the loaded preset=" << error << " dB, " << fit.getNbIteration() << " iterations");
+	etk::String text = preset.toText();
+	TEST_PRINT("equalizer fit preset:\n" << text);
+	// smooth correction curve
+	target = equalizerFitHeadphoneTarget();
+	int32_t listNbPeak[] = {4, 8, 16};
+	for (size_t iii=0; iii<sizeof(listNbPeak)/sizeof(int32_t); ++iii) {
+		fit.setTarget(target);
+		fit.setBands(listNbPeak[iii], true, true);
+		preset = fit.fit();
+		// response of the loaded preset measured on its impulse response
+		equalizer.init(sampleRate, 1, audio::format_float);
+		preset.apply(equalizer, sampleRate);
+		etk::Vector<float> impulse;
+		impulse.resize(65536, 0.0f);
+		impulse[0] = 1.0f;
+		equalizer.process(&impulse[0], &impulse[0], impulse.size());
+		etk::Vector<etk::Pair<float,float> > response;
+		for (size_t jjj=0; jjj<target.size(); ++jjj) {
+			response.pushBack(etk::makePair(target[jjj].first, float(impulseLevel(&impulse[0], impulse.size(), 1, target[jjj].first, sampleRate))));
+		}
+		TEST_PRINT("equalizer fit of a correction curve with " << listNbPeak[iii] + 2 << " bands: error=" << fit.getError() << " dB, "
+		           << fit.getNbIteration() << " iterations, error of the loaded preset=" << equalizerFitError(response, target, sampleRate) << " dB");
+	}
+}
+
+void performanceEqualizerFit(int32_t _nbBand, int32_t _nbThread) {
+	float sampleRate = 48000;
+	etk::Vector<etk::Pair<float,float> > target = equalizerFitHeadphoneTarget();
+	audio::algo::drain::EqualizerFit fit;
+	fit.init(sampleRate);
+	fit.setTarget(target);
+	fit.setBands(_nbBand-2, true, true);
+	if (_nbThread > 0) {
+		fit.setNbThread(_nbThread);
+	}
+	Performance perfo;
+	for (int32_t iii=0; iii<5; ++iii) {
+		perfo.tic();
+		fit.fit();
+		perfo.toc();
+	}
+	TEST_PRINT("equalizer fit " << _nbBand << " bands " << target.size() << " points " << fit.getNbRestart() << " restarts on " << fit.getNbThread() << " thread(s): "
+	           << perfo.getMinProcessing().toSeconds()*1000.0 << " ms (error=" << fit.getError() << " dB, " << fit.getNbIteration() << " iterations)");
+}
+
+/**
+ * @brief Slider positions of the graphic equalizer tests.
+ * @param[in] _pattern Name of the pattern: "single", "alternate", "smile" or "boost".
+ * @param[in] _nbBand Number of band.
+ */
+static etk::Vector<float> graphicEqualizerPattern(const etk::String& _pattern, int32_t _nbBand) {
+	etk::Vector<float> out;
+	out.resize(_nbBand, 0.0f);
+	for (int32_t bbb=0; bbb<_nbBand; ++bbb) {
+		if (_pattern == "single") {
+			out[bbb] = bbb == _nbBand/2 ? 12.0f : 0.0f;
+		} else if (_pattern == "alternate") {
+			out[bbb] = bbb%2 == 0 ? 12.0f : -12.0f;
+		} else if (_pattern == "smile") {
+			float position = 2.0f*float(bbb)/float(_nbBand-1) - 1.0f;
+			out[bbb] = 12.0f*position*position - 4.0f;
+		} else {
+			out[bbb] = 12.0f;
+		}
+	}
+	return out;
+}
+
+/**
+ * @brief Maximum error at the center of the bands of an impulse response.
+ */
+static double graphicEqualizerError(const etk::Vector<float>& _impulse, const etk::Vector<float>& _frequency, const etk::Vector<float>& _slider, float _sampleRate) {
+	double error = 0.0;
+	for (size_t bbb=0; bbb<_frequency.size(); ++bbb) {
+		error = etk::max(error, fabs(impulseLevel(&_impulse[0], _impulse.size(), 1, _frequency[bbb], _sampleRate) - _slider[bbb]));
+	}
+	return error;
+}
+
+void testGraphicEqualizer() {
+	float sampleRate = 48000;
+	audio::algo::drain::GraphicEqualizer graphic;
+	graphic.init(sampleRate, 1, audio::format_float, 3);
+	int32_t nbBand = graphic.getNbBand();
+	etk::Vector<float> frequency;
+	for (int32_t bbb=0; bbb<nbBand; ++bbb) {
+		frequency.pushBack(graphic.getFrequency(bbb));
+	}
+	TEST_PRINT("graphic equalizer: " << nbBand << " bands from " << frequency[0] << " Hz to " << frequency[nbBand-1] << " Hz, 10 bands in octave: "
+	           << audio::algo::drain::GraphicEqualizer::createBandFrequency(1).size());
+	double spacing = pow(2.0, 1.0/3.0);
+	double qualityBase = sqrt(spacing) / (spacing - 1.0);
+	etk::String listPattern[] = {"single", "alternate", "smile", "boost"};
+	for (size_t ppp=0; ppp<sizeof(listPattern)/sizeof(etk::String); ++ppp) {
+		etk::Vector<float> slider = graphicEqualizerPattern(listPattern[ppp], nbBand);
+		// naive: the gain of each band is the level of its slider
+		audio::algo::drain::Equalizer naive;
+		naive.init(sampleRate, 1, audio::format_float);
+		for (int32_t bbb=0; bbb<nbBand; ++bbb) {
+			naive.addBiquad(audio::algo::drain::biQuadType_peak, frequency[bbb], qualityBase*sqrt(pow(10.0, fabs(slider[bbb])/20.0)), slider[bbb]);
+		}
+		etk::Vector<float> impulse;
+		impulse.resize(65536, 0.0f);
+		impulse[0] = 1.0f;
+		naive.process(&impulse[0], &impulse[0], impulse.size());
+		double errorNaive = graphicEqualizerError(impulse, frequency, slider, sampleRate);
+		// corrected bands: the response of the graphic equalizer
+		graphic.reset();
+		graphic.setGains(slider);
+		for (size_t iii=0; iii<impulse.size(); ++iii) {
+			impulse[iii] = 0.0f;
+		}
+		impulse[0] = 1.0f;
+		graphic.process(&impulse[0], &impulse[0], impulse.size());
+		double error = graphicEqualizerError(impulse, frequency, slider, sampleRate);
+		float bandGainMax = 0.0f;
+		for (int32_t bbb=0; bbb<nbBand; ++bbb) {
+			bandGainMax = etk::max(bandGainMax, float(fabs(graphic.getBandGain(bbb))));
+		}
+		TEST_PRINT("graphic equalizer '" << listPattern[ppp] << "': error at the centers=" << error << " dB (naive bands " << errorNaive
+		           << " dB), biggest band gain=" << bandGainMax << " dB");
+	}
+}
+
+void performanceGraphicEqualizer(int32_t _nbChannel, int32_t _bandPerOctave) {
+	float sampleRate = 48000;
+	int32_t blockSize = 256;
+	audio::algo::drain::GraphicEqualizer graphic;
+	graphic.init(sampleRate, _nbChannel, audio::format_float, _bandPerOctave);
+	int32_t nbBand = graphic.getNbBand();
+	// slider drag: one slider move on a smile curve
+	etk::Vector<float> slider = graphicEqualizerPattern("smile", nbBand);
+	Performance perfoUpdate;
+	for (int32_t iii=0; iii<200; ++iii) {
+		slider[nbBand/2] = -12.0f + 0.1f*iii;
+		perfoUpdate.tic();
+		graphic.setGains(slider);
+		perfoUpdate.toc();
+	}
+	etk::Vector<float> input;
+	input.resize(blockSize*_nbChannel, 0.0f);
+	uint32_t seed = 12345;
+	for (size_t iii=0; iii<input.size(); ++iii) {
+		seed = seed*1664525 + 1013904223;
+		input[iii] = float(seed>>8)/float(1<<24) - 0.5f;
+	}
+	etk::Vector<float> output;
+	output.resize(input.size(), 0.0f);
+	int32_t nbBlock = int32_t(sampleRate*60/blockSize);
+	Performance perfoProcess;
+	perfoProcess.tic();
+	for (int32_t iii=0; iii<nbBlock; ++iii) {
+		// a slider change every 10 blocks (about 50 ms)
+		if (iii%10 == 0) {
+			slider[0] = float(iii%240)/10.0f - 12.0f;
+			graphic.setGain(0, slider[0]);
+		}
+		graphic.process(&output[0], &input[0], blockSize);
+	}
+	perfoProcess.toc();
+	double duration = double(nbBlock)*double(blockSize)/sampleRate;
+	TEST_PRINT("graphic equalizer " << _nbChannel << " channel(s) " << nbBand << " bands: slider change "
+	           << perfoUpdate.getMinProcessing().toSeconds()*1000000.0 << " us, process with slider changes x"
+	           << int32_t(duration/perfoProcess.getTotalTimeProcessing().toSeconds()) << " realtime");
+}
+
+/**
+ * @brief Read only access on a complete file (mapped in memory when the OS permit it, else read in a buffer).
+ */
+class InputFile {
+	private:
+		const uint8_t* m_data;
+		size_t m_size;
+		#ifdef TEST_POSIX
+			int m_fd;
+		#endif
+		etk::Vector<uint64_t> m_buffer;
+	public:
+		InputFile() :
+		  m_data(null),
+		  m_size(0) {
+			#ifdef TEST_POSIX
+				m_fd = -1;
+			#endif
+		}
+		~InputFile() {
+			#ifdef TEST_POSIX
+				if (m_fd >= 0) {
+					munmap(const_cast<uint8_t*>(m_data), m_size);
+					close(m_fd);
+				}
+			#endif
+		}
+		bool open(const etk::String& _fileName) {
+			#ifdef TEST_POSIX
+				m_fd = ::open(_fileName.c_str(), O_RDONLY);
+				if (m_fd >= 0) {
+					struct stat info;
+					if (    fstat(m_fd, &info) == 0
+					     && info.st_size > 0) {
+						void* data = mmap(null, info.st_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+						if (data != MAP_FAILED) {
+							// the file is read once from the start to the end:
+							madvise(data, info.st_size, MADV_SEQUENTIAL);
+							m_data = reinterpret_cast<const uint8_t*>(data);
+							m_size = info.st_size;
+							return true;
+						}
+					}
+					close(m_fd);
+					m_fd = -1;
+				}
+			#endif
+			ememory::SharedPtr<etk::io::Interface> fileIO = etk::uri::get(etk::Path(_fileName));
+			if (    fileIO == null
+			     || fileIO->open(etk::io::OpenMode::Read) == false) {
+				return false;
+			}
+			m_size = fileIO->size();
+			m_buffer.resize(m_size/sizeof(uint64_t) + 1, 0);
+			fileIO->read(&m_buffer[0], 1, m_size);
+			fileIO->close();
+			m_data = reinterpret_cast<const uint8_t*>(&m_buffer[0]);
+			return true;
+		}
+		const uint8_t* getData() const {
+			return m_data;
+		}
+		size_t getSize() const {
+			return m_size;
+		}
+};
+
+/**
+ * @brief Sequential writer with a big buffer (the data are written in place in the buffer, the file receive only big writes).
+ */
+class OutputFile {
+	private:
+		ememory::SharedPtr<etk::io::Interface> m_fileIO;
+		etk::Vector<uint8_t> m_buffer;
+		size_t m_position;
+	public:
+		OutputFile(size_t _bufferSize=1024*1024) :
+		  m_position(0) {
+			m_buffer.resize(_bufferSize, 0);
+		}
+		~OutputFile() {
+			if (m_fileIO != null) {
+				flush();
+				m_fileIO->close();
+			}
+		}
+		bool open(const etk::String& _fileName) {
+			m_fileIO = etk::uri::get(etk::Path(_fileName));
+			if (    m_fileIO == null
+			     || m_fileIO->open(etk::io::OpenMode::Write) == false) {
+				m_fileIO.reset();
+				return false;
+			}
+			return true;
+		}
+		/**
+		 * @brief Get a place to write _size bytes (call commit after).
+		 */
+		uint8_t* reserve(size_t _size) {
+			if (m_position + _size > m_buffer.size()) {
+				flush();
+			}
+			if (_size > m_buffer.size()) {
+				m_buffer.resize(_size, 0);
+			}
+			return &m_buffer[m_position];
+		}
+		void commit(size_t _size) {
+			m_position += _size;
+		}
+		void write(const void* _data, size_t _size) {
+			memcpy(reserve(_size), _data, _size);
+			commit(_size);
+		}
+		void flush() {
+			if (m_position != 0) {
+				m_fileIO->write(&m_buffer[0], 1, m_position);
+				m_position = 0;
+			}
+		}
+};
+
+/**
+ * @brief Description of the samples of a WAV file (PCM 16 bits or float 32 bits).
+ */
+class WaveInfo {
+	public:
+		int32_t nbChannel;
+		int32_t sampleRate;
+		enum audio::format format;
+		size_t dataOffset;
+		size_t dataSize;
+		WaveInfo() :
+		  nbChannel(0),
+		  sampleRate(0),
+		  format(audio::format_unknow),
+		  dataOffset(0),
+		  dataSize(0) {
+			
+		}
+};
+
+static uint32_t readLittleEndian(const uint8_t* _data, int32_t _size) {
+	uint32_t out = 0;
+	for (int32_t iii=_size-1; iii>=0; --iii) {
+		out = (out << 8) | _data[iii];
+	}
+	return out;
+}
+
+static bool parseWave(WaveInfo& _info, const uint8_t* _data, size_t _size) {
+	if (    _size < 12
+	     || memcmp(_data, "RIFF", 4) != 0
+	     || memcmp(&_data[8], "WAVE", 4) != 0) {
+		return false;
+	}
+	size_t offset = 12;
+	while (offset + 8 <= _size) {
+		size_t chunkSize = readLittleEndian(&_data[offset+4], 4);
+		if (    memcmp(&_data[offset], "fmt ", 4) == 0
+		     && chunkSize >= 16
+		     && offset + 8 + 16 <= _size) {
+			const uint8_t* fmt = &_data[offset+8];
+			uint32_t audioFormat = readLittleEndian(&fmt[0], 2);
+			uint32_t nbBit = readLittleEndian(&fmt[14], 2);
+			_info.nbChannel = readLittleEndian(&fmt[2], 2);
+			_info.sampleRate = readLittleEndian(&fmt[4], 4);
+			if (    audioFormat == 1
+			     && nbBit == 16) {
+				_info.format = audio::format_int16;
+			} else if (    audioFormat == 3
+			            && nbBit == 32) {
+				_info.format = audio::format_float;
+			} else {
+				TEST_ERROR("WAV format " << audioFormat << " on " << nbBit << " bits not supported (only PCM 16 bits and float 32 bits)");
+				return false;
+			}
+		} else if (memcmp(&_data[offset], "data", 4) == 0) {
+			_info.dataOffset = offset + 8;
+			_info.dataSize = etk::min(chunkSize, _size - _info.dataOffset);
+			return _info.format != audio::format_unknow;
+		}
+		// chunks are aligned on 2 bytes
+		offset += 8 + chunkSize + (chunkSize & 1);
+	}
+	return false;
+}
+
+static void writeWaveHeader(OutputFile& _file, const WaveInfo& _info) {
+	uint32_t nbByte = audio::getFormatBytes(_info.format);
+	uint8_t header[44];
+	memcpy(&header[0], "RIFF", 4);
+	memcpy(&header[8], "WAVEfmt ", 8);
+	memcpy(&header[36], "data", 4);
+	uint32_t values[][3] = {
+		{4, 4, uint32_t(36 + _info.dataSize)},
+		{16, 4, 16},
+		{20, 2, _info.format == audio::format_float ? 3u : 1u},
+		{22, 2, uint32_t(_info.nbChannel)},
+		{24, 4, uint32_t(_info.sampleRate)},
+		{28, 4, uint32_t(_info.sampleRate*_info.nbChannel*nbByte)},
+		{32, 2, uint32_t(_info.nbChannel*nbByte)},
+		{34, 2, nbByte*8},
+		{40, 4, uint32_t(_info.dataSize)}
+	};
+	for (size_t iii=0; iii<sizeof(values)/sizeof(values[0]); ++iii) {
+		for (uint32_t jjj=0; jjj<values[iii][1]; ++jjj) {
+			header[values[iii][0]+jjj] = (values[iii][2] >> (8*jjj)) & 0xFF;
+		}
+	}
+	_file.write(header, sizeof(header));
+}
+
+// Size of a processed block: input and output stay in the L1/L2 cache.
+static const size_t processBlockSize = 32*1024;
+
+/**
+ * @brief Process a raw or WAV file with an equalizer.
+ */
+static int32_t processFileEqualizer(const etk::String& _inputName,
+                                    const etk::String& _outputName,
+                                    const etk::String& _presetName,
+                                    int32_t _sampleRate,
+                                    int32_t _nbChannel,
+                                    enum audio::format _format,
+                                    bool _perf) {
+	echrono::Steady timeStart = echrono::Steady::now();
+	InputFile input;
+	if (input.open(_inputName) == false) {
+		TEST_ERROR("Can not open input file '" << _inputName << "'");
+		return -1;
+	}
+	WaveInfo info;
+	bool wave = parseWave(info, input.getData(), input.getSize());
+	if (wave == false) {
+		info.nbChannel = _nbChannel;
+		info.sampleRate = _sampleRate;
+		info.format = _format;
+		info.dataOffset = 0;
+		info.dataSize = input.getSize();
+	}
+	size_t chunkSize = audio::getFormatBytes(info.format) * info.nbChannel;
+	if (chunkSize == 0) {
+		TEST_ERROR("Wrong input format or number of channel");
+		return -1;
+	}
+	size_t nbChunk = info.dataSize / chunkSize;
+	info.dataSize = nbChunk * chunkSize;
+	TEST_INFO("Input: " << (wave == true ? "WAV " : "raw ") << info.nbChannel << " channels " << info.sampleRate << " Hz format=" << info.format << " " << nbChunk << " chunks");
+	// equalizer configuration:
+	audio::algo::drain::EqualizerPreset preset;
+	if (_presetName != "") {
+		ememory::SharedPtr<etk::io::Interface> fileIO = etk::uri::get(etk::Path(_presetName));
+		if (    fileIO == null
+		     || fileIO->open(etk::io::OpenMode::Read) == false) {
+			TEST_ERROR("Can not open preset file '" << _presetName << "'");
+			return -1;
+		}
+		// the binary preset start with "DREQ", else it is the text form
+		char magic[4] = {0, 0, 0, 0};
+		bool binary =    fileIO->read(magic, 1, 4) == 4
+		              && memcmp(magic, "DREQ", 4) == 0;
+		fileIO->close();
+		bool loaded = false;
+		if (binary == true) {
+			loaded = preset.loadFile(_presetName);
+		} else if (fileIO->open(etk::io::OpenMode::Read) == true) {
+			etk::String text = fileIO->readAllString();
+			fileIO->close();
+			loaded = preset.fromText(text);
+		}
+		if (loaded == false) {
+			TEST_ERROR("Can not load preset '" << _presetName << "'");
+			return -1;
+		}
+	} else {
+		preset.addBand(-1, audio::algo::drain::biQuadType_lowShelf, 100.0, 0.707, 3.0);
+		preset.addBand(-1, audio::algo::drain::biQuadType_peak, 400.0, 1.0, -2.0);
+		preset.addBand(-1, audio::algo::drain::biQuadType_peak, 1500.0, 1.0, 2.0);
+		preset.addBand(-1, audio::algo::drain::biQuadType_peak, 5000.0, 1.0, -1.0);
+		preset.addBand(-1, audio::algo::drain::biQuadType_highShelf, 10000.0, 0.707, 2.0);
+	}
+	audio::algo::drain::Equalizer algo;
+	algo.init(info.sampleRate, info.nbChannel, info.format);
+	preset.apply(algo, info.sampleRate);
+	OutputFile output;
+	if (output.open(_outputName) == false) {
+		TEST_ERROR("Can not open output file '" << _outputName << "'");
+		return -1;
+	}
+	if (etk::end_with(_outputName, ".wav") == true) {
+		writeWaveHeader(output, info);
+	}
+	// process by block directly from the mapped file in the write buffer
+	size_t blockSize = etk::max(size_t(1), processBlockSize / chunkSize);
+	const uint8_t* data = input.getData() + info.dataOffset;
+	Performance perfo;
+	for (size_t iii=0; iii<nbChunk; iii+=blockSize) {
+		size_t nbChunkBlock = etk::min(blockSize, nbChunk - iii);
+		uint8_t* out = output.reserve(nbChunkBlock*chunkSize);
+		if (_perf == true) {
+			perfo.tic();
+		}
+		algo.process(out, &data[iii*chunkSize], nbChunkBlock);
+		if (_perf == true) {
+			perfo.toc();
+		}
+		output.commit(nbChunkBlock*chunkSize);
+	}
+	output.flush();
+	double timeTotal = (echrono::Steady::now() - timeStart).toSeconds();
+	double duration = double(nbChunk) / double(info.sampleRate);
+	TEST_PRINT("Processed " << duration << "s of audio in " << timeTotal*1000.0 << "ms: x" << duration/timeTotal << " realtime (with I/O)");
+	if (_perf == true) {
+		double timeProcess = perfo.getTotalTimeProcessing().toSeconds();
+		TEST_PRINT("    blockSize=" << blockSize << " chunks, process only: " << timeProcess*1000.0 << "ms x" << duration/timeProcess << " realtime");
+		TEST_PRINT("    block min < avg < max = " << perfo.getMinProcessing() << " < "
+		           << perfo.getTotalTimeProcessing().toSeconds()*1000000000.0/perfo.getTotalIteration() << "ns < "
+		           << perfo.getMaxProcessing());
+	}
+	return 0;
+}
+
+/**
+ * @brief Convert the sample rate of a raw or WAV file.
+ */
+static int32_t processFileResampler(const etk::String& _inputName,
+                                    const etk::String& _outputName,
+                                    int32_t _sampleRateIn,
+                                    int32_t _sampleRateOut,
+                                    int32_t _nbChannel,
+                                    enum audio::format _format,
+                                    int32_t _quality,
+                                    bool _perf) {
+	echrono::Steady timeStart = echrono::Steady::now();
+	InputFile input;
+	if (input.open(_inputName) == false) {
+		TEST_ERROR("Can not open input file '" << _inputName << "'");
+		return -1;
+	}
+	WaveInfo info;
+	bool wave = parseWave(info, input.getData(), input.getSize());
+	if (wave == false) {
+		info.nbChannel = _nbChannel;
+		info.sampleRate = _sampleRateIn;
+		info.format = _format;
+		info.dataOffset = 0;
+		info.dataSize = input.getSize();
+	}
+	size_t chunkSize = audio::getFormatBytes(info.format) * info.nbChannel;
+	if (chunkSize == 0) {
+		TEST_ERROR("Wrong input format or number of channel");
+		return -1;
+	}
+	size_t nbChunk = info.dataSize / chunkSize;
+	TEST_INFO("Input: " << (wave == true ? "WAV " : "raw ") << info.nbChannel << " channels " << info.sampleRate << " Hz format=" << info.format << " " << nbChunk << " chunks");
+	audio::algo::drain::Resampler algo;
+	algo.init(info.sampleRate, _sampleRateOut, info.nbChannel, info.format, _quality);
+	// the output timeline is aligned on the input: same duration
+	size_t nbChunkOut = size_t(ceil(double(nbChunk) * double(_sampleRateOut) / double(info.sampleRate)));
+	TEST_INFO("Output: " << _sampleRateOut << " Hz " << nbChunkOut << " chunks, filter of " << algo.getNbTap() << " taps, latency " << algo.getLatency() << " chunks");
+	OutputFile output;
+	if (output.open(_outputName) == false) {
+		TEST_ERROR("Can not open output file '" << _outputName << "'");
+		return -1;
+	}
+	if (etk::end_with(_outputName, ".wav") == true) {
+		WaveInfo infoOut = info;
+		infoOut.sampleRate = _sampleRateOut;
+		infoOut.dataSize = nbChunkOut * chunkSize;
+		writeWaveHeader(output, infoOut);
+	}
+	size_t blockSize = etk::max(size_t(1), processBlockSize / chunkSize);
+	const uint8_t* data = input.getData() + info.dataOffset;
+	// zeros after the end of the file: flush the samples kept by the filter
+	etk::Vector<uint8_t> zero;
+	zero.resize(blockSize*chunkSize, 0);
+	size_t nbOutput = 0;
+	Performance perfo;
+	for (size_t iii=0; nbOutput<nbChunkOut; iii+=blockSize) {
+		const uint8_t* in = &zero[0];
+		size_t nbChunkBlock = blockSize;
+		if (iii < nbChunk) {
+			in = &data[iii*chunkSize];
+			nbChunkBlock = etk::min(blockSize, nbChunk - iii);
+		}
+		uint8_t* out = output.reserve(algo.getMaxOutputSize(nbChunkBlock)*chunkSize);
+		if (_perf == true) {
+			perfo.tic();
+		}
+		size_t nbOutputBlock = algo.process(out, in, nbChunkBlock);
+		if (_perf == true) {
+			perfo.toc();
+		}
+		nbOutputBlock = etk::min(nbOutputBlock, nbChunkOut - nbOutput);
+		output.commit(nbOutputBlock*chunkSize);
+		nbOutput += nbOutputBlock;
+	}
+	output.flush();
+	double timeTotal = (echrono::Steady::now() - timeStart).toSeconds();
+	double duration = double(nbChunk) / double(info.sampleRate);
+	TEST_PRINT("Resampled " << duration << "s of audio in " << timeTotal*1000.0 << "ms: x" << duration/timeTotal << " realtime (with I/O)");
+	if (_perf == true) {
+		double timeProcess = perfo.getTotalTimeProcessing().toSeconds();
+		TEST_PRINT("    blockSize=" << blockSize << " chunks, process only: " << timeProcess*1000.0 << "ms x" << duration/timeProcess << " realtime");
+	}
+	return 0;
+}
+
+/**
+ * @brief Histogram of duration (100ns step): record a value without allocation nor sort (usable in the real-time thread).
+ */
+class LatencyHistogram {
+	private:
+		etk::Vector<uint32_t> m_count;
+		int64_t m_total;
+		echrono::Duration m_max;
+	public:
+		LatencyHistogram(int32_t _maxMilliSecond=50) :
+		  m_total(0),
+		  m_max(echrono::nanoseconds(0)) {
+			m_count.resize(_maxMilliSecond*10000 + 1, 0);
+		}
+		void add(const echrono::Duration& _time) {
+			int64_t id = etk::min(int64_t(m_count.size()-1), etk::max(int64_t(0), _time.get()/100));
+			m_count[id]++;
+			m_total++;
+			m_max = etk::max(m_max, _time);
+		}
+		/**
+		 * @brief Get the duration under which _percent % of the values are.
+		 */
+		echrono::Duration getPercentile(double _percent) const {
+			int64_t limit = int64_t(double(m_total) * _percent / 100.0);
+			int64_t sum = 0;
+			for (size_t iii=0; iii<m_count.size(); ++iii) {
+				sum += m_count[iii];
+				if (sum > limit) {
+					return echrono::nanoseconds(iii*100);
+				}
+			}
+			return m_max;
+		}
+		echrono::Duration getMax() const {
+			return m_max;
+		}
+};
+
+static void sleepUntil(const echrono::Steady& _time) {
+	echrono::Duration delta = _time - echrono::Steady::now();
+	#ifdef TEST_POSIX
+		if (delta.get() > 0) {
+			struct timespec request;
+			request.tv_sec = delta.get() / 1000000000LL;
+			request.tv_nsec = delta.get() % 1000000000LL;
+			nanosleep(&request, null);
+		}
+	#else
+		if (delta.get() > 1000000LL) {
+			ethread::sleepMilliSeconds(delta.get() / 1000000LL);
+		}
+		while (echrono::Steady::now() < _time) {
+			// wait the end of the milli-second
+		}
+	#endif
+}
+
+/**
+ * @brief Simulate an audio driver: a thread call the Equalizer with a block at each period, optionally with threads loading the CPU and the memory.
+ * @param[in] _nbChannel Number of channel.
+ * @param[in] _nbStage Number of biquad of each channel.
+ * @param[in] _blockSize Number of chunk of a callback (period = _blockSize/sampleRate).
+ * @param[in] _nbLoadThread Number of background thread (copy of big buffers).
+ * @param[in] _duration Duration of the simulation in second.
+ */
+void realTimeSimulation(int32_t _nbChannel, int32_t _nbStage, int32_t _blockSize, int32_t _nbLoadThread, float _duration) {
+	float sampleRate = 48000;
+	audio::algo::drain::Equalizer algo;
+	algo.init(sampleRate, _nbChannel, audio::format_float);
+	for (int32_t iii=0; iii<_nbStage; ++iii) {
+		algo.addBiquad(audio::algo::drain::biQuadType_peak, 100.0*(iii+1), 1.0, 3.0);
+	}
+	etk::Vector<float> input;
+	input.resize(_blockSize*_nbChannel, 0.0f);
+	uint32_t seed = 12345;
+	for (size_t iii=0; iii<input.size(); ++iii) {
+		seed = seed*1664525 + 1013904223;
+		input[iii] = float(seed>>8)/float(1<<24) - 0.5f;
+	}
+	etk::Vector<float> output;
+	output.resize(input.size(), 0.0f);
+	// background load:
+	ethread::Mutex mutex;
+	bool stop = false;
+	etk::Vector<ememory::SharedPtr<ethread::Thread> > loadThreads;
+	for (int32_t iii=0; iii<_nbLoadThread; ++iii) {
+		loadThreads.pushBack(ememory::makeShared<ethread::Thread>([&mutex, &stop]() {
+		                                                              // bigger than the last level cache: evict the data of the callback
+		                                                              etk::Vector<uint8_t> bufferA;
+		                                                              bufferA.resize(8*1024*1024, 1);
+		                                                              etk::Vector<uint8_t> bufferB;
+		                                                              bufferB.resize(bufferA.size(), 2);
+		                                                              while (true) {
+		                                                                  {
+		                                                                      ethread::UniqueLock lock(mutex);
+		                                                                      if (stop == true) {
+		                                                                          return;
+		                                                                      }
+		                                                                  }
+		                                                                  memcpy(&bufferB[0], &bufferA[0], bufferA.size());
+		                                                                  memcpy(&bufferA[0], &bufferB[0], bufferA.size());
+		                                                              }
+		                                                          },
+		                                                          "load"));
+	}
+	// periodic callback:
+	echrono::Duration period = echrono::nanoseconds(int64_t(double(_blockSize) * 1000000000.0 / sampleRate));
+	int32_t nbCallback = int32_t(_duration * sampleRate / _blockSize);
+	int32_t nbMiss = 0;
+	LatencyHistogram histogram;
+	ethread::Thread callback([&]() {
+	                             echrono::Steady next = echrono::Steady::now() + period;
+	                             for (int32_t iii=0; iii<nbCallback; ++iii) {
+	                                 sleepUntil(next);
+	                                 echrono::Steady start = echrono::Steady::now();
+	                                 algo.process(&output[0], &input[0], _blockSize);
+	                                 echrono::Steady end = echrono::Steady::now();
+	                                 histogram.add(end - start);
+	                                 // the data must be ready before the next period (wake-up latency included)
+	                                 if (end > next + period) {
+	                                     nbMiss++;
+	                                 }
+	                                 next += period;
+	                             }
+	                         },
+	                         "callback");
+	callback.join();
+	{
+		ethread::UniqueLock lock(mutex);
+		stop = true;
+	}
+	for (size_t iii=0; iii<loadThreads.size(); ++iii) {
+		loadThreads[iii]->join();
+	}
+	TEST_PRINT("block=" << _blockSize << " channel=" << _nbChannel << " stage=" << _nbStage << " load=" << _nbLoadThread
+	           << ": p50=" << histogram.getPercentile(50.0) << " p99=" << histogram.getPercentile(99.0) << " p99.9=" << histogram.getPercentile(99.9)
+	           << " max=" << histogram.getMax() << " period=" << period << " deadline miss=" << nbMiss << "/" << nbCallback);
+}
+
+int main(int _argc, const char** _argv) {
+	// the only one init for etk:
+	etk::init(_argc, _argv);
+	etk::String inputName = "";
+	etk::String outputName = "output.raw";
+	bool performance = false;
+	bool perf = false;
+	int64_t sampleRateIn = 48000;
+	int64_t sampleRateOut = 48000;
+	int32_t nbChan = 1;
+	int32_t quality = 4;
+	etk::String test = "";
+	etk::String presetName = "";
+	enum audio::format format = audio::format_int16;
+	int32_t blockSize = -1;
+	int32_t nbStage = 8;
+	int32_t nbLoadThread = -1;
+	float duration = 10.0f;
+	for (int32_t iii=0; iii<_argc ; ++iii) {
+		etk::String data = _argv[iii];
+		if (etk::start_with(data,"--in=")) {
+			inputName = &data[5];
+		} else if (etk::start_with(data,"--out=")) {
+			outputName = &data[6];
+		} else if (data == "--performance") {
+			performance = true;
+		} else if (data == "--perf") {
+			perf = true;
+		} else if (etk::start_with(data,"--test=")) {
+			test = &data[7];
+		} else if (etk::start_with(data,"--block=")) {
+			blockSize = etk::string_to_int32_t(&data[8]);
+		} else if (etk::start_with(data,"--stage=")) {
+			nbStage = etk::string_to_int32_t(&data[8]);
+		} else if (etk::start_with(data,"--load=")) {
+			nbLoadThread = etk::string_to_int32_t(&data[7]);
+		} else if (etk::start_with(data,"--duration=")) {
+			duration = etk::string_to_double(&data[11]);
+		} else if (etk::start_with(data,"--preset=")) {
+			presetName = &data[9];
+		} else if (data == "--format=int16") {
+			format = audio::format_int16;
+		} else if (data == "--format=float") {
+			format = audio::format_float;
+		} else if (etk::start_with(data,"--sample-rate-in=")) {
+			data = &data[17];
+			sampleRateIn = etk::string_to_int32_t(data);
+		} else if (etk::start_with(data,"--sample-rate-out=")) {
+			data = &data[18];
+			sampleRateOut = etk::string_to_int32_t(data);
+		} else if (etk::start_with(data,"--nb=")) {
+			data = &data[5];
+			nbChan = etk::string_to_int32_t(data);
+		} else if (etk::start_with(data,"--quality=")) {
+			data = &data[10];
+			quality = etk::string_to_int32_t(data);
+		} else if (    data == "-h"
+		            || data == "--help") {
+			TEST_PRINT("Help : ");
+			TEST_PRINT("    ./xxx --fb=file.raw --mic=file.raw");
+			TEST_PRINT("        --in=YYY.raw            input file");
+			TEST_PRINT("        --out=zzz.raw           output file");
+			TEST_PRINT("        --performance           Generate signal to force algo to maximum process time");
+			TEST_PRINT("        --perf                  Enable performence test (little slower but real performence test)");
+			TEST_PRINT("        --test=XXXX             some test availlable ...");
+			TEST_PRINT("            EQUALIZER          Equalize a file (WAV PCM 16 bits / float 32 bits, or raw), print the speed in x realtime");
+			TEST_PRINT("                --preset=XXX.txt          Equalizer preset (text or binary, default: 5 bands)");
+			TEST_PRINT("                --sample-rate-in=XXXX     Raw input signal sample rate (default 48000)");
+			TEST_PRINT("                --nb=XX                   Raw input number of channel (default 1)");
+			TEST_PRINT("                --format=int16/float      Raw input sample format (default int16)");
+			TEST_PRINT("            RESAMPLE           Convert the sample rate of a file (WAV PCM 16 bits / float 32 bits, or raw), print the speed in x realtime");
+			TEST_PRINT("                --sample-rate-in=XXXX     Raw input signal sample rate (default 48000)");
+			TEST_PRINT("                --sample-rate-out=XXXX    Output signal sample rate (default 48000)");
+			TEST_PRINT("                --quality=XX              Quality of the filter [0..10] (default 4)");
+			TEST_PRINT("                --nb=XX                   Raw input number of channel (default 1)");
+			TEST_PRINT("                --format=int16/float      Raw input sample format (default int16)");
+			TEST_PRINT("            REALTIME           Call the equalizer from a periodic thread (audio driver simulation), print the process time percentiles and the deadline miss");
+			TEST_PRINT("                --block=XXX               Number of chunk of a callback (default: 32, 128 and 512)");
+			TEST_PRINT("                --nb=XX                   Number of channel (default 1)");
+			TEST_PRINT("                --stage=XX                Number of biquad (default 8)");
+			TEST_PRINT("                --load=XX                 Number of background load thread (default: 0 and 4)");
+			TEST_PRINT("                --duration=XX             Duration of each simulation in second (default 10)");
+			
+			exit(0);
+		}
+	}
+	// PERFORMANCE test only ....
+	if (performance == true) {
+		performanceEqualizer();
+		testBeamformer();
+		testBeamformerStft();
+		testDirectionOfArrival();
+		testVectorMath();
+		performanceEqualizerBank(16);
+		performanceEqualizerBank(1024);
+		performanceStaticEqualizer();
+		testBiQuadDesignLimit();
+		performancePresetLoad(1000);
+		testBiQuadCache();
+		testSetSampleRate();
+		performancePresetBinary(1000);
+		performanceParallelRender(600);
+		performanceEqualizerKernel(1, 4, 64);
+		performanceEqualizerKernel(2, 10, 256);
+		performanceEqualizerKernel(8, 10, 256);
+		performanceEqualizerKernel(16, 4, 1024);
+		performanceMixedPrecision();
+		testMixedPrecisionHistory();
+		performanceChain(256);
+		performanceChain(48000);
+		performanceDynamics(1, true, audio::algo::drain::dynamicsDetector_peak);
+		performanceDynamics(2, true, audio::algo::drain::dynamicsDetector_peak);
+		performanceDynamics(2, true, audio::algo::drain::dynamicsDetector_rms);
+		performanceDynamics(8, true, audio::algo::drain::dynamicsDetector_peak);
+		performanceDynamics(8, false, audio::algo::drain::dynamicsDetector_peak);
+		testDynamicEqualizer();
+		performanceDynamicEqualizer(2, 8);
+		performanceDynamicEqualizer(8, 8);
+		testLoudnessMeter();
+		performanceLoudnessMeter(1);
+		performanceLoudnessMeter(2);
+		performanceLoudnessMeter(8);
+		testResampler();
+		performanceResampler(1, 44100, 48000, 4);
+		performanceResampler(2, 44100, 48000, 4);
+		performanceResampler(8, 44100, 48000, 4);
+		performanceResampler(8, 44100, 48000, 4, true);
+		performanceResampler(2, 48000, 44100, 4);
+		performanceResampler(2, 48000, 16000, 4);
+		performanceResampler(2, 44100, 47999.5, 4);
+		performanceResampler(2, 44100, 48000, 0);
+		performanceResampler(2, 44100, 48000, 10);
+		testSpectrumAnalyzer();
+		performanceSpectrumAnalyzer(1, 2048, 512);
+		performanceSpectrumAnalyzer(2, 4096, 1024);
+		performanceSpectrumAnalyzer(8, 8192, 2048);
+		testChannelMixer();
+		performanceChannelMixer(6, 2, "standard");
+		performanceChannelMixer(8, 2, "standard");
+		performanceChannelMixer(2, 8, "standard");
+		performanceChannelMixer(8, 8, "standard");
+		performanceChannelMixer(8, 8, "permutation");
+		performanceChannelMixer(8, 8, "dense");
+		performanceChannelMixer(16, 16, "dense");
+		testCrossover();
+		performanceCrossover(2, 2, 4);
+		performanceCrossover(2, 3, 4);
+		performanceCrossover(2, 4, 4);
+		performanceCrossover(2, 4, 8);
+		testEqualizerFit();
+		performanceEqualizerFit(10, 1);
+		performanceEqualizerFit(10, 0);
+		performanceEqualizerFit(20, 1);
+		performanceEqualizerFit(20, 0);
+		testGraphicEqualizer();
+		performanceGraphicEqualizer(2, 1);
+		performanceGraphicEqualizer(2, 3);
+		performanceGraphicEqualizer(8, 3);
+		return 0;
+	}
+	if (test == "EQUALIZER") {
+		TEST_INFO("Start equalizer test ... ");
+		if (inputName == "") {
+			TEST_ERROR("Can not Process missing parameters...");
+			exit(-1);
+		}
+		return processFileEqualizer(inputName, outputName, presetName, sampleRateIn, nbChan, format, perf);
+	}
+	if (test == "RESAMPLE") {
+		TEST_INFO("Start resampler test ... ");
+		if (inputName == "") {
+			TEST_ERROR("Can not Process missing parameters...");
+			exit(-1);
+		}
+		return processFileResampler(inputName, outputName, sampleRateIn, sampleRateOut, nbChan, format, quality, perf);
+	}
+	if (test == "REALTIME") {
+		etk::Vector<int32_t> listBlockSize;
+		if (blockSize > 0) {
+			listBlockSize.pushBack(blockSize);
+		} else {
+			listBlockSize.pushBack(32);
+			listBlockSize.pushBack(128);
+			listBlockSize.pushBack(512);
+		}
+		etk::Vector<int32_t> listLoad;
+		if (nbLoadThread >= 0) {
+			listLoad.pushBack(nbLoadThread);
+		} else {
+			listLoad.pushBack(0);
+			listLoad.pushBack(4);
+		}
+		for (size_t iii=0; iii<listLoad.size(); ++iii) {
+			for (size_t jjj=0; jjj<listBlockSize.size(); ++jjj) {
+				realTimeSimulation(nbChan, nbStage, listBlockSize[jjj], listLoad[iii], duration);
+			}
+		}
+		return 0;
 	}
 	
 }
@@ -13,42 +13,15 @@ extern "C" {
 #include <test-debug/debug.hpp>
 #include <etk/math/Vector3D.hpp>
 #include <etk/uri/uri.hpp>
-
-const double speedSound = 340.29; // m/s
+#include <etk/Vector.hpp>
+#include <audio/algo/drain/ArrayGeometry.hpp>
+#include <audio/algo/drain/VectorMath.hpp>
 
 // ./binary > beamPattern.dat
 // > gnuplot
 // gnuplot> call 'beamPattern.gnuplot'
 // gnuplot> call 'polar.gnuplot'
 
-
-class Direction {
-	public:
-		double radius; //!< radius distance of the source
-		double angleAlpha; //!< angle on the XY plane, 0 is to the right and turning to the left is positive (clock orientation)
-		double angleEtha; //!< angle on the XZ plane, 0 is directly ahead, turning upwards is positive
-		Direction(double _alpha, double _etha, double _radius) {
-			radius = _radius;
-			angleAlpha = _alpha;
-			angleEtha = _etha;
-		}
-};
-
-
-double calculateDelay(vec3 _pos, Direction _dir) {
-	//convert direction in position:
-	vec3 posSource(0.0,0.0,_dir.radius);
-	//mat4 matrix = etk::matRotate(vec3(0,1,0), _dir.angleAlpha);// * etk::matRotate(vec3(1,0,0), _dir.angleEtha);
-	//vec3 pos = matrix * posSource;
-	vec3 pos = posSource.rotate(vec3(0,1,0), _dir.angleAlpha);
-	double delay = (_pos-pos).length();
-	double delayBase = pos.length();
-	TEST_DEBUG("posSource : src=" << pos << " to dst=" << _pos << " distance=" << delay);
-	TEST_DEBUG("   delta = " << delay - delayBase << " angle=" << _dir.angleAlpha*180/M_PI);
-	TEST_DEBUG("   theoric = " << _pos.x() * sin(_dir.angleAlpha));
-	return (delay - delayBase) / speedSound;
-}
-
 #if 0
 	int32_t posCount = 4;
 	vec3 positions[4] = {
@@ -163,32 +136,48 @@ int main(int argc, const char *argv[]) {
 	double freq = 3000.0; // Signal frequency in Hz 
 	double basicApplyDelay[posCount];
 	for (int32_t iii=0; iii<posCount; iii++) {
-		basicApplyDelay[iii] = 0.0f;
-		basicApplyDelay[iii] = calculateDelay(positions[iii], Direction(0.0/*M_PI/4*/, 0.0, distanceEar));
+		basicApplyDelay[iii] = audio::algo::drain::calculateDelay(positions[iii], audio::algo::drain::Direction(0.0/*M_PI/4*/, 0.0, distanceEar));
 		TEST_INFO("single delay: " << iii << " pos=" << positions[iii] << " value=" << basicApplyDelay[iii] << " sample 48k=" << basicApplyDelay[iii]*48000.0);
 	}
-	// Iterate through arrival angle points
+	// Phase of each wave for all the arrival angle points, then all the sin/cos in one pass
+	etk::Vector<float> angleRad;
+	angleRad.resize(ANGLE_RESOLUTION, 0.0f);
 	for (int32_t aaa=0; aaa<ANGLE_RESOLUTION; aaa++) {
-		// Calculate the planewave arrival angle
-		double angle = -180.0 + 360.0 * double(aaa) / double(ANGLE_RESOLUTION-1.0);
-		double angleRad = M_PI * double(angle) / 180.0;
-		double realSum = 0;
-		double imagSum = 0;
-		// Iterate through array elements
-		for (int32_t iii=0; iii<posCount; iii++) {
-			// Calculate element position and wavefront delay
-			double delay = calculateDelay(positions[iii], Direction(angleRad, 0.0, distanceEar));
-			// Add Wave
-			realSum += cos(2.0 * M_PI * freq * (delay-basicApplyDelay[iii]));
-			imagSum += sin(2.0 * M_PI * freq * (delay-basicApplyDelay[iii]));
+		angleRad[aaa] = M_PI * (-180.0 + 360.0 * double(aaa) / double(ANGLE_RESOLUTION-1.0)) / 180.0;
+	}
+	etk::Vector<float> phase;
+	phase.resize(posCount*ANGLE_RESOLUTION, 0.0f);
+	for (int32_t iii=0; iii<posCount; iii++) {
+		// Calculate element position and wavefront delay
+		for (int32_t aaa=0; aaa<ANGLE_RESOLUTION; aaa++) {
+			double delay = audio::algo::drain::calculateDelay(positions[iii], audio::algo::drain::Direction(angleRad[aaa], 0.0, distanceEar));
+			phase[iii*ANGLE_RESOLUTION + aaa] = 2.0 * M_PI * freq * (delay-basicApplyDelay[iii]);
 		}
-		double output = sqrt(realSum * realSum + imagSum * imagSum) / posCount;
-		double logOutput = 20 * log10(output);
-		if (logOutput < -50) {
-			logOutput = -50;
+	}
+	etk::Vector<float> waveImag;
+	waveImag.resize(posCount*ANGLE_RESOLUTION, 0.0f);
+	etk::Vector<float> waveReal;
+	waveReal.resize(posCount*ANGLE_RESOLUTION, 0.0f);
+	audio::algo::drain::vectorMath::sinCos(&waveImag[0], &waveReal[0], &phase[0], posCount*ANGLE_RESOLUTION);
+	// Add Waves (the first element row is used as accumulator)
+	for (int32_t iii=1; iii<posCount; iii++) {
+		for (int32_t aaa=0; aaa<ANGLE_RESOLUTION; aaa++) {
+			waveReal[aaa] += waveReal[iii*ANGLE_RESOLUTION + aaa];
+			waveImag[aaa] += waveImag[iii*ANGLE_RESOLUTION + aaa];
 		}
+	}
+	for (int32_t aaa=0; aaa<ANGLE_RESOLUTION; aaa++) {
+		waveReal[aaa] /= float(posCount);
+		waveImag[aaa] /= float(posCount);
+	}
+	etk::Vector<float> logOutput;
+	logOutput.resize(ANGLE_RESOLUTION, 0.0f);
+	audio::algo::drain::vectorMath::magnitudeToDb(&logOutput[0], &waveReal[0], &waveImag[0], ANGLE_RESOLUTION, -50.0f);
+	for (int32_t aaa=0; aaa<ANGLE_RESOLUTION; aaa++) {
+		double angle = -180.0 + 360.0 * double(aaa) / double(ANGLE_RESOLUTION-1.0);
+		double output = sqrt(waveReal[aaa] * waveReal[aaa] + waveImag[aaa] * waveImag[aaa]);
 		char ploppp[4096];
-		sprintf(ploppp, "%d %f %f %f %f\n", aaa, angle, angleRad, output, logOutput);
+		sprintf(ploppp, "%d %f %f %f %f\n", aaa, angle, angleRad[aaa], output, logOutput[aaa]);
 		fileIO->puts(ploppp);
 	}
 	fileIO->close();
@@ -10,7 +10,9 @@ extern "C" {
 // Number of angle points to calculate
 #define ANGLE_RESOLUTION 1000
 
-// ./binary > freqResp.dat
+// ./binary                         ==> freqResp.dat
+// ./binary --binary                ==> freqResp.bin (float matrix, see ResponseHeader)
+// ./binary --convert=freqResp.bin  ==> freqResp.dat
 // gnuplot
 // gnuplot> call 'freqResp.gnuplot'
 
@@ -18,35 +20,10 @@ extern "C" {
 #include <etk/uri/uri.hpp>
 #include <test-debug/debug.hpp>
 #include <etk/math/Vector3D.hpp>
-
-const double speedSound = 340.29; // m/s
-
-class Direction {
-	public:
-		double radius; //!< radius distance of the source
-		double angleAlpha; //!< angle on the XY plane, 0 is to the right and turning to the left is positive (clock orientation)
-		double angleEtha; //!< angle on the XZ plane, 0 is directly ahead, turning upwards is positive
-		Direction(double _alpha, double _etha, double _radius) {
-			radius = _radius;
-			angleAlpha = _alpha;
-			angleEtha = _etha;
-		}
-};
-
-
-double calculateDelay(vec3 _pos, Direction _dir) {
-	//convert direction in position:
-	vec3 posSource(0.0,0.0,_dir.radius);
-	//mat4 matrix = etk::matRotate(vec3(0,1,0), _dir.angleAlpha);// * etk::matRotate(vec3(1,0,0), _dir.angleEtha);
-	//vec3 pos = matrix * posSource;
-	vec3 pos = posSource.rotate(vec3(0,1,0), _dir.angleAlpha);
-	double delay = (_pos-pos).length();
-	double delayBase = pos.length();
-	TEST_DEBUG("posSource : src=" << pos << " to dst=" << _pos << " distance=" << delay);
-	TEST_DEBUG("   delta = " << delay - delayBase << " angle=" << _dir.angleAlpha*180/M_PI);
-	TEST_DEBUG("   theoric = " << _pos.x() * sin(_dir.angleAlpha));
-	return (delay - delayBase) / speedSound;
-}
+#include <ethread/Thread.hpp>
+#include <ethread/Semaphore.hpp>
+#include <audio/algo/drain/ArrayGeometry.hpp>
+#include <audio/algo/drain/VectorMath.hpp>
 
 #if 0
 	int32_t posCount = 4;
@@ -151,48 +128,287 @@ double calculateDelay(vec3 _pos, Direction _dir) {
 
 const double distanceEar = 3;
 
+/**
+ * @brief Header of the binary response file (native endian), followed by nbFreq rows of nbAngle float gain in dB.
+ */
+class ResponseHeader {
+	public:
+		char magic[4]; //!< "DRFR"
+		uint32_t version; //!< version of the file format
+		uint32_t nbAngle; //!< number of angle point (X axis, row size)
+		uint32_t nbFreq; //!< number of frequency point (Y axis, number of row)
+		float angleMin; //!< first angle (degrees)
+		float angleMax; //!< last angle (degrees)
+		float freqMin; //!< first frequency (Hz)
+		float freqMax; //!< last frequency (Hz)
+};
+static const uint32_t responseVersion = 1;
+// Size of a chunk send to the writer (in float)
+static const int32_t chunkSizeMin = 1024*1024;
+// Maximum number of point on an axis of a response file (the ids stay in int32_t)
+static const uint32_t nbPointMax = 1024*1024;
+// Limits of the gain written in the text file (dB): a line always fit in its 64 characters
+static const float gainTextMin = -1000.0f;
+static const float gainTextMax = 1000.0f;
+
+/**
+ * @brief Chunk of frequency rows generated by the producer and flushed by the writer.
+ */
+class ResponseChunk {
+	public:
+		int32_t firstFreq; //!< Id of the first frequency row in the chunk
+		int32_t nbFreq; //!< Number of frequency row in the chunk
+		etk::Vector<float> data; //!< nbFreq*nbAngle gain in dB
+};
+
+static double getAngle(int32_t _id, int32_t _nbAngle) {
+	return -180.0 + 360.0 * double(_id) / double(_nbAngle-1);
+}
+
+static double getFrequency(int32_t _id, int32_t _nbFreq) {
+	return 10000.0 * double(_id) / double(_nbFreq-1);
+}
+
+/**
+ * @brief Calculate a full chunk of frequency rows.
+ * @param[in,out] _chunk Chunk to fill (firstFreq and nbFreq already set).
+ * @param[in] _delay Wavefront delay table [position][angle], already compensated with the steering delay.
+ * @param[in] _nbAngle Number of angle point.
+ * @param[in] _nbFreq Total number of frequency point.
+ * @param[out] _phase Working buffer (posCount*nbAngle).
+ * @param[out] _real Working buffer (posCount*nbAngle).
+ * @param[out] _imag Working buffer (posCount*nbAngle).
+ */
+static void calculateChunk(ResponseChunk& _chunk,
+                           const etk::Vector<double>& _delay,
+                           int32_t _nbAngle,
+                           int32_t _nbFreq,
+                           etk::Vector<float>& _phase,
+                           etk::Vector<float>& _real,
+                           etk::Vector<float>& _imag) {
+	int32_t nbPoint = posCount*_nbAngle;
+	for (int32_t fff=0; fff<_chunk.nbFreq; ++fff) {
+		double pulsation = 2.0 * M_PI * getFrequency(_chunk.firstFreq + fff, _nbFreq);
+		for (int32_t iii=0; iii<nbPoint; ++iii) {
+			_phase[iii] = pulsation * _delay[iii];
+		}
+		audio::algo::drain::vectorMath::sinCos(&_imag[0], &_real[0], &_phase[0], nbPoint);
+		// Add the wave of each array element (the first element row is used as accumulator)
+		for (int32_t iii=1; iii<posCount; ++iii) {
+			const float* real = &_real[iii*_nbAngle];
+			const float* imag = &_imag[iii*_nbAngle];
+			for (int32_t aaa=0; aaa<_nbAngle; ++aaa) {
+				_real[aaa] += real[aaa];
+				_imag[aaa] += imag[aaa];
+			}
+		}
+		float scale = 1.0f / float(posCount);
+		for (int32_t aaa=0; aaa<_nbAngle; ++aaa) {
+			_real[aaa] *= scale;
+			_imag[aaa] *= scale;
+		}
+		audio::algo::drain::vectorMath::magnitudeToDb(&_chunk.data[fff*_nbAngle], &_real[0], &_imag[0], _nbAngle, -50.0f);
+	}
+}
+
+/**
+ * @brief Write a chunk in the gnuplot text format ("angle freq gain" and an empty line after each frequency row).
+ */
+static void writeChunkText(ememory::SharedPtr<etk::io::Interface> _fileIO, const float* _data, int32_t _firstFreq, int32_t _nbFreqChunk, int32_t _nbAngle, int32_t _nbFreq) {
+	etk::Vector<char> text;
+	text.resize(_nbAngle*64 + 2, 0);
+	for (int32_t fff=0; fff<_nbFreqChunk; ++fff) {
+		double freq = getFrequency(_firstFreq + fff, _nbFreq);
+		size_t pos = 0;
+		for (int32_t aaa=0; aaa<_nbAngle; ++aaa) {
+			float gain = _data[fff*_nbAngle + aaa];
+			if (isnan(gain) == false) {
+				gain = etk::max(gainTextMin, etk::min(gainTextMax, gain));
+			}
+			// keep one character for the empty line
+			int32_t size = snprintf(&text[pos], text.size() - pos - 1, "%f %f %f\n", getAngle(aaa, _nbAngle), freq, gain);
+			if (    size < 0
+			     || pos + size >= text.size() - 1) {
+				break;
+			}
+			pos += size;
+		}
+		text[pos++] = '\n';
+		_fileIO->write(&text[0], 1, pos);
+	}
+}
+
+/**
+ * @brief Convert a binary response file in the gnuplot text file used by freqResp.gnuplot.
+ */
+static int32_t convertToText(const etk::String& _inputName, const etk::String& _outputName) {
+	ememory::SharedPtr<etk::io::Interface> fileIn = etk::uri::get(etk::Path(_inputName));
+	if (    fileIn == null
+	     || fileIn->open(etk::io::OpenMode::Read) == false) {
+		TEST_ERROR("Can not open file '" << _inputName << "'");
+		return -1;
+	}
+	ResponseHeader header;
+	if (    fileIn->read(&header, sizeof(ResponseHeader), 1) != 1
+	     || header.magic[0] != 'D'
+	     || header.magic[1] != 'R'
+	     || header.magic[2] != 'F'
+	     || header.magic[3] != 'R') {
+		TEST_ERROR("'" << _inputName << "' is not a frequency response file");
+		fileIn->close();
+		return -1;
+	}
+	if (header.version != responseVersion) {
+		TEST_ERROR("'" << _inputName << "' version " << header.version << " not supported");
+		fileIn->close();
+		return -1;
+	}
+	// getAngle and getFrequency need 2 points, a chunk (nbFreqChunk*nbAngle) stay under chunkSizeMin
+	if (    header.nbAngle < 2
+	     || header.nbAngle > nbPointMax
+	     || header.nbFreq < 2
+	     || header.nbFreq > nbPointMax) {
+		TEST_ERROR("'" << _inputName << "' has a wrong size: " << header.nbFreq << "x" << header.nbAngle << " points (limit [2.." << nbPointMax << "])");
+		fileIn->close();
+		return -1;
+	}
+	TEST_INFO("convert " << header.nbFreq << "x" << header.nbAngle << " points");
+	ememory::SharedPtr<etk::io::Interface> fileOut = etk::uri::get(etk::Path(_outputName));
+	if (    fileOut == null
+	     || fileOut->open(etk::io::OpenMode::Write) == false) {
+		TEST_ERROR("Can not open file '" << _outputName << "'");
+		fileIn->close();
+		return -1;
+	}
+	int32_t nbFreqChunk = etk::max(int32_t(1), int32_t(chunkSizeMin/header.nbAngle));
+	etk::Vector<float> data;
+	data.resize(nbFreqChunk*header.nbAngle, 0.0f);
+	for (uint32_t fff=0; fff<header.nbFreq; fff+=nbFreqChunk) {
+		int32_t nbFreq = etk::min(nbFreqChunk, int32_t(header.nbFreq - fff));
+		if (fileIn->read(&data[0], sizeof(float), nbFreq*header.nbAngle) != nbFreq*header.nbAngle) {
+			TEST_ERROR("'" << _inputName << "' is truncated");
+			break;
+		}
+		writeChunkText(fileOut, &data[0], fff, nbFreq, header.nbAngle, header.nbFreq);
+	}
+	fileOut->close();
+	fileIn->close();
+	return 0;
+}
+
 int main(int argc, const char *argv[]) {
 	etk::init(argc, argv);
+	int32_t nbFreq = FREQ_RESOLUTION;
+	int32_t nbAngle = ANGLE_RESOLUTION;
+	bool binary = false;
+	etk::String convertName = "";
+	for (int32_t iii=1; iii<argc; ++iii) {
+		etk::String data = argv[iii];
+		if (etk::start_with(data,"--freq-resolution=")) {
+			nbFreq = etk::string_to_int32_t(&data[18]);
+		} else if (etk::start_with(data,"--angle-resolution=")) {
+			nbAngle = etk::string_to_int32_t(&data[19]);
+		} else if (data == "--binary") {
+			binary = true;
+		} else if (etk::start_with(data,"--convert=")) {
+			convertName = &data[10];
+		} else if (    data == "-h"
+		            || data == "--help") {
+			TEST_PRINT("Help : ");
+			TEST_PRINT("    ./xxx [options]");
+			TEST_PRINT("        --freq-resolution=XXX   Number of frequency point (default " << FREQ_RESOLUTION << ")");
+			TEST_PRINT("        --angle-resolution=XXX  Number of angle point (default " << ANGLE_RESOLUTION << ")");
+			TEST_PRINT("        --binary                Generate the binary float matrix 'freqResp.bin' instead of 'freqResp.dat'");
+			TEST_PRINT("        --convert=XXX.bin       Convert a binary file in 'freqResp.dat' for gnuplot");
+			return 0;
+		}
+	}
+	if (convertName != "") {
+		return convertToText(convertName, "freqResp.dat");
+	}
+	if (    nbFreq < 2
+	     || nbAngle < 2
+	     || nbFreq > int32_t(nbPointMax)
+	     || nbAngle > int32_t(nbPointMax)) {
+		TEST_ERROR("Resolution must be in [2.." << nbPointMax << "]");
+		return -1;
+	}
 	TEST_INFO("start calculation");
-	ememory::SharedPtr<etk::io::Interface> fileIO = etk::uri::get(etk::Path("freqResp.dat"));
-	if (fileIO->open(etk::io::OpenMode::Write) == false) {
+	ememory::SharedPtr<etk::io::Interface> fileIO = etk::uri::get(etk::Path(binary == true ? "freqResp.bin" : "freqResp.dat"));
+	if (    fileIO == null
+	     || fileIO->open(etk::io::OpenMode::Write) == false) {
 		TEST_ERROR("Can not open file...");
 		return -1;
 	}
 	double basicApplyDelay[posCount];
 	for (int32_t iii=0; iii<posCount; iii++) {
-		basicApplyDelay[iii] = 0.0f;
-		basicApplyDelay[iii] = calculateDelay(positions[iii], Direction(0.0f/*M_PI/4*/, 0.0, distanceEar));
+		basicApplyDelay[iii] = audio::algo::drain::calculateDelay(positions[iii], audio::algo::drain::Direction(0.0/*M_PI/4*/, 0.0, distanceEar));
 		TEST_INFO("single delay: " << iii << " pos=" << positions[iii] << " value=" << basicApplyDelay[iii] << " sample 48k=" << basicApplyDelay[iii]*48000.0);
 	}
-	// Iterate through arrival angle points
-	for (int32_t fff=0; fff<FREQ_RESOLUTION; ++fff) {
-		double freq = 10000.0 * double(fff) / double(FREQ_RESOLUTION-1);
-		for (int32_t aaa=0; aaa<ANGLE_RESOLUTION; ++aaa) {
+	// The wavefront delay does not depend on the frequency ==> calculate it one time for all angles
+	etk::Vector<double> delay;
+	delay.resize(posCount*nbAngle, 0.0);
+	for (int32_t iii=0; iii<posCount; ++iii) {
+		for (int32_t aaa=0; aaa<nbAngle; ++aaa) {
 			// Calculate the planewave arrival angle
-			double angle = -180.0 + 360.0 * double(aaa) / double(ANGLE_RESOLUTION-1);
-			double angleRad = M_PI * double(angle) / 180.0;
-			double realSum = 0;
-			double imagSum = 0;
-			// Iterate through array elements
-			for (int32_t iii=0; iii<posCount; ++iii) {
-				// Calculate element position and wavefront delay
-				double delay = calculateDelay(positions[iii], Direction(angleRad, 0.0, distanceEar));
-				// Add Wave
-			realSum += cos(2.0 * M_PI * freq * (delay-basicApplyDelay[iii]));
-			imagSum += sin(2.0 * M_PI * freq * (delay-basicApplyDelay[iii]));
-			}
-			double output = sqrt(realSum * realSum + imagSum * imagSum) / posCount;
-			double logOutput = 20.0 * log10(output);
-			if (logOutput < -50.0) {
-				logOutput = -50.0;
-			}
-			char ploppp[4096];
-			sprintf(ploppp, "%f %f %f\n", angle, freq, logOutput);
-			fileIO->puts(ploppp);
+			double angleRad = M_PI * getAngle(aaa, nbAngle) / 180.0;
+			delay[iii*nbAngle + aaa] = audio::algo::drain::calculateDelay(positions[iii], audio::algo::drain::Direction(angleRad, 0.0, distanceEar)) - basicApplyDelay[iii];
 		}
-		fileIO->puts("\n");
 	}
+	if (binary == true) {
+		ResponseHeader header;
+		header.magic[0] = 'D';
+		header.magic[1] = 'R';
+		header.magic[2] = 'F';
+		header.magic[3] = 'R';
+		header.version = responseVersion;
+		header.nbAngle = nbAngle;
+		header.nbFreq = nbFreq;
+		header.angleMin = getAngle(0, nbAngle);
+		header.angleMax = getAngle(nbAngle-1, nbAngle);
+		header.freqMin = getFrequency(0, nbFreq);
+		header.freqMax = getFrequency(nbFreq-1, nbFreq);
+		fileIO->write(&header, sizeof(ResponseHeader), 1);
+	}
+	// Double buffering: the producer thread calculate a chunk while the current one is written.
+	int32_t nbFreqChunk = etk::max(int32_t(1), chunkSizeMin/nbAngle);
+	ResponseChunk chunks[2];
+	for (int32_t iii=0; iii<2; ++iii) {
+		chunks[iii].data.resize(nbFreqChunk*nbAngle, 0.0f);
+	}
+	ethread::Semaphore semaphoreFree;
+	ethread::Semaphore semaphoreFull;
+	semaphoreFree.post();
+	semaphoreFree.post();
+	int32_t nbChunk = (nbFreq + nbFreqChunk - 1) / nbFreqChunk;
+	ethread::Thread producer([&]() {
+		etk::Vector<float> phase;
+		phase.resize(posCount*nbAngle, 0.0f);
+		etk::Vector<float> real;
+		real.resize(posCount*nbAngle, 0.0f);
+		etk::Vector<float> imag;
+		imag.resize(posCount*nbAngle, 0.0f);
+		for (int32_t ccc=0; ccc<nbChunk; ++ccc) {
+			semaphoreFree.wait();
+			ResponseChunk& chunk = chunks[ccc%2];
+			chunk.firstFreq = ccc*nbFreqChunk;
+			chunk.nbFreq = etk::min(nbFreqChunk, nbFreq - chunk.firstFreq);
+			calculateChunk(chunk, delay, nbAngle, nbFreq, phase, real, imag);
+			semaphoreFull.post();
+		}
+	}, "freqResp producer");
+	for (int32_t ccc=0; ccc<nbChunk; ++ccc) {
+		semaphoreFull.wait();
+		ResponseChunk& chunk = chunks[ccc%2];
+		if (binary == true) {
+			fileIO->write(&chunk.data[0], sizeof(float), chunk.nbFreq*nbAngle);
+		} else {
+			writeChunkText(fileIO, &chunk.data[0], chunk.firstFreq, chunk.nbFreq, nbAngle, nbFreq);
+		}
+		TEST_VERBOSE("write : " << chunk.firstFreq + chunk.nbFreq << "/" << nbFreq);
+		semaphoreFree.post();
+	}
+	producer.join();
 	fileIO->close();
 	return 0;
-}
\ No newline at end of file
+}
@@ -32,6 +32,7 @@ def configure(target, my_module):
 	my_module.add_depend([
 	    'm',
 	    'etk',
+	    'audio-algo-drain',
 	    'test-debug'
 	    ])
 	return True
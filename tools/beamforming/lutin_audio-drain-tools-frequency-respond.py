@@ -32,6 +32,8 @@ def configure(target, my_module):
 	my_module.add_depend([
 	    'm',
 	    'etk',
+	    'audio-algo-drain',
+	    'ethread',
 	    'test-debug'
 	    ])
 	return True